@@ -30,7 +30,9 @@ LOCAL_SRC_FILES := \
     src/acdb_utility.c\
     src/acdb_data_proc.c\
     src/acdb_heap.c\
-    src/acdb_context_mgr.c
+    src/acdb_context_mgr.c\
+    src/acdb_gkv_index.c\
+    src/acdb_sort.c
 
 LOCAL_MODULE := libar-acdb
 LOCAL_MODULE_OWNER := qti
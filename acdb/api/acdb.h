@@ -2292,6 +2292,16 @@ int32_t acdb_remove_database(const acdb_handle_t* acdb_handle);
 */
 int32_t acdb_get_handle(AcdbFile* acdb_file, acdb_handle_t* acdb_handle);
 
+/**
+* \brief
+*       Retrieves the data version. The version changes whenever calibration
+*       data is set, persisted, deleted or reloaded (including changes made
+*       through ATS), so clients that cache data read from the ACDB can
+*       compare it with the version they cached at to detect stale entries.
+* \return the current data version
+*/
+uint32_t acdb_get_data_version(void);
+
 /** @ingroup ACDB_IOCTL
 
 	Main entry function to the ACDB. This entry function takes any
@@ -2324,6 +2334,73 @@ int32_t acdb_ioctl(uint32_t cmd_id,
 	const void *cmd_struct, uint32_t cmd_struct_size,
 	void *rsp_struct, uint32_t rsp_struct_size);
 
+/** @ingroup ACDB_IOCTL
+
+	Allocates the response buffer of a command executed with
+	acdb_ioctl_alloc().
+
+	@param[in] size
+	Number of bytes needed for the response. This is never zero.
+	@param[in] context
+	The alloc_context passed to acdb_ioctl_alloc().
+
+	@return
+	A buffer of at least size bytes, or NULL if it cannot be allocated.
+*/
+typedef void *(*AcdbAllocCallback)(uint32_t size, void *context);
+
+/** @ingroup ACDB_IOCTL
+
+	Single-call variant of acdb_ioctl() for commands whose response size
+	is not known up front. Instead of calling acdb_ioctl() once with a
+	NULL buffer to query the size and again to fill the buffer, the
+	caller passes an allocator. ACDB SW looks up the command once,
+	calls alloc_cb with the response size and fills the returned buffer
+	while holding the database for the whole call.
+
+	Supported commands and the response buffer that is allocated:
+	 - ACDB_CMD_GET_GRAPH: AcdbGetGraphRsp.subgraphs
+	 - ACDB_CMD_GET_SUBGRAPH_CALIBRATION_DATA_NONPERSIST: AcdbBlob.buf
+	 - ACDB_CMD_GET_PROC_SUBGRAPH_CAL_DATA_PERSIST:
+	   AcdbSgIdPersistCalData.cal_data
+
+	The buffer pointer in the response must be NULL on entry. alloc_cb
+	is not called when the response is empty, in which case the buffer
+	pointer stays NULL. Once alloc_cb has returned a buffer, the buffer
+	is stored in the response and belongs to the caller even if the
+	command fails afterwards.
+
+	acdb_ioctl() remains available for all commands; both calls return
+	the same data.
+
+	@param[in] cmd_id
+	Command ID to execute on the Audio Calibration Database.
+	@param[in] cmd
+	Pointer to the command structure.
+	@param[in] cmd_size
+	Size of the command structure.
+	@param[out] rsp
+	Pointer to the response structure.
+	@param[in] rsp_size
+	Size of the response structure.
+	@param[in] alloc_cb
+	Allocator for the response buffer.
+	@param[in] alloc_context
+	Client context passed to alloc_cb.
+
+	@return
+	The result of the call as defined by the command.
+	AR_EUNSUPPORTED if the command is not supported by this call.
+	AR_ENOMEMORY if alloc_cb returns NULL.
+
+	@dependencies
+	None
+*/
+int32_t acdb_ioctl_alloc(uint32_t cmd_id,
+	const void *cmd_struct, uint32_t cmd_struct_size,
+	void *rsp_struct, uint32_t rsp_struct_size,
+	AcdbAllocCallback alloc_cb, void *alloc_context);
+
 #ifdef __cplusplus
 }
 #endif /*__cplusplus*/
@@ -14,12 +14,14 @@
 #include <errno.h>
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include "adie_rtc_api.h"
 #include "ar_osal_error.h"
 #include "ar_osal_file_io.h"
 #include "ar_osal_log.h"
+#include "ar_osal_timer.h"
 
 #define CDC_REG_DIG_BASE_READ    0x200
 #define CDC_REG_DIG_OFFSET    0x000
@@ -31,6 +33,11 @@
 #define WCD939X_I2C_REG_MAX 0x4FF
 #define WCD939X_I2C_REG_MIN 0
 #define IS_I2C_REG(reg) (((reg) >= WCD939X_I2C_REG_MIN) && ((reg) <= WCD939X_I2C_REG_MAX))
+/* How long a parsed register dump is reused before the regmap is read again.
+ * Registers can also be changed by the codec driver, so the dump is only
+ * trusted for the length of a burst of tuning reads */
+#define REG_SNAPSHOT_TTL_MS 500
+#define REG_SNAPSHOT_INITIAL_ENTRIES 256
 
 #define LOG_TAG "ADIE_RTC"
 
@@ -71,6 +78,20 @@ static struct chipset_id_info codec_chipset[] = {
     {"CODEC_UNDEFINED", CODEC_UNDEFINED}
 };
 
+struct reg_entry {
+    uint32_t    address;
+    uint32_t    value;
+};
+
+/* Register values parsed from a regmap dump, sorted by address */
+struct reg_snapshot {
+    struct reg_entry    *entries;
+    uint32_t    num_entries;
+    uint32_t    max_entries;
+    uint64_t    timestamp_ms;
+    int         is_valid;
+};
+
 struct codec_info {
     uint32_t    handle;
     uint32_t    chipset_id;
@@ -81,18 +102,19 @@ struct codec_info {
     char        address_path[FILE_NAME_LENGTH]; /* regmap/codec_name/address */
     char        data_path[FILE_NAME_LENGTH]; /* regmap/codec_name/path */
     int         is_address_data_paths_available;
+    struct reg_snapshot snapshot;
  };
 
 struct wcd939x_i2c_reg_info {
     char        reg_path[FILE_NAME_LENGTH];
     char        address_path[FILE_NAME_LENGTH]; /* regmap/codec_name/address */
     char        data_path[FILE_NAME_LENGTH]; /* regmap/codec_name/path */
+    struct reg_snapshot snapshot;
 } wcd939x_i2c_info;
 
 static struct codec_info *codec_info;
 static uint32_t found_codec_path;
 static uint32_t number_of_codecs;
-static uint32_t register_length = 4;
 
 static int lnx_to_ar(int lx_err)
 {
@@ -568,6 +590,198 @@ done:
     return rc;
 }
 
+static int compare_reg_entry(const void *a, const void *b)
+{
+    const struct reg_entry *lhs = (const struct reg_entry *)a;
+    const struct reg_entry *rhs = (const struct reg_entry *)b;
+
+    if (lhs->address < rhs->address)
+        return -1;
+    return lhs->address > rhs->address;
+}
+
+static void free_reg_snapshot(struct reg_snapshot *snapshot)
+{
+    free(snapshot->entries);
+    memset(snapshot, 0, sizeof(*snapshot));
+}
+
+static void invalidate_reg_snapshots(int32_t codec_idx)
+{
+    codec_info[codec_idx].snapshot.is_valid = 0;
+    wcd939x_i2c_info.snapshot.is_valid = 0;
+}
+
+/*
+ * Parses a regmap dump made of "<address>: <value>" lines into the
+ * snapshot. The dump is normally in address order, so it is only sorted
+ * when it is not.
+ */
+static int parse_reg_snapshot(struct reg_snapshot *snapshot,
+                char_t *rtc_io_buf, int32_t rtc_io_buf_size)
+{
+    struct reg_entry *temp;
+    char_t *cur = rtc_io_buf;
+    char_t *end = rtc_io_buf + rtc_io_buf_size;
+    char_t *next;
+    uint32_t address;
+    uint32_t value;
+    int is_sorted = 1;
+
+    snapshot->num_entries = 0;
+    while (cur < end) {
+        while (cur < end && isspace((unsigned char)*cur))
+            cur++;
+        if (cur == end)
+            break;
+
+        address = strtoul(cur, &next, 16);
+        if (next == cur || *next != ':') {
+            AR_LOG_ERR(LOG_TAG,"%s: malformed register entry at offset %d\n",
+                    __func__, (int)(cur - rtc_io_buf));
+            return -EINVAL;
+        }
+        cur = next + 1;
+        value = strtoul(cur, &next, 16);
+        if (next == cur) {
+            AR_LOG_ERR(LOG_TAG,"%s: missing value for register[0x%x]\n",
+                    __func__, address);
+            return -EINVAL;
+        }
+        cur = next;
+        while (cur < end && *cur != '\n')
+            cur++;
+        cur++;
+
+        if (address >= CDC_REG_DIG_BASE_READ)
+            address -= CDC_REG_DIG_OFFSET;
+
+        if (snapshot->num_entries == snapshot->max_entries) {
+            uint32_t max_entries = snapshot->max_entries ?
+                snapshot->max_entries * 2 : REG_SNAPSHOT_INITIAL_ENTRIES;
+
+            temp = realloc(snapshot->entries, max_entries * sizeof(struct reg_entry));
+            if (!temp) {
+                AR_LOG_ERR(LOG_TAG,"cannot allocate memory for %d registers", max_entries);
+                return -ENOMEM;
+            }
+            snapshot->entries = temp;
+            snapshot->max_entries = max_entries;
+        }
+
+        if (snapshot->num_entries > 0 &&
+            snapshot->entries[snapshot->num_entries - 1].address > address)
+            is_sorted = 0;
+
+        snapshot->entries[snapshot->num_entries].address = address;
+        snapshot->entries[snapshot->num_entries].value = value;
+        snapshot->num_entries++;
+    }
+
+    if (!is_sorted)
+        qsort(snapshot->entries, snapshot->num_entries,
+                sizeof(struct reg_entry), compare_reg_entry);
+
+    return 0;
+}
+
+/*
+ * Returns the snapshot of the regmap that holds reg_addr, reading the
+ * regmap again if the snapshot was invalidated by a write or is older
+ * than REG_SNAPSHOT_TTL_MS.
+ */
+static int get_reg_snapshot(int32_t codec_idx, uint32_t reg_addr,
+                struct reg_snapshot **snapshot_out, char **reg_path_out)
+{
+    int result = 0;
+    int fd = -1;
+    char_t *rtc_io_buf_base = NULL;
+    int32_t rtc_io_buf_size = 0;
+    uint64_t now_ms = 0;
+    char *reg_path = codec_info[codec_idx].reg_path;
+    struct reg_snapshot *snapshot = &codec_info[codec_idx].snapshot;
+
+    if (codec_info[codec_idx].chipset_id == WCD939X && IS_I2C_REG(reg_addr)) {
+        if (strlen(wcd939x_i2c_info.reg_path) == 0) {
+            AR_LOG_ERR(LOG_TAG,"codec (i2c reg) path is empty\n %d",
+                    codec_info[codec_idx].handle);
+            return -EINVAL;
+        }
+        reg_path = wcd939x_i2c_info.reg_path;
+        snapshot = &wcd939x_i2c_info.snapshot;
+    }
+
+    *snapshot_out = snapshot;
+    *reg_path_out = reg_path;
+
+    now_ms = ar_timer_get_time_in_ms();
+    if (snapshot->is_valid && now_ms - snapshot->timestamp_ms < REG_SNAPSHOT_TTL_MS)
+        return 0;
+
+    snapshot->is_valid = 0;
+
+    fd = open(reg_path, O_RDWR);
+    if(fd < 0)
+    {
+        AR_LOG_ERR(LOG_TAG,"cannot open adie peek error: %d, path: %s",
+                fd, reg_path);
+        return -EINVAL;
+    }
+    result = parse_codec_reg_file(&rtc_io_buf_base, &rtc_io_buf_size, fd, codec_idx);
+    close(fd);
+    if (rtc_io_buf_base == NULL || result < 0)
+    {
+        result = -EINVAL;
+        AR_LOG_ERR(LOG_TAG,"cannot allocate memory: %d, path: %s",
+                READ_STEP_SIZE, reg_path);
+        goto done;
+    }
+    if (rtc_io_buf_size <= 0)
+    {
+        result = -EINVAL;
+        AR_LOG_ERR(LOG_TAG,"length of written bytes does not match expected value %d", rtc_io_buf_size);
+        goto done;
+    }
+
+    /* parse_codec_reg_file always leaves READ_STEP_SIZE bytes of room after
+     * the data, so the dump can be terminated for strtoul */
+    rtc_io_buf_base[rtc_io_buf_size] = '\0';
+    result = parse_reg_snapshot(snapshot, rtc_io_buf_base, rtc_io_buf_size);
+    if (result < 0)
+        goto done;
+
+    snapshot->timestamp_ms = now_ms;
+    snapshot->is_valid = 1;
+    AR_LOG_DEBUG(LOG_TAG,"%s: parsed %d registers from %s\n",
+            __func__, snapshot->num_entries, reg_path);
+
+done:
+    free(rtc_io_buf_base);
+    return result;
+}
+
+static int find_reg_value(const struct reg_snapshot *snapshot,
+                uint32_t reg_addr, uint32_t *value)
+{
+    uint32_t low = 0;
+    uint32_t high = snapshot->num_entries;
+    uint32_t mid;
+
+    while (low < high) {
+        mid = low + (high - low) / 2;
+        if (snapshot->entries[mid].address < reg_addr)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    if (low == snapshot->num_entries || snapshot->entries[low].address != reg_addr)
+        return -EINVAL;
+
+    *value = snapshot->entries[low].value;
+    return 0;
+}
+
 int32_t adie_rtc_get_api_version(struct adie_rtc_version *api_version)
 {
     if (!api_version)
@@ -614,6 +828,14 @@ int32_t adie_rtc_init(void)
 
 int32_t adie_rtc_deinit(void)
 {
+    uint32_t i;
+
+    if (codec_info != NULL) {
+        for (i = 0; i < number_of_codecs; i++)
+            free_reg_snapshot(&codec_info[i].snapshot);
+    }
+    free_reg_snapshot(&wcd939x_i2c_info.snapshot);
+
     free(codec_info);
     codec_info = NULL;
 
@@ -675,27 +897,14 @@ int32_t adie_rtc_get_codec_info(struct adie_rtc_codec_info *cdc_info, uint32_t s
 
 int32_t adie_rtc_get_register(struct adie_rtc_register_req *req)
 {
-    int res = 0;
     int result = 0;
-    int fd = -1;
-    char_t *rtc_io_buf = NULL;
-    char_t *rtc_io_buf_base = NULL;
-    int found = 0;
-    uint32_t ultempRegAddr = 0;
-    int32_t lRegValue = 0;
+    uint32_t lRegValue = 0;
     uint32_t handle = req->codec_handle;
     int32_t codec_idx = 0;
     uint32_t regAddr = req->reg.register_id;
     uint32_t regMask = req->reg.register_mask;
-    size_t numBytes = 0;
-    char_t *pCurInputBuf = NULL;
-    int32_t rtc_io_buf_size = 0;
-    char_t reg[5], val[3];
-    reg[4] = '\0', val[2] = '\0';
-    uint32_t offset = 0;
-    int reg_len, i2c_file_open = 0;
-    char *save;
-    char *token;
+    struct reg_snapshot *snapshot = NULL;
+    char *reg_path = NULL;
 
     codec_idx = find_codec_index(handle);
     if (codec_idx < 0) {
@@ -707,102 +916,25 @@ int32_t adie_rtc_get_register(struct adie_rtc_register_req *req)
         AR_LOG_ERR(LOG_TAG,"codec path is empty\n %d", handle);
         goto done;
     }
-    //AR_LOG_INFO(LOG_TAG,"reg path= %s",codec_info[codec_idx].reg_path);
-    if (codec_info[codec_idx].chipset_id == WCD939X) {
-        if (IS_I2C_REG(regAddr)) {
-           if (strlen(wcd939x_i2c_info.reg_path) == 0) {
-               result = -EINVAL;
-               AR_LOG_ERR(LOG_TAG,"codec (i2c reg) path is empty\n %d", handle);
-               goto done;
-           }
-           fd = open(wcd939x_i2c_info.reg_path, O_RDWR);
-           i2c_file_open = 1;
-        } else {
-            fd = open(codec_info[codec_idx].reg_path, O_RDWR);
-        }
-    } else {
-        fd = open(codec_info[codec_idx].reg_path, O_RDWR);
-    }
-    if(fd < 0)
-    {
-        result = -EINVAL;
-        AR_LOG_ERR(LOG_TAG,"cannot open adie peek error: %d, path: %s",
-                fd, codec_info[codec_idx].reg_path);
+
+    result = get_reg_snapshot(codec_idx, regAddr, &snapshot, &reg_path);
+    if (result < 0)
         goto done;
-    }
-    result = parse_codec_reg_file(&rtc_io_buf_base, &rtc_io_buf_size, fd, codec_idx);
-    if (rtc_io_buf_base == NULL || result < 0)
-    {
-        result = -EINVAL;
-        AR_LOG_ERR(LOG_TAG,"cannot allocate memory: %d, path: %s",
-                READ_STEP_SIZE, codec_info[codec_idx].reg_path);
-            goto close_fd;
-    }
-    if (rtc_io_buf_size <= 0)
+
+    result = find_reg_value(snapshot, regAddr, &lRegValue);
+    if (result < 0)
     {
-        result = -EINVAL;
-        AR_LOG_ERR(LOG_TAG,"length of written bytes does not match expected value %d", rtc_io_buf_size);
-        goto close_fd;
-    }
-    numBytes = rtc_io_buf_size;
-    rtc_io_buf = rtc_io_buf_base;
-    memcpy((void*)reg, (void*)(rtc_io_buf+offset), sizeof(uint32_t));
-    token = strtok_r(reg, ":", &save);
-    if (token == NULL) {
-        AR_LOG_ERR(LOG_TAG,"%s: strtok failed to find register length : delimiter!\n", __func__);
-        result = -EINVAL;
-        goto done;
-    }
-    reg_len = strlen(token);
-    if (reg_len <= 0) {
-        AR_LOG_ERR(LOG_TAG,"%s: register length is %d!\n", __func__, reg_len);
-        result = -EINVAL;
+        AR_LOG_ERR(LOG_TAG,"get adie register[0x%x] failed Peek(%s) Poke(%s)",
+                regAddr, reg_path, reg_path);
         goto done;
     }
-    register_length = reg_len;
-    AR_LOG_DEBUG(LOG_TAG,"%s: valid register length is %d\n", __func__, register_length);
-    while(numBytes>offset)
-    {
-        memcpy((void*)reg, (void*)(rtc_io_buf+offset), sizeof(uint32_t));
-        offset += register_length;
-        ultempRegAddr = strtoul(reg, NULL, 16);
-        offset += 2;
-        memcpy((void*)val, (void*)(rtc_io_buf+offset), sizeof(uint16_t));
-        lRegValue = strtol(val, NULL, 16);
-        offset += 3;
-        if (ultempRegAddr >= CDC_REG_DIG_BASE_READ)
-            ultempRegAddr -= CDC_REG_DIG_OFFSET;
-        if(ultempRegAddr == regAddr)
-        {
-            found = 1;
-            AR_LOG_DEBUG(LOG_TAG,"register[%08X] found from the file!\n",regAddr);
-            break;
-        }
-    }
-    if (found == 0)
-    {
-        result = -EINVAL;
-        if (i2c_file_open) {
-            AR_LOG_ERR(LOG_TAG,"get adie register[0x%x] failed Peek(%s) Poke(%s)",
-                    regAddr, wcd939x_i2c_info.reg_path, wcd939x_i2c_info.reg_path);
-        } else {
-            AR_LOG_ERR(LOG_TAG,"get adie register[0x%x] failed Peek(%s) Poke(%s)",
-                    regAddr, codec_info[codec_idx].reg_path, codec_info[codec_idx].reg_path);
-        }
-        goto close_fd;
-    }
-    else
-    {
-        AR_LOG_ERR(LOG_TAG,"Found the value for register = 0x%X, value = 0x%X\n",regAddr,lRegValue);
-    }
+    AR_LOG_DEBUG(LOG_TAG,"Found the value for register = 0x%X, value = 0x%X\n",regAddr,lRegValue);
+
     /* return a masked value */
     lRegValue &= regMask;
     req->reg.value = lRegValue;/* output value*/
 
-close_fd:
-    close(fd);
 done:
-    free(rtc_io_buf_base);
     return lnx_to_ar(result);
 }
 
@@ -941,6 +1073,7 @@ int32_t adie_rtc_set_register(struct adie_rtc_register_req *req)
 
     AR_LOG_DEBUG(LOG_TAG,"set register request received for ==> reg[%X], val[%X], bytes[%zu]\n",
             regAddr, ulRegValue, numBytes1);
+    invalidate_reg_snapshots(codec_idx);
     if (codec_info->is_address_data_paths_available) {
         result = _adie_rtc_set_register(codec_idx, regAddr, ulRegValue);
     } else {
@@ -1010,6 +1143,7 @@ int32_t adie_rtc_set_multiple_registers(struct adie_rtc_multi_register_req *req,
         result = -EINVAL;
         goto done;
     }
+    invalidate_reg_snapshots(codec_idx);
     for (i = 0; i < req->num_registers; ++i) {
         temp = NULL;
         regAddr = req->register_list[i].register_id;
@@ -1062,26 +1196,16 @@ done:
 
 int32_t adie_rtc_get_multiple_registers(struct adie_rtc_multi_register_req *req, uint32_t size)
 {
-    struct adie_rtc_register_req  sreq;
     uint32_t i = 0;
     uint32_t handle;
     int32_t codec_idx = 0;
-    int fd = -1;
     int result = -EINVAL;
     int found = 0;
-    uint32_t ultempRegAddr = 0;
-    int32_t lRegValue = 0;
-    char_t *rtc_io_buf_base = NULL;
-    char_t *rtc_io_buf = NULL;
-    int32_t rtc_io_buf_size = 0;
-    size_t numBytes = 0;
-    uint32_t regAddr, regMask;
-    char_t reg[5], val[3];
-    char *save;
-    char *token;
-    int reg_len;
+    uint32_t lRegValue = 0;
+    uint32_t regAddr = 0, regMask = 0;
     uint32_t count = 0;
-    uint32_t offset = 0;
+    struct reg_snapshot *snapshot = NULL;
+    char *reg_path = NULL;
 
     if (!req || (size == 0))
         return lnx_to_ar(-EINVAL);
@@ -1099,117 +1223,40 @@ int32_t adie_rtc_get_multiple_registers(struct adie_rtc_multi_register_req *req,
         AR_LOG_ERR(LOG_TAG, "codec path is empty %d", handle);
         goto done;
     }
-    regAddr = req->register_list[0].register_id; //read first reg
-    if (codec_info[codec_idx].chipset_id == WCD939X) {
-        if (IS_I2C_REG(regAddr)) {
-           if (strlen(wcd939x_i2c_info.reg_path) == 0) {
-               result = -EINVAL;
-               AR_LOG_ERR(LOG_TAG,"codec (i2c reg) path is empty\n %d", handle);
-               goto done;
-           }
-           fd = open(wcd939x_i2c_info.reg_path, O_RDWR);
-        } else {
-            fd = open(codec_info[codec_idx].reg_path, O_RDWR);
-        }
-    } else {
-        fd = open(codec_info[codec_idx].reg_path, O_RDWR);
-    }
-    if(fd < 0)
-    {
-        result = -EINVAL;
-        AR_LOG_ERR(LOG_TAG,"cannot open adie peek error: %d, path: %s",
-                fd, codec_info[codec_idx].reg_path);
-        goto done;
-    }
-    result = parse_codec_reg_file(&rtc_io_buf_base, &rtc_io_buf_size, fd, codec_idx);
-    if (rtc_io_buf_base == NULL || result < 0)
-    {
-        result = -EINVAL;
-        AR_LOG_ERR(LOG_TAG,"cannot allocate memory: %d, path: %s",
-                READ_STEP_SIZE, codec_info[codec_idx].reg_path);
-        goto close_fd;
-    }
-    if (rtc_io_buf_size <= 0)
-    {
-        result = -EINVAL;
-        AR_LOG_ERR(LOG_TAG,"length of written bytes does not match expected value %d", rtc_io_buf_size);
-        goto close_fd;
-    }
-    numBytes = rtc_io_buf_size;
-    rtc_io_buf = rtc_io_buf_base;
 
-    reg[4] = '\0', val[2] = '\0';
+    /* Each regmap is parsed at most once for the whole batch */
     for (i = 0; i < req->num_registers; ++i) {
         regAddr = req->register_list[i].register_id;
         regMask = req->register_list[i].register_mask;
 
-        found = 0;
-        offset = 0;
-        if (rtc_io_buf == NULL) {
-            AR_LOG_ERR(LOG_TAG, "rtc_io_buf is NULL");
-            result = -EINVAL;
-            goto close_fd;
-        }
-        memcpy((void*)reg, (void*)(rtc_io_buf+offset), sizeof(uint32_t));
-        token = strtok_r(reg, ":", &save);
-        if (token == NULL) {
-            AR_LOG_ERR(LOG_TAG,"%s: strtok failed to find register length : delimiter!\n", __func__);
-            result = -EINVAL;
-            goto close_fd;
-        }
-        reg_len = strlen(token);
-        if (reg_len <= 0) {
-            AR_LOG_ERR(LOG_TAG,"%s: register length is %d!\n", __func__, reg_len);
-            result = -EINVAL;
+        result = get_reg_snapshot(codec_idx, regAddr, &snapshot, &reg_path);
+        if (result < 0)
             goto done;
-        }
-        register_length = reg_len;
-        AR_LOG_DEBUG(LOG_TAG,"%s: valid register length is %d\n", __func__, register_length);
-        while(numBytes > offset) {
-            memcpy((void*)reg, (void*)(rtc_io_buf+offset), sizeof(uint32_t));
-            offset += register_length;
-            ultempRegAddr = strtoul(reg, NULL, 16);
-            offset += 2;
-            memcpy((void*)val, (void*)(rtc_io_buf+offset), sizeof(uint16_t));
-            lRegValue = strtol(val, NULL, 16);
-            offset += 3;
-            if (ultempRegAddr >= CDC_REG_DIG_BASE_READ)
-                ultempRegAddr -= CDC_REG_DIG_OFFSET;
-
-            if(ultempRegAddr == regAddr)
-            {
-                count++;
-                found = 1;
-                /* return a masked value */
-                lRegValue &= regMask;
-                req->register_list[i].value = lRegValue;
-                usleep(30);
-                AR_LOG_DEBUG(LOG_TAG, "reg[%08X],val[%08X], count[%d]\n",
-                        ultempRegAddr, lRegValue,count);
-                break;
-            }
+
+        found = 0;
+        if (find_reg_value(snapshot, regAddr, &lRegValue) == 0) {
+            count++;
+            found = 1;
+            /* return a masked value */
+            lRegValue &= regMask;
+            req->register_list[i].value = lRegValue;
+            AR_LOG_DEBUG(LOG_TAG, "reg[%08X],val[%08X], count[%d]\n",
+                    regAddr, lRegValue, count);
         }
     }
     if (found == 0) {
         AR_LOG_ERR(LOG_TAG, "GetMultipleAdieReg failed because reg[%08x] is not found\n", regAddr);
         result = -EINVAL;
-        goto close_fd;
+        goto done;
     }
 
     if (result == 0 && req->num_registers != count) {
         AR_LOG_ERR(LOG_TAG, "Error in lengths of input or output buffers or total registers");
         result = 0;
-        goto close_fd;
+        goto done;
     }
 
-close_fd:
-    if (fd != -1)
-        close(fd);
-
 done:
-    if(rtc_io_buf_base)
-        free(rtc_io_buf_base);
-
     return lnx_to_ar(result);
 }
 
@@ -18,12 +18,13 @@
 */
 
 #include "gsl_dls_client_intf.h"
+#include "ats_transport_api.h"
 
 #define ATS_DLS_MAJOR_VERSION 0x1
 #define ATS_DLS_MINOR_VERSION 0x0
 
-typedef int32_t (*ATS_DSL_TCPIP_SEND_CALLBACK)(const uint8_t* buffer, uint32_t buffer_size);
-// int32_t ats_transport_dls_send_callback(const uint8_t* buffer, uint32_t buffer_size);
+typedef int32_t (*ATS_DSL_TCPIP_SEND_CALLBACK)(
+	const ats_transport_segment_t* segments, uint32_t segment_count);
 
 /**
 	\brief
@@ -61,7 +62,7 @@ int32_t ats_dls_init(ATS_DSL_TCPIP_SEND_CALLBACK callback);
 * \brief Releases resources aquired during ats_dls_init(...). These resources
 * include:
 *	1. the dls shared memory pool
-*	2. the ats dls packet buffer for sending binary packets through the dls tcpip server
+*	2. the per log code throughput and drop counters, which are logged first
 *
 * \param [in] callback: The callback function that is invoked when spf notifies
 *                       gsl about ready dls log buffers
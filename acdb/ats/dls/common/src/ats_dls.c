@@ -27,6 +27,7 @@
 #include "ats_common.h"
 #include "ar_osal_mutex.h"
 #include "ar_osal_thread.h"
+#include "ar_osal_timer.h"
 #include "acdb_utility.h"
 #include "acdb_common.h"
 
@@ -38,13 +39,45 @@
 #define ATS_DEFAULT_DLS_BUFFER_SIZE 5120
 /**< The number of DLS buffers in shared memory */
 #define ATS_DEFAULT_DLS_BUFFER_COUNT 30
+/**< The size of the ATS DLS get log packet header: tag(4), version(2), count(2), size(4) */
+#define ATS_DLS_HEADER_SIZE 12
+/**< The header followed by a packet size and packet data segment per buffer */
+#define ATS_DLS_MAX_SEND_SEGMENT_COUNT (1 + 2 * GSL_DLS_CLIENT_MAX_BUFFER_COUNT)
+/**< Each log packet starts with dls_log_hdr_type: len(2), code(2), timestamp(8) */
+#define ATS_DLS_LOG_CODE_OFFSET 2
+/**< The maximum number of log codes that counters are kept for */
+#define ATS_DLS_MAX_LOG_CODE_STATS 32
+
+/**< Throughput and drop counters for one log code */
+typedef struct _ats_dls_log_code_stats_t AtsDlsLogCodeStats;
+struct _ats_dls_log_code_stats_t
+{
+	/**< The log code the counters belong to */
+	uint16_t log_code;
+	/**< The number of log packets sent to the client */
+	uint32_t packets_sent;
+	/**< The number of log packets that could not be sent */
+	uint32_t packets_dropped;
+	/**< The number of log packet bytes sent to the client */
+	uint64_t bytes_sent;
+	/**< The time in ms when the counters were started */
+	uint64_t start_time_ms;
+};
 
 /* The dls buffer pool configuration */
 struct gsl_dls_buffer_pool_config_t buffer_pool_config;
-//buffer that stores binary log packets before sending to tcpip dls server
-AtsBuffer dls_data_send_buffer;
 ar_osal_mutex_t buffer_ready_lock;
 ATS_DSL_TCPIP_SEND_CALLBACK ats_dls_tcpip_send_callback;
+/* Per log code counters. Kept under their own lock so that a slow client
+ * does not hold up starting and stopping log codes */
+static ar_osal_mutex_t log_code_stats_lock;
+static AtsDlsLogCodeStats log_code_stats[ATS_DLS_MAX_LOG_CODE_STATS];
+static uint32_t log_code_stats_count;
+/* Gathered write state for the buffer ready callback. Protected by buffer_ready_lock */
+static uint8_t dls_send_header[ATS_DLS_HEADER_SIZE];
+static uint32_t dls_send_packet_sizes[GSL_DLS_CLIENT_MAX_BUFFER_COUNT];
+static struct gls_dls_buffer_t dls_send_log_buffers[GSL_DLS_CLIENT_MAX_BUFFER_COUNT];
+static ats_transport_segment_t dls_send_segments[ATS_DLS_MAX_SEND_SEGMENT_COUNT];
 
 #if defined(_DEVICE_SIM)
 int32_t gsl_dls_client_is_feature_supported()
@@ -91,6 +124,127 @@ int32_t gsl_dls_client_register_deregister_log_code(uint32_t log_code, bool_t is
 
 int32_t ats_dls_buffer_ready_callback(void);
 
+/**
+* \brief Finds the counters for a log code, adding them if the log code is new.
+* The caller must hold log_code_stats_lock
+*
+* \param [in] log_code: The log code to find counters for
+* \return the counters or NULL if the counter table is full
+*/
+static AtsDlsLogCodeStats *ats_dls_get_log_code_stats(uint16_t log_code)
+{
+	AtsDlsLogCodeStats *stats = NULL;
+
+	for (uint32_t i = 0; i < log_code_stats_count; i++)
+	{
+		if (log_code_stats[i].log_code == log_code)
+			return &log_code_stats[i];
+	}
+
+	if (log_code_stats_count >= ATS_DLS_MAX_LOG_CODE_STATS)
+		return NULL;
+
+	stats = &log_code_stats[log_code_stats_count++];
+	ar_mem_set(stats, 0, sizeof(AtsDlsLogCodeStats));
+	stats->log_code = log_code;
+	stats->start_time_ms = ar_timer_get_time_in_ms();
+
+	return stats;
+}
+
+/**
+* \brief Counts a log packet as sent or dropped against its log code
+*
+* \param [in] log_buffer: The DLS buffer containing the log packet
+* \param [in] is_sent: TRUE if the packet was sent, FALSE if it was dropped
+*/
+static void ats_dls_update_log_code_stats(
+	const struct gls_dls_buffer_t *log_buffer, bool_t is_sent)
+{
+	uint16_t log_code = 0;
+	AtsDlsLogCodeStats *stats = NULL;
+
+	if (log_buffer->size < ATS_DLS_LOG_CODE_OFFSET + sizeof(uint16_t))
+		return;
+
+	ar_mem_cpy((uint8_t*)&log_code, sizeof(uint16_t),
+		log_buffer->buffer + ATS_DLS_LOG_CODE_OFFSET, sizeof(uint16_t));
+
+	ACDB_MUTEX_LOCK(log_code_stats_lock);
+
+	stats = ats_dls_get_log_code_stats(log_code);
+	if (IsNull(stats))
+	{
+		ACDB_MUTEX_UNLOCK(log_code_stats_lock);
+		return;
+	}
+
+	if (is_sent)
+	{
+		stats->packets_sent++;
+		stats->bytes_sent += log_buffer->size;
+	}
+	else
+	{
+		stats->packets_dropped++;
+	}
+
+	ACDB_MUTEX_UNLOCK(log_code_stats_lock);
+}
+
+/**
+* \brief Logs the throughput and drop counters of a log code and removes them
+* from the counter table. The caller must hold log_code_stats_lock
+*
+* \param [in] index: The index of the counters in the counter table
+*/
+static void ats_dls_report_log_code_stats(uint32_t index)
+{
+	AtsDlsLogCodeStats *stats = &log_code_stats[index];
+	uint64_t elapsed_ms = ar_timer_get_time_in_ms() - stats->start_time_ms;
+	uint64_t bytes_per_sec = 0;
+
+	if (elapsed_ms > 0)
+		bytes_per_sec = stats->bytes_sent * 1000 / elapsed_ms;
+
+	ATS_INFO("Log code 0x%x: %u packets sent, %u packets dropped, "
+		"%llu bytes sent in %llu ms (%llu bytes/s)",
+		stats->log_code, stats->packets_sent, stats->packets_dropped,
+		(unsigned long long)stats->bytes_sent,
+		(unsigned long long)elapsed_ms,
+		(unsigned long long)bytes_per_sec);
+
+	log_code_stats[index] = log_code_stats[--log_code_stats_count];
+}
+
+/**
+* \brief Writes the ATS DLS get log packet header. See ats_dls_get_log_data
+* for the format
+*
+* \param [out] buf: The buffer to write the ATS_DLS_HEADER_SIZE byte header to
+* \param [in] log_buffer_count: The number of log packets following the header
+* \param [in] total_log_data_size: The size of the log packets following the header
+*/
+static void ats_dls_write_log_data_header(uint8_t *buf,
+	uint16_t log_buffer_count, uint32_t total_log_data_size)
+{
+	uint32_t offset = 0;
+	AtsDlsLogDataHeader header = { 0 };
+
+	header.header_id = ATS_DLS_HEADER_TAG;
+	header.header_version = ATS_DLS_HEADER_VERSION;
+	header.log_buffer_count = log_buffer_count;
+	header.total_log_data_size = total_log_data_size;
+
+	ATS_MEM_CPY_SAFE(buf + offset, sizeof(uint32_t), &header.header_id, sizeof(uint32_t));
+	offset += sizeof(uint32_t);
+	ATS_MEM_CPY_SAFE(buf + offset, sizeof(uint16_t), &header.header_version, sizeof(uint16_t));
+	offset += sizeof(uint16_t);
+	ATS_MEM_CPY_SAFE(buf + offset, sizeof(uint16_t), &header.log_buffer_count, sizeof(uint16_t));
+	offset += sizeof(uint16_t);
+	ATS_MEM_CPY_SAFE(buf + offset, sizeof(uint32_t), &header.total_log_data_size, sizeof(uint32_t));
+}
+
 int32_t ats_dls_register_log_code(
 	uint8_t *cmd_buf,
 	uint32_t cmd_buf_size,
@@ -112,6 +266,16 @@ int32_t ats_dls_register_log_code(
 
 	status = gsl_dls_client_register_deregister_log_code(log_code, TRUE);
 
+	if (AR_SUCCEEDED(status))
+	{
+		ACDB_MUTEX_LOCK(log_code_stats_lock);
+		if (IsNull(ats_dls_get_log_code_stats((uint16_t)log_code)))
+		{
+			ATS_DBG("No counters are kept for log code 0x%x", log_code);
+		}
+		ACDB_MUTEX_UNLOCK(log_code_stats_lock);
+	}
+
 	*rsp_buf_bytes_filled = 0;
 	return status;
 }
@@ -140,6 +304,17 @@ int32_t ats_dls_deregister_log_code(
 
 	status = gsl_dls_client_register_deregister_log_code(log_code, FALSE);
 
+	ACDB_MUTEX_LOCK(log_code_stats_lock);
+	for (uint32_t i = 0; i < log_code_stats_count; i++)
+	{
+		if (log_code_stats[i].log_code == (uint16_t)log_code)
+		{
+			ats_dls_report_log_code_stats(i);
+			break;
+		}
+	}
+	ACDB_MUTEX_UNLOCK(log_code_stats_lock);
+
 	*rsp_buf_bytes_filled = 0;
 	return status;
 }
@@ -207,26 +382,33 @@ int32_t ats_dls_get_log_data(
 
 	__UNREFERENCED_PARAM(cmd_buf);
 	__UNREFERENCED_PARAM(cmd_buf_size);
-	__UNREFERENCED_PARAM(rsp_buf_size);
 
 	int32_t status = AR_EOK;
 	uint32_t offset = 0;
-	uint32_t dls_log_data_rsp_header_size = 12;
+	uint16_t log_buffer_count = 0;
+	uint32_t total_log_data_size = 0;
 	struct gsl_dls_ready_buffer_index_list_t ready_buffer_index_list;
+	struct gsl_dls_ready_buffer_index_list_t used_buffer_index_list;
 	struct gls_dls_buffer_t log_buffer;
-	AtsDlsLogDataHeader rsp = {0};
 
 	*rsp_buf_bytes_filled = 0;
 
+	if (rsp_buf_size < ATS_DLS_HEADER_SIZE)
+		return AR_ENEEDMORE;
+
+	ACDB_MUTEX_LOCK(buffer_ready_lock);
+
 	gsl_dls_client_get_ready_dls_buffer_list(&ready_buffer_index_list);
 
 	if (ready_buffer_index_list.buffer_count == 0)
+	{
+		ACDB_MUTEX_UNLOCK(buffer_ready_lock);
 		return status;
+	}
 
-	/* skip the header and write it later
-	 * the header isn't 4-byte aligned so subtract 4 bytes due to struct alignment
-	 */
-	offset += dls_log_data_rsp_header_size;
+	/* skip the header and write it later */
+	offset += ATS_DLS_HEADER_SIZE;
+	used_buffer_index_list.buffer_count = 0;
 
 	ATS_DBG("#dls ready buffers %d", ready_buffer_index_list.buffer_count);
 
@@ -235,9 +417,15 @@ int32_t ats_dls_get_log_data(
 		status = gsl_dls_client_get_log_buffer(ready_buffer_index_list.buffer_index_list[index], &log_buffer);
 		if(AR_FAILED(status))
 		{
+			used_buffer_index_list.buffer_index_list[used_buffer_index_list.buffer_count++] =
+				ready_buffer_index_list.buffer_index_list[index];
 			continue;
 		}
 
+		/* Buffers that don't fit stay ready and are sent with the next request */
+		if (sizeof(uint32_t) + log_buffer.size > rsp_buf_size - offset)
+			break;
+
 		ATS_DBG("Buffer size received from dls client is %d bytes", log_buffer.size);
 
 		ATS_MEM_CPY_SAFE(rsp_buf + offset, sizeof(uint32_t), &log_buffer.size, sizeof(uint32_t));
@@ -247,33 +435,25 @@ int32_t ats_dls_get_log_data(
 		offset += log_buffer.size;
 
 		//include log buffer size filed and data in the total size
-		rsp.total_log_data_size += sizeof(uint32_t) + log_buffer.size;
-	}
+		total_log_data_size += sizeof(uint32_t) + log_buffer.size;
+		log_buffer_count++;
 
-	//Write header
-	ATS_DBG("writing header");
-	rsp.header_id = ATS_DLS_HEADER_TAG;
-	rsp.header_version = ATS_DLS_HEADER_VERSION;
-	rsp.log_buffer_count = ready_buffer_index_list.buffer_count;
+		used_buffer_index_list.buffer_index_list[used_buffer_index_list.buffer_count++] =
+			ready_buffer_index_list.buffer_index_list[index];
+		ats_dls_update_log_code_stats(&log_buffer, TRUE);
+	}
 	status = AR_EOK;
 
-	offset = 0;
-	ATS_MEM_CPY_SAFE(rsp_buf + offset, sizeof(uint32_t), &rsp.header_id, sizeof(uint32_t));
-	offset += sizeof(uint32_t);
-	ATS_MEM_CPY_SAFE(rsp_buf + offset, sizeof(uint16_t), &rsp.header_version, sizeof(uint16_t));
-	offset += sizeof(uint16_t);
-	ATS_MEM_CPY_SAFE(rsp_buf + offset, sizeof(uint16_t), &rsp.log_buffer_count, sizeof(uint16_t));
-	offset += sizeof(uint16_t);
-	ATS_MEM_CPY_SAFE(rsp_buf + offset, sizeof(uint32_t), &rsp.total_log_data_size, sizeof(uint32_t));
-	offset += sizeof(uint32_t);
-
-	// ATS_MEM_CPY_SAFE(rsp_buf, sizeof(uint32_t), &rsp, sizeof(AtsDlsLogDataHeader));
-	*rsp_buf_bytes_filled += sizeof(AtsDlsLogDataHeader) + rsp.total_log_data_size;
+	ats_dls_write_log_data_header(rsp_buf, log_buffer_count, total_log_data_size);
+	*rsp_buf_bytes_filled += ATS_DLS_HEADER_SIZE + total_log_data_size;
 
 	ATS_DBG("return buffers to spf");
-	gsl_dls_client_return_used_buffers(&ready_buffer_index_list);
+	if (used_buffer_index_list.buffer_count > 0)
+		gsl_dls_client_return_used_buffers(&used_buffer_index_list);
 	ATS_DBG("done returning buffers to spf");
 
+	ACDB_MUTEX_UNLOCK(buffer_ready_lock);
+
 	return status;
 }
 
@@ -351,6 +531,17 @@ int32_t ats_dls_init(ATS_DSL_TCPIP_SEND_CALLBACK callback)
 		return status;
 	}
 
+	status = ar_osal_mutex_create(&log_code_stats_lock);
+	if (AR_FAILED(status))
+	{
+		ATS_ERR("Error[%d]: Failed to create log code stats lock", status);
+		ar_osal_mutex_destroy(buffer_ready_lock);
+		return status;
+	}
+
+	log_code_stats_count = 0;
+	ats_dls_tcpip_send_callback = callback;
+
 	status = ats_register_service(ATS_DLS_SERVICE_ID, ats_dls_ioctl);
 	if (AR_FAILED(status))
 	{
@@ -366,15 +557,13 @@ int32_t ats_dls_init(ATS_DSL_TCPIP_SEND_CALLBACK callback)
 	{
 		ATS_ERR("Error[%d]: Failed initialize dls client", status);
 	}
-	//allocate buffer for storing dls log buffer
 
-	dls_data_send_buffer.buffer_size = buffer_pool_config.buffer_count *buffer_pool_config.buffer_size;
-	dls_data_send_buffer.buffer = ACDB_MALLOC(uint8_t, dls_data_send_buffer.buffer_size);
-
-	ats_dls_tcpip_send_callback = callback;
 destroy_lock:
 	if(AR_FAILED(status))
+	{
+		ar_osal_mutex_destroy(log_code_stats_lock);
 		ar_osal_mutex_destroy(buffer_ready_lock);
+	}
 
 	return status;
 }
@@ -404,29 +593,92 @@ int32_t ats_dls_deinit(void)
 		ATS_DBG("Error[%d]: Failed to deregister ATS Data Logging Service.", status, 0);
 	}
 
-	ar_osal_mutex_destroy(buffer_ready_lock);
+	ACDB_MUTEX_LOCK(log_code_stats_lock);
+	while (log_code_stats_count > 0)
+	{
+		ats_dls_report_log_code_stats(log_code_stats_count - 1);
+	}
+	ACDB_MUTEX_UNLOCK(log_code_stats_lock);
 
-	//free ats dls send buffer
+	ar_osal_mutex_destroy(log_code_stats_lock);
+	ar_osal_mutex_destroy(buffer_ready_lock);
 
 	return status;
 }
 
+/**
+* \brief Sends the ready log buffers to the client with one gathered write
+* straight from the DLS shared memory pool. The buffers are returned to SPF as
+* soon as the write completes. Returning them one at a time would cost an SPF
+* round trip per buffer, so they are returned with one command.
+*/
 int32_t ats_dls_buffer_ready_callback(void)
 {
 	int32_t status = AR_EOK;
-	uint32_t bytes_written = 0;
+	uint16_t log_buffer_count = 0;
+	uint32_t total_log_data_size = 0;
+	uint32_t segment_count = 1;
+	struct gls_dls_buffer_t *log_buffer = NULL;
+	struct gsl_dls_ready_buffer_index_list_t ready_buffer_index_list;
 
 	ACDB_MUTEX_LOCK(buffer_ready_lock);
 
-	ar_mem_set(dls_data_send_buffer.buffer, 0, dls_data_send_buffer.buffer_size);
+	gsl_dls_client_get_ready_dls_buffer_list(&ready_buffer_index_list);
+
+	if (ready_buffer_index_list.buffer_count == 0)
+	{
+		ACDB_MUTEX_UNLOCK(buffer_ready_lock);
+		return status;
+	}
+
+	ATS_DBG("#dls ready buffers %d", ready_buffer_index_list.buffer_count);
+
+	for (uint16_t index = 0; index < ready_buffer_index_list.buffer_count; index++)
+	{
+		log_buffer = &dls_send_log_buffers[log_buffer_count];
+		status = gsl_dls_client_get_log_buffer(ready_buffer_index_list.buffer_index_list[index], log_buffer);
+		if (AR_FAILED(status))
+		{
+			continue;
+		}
+
+		dls_send_packet_sizes[log_buffer_count] = log_buffer->size;
+
+		dls_send_segments[segment_count].buf = (const uint8_t*)&dls_send_packet_sizes[log_buffer_count];
+		dls_send_segments[segment_count].size = sizeof(uint32_t);
+		segment_count++;
+		dls_send_segments[segment_count].buf = log_buffer->buffer;
+		dls_send_segments[segment_count].size = log_buffer->size;
+		segment_count++;
 
-	status = ats_dls_get_log_data(NULL, 0,
-		dls_data_send_buffer.buffer,
-		dls_data_send_buffer.buffer_size,
-		&bytes_written);
+		total_log_data_size += sizeof(uint32_t) + log_buffer->size;
+		log_buffer_count++;
+	}
+	status = AR_EOK;
 
-	ATS_DBG("calling ats dls tcpip send callback. sending %d bytes", bytes_written);
-	ats_dls_tcpip_send_callback(dls_data_send_buffer.buffer, bytes_written);
+	if (log_buffer_count > 0)
+	{
+		ats_dls_write_log_data_header(dls_send_header, log_buffer_count, total_log_data_size);
+		dls_send_segments[0].buf = dls_send_header;
+		dls_send_segments[0].size = ATS_DLS_HEADER_SIZE;
+
+		ATS_DBG("calling ats dls tcpip send callback. sending %d bytes",
+			ATS_DLS_HEADER_SIZE + total_log_data_size);
+		status = ats_dls_tcpip_send_callback(dls_send_segments, segment_count);
+		if (AR_FAILED(status))
+		{
+			ATS_ERR("Error[%d]: Failed to send %d log packets. Dropping them",
+				status, log_buffer_count);
+		}
+
+		for (uint16_t i = 0; i < log_buffer_count; i++)
+		{
+			ats_dls_update_log_code_stats(&dls_send_log_buffers[i], AR_SUCCEEDED(status));
+		}
+	}
+
+	/* The log data has left the shared memory pool, so SPF can reuse the buffers */
+	gsl_dls_client_return_used_buffers(&ready_buffer_index_list);
 
 	ACDB_MUTEX_UNLOCK(buffer_ready_lock);
 
@@ -3145,6 +3145,34 @@ int32_t ats_deregister_service(uint32_t servie_id);
 */
 int32_t ats_get_service_info(AtsCmdGetServiceInfoRsp *svc_info_rsp, uint32_t rsp_buf_len);
 
+/**
+* \brief ats_stream_is_supported
+*		Checks whether the response of the executing command can be sent to
+*       the client in pieces instead of through the ATS response buffer
+* \return TRUE if the response can be streamed, FALSE otherwise
+*/
+bool_t ats_stream_is_supported(void);
+
+/**
+* \brief ats_stream_begin
+*		Starts a streamed response for the executing command. The response
+*       header is sent with the first call to ats_stream_write. Once started,
+*       the service callback must not write to its response buffer.
+* \param [in] data_length: The total number of bytes that will be written
+* \return 0 on success, non-zero on failure
+*/
+int32_t ats_stream_begin(uint32_t data_length);
+
+/**
+* \brief ats_stream_write
+*		Sends the next part of a streamed response. The data can be sent from
+*       any memory, including the service callback's response buffer.
+* \param [in] buf: The data to send
+* \param [in] size: The number of bytes in buf
+* \return 0 on success, non-zero on failure
+*/
+int32_t ats_stream_write(const uint8_t *buf, uint32_t size);
+
 
 #ifdef __cplusplus
 }  /* extern "C" */
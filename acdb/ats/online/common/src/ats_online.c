@@ -245,6 +245,76 @@ int32_t ats_onc_get_acdb_files_info(
     return status;
 }
 
+/**
+* \brief ats_onc_stream_file_write
+*		Sends file data read by the file manager to the client. The
+*       streamed response is started on the first write once the size of
+*       the file data is known.
+*
+* \param [in] context: Points to a bool_t that is TRUE once the stream is started
+*/
+static int32_t ats_onc_stream_file_write(void *context,
+    uint32_t total_size, const uint8_t *buf, uint32_t size)
+{
+    int32_t status = AR_EOK;
+    bool_t *is_started = (bool_t*)context;
+
+    if (!*is_started)
+    {
+        status = ats_stream_begin(total_size);
+        if (AR_FAILED(status))
+            return status;
+
+        *is_started = TRUE;
+    }
+
+    return ats_stream_write(buf, size);
+}
+
+/**
+* \brief ats_onc_get_loaded_file_data
+*		Returns data from a loaded *.acdb or *.qwsp file. When the transport
+*       supports it, the data is streamed to the client so that the size of
+*       the request is not limited by the response buffer.
+*
+* \sa ats_onc_get_acdb_file
+* \sa ats_onc_get_selected_acdb_file
+*/
+static int32_t ats_onc_get_loaded_file_data(
+    AcdbFileManGetFileDataReq *req,
+    uint8_t *rsp_buf,
+    uint32_t rsp_buf_size,
+    uint32_t *rsp_buf_bytes_filled)
+{
+    int32_t status = AR_EOK;
+    bool_t is_started = FALSE;
+    AcdbFileManBlob rsp = { 0 };
+    AcdbFileManStream stream = { 0 };
+
+    if (ats_stream_is_supported())
+    {
+        /* The response buffer is only used as scratch space for reading
+         * files that are not cached */
+        stream.write = ats_onc_stream_file_write;
+        stream.context = &is_started;
+        stream.size = rsp_buf_size;
+        stream.buf = rsp_buf;
+
+        status = AtsCmdStreamLoadedFileData(req, &stream);
+
+        *rsp_buf_bytes_filled = 0;
+        return status;
+    }
+
+    rsp.size = rsp_buf_size;
+    rsp.buf = rsp_buf;
+
+    status = AtsCmdGetLoadedFileData(req, &rsp);
+
+    *rsp_buf_bytes_filled = rsp.bytes_filled;
+    return status;
+}
+
 /**
 * \brief get_acdb_file
 *		Downloads the requested ACDB data file from the target.
@@ -262,7 +332,6 @@ int32_t ats_onc_get_acdb_file(
     __UNREFERENCED_PARAM(cmd_buf_size);
 
     int32_t status = AR_EOK;
-    AcdbFileManBlob rsp = { 0 };
     AcdbFileManGetFileDataReq req = { 0 };
     int32_t sz_request = sizeof(AcdbFileManGetFileDataReq)
         - sizeof(size_t) - sizeof(req.acdb_handle);
@@ -277,17 +346,14 @@ int32_t ats_onc_get_acdb_file(
     req.file_name = &cmd_buf[sz_request];
     req.acdb_handle = 0;
 
-    rsp.size = rsp_buf_size;
-    rsp.buf = rsp_buf;
-
-    status = AtsCmdGetLoadedFileData(&req, &rsp);
+    status = ats_onc_get_loaded_file_data(&req,
+        rsp_buf, rsp_buf_size, rsp_buf_bytes_filled);
 
     if (AR_FAILED(status))
     {
         ATS_ERR("Error[%d]: Failed to retrieve loaded acdb file info", status);
     }
 
-    *rsp_buf_bytes_filled = rsp.bytes_filled;
     return status;
 }
 
@@ -1153,7 +1219,6 @@ int32_t ats_onc_get_selected_acdb_file(uint8_t* cmd_buf,
     __UNREFERENCED_PARAM(cmd_buf_size);
 
     int32_t status = AR_EOK;
-    AcdbFileManBlob rsp = { 0 };
     AcdbFileManGetFileDataReq req = { 0 };
     int32_t sz_request = sizeof(AcdbFileManGetFileDataReq) - sizeof(size_t);
 
@@ -1165,18 +1230,14 @@ int32_t ats_onc_get_selected_acdb_file(uint8_t* cmd_buf,
     ACDB_MEM_CPY_SAFE(&req, sz_request, cmd_buf, sz_request);
     req.file_name = &cmd_buf[sz_request];
 
-    rsp.size = rsp_buf_size;
-    rsp.buf = rsp_buf;
-
-    status = AtsCmdGetLoadedFileData(&req, &rsp);
+    status = ats_onc_get_loaded_file_data(&req,
+        rsp_buf, rsp_buf_size, rsp_buf_bytes_filled);
 
     if (AR_FAILED(status))
     {
         ATS_ERR("Failed to retrieve loaded acdb file info");
     }
 
-    *rsp_buf_bytes_filled = rsp.bytes_filled;
-
     return status;
 }
 
@@ -1407,6 +1468,8 @@ int32_t ats_online_ioctl(
 )
 {
     int32_t status = AR_EOK;
+    /* Commands that modify ACDB data lock out all other ACDB clients */
+    bool_t is_exclusive = FALSE;
 
     int32_t(*func_cb)(
         uint8_t *cmd_buf,
@@ -1429,6 +1492,7 @@ int32_t ats_online_ioctl(
         break;
     case ATS_CMD_ONC_SET_MAX_BUFFER_LENGTH:
         func_cb = ats_onc_set_max_buffer_length;
+        is_exclusive = TRUE;
         break;
     case ATS_CMD_ONC_GET_ACDB_FILES_INFO:
         func_cb = ats_onc_get_acdb_files_info;
@@ -1447,30 +1511,37 @@ int32_t ats_online_ioctl(
         break;
     case ATS_CMD_ONC_SET_CAL_DATA_NON_PERSIST:
         func_cb = ats_onc_set_cal_data_non_persist;
+        is_exclusive = TRUE;
         break;
     case ATS_CMD_ONC_SET_CAL_DATA_NON_PERSIST_2:
         func_cb = ats_onc_set_cal_data_non_persist_2;
+        is_exclusive = TRUE;
         break;
     case ATS_CMD_ONC_GET_CAL_DATA_PERSIST:
         func_cb = ats_onc_get_cal_data_persist;
         break;
     case ATS_CMD_ONC_SET_CAL_DATA_PERSIST:
         func_cb = ats_onc_set_cal_data_persist;
+        is_exclusive = TRUE;
         break;
     case ATS_CMD_ONC_SET_CAL_DATA_PERSIST_2:
         func_cb = ats_onc_set_cal_data_persist_2;
+        is_exclusive = TRUE;
         break;
     case ATS_CMD_ONC_GET_TAG_DATA:
         func_cb = ats_onc_get_tag_data;
         break;
     case ATS_CMD_ONC_SET_TAG_DATA:
         func_cb = ats_onc_set_tag_data;
+        is_exclusive = TRUE;
         break;
     case ATS_CMD_ONC_SET_TAG_DATA_2:
         func_cb = ats_onc_set_tag_data_2;
+        is_exclusive = TRUE;
         break;
     case ATS_CMD_ONC_DELETE_DELTA_FILES:
         func_cb = ats_onc_delete_delta_files;
+        is_exclusive = TRUE;
         break;
     case ATS_CMD_ONC_IS_DELTA_DATA_SUPPORTED:
         func_cb = ats_onc_is_delta_data_supported;
@@ -1480,6 +1551,7 @@ int32_t ats_online_ioctl(
         break;
     case ATS_CMD_ONC_ACDB_REINIT:
         func_cb = ats_onc_reinit_acdb;
+        is_exclusive = TRUE;
         break;
     case ATS_CMD_ONC_GET_ALL_DB_FILE_SETS:
         func_cb = ats_onc_get_fileset_info;
@@ -1495,6 +1567,7 @@ int32_t ats_online_ioctl(
         break;
     case ATS_CMD_ONC_SELECTED_CLIENT_DB_REINIT:
         func_cb = ats_onc_acdb_reinit_selected_database;
+        is_exclusive = TRUE;
         break;
     case ATS_CMD_ONC_CHECK_SELECTED_CLIENT_CONNECTION:
         func_cb = ats_onc_check_selected_database_connection;
@@ -1507,7 +1580,7 @@ int32_t ats_online_ioctl(
 
     if (status == AR_EOK)
     {
-        ACDB_MUTEX_LOCK(ACDB_CTX_MAN_CLIENT_CMD_LOCK);
+        ACDB_CTX_MAN_CLIENT_CMD_LOCK(is_exclusive);
 
         status = func_cb(cmd_buf,
             cmd_buf_size,
@@ -1515,7 +1588,7 @@ int32_t ats_online_ioctl(
             rsp_buf_size,
             rsp_buf_bytes_filled);
 
-        ACDB_MUTEX_UNLOCK(ACDB_CTX_MAN_CLIENT_CMD_LOCK);
+        ACDB_CTX_MAN_CLIENT_CMD_UNLOCK();
     }
 
     return status;
@@ -122,6 +122,22 @@ struct _ats_key_vector_t
     AcdbKeyValuePair kv_pair_list[0];
 };
 
+typedef struct _ats_vcpm_rtc_index_t AtsVcpmRtcIndex;
+struct _ats_vcpm_rtc_index_t
+{
+    /**< The active voice CKV sorted by key ID */
+    AcdbKeyValuePair *sorted_ckv;
+    /**< The number of keys in the active voice CKV */
+    uint32_t key_count;
+    /**< The active voice CKV values ordered like the key IDs of the last
+    voice key table that matched. Compared directly against LUT entries */
+    uint32_t *lut_values;
+    /**< The requested <iid, pid> pairs sorted by iid then pid */
+    AtsIidPidPair *sorted_id_pairs;
+    /**< The number of requested <iid, pid> pairs */
+    uint32_t id_pair_count;
+};
+
 typedef struct ats_vcpm_active_ckv_info_t AtsVcpmActiveCkvInfo;
 struct ats_vcpm_active_ckv_info_t
 {
@@ -151,14 +167,19 @@ int32_t ats_rtc_get_audio_persist_param_data(
 int32_t ats_rtc_get_active_voice_ckv(AcdbSgIdPersistData *sg_cal_data,
     struct gsl_rtc_param *rtc_param,
     AtsKeyVector **active_ckv);
+int32_t ats_rtc_create_vcpm_index(AtsKeyVector *active_ckv,
+    AtsUintList *iid_pid_pair_list, AtsVcpmRtcIndex *index);
+
+void ats_rtc_free_vcpm_index(AtsVcpmRtcIndex *index);
+
 int32_t ats_rtc_compare_voice_key_ids(AtsVcpmChunk *voice_key_table_chunk,
-    uint32_t voice_key_table_offset, AtsKeyVector *active_ckv);
+    uint32_t voice_key_table_offset, AtsVcpmRtcIndex *index);
 
 int32_t ats_rtc_compare_voice_key_values(AtsVcpmChunk *voice_lut_chunk,
-    uint32_t voice_lut_offset, AtsKeyVector *active_ckv);
+    uint32_t voice_lut_offset, AtsVcpmRtcIndex *index);
 
 int32_t ats_rtc_is_iid_pid_in_list(
-    AtsSpfParamCal *param_cal, AtsUintList *id_pair_list);
+    AtsSpfParamCal *param_cal, AtsVcpmRtcIndex *index);
 
 int32_t ats_rtc_get_vcpm_master_key_table(
     AcdbSgIdPersistData *sg_cal_data,
@@ -1226,97 +1247,184 @@ int32_t ats_rtc_get_active_voice_ckv(AcdbSgIdPersistData *sg_cal_data,
     return status;
 }
 
-int32_t ats_rtc_compare_voice_key_ids(AtsVcpmChunk *voice_key_table_chunk,
-    uint32_t voice_key_table_offset, AtsKeyVector *active_ckv)
+/**
+* \brief
+*       Builds the lookup state used to match the active voice CKV and the
+*       requested <iid, pid> pairs against the VCPM blob. The inputs are
+*       copied, so the response buffer that holds the active CKV can be
+*       overwritten once the index is built.
+*
+* \param [in] active_ckv: The active voice CKV
+* \param [in] iid_pid_pair_list: The requested <iid, pid> pairs
+* \param [out] index: The index to build. Release it with ats_rtc_free_vcpm_index
+*
+* \return 0 on success, non-zero on failure
+*/
+int32_t ats_rtc_create_vcpm_index(AtsKeyVector *active_ckv,
+    AtsUintList *iid_pid_pair_list, AtsVcpmRtcIndex *index)
 {
     int32_t status = AR_EOK;
-    uint32_t num_found = 0;
+    uint32_t sz_ckv = 0;
+    uint32_t sz_id_pairs = 0;
+    uint8_t *buf = NULL;
+
+    if (IsNull(active_ckv) || IsNull(iid_pid_pair_list) || IsNull(index))
+    {
+        ATS_ERR("Error[%d]: One or more input parameters(s) are null",
+            AR_EBADPARAM);
+        return AR_EBADPARAM;
+    }
+
+    ar_mem_set(index, 0, sizeof(AtsVcpmRtcIndex));
+    index->key_count = active_ckv->key_count;
+    index->id_pair_count = iid_pid_pair_list->count;
+
+    sz_ckv = index->key_count * sizeof(AcdbKeyValuePair);
+    sz_id_pairs = index->id_pair_count * sizeof(AtsIidPidPair);
+
+    if (sz_ckv + sz_id_pairs == 0)
+        return AR_EOK;
+
+    buf = ACDB_MALLOC(uint8_t,
+        sz_ckv + sz_id_pairs + index->key_count * sizeof(uint32_t));
+    if (IsNull(buf))
+    {
+        ATS_ERR("Error[%d]: Unable to allocate the vcpm index", AR_ENOMEMORY);
+        return AR_ENOMEMORY;
+    }
+
+    index->sorted_ckv = (AcdbKeyValuePair*)buf;
+    index->sorted_id_pairs = (AtsIidPidPair*)(buf + sz_ckv);
+    index->lut_values = (uint32_t*)(buf + sz_ckv + sz_id_pairs);
+
+    if (sz_ckv > 0)
+    {
+        ACDB_MEM_CPY_SAFE(index->sorted_ckv, sz_ckv,
+            active_ckv->kv_pair_list, sz_ckv);
+        status = AcdbSort2(sz_ckv, index->sorted_ckv,
+            sizeof(AcdbKeyValuePair), 0);
+    }
+
+    /* Stable sort by pid then by iid to order the pairs by <iid, pid> */
+    if (AR_SUCCEEDED(status) && sz_id_pairs > 0)
+    {
+        ACDB_MEM_CPY_SAFE(index->sorted_id_pairs, sz_id_pairs,
+            iid_pid_pair_list->list, sz_id_pairs);
+        status = AcdbSort2(sz_id_pairs, index->sorted_id_pairs,
+            sizeof(AtsIidPidPair), 1);
+        if (AR_SUCCEEDED(status))
+            status = AcdbSort2(sz_id_pairs, index->sorted_id_pairs,
+                sizeof(AtsIidPidPair), 0);
+    }
+
+    if (AR_FAILED(status))
+    {
+        ATS_ERR("Error[%d]: Unable to sort the vcpm index", status);
+        ats_rtc_free_vcpm_index(index);
+    }
+
+    return status;
+}
+
+/**
+* \brief
+*       Releases the memory aquired by ats_rtc_create_vcpm_index
+*
+* \param [in] index: The index to release
+*/
+void ats_rtc_free_vcpm_index(AtsVcpmRtcIndex *index)
+{
+    if (IsNull(index))
+        return;
+
+    if (!IsNull(index->sorted_ckv))
+        ACDB_FREE(index->sorted_ckv);
+
+    ar_mem_set(index, 0, sizeof(AtsVcpmRtcIndex));
+}
+
+/**
+* \brief
+*       Checks whether a voice key table has the same key IDs as the active
+*       voice CKV. On a match, the active CKV values are arranged in the
+*       order of the table's key IDs so that LUT entries can be compared
+*       with ats_rtc_compare_voice_key_values
+*
+* \return AR_EOK if the key IDs match, AR_ENOTEXIST otherwise
+*/
+int32_t ats_rtc_compare_voice_key_ids(AtsVcpmChunk *voice_key_table_chunk,
+    uint32_t voice_key_table_offset, AtsVcpmRtcIndex *index)
+{
+    uint32_t kv_index = 0;
     AtsUintList *voice_key_table = NULL;
+    AcdbKeyValuePair key = { 0 };
 
     voice_key_table = (AtsUintList*)
         ((uint8_t*)voice_key_table_chunk->data
             + voice_key_table_offset);
 
-    //Compare Key IDs
-    if (voice_key_table->count == active_ckv->key_count)
+    if (voice_key_table->count != index->key_count)
+        return AR_ENOTEXIST;
+
+    for (uint32_t i = 0; i < voice_key_table->count; i++)
     {
-        for (uint32_t i = 0; i < voice_key_table->count; i++)
+        key.key = voice_key_table->list[i];
+        if (SEARCH_ERROR == AcdbDataBinarySearch2(
+            index->sorted_ckv, index->key_count * sizeof(AcdbKeyValuePair),
+            &key, 1, 2, &kv_index))
         {
-            for (uint32_t j = 0; j < voice_key_table->count; j++)
-            {
-                if (voice_key_table->list[i] ==
-                    active_ckv->kv_pair_list[j].key)
-                {
-                    num_found++;
-                    break;
-                }
-            }
+            return AR_ENOTEXIST;
         }
 
-        if (voice_key_table->count != num_found)
-            return AR_ENOTEXIST;
-    }
-    else
-    {
-        status = AR_ENOTEXIST;
+        /* kv_index is a uint32_t offset into sorted_ckv */
+        index->lut_values[i] = ((uint32_t*)index->sorted_ckv)[kv_index + 1];
     }
 
-    return status;
+    return AR_EOK;
 }
 
+/**
+* \brief
+*       Checks whether a LUT entry holds the active voice CKV values. The LUT
+*       values follow the key ID order of the voice key table matched by
+*       ats_rtc_compare_voice_key_ids
+*
+* \return AR_EOK if the values match, AR_ENOTEXIST otherwise
+*/
 int32_t ats_rtc_compare_voice_key_values(AtsVcpmChunk *voice_lut_chunk,
-    uint32_t voice_lut_offset, AtsKeyVector *active_ckv)
+    uint32_t voice_lut_offset, AtsVcpmRtcIndex *index)
 {
-    int32_t status = AR_EOK;
-    uint32_t num_found = 0;
     AtsUintList *voice_lut_table = NULL;
 
     voice_lut_table = (AtsUintList*)
         ((uint8_t*)voice_lut_chunk->data
             + voice_lut_offset);
 
-    //Compare Key Values
-    if (voice_lut_table->count == active_ckv->key_count)
-    {
-        for (uint32_t i = 0; i < voice_lut_table->count; i++)
-        {
-            for (uint32_t j = 0; j < voice_lut_table->count; j++)
-            {
-                if (voice_lut_table->list[i] ==
-                    active_ckv->kv_pair_list[j].value)
-                {
-                    num_found++;
-                    break;
-                }
-            }
-        }
+    if (voice_lut_table->count != index->key_count)
+        return AR_ENOTEXIST;
 
-        if (voice_lut_table->count != num_found)
-            return AR_ENOTEXIST;
-    }
-    else
-    {
-        status = AR_ENOTEXIST;
-    }
+    if (index->key_count > 0 && 0 != ar_mem_cmp(voice_lut_table->list,
+        index->lut_values, index->key_count * sizeof(uint32_t)))
+        return AR_ENOTEXIST;
 
-    return status;
+    return AR_EOK;
 }
 
 int32_t ats_rtc_is_iid_pid_in_list(
-    AtsSpfParamCal *param_cal, AtsUintList *id_pair_list)
+    AtsSpfParamCal *param_cal, AtsVcpmRtcIndex *index)
 {
-    int32_t status = AR_ENOTEXIST;
-    AtsIidPidPair *list = (AtsIidPidPair*)
-        ((uint8_t*)id_pair_list + sizeof(AtsUintList));
+    uint32_t pair_index = 0;
 
-    for (uint32_t i = 0; i < id_pair_list->count; i++)
-    {
-        if (0 == ar_mem_cmp(param_cal, (void*)&list[i],
-            sizeof(AtsIidPidPair)))
-            return AR_EOK;
-    }
+    if (index->id_pair_count == 0)
+        return AR_ENOTEXIST;
 
-    return status;
+    /* The param header starts with <iid, pid> */
+    if (SEARCH_ERROR == AcdbDataBinarySearch2(
+        index->sorted_id_pairs, index->id_pair_count * sizeof(AtsIidPidPair),
+        param_cal, 2, 2, &pair_index))
+        return AR_ENOTEXIST;
+
+    return AR_EOK;
 }
 
 int32_t ats_rtc_get_vcpm_master_key_table(
@@ -1382,6 +1490,7 @@ int32_t ats_rtc_get_vcpm_param_data(
     AtsVcpmChunk *voice_key_table_chunk = NULL;
     AtsVcpmChunk *lookup_table_chunk = NULL;
     AtsVcpmChunk *data_pool_chunk = NULL;
+    AtsVcpmRtcIndex index = { 0 };
 
     if (IsNull(sg_cal_data) || IsNull(iid_pid_pair_list) ||
         IsNull(active_ckv) || IsNull(rsp_buf) || IsNull(rsp_buf_bytes_filled))
@@ -1391,6 +1500,12 @@ int32_t ats_rtc_get_vcpm_param_data(
         return AR_EBADPARAM;
     }
 
+    /* The active CKV lives in the response buffer, so copy it into the index
+     * before the response is written */
+    status = ats_rtc_create_vcpm_index(active_ckv, iid_pid_pair_list, &index);
+    if (AR_FAILED(status))
+        return status;
+
     /* make space to write total size */
     blob_offset = sizeof(uint32_t);
     total_size = (uint32_t*)rsp_buf;
@@ -1427,7 +1542,7 @@ int32_t ats_rtc_get_vcpm_param_data(
         vckt_offset = ckv_data_table->offset_voice_key_table;
 
         status = ats_rtc_compare_voice_key_ids(
-            voice_key_table_chunk, vckt_offset, active_ckv);
+            voice_key_table_chunk, vckt_offset, &index);
         if (AR_FAILED(status))
         {
             offset += sizeof(ckv_data_table->table_size)
@@ -1444,7 +1559,7 @@ int32_t ats_rtc_get_vcpm_param_data(
             vlut_offset = cal_data_obj->offset_ckv_lut;
 
             status = ats_rtc_compare_voice_key_values(
-                lookup_table_chunk, vlut_offset, active_ckv);
+                lookup_table_chunk, vlut_offset, &index);
             if (AR_FAILED(status))
             {
                 offset += sizeof(AtsVcpmCalDataObj)
@@ -1466,8 +1581,7 @@ int32_t ats_rtc_get_vcpm_param_data(
                     (uint8_t*)data_pool_chunk + sizeof(uint32_t),
                     dp_offset);
 
-                status = ats_rtc_is_iid_pid_in_list(
-                    param_cal, iid_pid_pair_list);
+                status = ats_rtc_is_iid_pid_in_list(param_cal, &index);
                 if (AR_FAILED(status))
                 {
                     offset += sizeof(AtsVcpmParamInfo);
@@ -1526,5 +1640,6 @@ int32_t ats_rtc_get_vcpm_param_data(
         *total_size = blob_offset;
     }
 
+    ats_rtc_free_vcpm_index(&index);
     return status;
 }
\ No newline at end of file
@@ -57,6 +57,20 @@ typedef struct ats_registry_table_t {
 	AtsServiceNode *p_tail;
 }AtsRegistryTable;
 
+/**< Tracks a response that is sent to the client while the command executes */
+typedef struct ats_stream_t {
+	/**< TRUE while a service callback is executing */
+	bool_t is_enabled;
+	/**< TRUE once ats_stream_begin is called */
+	bool_t is_started;
+	/**< TRUE once the response header has been sent */
+	bool_t is_header_sent;
+	/**< The number of response data bytes that have not been sent */
+	uint32_t remaining;
+	/**< The service command id, data length, and status of the response */
+	uint8_t header[ATS_ERROR_FRAME_LENGTH];
+}AtsStream;
+
 /* ---------------------------------------------------------------------------
  * Global Variables
  *--------------------------------------------------------------------------- */
@@ -65,6 +79,7 @@ ATS_SIM_CALLBACK ats_simulation_callback    = NULL;
 bool_t simulation_enabled                   = FALSE;
 static AtsRegistryTable *g_ats_reg_tbl      = NULL;
 static uint32_t ats_init_count              = 0;
+static AtsStream ats_stream                 = {0};
 
 /* ---------------------------------------------------------------------------
 * External Functions and Forward Declarations
@@ -105,6 +120,14 @@ static void ats_create_suc_resp(
 
 static bool_t is_service_registered(uint32_t service_id);
 
+static void ats_stream_reset(uint32_t service_cmd_id);
+
+static void ats_stream_end(int32_t status,
+    uint8_t *req_buf_ptr,
+    uint8_t **resp_buf_ptr,
+    uint32_t *resp_buf_length
+);
+
 void ats_register_simulation(ATS_SIM_CALLBACK sim_callback);
 
 void ats_simulation_switch(void);
@@ -434,6 +457,8 @@ void ats_execute_command(uint8_t *req_buf_ptr,
                     else break;
                 }
 
+				ats_stream_reset(service_cmd_id);
+
 				if (temp_req_buf_len == 0)
 				{
 					status = ats_cb_req_op(service_cmd_id,
@@ -446,6 +471,8 @@ void ats_execute_command(uint8_t *req_buf_ptr,
                         req_buf_ptr + ATS_HEADER_LENGTH, temp_req_buf_len,
                         temp_resp_buf, resp_buf_size, resp_buf_length);
 				}
+
+				ats_stream.is_enabled = FALSE;
 				break;
 			}
 			else
@@ -454,7 +481,11 @@ void ats_execute_command(uint8_t *req_buf_ptr,
 			}
 		}
 
-		if (AR_FAILED(status))
+		if (ats_stream.is_started && ats_stream.is_header_sent)
+		{
+			ats_stream_end(status, req_buf_ptr, resp_buf_ptr, resp_buf_length);
+		}
+		else if (AR_FAILED(status))
 		{
             ATS_ERR("Error[%d]: Error occured while executing Command[%s-%d]", status, svc_id_str, ATS_GET_COMMAND_ID(service_cmd_id));
 			//ats_create_error_resp(status, req_buf_ptr, *resp_buf_ptr, resp_buf_length);
@@ -796,6 +827,94 @@ int32_t ats_get_service_info(AtsCmdGetServiceInfoRsp *svc_info_rsp, uint32_t rsp
     return status;
 }
 
+bool_t ats_stream_is_supported(void)
+{
+    return ats_stream.is_enabled && !ats_stream.is_started &&
+        ats_transport_is_stream_supported();
+}
+
+int32_t ats_stream_begin(uint32_t data_length)
+{
+    int32_t status = AR_EOK;
+    uint32_t resp_data_length = 0;
+
+    if (!ats_stream.is_enabled || ats_stream.is_started)
+    {
+        ATS_ERR("Error[%d]: A stream can only be started once "
+            "by the executing command", AR_EUNSUPPORTED);
+        return AR_EUNSUPPORTED;
+    }
+
+    if (data_length > 0xFFFFFFFFul - ATS_ERROR_CODE_LENGTH)
+    {
+        ATS_ERR("Error[%d]: The stream length %u is too large",
+            AR_EBADPARAM, data_length);
+        return AR_EBADPARAM;
+    }
+
+    resp_data_length = ATS_ERROR_CODE_LENGTH + data_length;
+
+    //Data length. The service + command id is set in ats_stream_reset
+    ATS_MEM_CPY_SAFE(ats_stream.header + ATS_DATA_LENGTH_POSITION,
+        ATS_DATA_LENGTH_LENGTH, &resp_data_length, ATS_DATA_LENGTH_LENGTH);
+
+    //Status
+    ATS_MEM_CPY_SAFE(ats_stream.header + ATS_HEADER_LENGTH,
+        ATS_ERROR_CODE_LENGTH, &status, ATS_ERROR_CODE_LENGTH);
+
+    ats_stream.remaining = data_length;
+    ats_stream.is_started = TRUE;
+    return status;
+}
+
+int32_t ats_stream_write(const uint8_t *buf, uint32_t size)
+{
+    int32_t status = AR_EOK;
+    ats_transport_segment_t segments[2] = { 0 };
+    uint32_t segment_count = 0;
+
+    if (!ats_stream.is_enabled || !ats_stream.is_started)
+    {
+        ATS_ERR("Error[%d]: The stream has not been started", AR_EUNSUPPORTED);
+        return AR_EUNSUPPORTED;
+    }
+
+    if ((IsNull(buf) && size > 0) || size > ats_stream.remaining)
+    {
+        ATS_ERR("Error[%d]: Unable to write %u bytes to the stream. "
+            "%u bytes remain", AR_EBADPARAM, size, ats_stream.remaining);
+        return AR_EBADPARAM;
+    }
+
+    /* The header is held back until there is data so that a command that
+     * fails before writing anything can still return an error response */
+    if (!ats_stream.is_header_sent)
+    {
+        segments[segment_count].buf = ats_stream.header;
+        segments[segment_count].size = ATS_ERROR_FRAME_LENGTH;
+        segment_count++;
+    }
+
+    segments[segment_count].buf = buf;
+    segments[segment_count].size = size;
+    segment_count++;
+
+    /* Mark the header as sent even if sending fails since the client may
+     * have received part of it */
+    ats_stream.is_header_sent = TRUE;
+
+    status = ats_transport_stream_send(segments, segment_count);
+    if (AR_FAILED(status))
+    {
+        ATS_ERR("Error[%d]: Failed to send %u bytes of the stream",
+            status, size);
+        return status;
+    }
+
+    ats_stream.remaining -= size;
+    return status;
+}
+
 /**
 * \brief
 * Get request data length from a request buffer
@@ -963,6 +1082,59 @@ static void ats_create_suc_resp(uint32_t error_code, uint32_t data_length,
         &error_code, sizeof(error_code));
 }
 
+/**
+* \brief
+* Prepares the stream state for the command that is about to execute.
+*
+* \param[in] service_cmd_id - the service command id of the command
+*
+* \return none
+*/
+static void ats_stream_reset(uint32_t service_cmd_id)
+{
+    ar_mem_set(&ats_stream, 0, sizeof(ats_stream));
+
+    ATS_MEM_CPY_SAFE(ats_stream.header + ATS_SERVICE_COMMAND_ID_POSITION,
+        ATS_SERVICE_COMMAND_ID_LENGTH, &service_cmd_id,
+        ATS_SERVICE_COMMAND_ID_LENGTH);
+
+    ats_stream.is_enabled = TRUE;
+}
+
+/**
+* \brief
+* Completes a streamed response after the service callback returns. Nothing
+* is left in the ATS buffer for the transport to send. If the command failed
+* or did not send all of the data it promised, the response is NULL so that
+* the transport drops the client since the response can no longer be framed.
+*
+* \param[in] status - the status returned by the service callback
+* \param[in] req_buf_ptr - pointer to request buffer
+* \param[out] resp_buf_ptr - pointer to response buffer
+* \param[out] resp_buf_length - length of the response buffer
+*
+* \return none
+*/
+static void ats_stream_end(int32_t status,
+    uint8_t *req_buf_ptr,
+    uint8_t **resp_buf_ptr,
+    uint32_t *resp_buf_length
+)
+{
+    __UNREFERENCED_PARAM(req_buf_ptr);
+
+    *resp_buf_length = 0;
+
+    if (AR_FAILED(status) || ats_stream.remaining > 0)
+    {
+        ATS_ERR("Error[%d]: The streamed response ended with %u bytes unsent",
+            status, ats_stream.remaining);
+        *resp_buf_ptr = NULL;
+    }
+
+    ar_mem_set(&ats_stream, 0, sizeof(ats_stream));
+}
+
 /**
 * \brief
 * Checks if the given service is already registered.
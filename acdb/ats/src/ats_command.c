@@ -68,6 +68,22 @@ int32_t AtsCmdGetLoadedFileData(
     return status;
 }
 
+int32_t AtsCmdStreamLoadedFileData(
+    AcdbFileManGetFileDataReq *req, AcdbFileManStream *stream)
+{
+    int32_t status = AR_EOK;
+    status = acdb_file_man_ioctl(ACDB_FILE_MAN_STREAM_DATABASE_FILE_SET,
+        req, sizeof(AcdbFileManGetFileDataReq),
+        stream, sizeof(AcdbFileManStream));
+
+    if (AR_FAILED(status))
+    {
+        ATS_ERR("Error[%d]: Failed to stream loaded acdb file data", status);
+    }
+
+    return status;
+}
+
 int32_t AtsCmdGetHeapEntryInfo(
     acdb_handle_t acdb_handle, AcdbBufferContext *rsp)
 {
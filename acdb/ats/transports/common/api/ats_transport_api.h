@@ -35,6 +35,15 @@ typedef void(*ats_cmd_rsp_callback_t)(
     uint8_t *req_buffer, uint32_t req_buffer_length,
     uint8_t **resp_buffer, uint32_t *resp_buffer_length);
 
+/**< A contiguous piece of a streamed response */
+typedef struct ats_transport_segment_t
+{
+    /**< The data to send */
+    const uint8_t *buf;
+    /**< The number of bytes in buf */
+    uint32_t size;
+}ats_transport_segment_t;
+
 /**
 * \brief ats_transport_init
 *      Initializes the transport layer. One or more transports can be initialized depending
@@ -55,12 +64,34 @@ int32_t ats_transport_deinit(void);
 
 /**
  * \brief ats_transport_dls_send_callback
- *		Sends binary log data through the transport layer
- * \param [in] buffer: the buffer containing the data to send
- * \param [in] buffer_size: the size of the buffer
+ *		Sends binary log data through the transport layer. The segments are
+ *      sent in order with one gathered write so that log buffers can be sent
+ *      straight from shared memory.
+ * \param [in] segments: the pieces of log data to send
+ * \param [in] segment_count: the number of segments
+ * \return 0 on success, non-zero on failure
+ */
+int32_t ats_transport_dls_send_callback(
+    const ats_transport_segment_t *segments, uint32_t segment_count);
+
+/**
+ * \brief ats_transport_is_stream_supported
+ *		Checks whether the transport executing the current command can send
+ *      a response in pieces with ats_transport_stream_send
+ * \return TRUE if streaming is supported, FALSE otherwise
+ */
+bool_t ats_transport_is_stream_supported(void);
+
+/**
+ * \brief ats_transport_stream_send
+ *		Sends part of the response for the command that is currently executing
+ *      directly to the client. The segments are sent in order.
+ * \param [in] segments: the pieces of the response to send
+ * \param [in] segment_count: the number of segments
  * \return 0 on success, non-zero on failure
  */
-int32_t ats_transport_dls_send_callback(const uint8_t* buffer, uint32_t buffer_size);
+int32_t ats_transport_stream_send(
+    const ats_transport_segment_t *segments, uint32_t segment_count);
 
 #endif /*_ATS_TRANSPORT_API_H_*/
 
@@ -92,19 +92,44 @@ int32_t ats_transport_deinit(void)
     return status;
 }
 
-int32_t ats_transport_dls_send_callback(const uint8_t* buffer, uint32_t buffer_size)
+int32_t ats_transport_dls_send_callback(
+    const ats_transport_segment_t *segments, uint32_t segment_count)
 {
 	#if defined(ATS_TRANSPORT_TCPIP)
 
-	ATS_TRANSPORT_DBG("Sending %d bytes", buffer_size);
-	return tcpip_cmd_server_send_dls_log_data(buffer, buffer_size);
+	ATS_TRANSPORT_DBG("Sending %d segments", segment_count);
+	return tcpip_cmd_server_send_dls_log_data(segments, segment_count);
 
 	#else
-	__UNREFERENCED_PARAM(buffer);
-	__UNREFERENCED_PARAM(buffer_size);
+	__UNREFERENCED_PARAM(segments);
+	__UNREFERENCED_PARAM(segment_count);
 	/* We dont need to support diag since it already has support for pushing
 	 * binary log packets to the ats realtime tuning client */
 
 	return AR_EUNSUPPORTED;
 	#endif
 }
+
+bool_t ats_transport_is_stream_supported(void)
+{
+	#if defined(ATS_TRANSPORT_TCPIP)
+	return tcpip_cmd_server_is_stream_supported();
+	#else
+	/* Diag packets are limited in size, so responses are always
+	 * returned through the ATS buffer */
+	return FALSE;
+	#endif
+}
+
+int32_t ats_transport_stream_send(
+    const ats_transport_segment_t *segments, uint32_t segment_count)
+{
+	#if defined(ATS_TRANSPORT_TCPIP)
+	return tcpip_cmd_server_send_stream(segments, segment_count);
+	#else
+	__UNREFERENCED_PARAM(segments);
+	__UNREFERENCED_PARAM(segment_count);
+
+	return AR_EUNSUPPORTED;
+	#endif
+}
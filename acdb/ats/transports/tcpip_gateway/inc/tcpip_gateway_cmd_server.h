@@ -123,6 +123,20 @@ private:
         buffer_t* gateway_message_buf, buffer_t* gateway_recv_buf,
         bool_t is_cmd_request, tgws_status_codes_t &status_code);
 
+    /**
+    * \brief
+    *	  Relays a response from the TCPIP CMD Server to QACT. The response is sent to
+    *     QACT as it is received so responses of any size can be forwarded
+    *
+    * \param [in] sender_socket_ptr: A pointer to the socket established with the TCPIP CMD server
+    * \param [in] receiver_socket_ptr: A pointer to the socket established with QACT
+    * \param [in/out] gateway_recv_buf: The buffer used to hold each chunk of the response
+    * \param [out] status_code: A gateway status code that the caller can use to handle gateway server specific errors
+    */
+    void tcp_relay_response(
+        ar_socket_t* sender_socket_ptr, ar_socket_t* receiver_socket_ptr,
+        buffer_t* gateway_recv_buf, tgws_status_codes_t &status_code);
+
     /**
     * \brief
     *	 Connects the Gateway Server to the TCPIP CMD Server
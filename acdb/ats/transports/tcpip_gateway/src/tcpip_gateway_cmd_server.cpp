@@ -120,6 +120,19 @@ static void tgws_create_error_resp(
 	uint32_t& rsp_msg_legnth
 );
 
+/**
+* \brief
+*   Sends the whole buffer over the socket
+*
+* \param[in] socket: The socket to send the data to
+* \param[in] buffer: The data to send
+* \param[in] buffer_length: The number of bytes to send
+*
+* \return AR_EOK on success, non-zero on failure
+*/
+static int32_t tgws_send_all(
+	ar_socket_t socket, const char_t* buffer, uint32_t buffer_length);
+
 /*
 ============================================================================
 				   TCPIP Gateway Server Implementation
@@ -498,10 +511,10 @@ void* TcpipGatewayServer::transmit_routine(void* arg)
 		}
 
 		/* Forward responses from CMD Server to Gateway Client */
-		tcp_forward(
+		tcp_relay_response(
 			/* from server */ server_socket_ptr,
 			/* to client   */ client_socket_ptr,
-			&message_buffer, &recieve_buffer, false, status_code);
+			&recieve_buffer, status_code);
 		if (TGWS_E_END_MSG_FWD == status_code)
 			break;
 	}
@@ -775,6 +788,94 @@ tcp_forward_end:
 	}
 }
 
+void TcpipGatewayServer::tcp_relay_response(
+	ar_socket_t* sender_socket_ptr, ar_socket_t* receiver_socket_ptr,
+	buffer_t* gateway_recv_buf, tgws_status_codes_t& agws_status_code)
+{
+	int32_t status = AR_EOK;
+	ar_socket_t sender_socket = *sender_socket_ptr;
+	ar_socket_t receiver_socket = *receiver_socket_ptr;
+	uint32_t header_bytes_read = 0;
+	uint32_t message_length = 0;
+	uint32_t msg_offset = 0;
+	uint32_t recv_size = 0;
+	int32_t bytes_read = 0;
+	char_t header[ATS_HEADER_LENGTH] = { 0 };
+
+	//Receive the header to find out how much data follows
+	while (header_bytes_read < ATS_HEADER_LENGTH)
+	{
+		bytes_read = 0;
+		ar_socket_recv(
+			sender_socket,
+			header + header_bytes_read,
+			ATS_HEADER_LENGTH - header_bytes_read,
+			0, &bytes_read);
+
+		if (bytes_read <= 0)
+		{
+			if (bytes_read < 0 && AR_SOCKET_LAST_ERROR == EINTR) continue;
+
+			GATEWAY_INFO("Failed to recieve response from server");
+			ar_socket_close(sender_socket);
+			agws_status_code = TGWS_E_END_MSG_FWD;
+			return;
+		}
+
+		header_bytes_read += bytes_read;
+	}
+
+	tgws_get_ats_command_length(header, ATS_HEADER_LENGTH, &message_length);
+	GATEWAY_DBG("Relaying response with length: %d", message_length);
+
+	status = tgws_send_all(receiver_socket, header, ATS_HEADER_LENGTH);
+	if (AR_FAILED(status))
+	{
+		GATEWAY_ERR("Error[%d]: Failed to send data to client", status);
+		ar_socket_close(receiver_socket);
+		agws_status_code = TGWS_E_END_MSG_FWD;
+		return;
+	}
+
+	/* The response is passed on as it arrives so its size is not limited
+	 * by the message buffer and it is not copied */
+	while (msg_offset < message_length)
+	{
+		bytes_read = 0;
+		recv_size = message_length - msg_offset < gateway_recv_buf->buffer_size ?
+			message_length - msg_offset : gateway_recv_buf->buffer_size;
+
+		ar_socket_recv(
+			sender_socket,
+			gateway_recv_buf->buffer,
+			(int32_t)recv_size,
+			0, &bytes_read);
+
+		if (bytes_read <= 0)
+		{
+			if (bytes_read < 0 && AR_SOCKET_LAST_ERROR == EINTR) continue;
+
+			GATEWAY_ERR("Failed to recieve response from server");
+			ar_socket_close(sender_socket);
+			agws_status_code = TGWS_E_END_MSG_FWD;
+			return;
+		}
+
+		status = tgws_send_all(receiver_socket, gateway_recv_buf->buffer, (uint32_t)bytes_read);
+		if (AR_FAILED(status))
+		{
+			GATEWAY_ERR("Error[%d]: Failed to send data to client", status);
+			ar_socket_close(receiver_socket);
+			agws_status_code = TGWS_E_END_MSG_FWD;
+			return;
+		}
+
+		msg_offset += (uint32_t)bytes_read;
+	}
+
+	GATEWAY_DBG("*** Full response relayed [%d bytes]***", message_length + ATS_HEADER_LENGTH);
+}
+
 void TcpipGatewayServer::start(void* arg)
 {
 	GATEWAY_ERR("Start routine callback...");
@@ -899,6 +1000,30 @@ static bool_t tgws_get_ats_command_length(
 	return result;
 }
 
+static int32_t tgws_send_all(
+	ar_socket_t socket, const char_t* buffer, uint32_t buffer_length)
+{
+	int32_t status = AR_EOK;
+	int32_t bytes_sent = 0;
+	uint32_t total_sent = 0;
+
+	while (total_sent < buffer_length)
+	{
+		bytes_sent = 0;
+		status = ar_socket_send(socket, buffer + total_sent,
+			(int32_t)(buffer_length - total_sent), 0, &bytes_sent);
+		if (AR_FAILED(status))
+		{
+			if (AR_SOCKET_LAST_ERROR == EINTR) continue;
+			return status;
+		}
+
+		total_sent += (uint32_t)bytes_sent;
+	}
+
+	return AR_EOK;
+}
+
 static void tgws_create_error_resp(
 	uint32_t service_cmd_id, uint32_t ar_status_code,
 	char_t* message_buffer, uint32_t message_buffer_size,
@@ -25,6 +25,7 @@
 #include "ar_osal_thread.h"
 #include "ats_common.h"
 #include "acdb_utility.h"
+#include "ats_transport_api.h"
 
 #ifdef __cplusplus
 extern "C"{
@@ -45,8 +46,8 @@ extern "C"{
 *		designated port.
 *		ats communicates with the Gateway Server for any connection to external clients
 *
-*		Note: Only one client can be connected to this target at a time. The use of a mutex
-*		ensures this.
+*		Note: Up to TCPIP_CMD_SERVER_MAX_CLIENTS clients can be connected at a time.
+*		Their commands are executed one at a time.
 *
 *	\param [in] ats_cb: A callback to ats_exectue_command
 *
@@ -62,9 +63,6 @@ int32_t tcpip_cmd_server_init(void(*ats_cb)(uint8_t *buf, uint32_t buf_len, uint
 *	\detdesc
 *       Releases threading and memory resources aquired during tcpip_cmd_server_init
 *
-*		Note: Only one client can be connected to this target at a time. The use of a mutex
-*		ensures this.
-*
 *	\return
 *		0 on success, non-zero on failure
 */
@@ -84,14 +82,46 @@ int32_t tcpip_cmd_server_deinit(void);
 
 	\detdesc
 		Log packet data is sent on a port separate from the command/response packets.
+		The segments are written to the socket with gathered writes, so the log
+		buffers can point directly into the DLS shared memory pool.
 
 	\dependencies
 		DLS support must be enabled in the build to successfully forward log data to clients
 
-	\param [in] buffer: logging buffer populated by ats dls service layer
-	\param [in] buffer_size: size of the log data buffer in bytes
+	\param [in] segments: the pieces of log data populated by ats dls service layer
+	\param [in] segment_count: the number of segments
+*/
+int32_t tcpip_cmd_server_send_dls_log_data(
+	const ats_transport_segment_t* segments, uint32_t segment_count);
+
+/**
+	\brief
+		Checks whether the command that is currently executing came from a
+		TCP/IP client that can receive its response with tcpip_cmd_server_send_stream
+
+	\return
+		TRUE if the response can be streamed, FALSE otherwise
+*/
+bool_t tcpip_cmd_server_is_stream_supported(void);
+
+/**
+	\brief
+		Sends part of the response of the command that is currently executing to
+		the client that sent the command
+
+	\detdesc
+		The segments are written to the socket with one gathered write. The call
+		blocks until all the data is sent, so it must only be called from the
+		ATS command callback.
+
+	\param [in] segments: the pieces of the response to send in order
+	\param [in] segment_count: the number of segments
+
+	\return
+		0 on success, non-zero on failure
 */
-int32_t tcpip_cmd_server_send_dls_log_data(const uint8_t* buffer, uint32_t buffer_size);
+int32_t tcpip_cmd_server_send_stream(
+	const ats_transport_segment_t* segments, uint32_t segment_count);
 
 
 #endif /*ATS_TRANSPORT_TCPIP*/
@@ -9,9 +9,9 @@
 *
 *    This file contains the TCP/IP server implementation to host connections
 *    to QACT.
-*    This file first sets up a listening socket on port 5558. Upon accepting
-*    new connections, the server creates new receiving threads that handles
-*    all ATS upcalls.
+*    This file first sets up a listening socket on port 5558. All client
+*    connections are served by one event loop thread that handles all
+*    ATS upcalls.
 *
 *  \copyright
 *      Copyright (c) Qualcomm Innovation Center, Inc. All rights reserved.
@@ -29,6 +29,7 @@
 #include "ar_osal_error.h"
 
 #include "ats_i.h"
+#include "ats_transport_api.h"
 #include "tcpip_dls_server.h"
 
 //#if defined(__linux__)
@@ -47,6 +48,16 @@
 #define TCPIP_CMD_SERVER_MAX_MSG_BUFFER_SIZE      0x200000ul //2MB max size
 #define TCPIP_CMD_SERVER_ADDRESS "127.0.0.1" //local host
 #define TCPIP_CMD_SERVER_PORT 5559
+/**< The maximum number of clients that can be connected to the server at once */
+#define TCPIP_CMD_SERVER_MAX_CLIENTS              8
+/**< The number of message buffers shared by all connections. A connection
+ * holds a buffer while it receives a request body or while it waits for
+ * the socket to drain a response */
+#define TCPIP_CMD_SERVER_BUFFER_POOL_COUNT        4
+/**< The maximum number of segments sent in one streamed write */
+#define TCPIP_CMD_SERVER_MAX_STREAM_SEGMENTS      4
+/**< How long a streamed write waits for the client to drain the socket */
+#define TCPIP_CMD_SERVER_STREAM_SEND_TIMEOUT_MS   5000
 
 typedef void(*ATS_EXECUTE_CALLBACK) (
     uint8_t* req, uint32_t req_len,
@@ -57,6 +68,46 @@ struct buffer_t {
     char_t* buffer;
 };
 
+/**< A message buffer in the shared buffer pool */
+struct tcpip_cmd_pool_buffer_t {
+    buffer_t message;
+    bool_t in_use;
+};
+
+typedef enum tcpip_cmd_conn_state_t
+{
+    /**< The connection slot is not in use */
+    TCPIP_CMD_CONN_STATE_CLOSED = 0,
+    /**< Reading the ATS header of the next request */
+    TCPIP_CMD_CONN_STATE_RECV_HEADER,
+    /**< Waiting for a pool buffer to store the request body */
+    TCPIP_CMD_CONN_STATE_WAIT_BUFFER,
+    /**< Reading the request body */
+    TCPIP_CMD_CONN_STATE_RECV_BODY,
+    /**< Waiting for the socket to accept the rest of the response */
+    TCPIP_CMD_CONN_STATE_SEND,
+}tcpip_cmd_conn_state_t;
+
+/**< The state of one client connection */
+struct tcpip_cmd_connection_t {
+    ar_socket_t socket;
+    tcpip_cmd_conn_state_t state;
+    /**< The request header. Kept outside the pool so that idle
+     * connections do not hold a buffer */
+    char_t header[ATS_HEADER_LENGTH];
+    uint32_t header_bytes;
+    /**< The length of the request including the header */
+    uint32_t msg_len;
+    uint32_t msg_bytes;
+    /**< TRUE if the request is too large and its body is dropped */
+    bool_t discard;
+    /**< The pool buffer held by the connection or NULL */
+    tcpip_cmd_pool_buffer_t *buffer;
+    /**< The length of the pending response stored in the pool buffer */
+    uint32_t send_len;
+    uint32_t send_bytes;
+};
+
 class TcpipServer;
 
 class TcpipCmdServer
@@ -68,16 +119,25 @@ public:
     uint16_t port;
     std::string address;
     ar_socket_t listen_socket;
-    ar_socket_t accept_socket;
     ATS_EXECUTE_CALLBACK execute_command;
 
 private:
-    uint8_t is_connected;
-    bool_t is_aborted;
-    bool_t should_close_server;
-    ar_osal_mutex_t connection_lock;
-    buffer_t message_buffer;
+    int32_t epoll_fd;
+    /**< Signalled by stop() to wake up the connection routine */
+    int32_t wake_event_fd;
+    bool_t is_listening;
+    uint32_t num_connections;
+    /**< The largest request accepted by the server. Updated by
+     * ATS_CMD_ONC_SET_MAX_BUFFER_LENGTH */
+    uint32_t max_message_size;
+    /**< Sink for the body of requests larger than max_message_size */
     buffer_t recieve_buffer;
+    char_t error_response[ATS_ERROR_FRAME_LENGTH];
+    tcpip_cmd_connection_t connections[TCPIP_CMD_SERVER_MAX_CLIENTS];
+    tcpip_cmd_pool_buffer_t buffer_pool[TCPIP_CMD_SERVER_BUFFER_POOL_COUNT];
+    /**< The connection whose command is executing. Set only while
+     * the command callback runs */
+    tcpip_cmd_connection_t *executing_conn;
 
     /*------------------------- Server Commands -------------------------*/
 
@@ -92,7 +152,27 @@ private:
 
 public:
 
-    int32_t send_dls_log_buffers(const char_t* buffer, uint32_t buffer_size);
+    int32_t send_dls_log_buffers(const ats_transport_segment_t *segments, uint32_t segment_count);
+
+    /**
+    * \brief
+    *       Checks whether a command from a client is executing
+    *
+    * \return Returns TRUE if the response can be streamed to the client
+    */
+    bool_t is_stream_supported();
+
+    /**
+    * \brief
+    *       Writes part of a response directly to the client of the
+    *       executing command. Blocks until all segments are sent
+    *
+    * \param [in] segments: The pieces of the response to send in order
+    * \param [in] segment_count: The number of segments
+    *
+    * \return Returns AR_EOK on success and non-zero on failure
+    */
+    int32_t send_stream(const ats_transport_segment_t *segments, uint32_t segment_count);
 
 public:
 
@@ -100,7 +180,7 @@ public:
 
     /**
     * \brief
-    *       Starts the server by initializing locks and launches the connection routine thread
+    *       Starts the server by launching the connection routine thread
     *
     * \param [in] args: Optional arguments. Unused for now.
     *
@@ -118,12 +198,14 @@ public:
 
     /**
     * \brief
-    *	  Listens for incoming clients and starts the data transmission thread after a client connects
+    *	  Serves all clients of the command server from a single epoll loop
     *
     * \detdesc
-    *     Creates the listening socket on 5559 and accepts incoming connections.
-    *	  Upon accepting a new connection, a thread called recv_thread_proc is
-    *	  created to handle transmitting(send/recieve) data to client.
+    *     Creates the listening socket and waits for socket events. Each
+    *     connection is driven by its own state machine that reads the
+    *     request header, reads the request body into a pool buffer,
+    *     executes the command and sends the response. Commands are
+    *     executed one at a time since the ATS response buffer is shared.
     *
     * \dependencies
     *	  None
@@ -132,38 +214,43 @@ public:
     */
     void *connect_routine(void *args);
 
-    /**
-    * \brief
-    *    Routine for transmitting data between ATS and its client(s)
-    *
-    * \detdesc
-    *    Thread process that is created to handle 2 way message sending between server and client
-    *
-    * \param [in] args: This is unused
-    */
-    void *transmit_routine(void *args);
-
 private:
 
-    int32_t set_connected_lock(uint8_t is_conn);
-
     static void connect(void* arg);
 
-    static void transmit(void* arg);
+    int32_t create_event_loop();
+
+    void destroy_event_loop();
+
+    int32_t update_events(int32_t op, ar_socket_t socket, void *data, uint32_t events);
+
+    int32_t set_state(tcpip_cmd_connection_t *conn, tcpip_cmd_conn_state_t state);
 
-    int32_t recv_message_header(char_t *msgBuf, uint32_t msgbuflen,
-        char_t *recvbuf, uint32_t recvbuflen, uint32_t &msg_len);
+    void accept_connection();
 
-    int32_t recv_message(char_t *msgBuf, uint32_t msgbuflen,
-        char_t *recvbuf, uint32_t recvbuflen, uint32_t msg_len);
+    void close_connection(tcpip_cmd_connection_t *conn);
 
-    int32_t process_message(
-        char_t *msgBuf, uint32_t msgbuflen, uint32_t msg_len,
-        char_t **out_buf, uint32_t out_buf_len, uint32_t &resp_len);
+    tcpip_cmd_pool_buffer_t *acquire_pool_buffer();
 
-    int32_t send_message(char_t *buf, uint32_t buf_len, uint32_t msg_len);
+    void release_pool_buffer(tcpip_cmd_connection_t *conn);
 
-    int32_t execute_server_command(uint32_t service_cmd_id, uint32_t message_length);
+    int32_t reserve_pool_buffer(tcpip_cmd_connection_t *conn, uint32_t size);
+
+    void resume_waiting_connection();
+
+    void handle_recv(tcpip_cmd_connection_t *conn);
+
+    void handle_send(tcpip_cmd_connection_t *conn);
+
+    int32_t start_message_body(tcpip_cmd_connection_t *conn);
+
+    int32_t process_message(tcpip_cmd_connection_t *conn);
+
+    int32_t send_response(tcpip_cmd_connection_t *conn,
+        const char_t *resp, uint32_t resp_len);
+
+    int32_t execute_server_command(uint32_t service_cmd_id, const char_t *message,
+        uint32_t message_length);
 
     void start_dls_server();
 
@@ -190,7 +277,11 @@ public:
 
     int32_t stop();
 
-    int32_t send_dls_log_buffers(const uint8_t* buffer, uint32_t buffer_size);
+    int32_t send_dls_log_buffers(const ats_transport_segment_t *segments, uint32_t segment_count);
+
+    bool_t is_stream_supported();
+
+    int32_t send_stream(const ats_transport_segment_t *segments, uint32_t segment_count);
 };
 
 #endif /*ATS_TRANSPORT_TCPIP*/
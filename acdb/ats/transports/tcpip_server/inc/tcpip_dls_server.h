@@ -31,12 +31,15 @@
 #include "ar_osal_log.h"
 #include "ar_sockets_api.h"
 #include "tcpip_socket_util.h"
+#include "ats_transport_api.h"
 
 #define TCPIP_THREAD_PRIORITY_HIGH 0
 #define TCPIP_THREAD_PRIORITY_LOW 1
 #define TCPIP_THD_STACK_SIZE 0xF4240 //1mb stack size
 
 #define TCPIP_DLS_SERVER_PORT 5561
+/**< The maximum number of segments written to the socket with one sendmsg */
+#define TCPIP_DLS_SERVER_MAX_IOV_COUNT 64
 
 class TcpipDlsServer
 {
@@ -58,11 +61,12 @@ public:
 	void* connect_routine(void* args);
 
 	/* \brief
-	*	Sends DLS log buffers to the client
-	*	param[in] buffer: a data buffer containing the DLS packet data
-	*	param[in] buffer: The size of the buffer containing the DLS packet data
+	*	Sends DLS log buffers to the client using gathered writes. The call
+	*	returns once all the segments have been written to the socket.
+	*	param[in] segments: the pieces of DLS packet data to send in order
+	*	param[in] segment_count: The number of segments
 	*/
-	int32_t send_dls_log_buffers(const char_t* buffer, uint32_t buffer_size);
+	int32_t send_dls_log_buffers(const ats_transport_segment_t* segments, uint32_t segment_count);
 
 private:
 	int32_t set_connected_lock(uint8_t is_conn);
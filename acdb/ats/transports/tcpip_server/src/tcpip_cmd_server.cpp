@@ -7,9 +7,9 @@
 *
 *    This file contains the TCP/IP server implementation to host connections
 *    to QACT.
-*    This file first sets up a listening socket on port 5558. Upon accepting
-*    new connections, the server creates new receiving threads that handles
-*    all ATS upcalls.
+*    This file first sets up a listening socket on port 5558. All client
+*    connections are served by one event loop thread that handles all
+*    ATS upcalls.
 *
 *  \copyright
 *      Copyright (c) Qualcomm Innovation Center, Inc. All rights reserved.
@@ -17,8 +17,12 @@
 *=============================================================================
 */
 #ifdef ATS_TRANSPORT_TCPIP
-#include <thread>
-#include <chrono>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/uio.h>
 #include "tcpip_socket_util.h"
 #include "tcpip_dls_server.h"
 #include "tcpip_server_api.h"
@@ -35,12 +39,11 @@
 #define TCPIP_CMD_SVR_DBG(...) AR_LOG_DEBUG(TCPIP_CMD_SRV_LOG_TAG, __VA_ARGS__)
 #define TCPIP_CMD_SVR_INFO(...) AR_LOG_INFO(TCPIP_CMD_SRV_LOG_TAG, __VA_ARGS__)
 
-/**< The maximum number of clients that can connect to the command server*/
-#define MAX_TCPIP_CLIENTS_ALLOWED 1
+/**< The maximum number of socket events handled per wake up. Covers all
+ * clients plus the listening socket and the wake up event */
+#define TCPIP_CMD_SERVER_MAX_EVENTS (TCPIP_CMD_SERVER_MAX_CLIENTS + 2)
 /**< The name of the listening thread */
 #define TCPIP_THREAD_LISTENER "ATS_THD_LISTENER"
-/**< The name of the data transmission thread */
-#define TCPIP_THREAD_TRANSMIT "ATS_THD_TRANSMIT"
 /**< The size of the stack used by the threads created by the server */
 #define TCPIP_THD_STACK_SIZE 0xF4240 //1mb stack size
 /**< Indicates a high thread priority when creating a thread */
@@ -50,7 +53,6 @@
 
 typedef void *(TcpipCmdServer::*cmd_server_thread_callback)(void* args);
 static cmd_server_thread_callback thd_cb_connect_routine = &TcpipCmdServer::connect_routine;
-static cmd_server_thread_callback thd_cb_transmit_routine = &TcpipCmdServer::transmit_routine;
 
 /**< Instantiate a global static instance of the server for the duration of the appliation */
 static TcpipServer server;
@@ -155,9 +157,21 @@ int32_t tcpip_cmd_server_deinit()
     return status;
 }
 
-int32_t tcpip_cmd_server_send_dls_log_data(const uint8_t * sendbuf, uint32_t payload_size)
+int32_t tcpip_cmd_server_send_dls_log_data(
+    const ats_transport_segment_t* segments, uint32_t segment_count)
 {
-    return server.send_dls_log_buffers(sendbuf, payload_size);
+    return server.send_dls_log_buffers(segments, segment_count);
+}
+
+bool_t tcpip_cmd_server_is_stream_supported(void)
+{
+    return server.is_stream_supported();
+}
+
+int32_t tcpip_cmd_server_send_stream(
+    const ats_transport_segment_t* segments, uint32_t segment_count)
+{
+    return server.send_stream(segments, segment_count);
 }
 /*
 ============================================================================
@@ -197,9 +211,19 @@ int32_t TcpipServer::stop()
     return status;
 }
 
-int32_t TcpipServer::send_dls_log_buffers(const uint8_t* buffer, uint32_t buffer_size)
+int32_t TcpipServer::send_dls_log_buffers(const ats_transport_segment_t *segments, uint32_t segment_count)
+{
+    return cmd_server.send_dls_log_buffers(segments, segment_count);
+}
+
+bool_t TcpipServer::is_stream_supported()
+{
+    return cmd_server.is_stream_supported();
+}
+
+int32_t TcpipServer::send_stream(const ats_transport_segment_t *segments, uint32_t segment_count)
 {
-    return cmd_server.send_dls_log_buffers((const char_t*)buffer, buffer_size);
+    return cmd_server.send_stream(segments, segment_count);
 }
 
 /*
@@ -210,6 +234,18 @@ int32_t TcpipServer::send_dls_log_buffers(const uint8_t* buffer, uint32_t buffer
 TcpipCmdServer::TcpipCmdServer(std::string thd_name)
     : thd_name(thd_name)
 {
+    listen_socket = INVALID_SOCKET;
+    epoll_fd = -1;
+    wake_event_fd = -1;
+    is_listening = FALSE;
+    num_connections = 0;
+    max_message_size = ATS_BUFFER_LENGTH;
+    recieve_buffer.buffer_size = 0;
+    recieve_buffer.buffer = NULL;
+    ar_mem_set(error_response, 0, sizeof(error_response));
+    ar_mem_set(connections, 0, sizeof(connections));
+    ar_mem_set(buffer_pool, 0, sizeof(buffer_pool));
+    executing_conn = NULL;
 }
 
 int32_t TcpipCmdServer::start(void *args)
@@ -219,11 +255,12 @@ int32_t TcpipCmdServer::start(void *args)
 
     this->address = TCPIP_CMD_SERVER_ADDRESS;
     this->port = TCPIP_CMD_SERVER_PORT;
+    this->max_message_size = ATS_BUFFER_LENGTH;
 
-    status = ar_osal_mutex_create(&connection_lock);
+    status = create_event_loop();
     if (AR_FAILED(status))
     {
-        TCPIP_CMD_SVR_ERR("Error[%d]: Failed to create mutex for %s thread", status, thd_name.c_str());
+        TCPIP_CMD_SVR_ERR("Error[%d]: Failed to create the event loop for %s thread", status, thd_name.c_str());
         return status;
     }
 
@@ -241,6 +278,7 @@ int32_t TcpipCmdServer::start(void *args)
     if (AR_FAILED(status))
     {
         TCPIP_CMD_SVR_ERR("Error[%d]: Failed to create thread %s", status, thd_name.c_str());
+        destroy_event_loop();
         return status;
     }
 
@@ -250,16 +288,24 @@ int32_t TcpipCmdServer::start(void *args)
 int32_t TcpipCmdServer::stop()
 {
     int32_t status = AR_EOK;
+    uint64_t wake = 1;
+
+    if (0 > wake_event_fd)
+    {
+        return AR_EOK;
+    }
 
     TCPIP_CMD_SVR_INFO("Closing ATS CMD/RSP Server ...");
-    is_aborted = true;
-    should_close_server = true;
 
     stop_dls_server();
 
-    ar_socket_close(listen_socket);
-    ar_socket_close(accept_socket);
-    ar_osal_mutex_unlock(connection_lock);
+    /* The connection routine closes all connections and the listening
+     * socket after it is woken up */
+    if (0 > write(wake_event_fd, &wake, sizeof(wake)))
+    {
+        TCPIP_CMD_SVR_ERR("Error[%d]: Failed to wake up the listener thread. Socket error: %d",
+            AR_EFAILED, AR_SOCKET_LAST_ERROR);
+    }
 
     TCPIP_CMD_SVR_DBG("Destroying listening thread...");
     status = ar_osal_thread_join_destroy(thd_connection_routine);
@@ -268,46 +314,107 @@ int32_t TcpipCmdServer::stop()
         TCPIP_CMD_SVR_ERR("Error[%d]:An error occured when waiting to close the listener thread.", status);
     }
 
-    TCPIP_CMD_SVR_DBG("Destroying mutexes thread...");
-    ar_osal_mutex_destroy(connection_lock);
-
-    is_aborted = false;
-    should_close_server = false;
+    destroy_event_loop();
     return status;
 }
 
 
-int32_t TcpipCmdServer::send_dls_log_buffers(const char_t* buffer, uint32_t buffer_size)
+int32_t TcpipCmdServer::send_dls_log_buffers(const ats_transport_segment_t *segments, uint32_t segment_count)
 {
 #ifdef ATS_DATA_LOGGING
-    return _dls_server.send_dls_log_buffers(buffer, buffer_size);
+    return _dls_server.send_dls_log_buffers(segments, segment_count);
 #else
-    __UNREFERENCED_PARAM(buffer);
-    __UNREFERENCED_PARAM(buffer_size);
+    __UNREFERENCED_PARAM(segments);
+    __UNREFERENCED_PARAM(segment_count);
     return AR_EUNSUPPORTED;
 #endif
 }
 
+bool_t TcpipCmdServer::is_stream_supported()
+{
+    return NULL != executing_conn;
+}
 
-int32_t TcpipCmdServer::set_connected_lock(uint8_t value)
+int32_t TcpipCmdServer::send_stream(const ats_transport_segment_t *segments, uint32_t segment_count)
 {
-    int32_t status = AR_EOK;
+    struct iovec iov[TCPIP_CMD_SERVER_MAX_STREAM_SEGMENTS];
+    struct msghdr msg;
+    struct pollfd pfd;
+    uint32_t iov_count = 0;
+    uint32_t iov_index = 0;
+    ssize_t bytes_sent = 0;
+    int32_t poll_status = 0;
+
+    if (NULL == executing_conn)
+    {
+        TCPIP_CMD_SVR_ERR("Error[%d]: No command is executing", AR_EUNSUPPORTED);
+        return AR_EUNSUPPORTED;
+    }
 
-    status = ar_osal_mutex_lock(connection_lock);
-    if (AR_FAILED(status))
+    if (IsNull(segments) || segment_count > TCPIP_CMD_SERVER_MAX_STREAM_SEGMENTS)
     {
-        return status;
+        TCPIP_CMD_SVR_ERR("Error[%d]: Invalid stream segments", AR_EBADPARAM);
+        return AR_EBADPARAM;
+    }
+
+    for (uint32_t i = 0; i < segment_count; i++)
+    {
+        if (0 == segments[i].size)
+            continue;
+
+        iov[iov_count].iov_base = (void*)segments[i].buf;
+        iov[iov_count].iov_len = segments[i].size;
+        iov_count++;
     }
 
-    is_connected = value;
+    ar_mem_set(&msg, 0, sizeof(msg));
+    pfd.fd = executing_conn->socket;
+    pfd.events = POLLOUT;
 
-    status = ar_osal_mutex_lock(connection_lock);
-    if (AR_FAILED(status))
+    /* The socket is non-blocking, so wait for the client to drain it
+     * whenever it fills up */
+    while (iov_index < iov_count)
     {
-        return status;
+        msg.msg_iov = &iov[iov_index];
+        msg.msg_iovlen = iov_count - iov_index;
+
+        bytes_sent = sendmsg(executing_conn->socket, &msg, MSG_NOSIGNAL);
+        if (bytes_sent < 0)
+        {
+            if (AR_SOCKET_LAST_ERROR == EINTR) continue;
+            if (AR_SOCKET_LAST_ERROR != EAGAIN &&
+                AR_SOCKET_LAST_ERROR != EWOULDBLOCK)
+            {
+                TCPIP_CMD_SVR_ERR("Unable to stream message. Socket error: %d", AR_SOCKET_LAST_ERROR);
+                return AR_EFAILED;
+            }
+
+            pfd.revents = 0;
+            poll_status = poll(&pfd, 1, TCPIP_CMD_SERVER_STREAM_SEND_TIMEOUT_MS);
+            if (poll_status < 0 && AR_SOCKET_LAST_ERROR == EINTR) continue;
+            if (poll_status <= 0 || (pfd.revents & (POLLERR | POLLHUP)))
+            {
+                TCPIP_CMD_SVR_ERR("Error[%d]: The client stopped receiving the stream. Socket error: %d",
+                    AR_ETIMEOUT, AR_SOCKET_LAST_ERROR);
+                return AR_ETIMEOUT;
+            }
+            continue;
+        }
+
+        while (iov_index < iov_count && (size_t)bytes_sent >= iov[iov_index].iov_len)
+        {
+            bytes_sent -= (ssize_t)iov[iov_index].iov_len;
+            iov_index++;
+        }
+
+        if (iov_index < iov_count)
+        {
+            iov[iov_index].iov_base = (uint8_t*)iov[iov_index].iov_base + bytes_sent;
+            iov[iov_index].iov_len -= (size_t)bytes_sent;
+        }
     }
 
-    return status;
+    return AR_EOK;
 }
 
 void TcpipCmdServer::connect(void* arg)
@@ -316,10 +423,102 @@ void TcpipCmdServer::connect(void* arg)
     (thread->*thd_cb_connect_routine)(NULL);
 }
 
-void TcpipCmdServer::transmit(void* arg)
+int32_t TcpipCmdServer::create_event_loop()
+{
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (0 > epoll_fd)
+    {
+        TCPIP_CMD_SVR_ERR("Error[%d]: Failed to create epoll instance. Socket error: %d",
+            AR_EFAILED, AR_SOCKET_LAST_ERROR);
+        return AR_EFAILED;
+    }
+
+    wake_event_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (0 > wake_event_fd)
+    {
+        TCPIP_CMD_SVR_ERR("Error[%d]: Failed to create wake up event. Socket error: %d",
+            AR_EFAILED, AR_SOCKET_LAST_ERROR);
+        destroy_event_loop();
+        return AR_EFAILED;
+    }
+
+    if (AR_FAILED(update_events(EPOLL_CTL_ADD, wake_event_fd, &wake_event_fd, EPOLLIN)))
+    {
+        destroy_event_loop();
+        return AR_EFAILED;
+    }
+
+    for (uint32_t i = 0; i < TCPIP_CMD_SERVER_MAX_CLIENTS; i++)
+    {
+        connections[i].socket = INVALID_SOCKET;
+        connections[i].state = TCPIP_CMD_CONN_STATE_CLOSED;
+        connections[i].buffer = NULL;
+    }
+    num_connections = 0;
+
+    return AR_EOK;
+}
+
+void TcpipCmdServer::destroy_event_loop()
+{
+    if (0 <= wake_event_fd)
+    {
+        close(wake_event_fd);
+        wake_event_fd = -1;
+    }
+
+    if (0 <= epoll_fd)
+    {
+        close(epoll_fd);
+        epoll_fd = -1;
+    }
+}
+
+int32_t TcpipCmdServer::update_events(int32_t op, ar_socket_t socket, void *data, uint32_t events)
+{
+    struct epoll_event event;
+
+    ar_mem_set(&event, 0, sizeof(event));
+    event.events = events;
+    event.data.ptr = data;
+
+    if (0 > epoll_ctl(epoll_fd, op, socket, &event))
+    {
+        TCPIP_CMD_SVR_ERR("Error[%d]: Failed to update socket events. Socket error: %d",
+            AR_EFAILED, AR_SOCKET_LAST_ERROR);
+        return AR_EFAILED;
+    }
+
+    return AR_EOK;
+}
+
+/* Returns the socket events a connection waits for in the given state */
+static uint32_t tcpip_cmd_server_get_state_events(tcpip_cmd_conn_state_t state)
+{
+    switch (state)
+    {
+    case TCPIP_CMD_CONN_STATE_RECV_HEADER:
+    case TCPIP_CMD_CONN_STATE_RECV_BODY:
+        return EPOLLIN;
+    case TCPIP_CMD_CONN_STATE_SEND:
+        return EPOLLOUT;
+    default:
+        return 0;
+    }
+}
+
+int32_t TcpipCmdServer::set_state(tcpip_cmd_connection_t *conn, tcpip_cmd_conn_state_t state)
 {
-    TcpipCmdServer * thread = (TcpipCmdServer*)arg;
-    (thread->*thd_cb_transmit_routine)(NULL);
+    int32_t status = AR_EOK;
+    uint32_t events = tcpip_cmd_server_get_state_events(state);
+
+    if (events != tcpip_cmd_server_get_state_events(conn->state))
+    {
+        status = update_events(EPOLL_CTL_MOD, conn->socket, conn, events);
+    }
+
+    conn->state = state;
+    return status;
 }
 
 void *TcpipCmdServer::connect_routine(void *args)
@@ -328,7 +527,18 @@ void *TcpipCmdServer::connect_routine(void *args)
 
     TCPIP_CMD_SVR_INFO("Starting TCP/IP server thread.");
     int32_t status = AR_EOK;
-    ar_osal_thread_t thd_transmit = NULL;
+    int32_t flags = 0;
+    int32_t num_events = 0;
+    bool_t is_running = TRUE;
+    bool_t should_accept = FALSE;
+    struct epoll_event events[TCPIP_CMD_SERVER_MAX_EVENTS];
+    struct ar_heap_info_t heap_inf =
+    {
+        AR_HEAP_ALIGN_DEFAULT,
+        AR_HEAP_POOL_DEFAULT,
+        AR_HEAP_ID_DEFAULT,
+        AR_HEAP_TAG_DEFAULT
+    };
 
     status = tcpip_socket_util_create_socket(TCPIP_SERVER_TYPE_CMD, AR_SOCKET_ADDRESS_FAMILY, address, port, &listen_socket);
     if (AR_FAILED(status))
@@ -341,79 +551,124 @@ void *TcpipCmdServer::connect_routine(void *args)
 
     /* Clients will recieve a 'connection refused' error if the the
      * listening queue is full. The size of the queue is
-     * MAX_TCPIP_CLIENTS_ALLOWED */
-    status = ar_socket_listen(listen_socket, MAX_TCPIP_CLIENTS_ALLOWED);
+     * TCPIP_CMD_SERVER_MAX_CLIENTS */
+    status = ar_socket_listen(listen_socket, TCPIP_CMD_SERVER_MAX_CLIENTS);
     if (AR_FAILED(status))
     {
-        TCPIP_CMD_SVR_INFO("Error[%d]: Listen failed. Closing server...");
-        ar_socket_close(listen_socket);
-        return NULL;
+        TCPIP_CMD_SVR_ERR("Error[%d]: Listen failed. Closing server...", status);
+        goto connect_routine_end;
     }
 
-    TCPIP_CMD_SVR_INFO("Waiting to accept ATS TCP/IP Command-Response clients...");
-    while (true)
+    flags = fcntl(listen_socket, F_GETFL, 0);
+    if (0 > flags || 0 > fcntl(listen_socket, F_SETFL, flags | O_NONBLOCK))
     {
-        if (should_close_server) break;
+        TCPIP_CMD_SVR_ERR("Error[%d]: Failed to make the listening socket non-blocking", AR_EFAILED);
+        goto connect_routine_end;
+    }
 
-        status = tcpip_socket_util_accept_connections(AR_SOCKET_ADDRESS_FAMILY, listen_socket, &accept_socket);
-        if (AR_FAILED(status))
-        {
-            ar_socket_close(accept_socket);
+    recieve_buffer.buffer_size = TCPIP_CMD_SERVER_RECV_BUFFER_SIZE;
+    recieve_buffer.buffer = (char_t*)ar_heap_malloc(recieve_buffer.buffer_size, &heap_inf);
+    if (NULL == recieve_buffer.buffer)
+    {
+        TCPIP_CMD_SVR_ERR("Error[%d]: Failed to allocate the receive buffer", AR_ENOMEMORY);
+        goto connect_routine_end;
+    }
 
+    if (AR_FAILED(update_events(EPOLL_CTL_ADD, listen_socket, &listen_socket, EPOLLIN)))
+    {
+        goto connect_routine_end;
+    }
+    is_listening = TRUE;
+
+    TCPIP_CMD_SVR_INFO("Waiting to accept ATS TCP/IP Command-Response clients...");
+    while (is_running)
+    {
+        num_events = epoll_wait(epoll_fd, events, TCPIP_CMD_SERVER_MAX_EVENTS, -1);
+        if (0 > num_events)
+        {
             if (AR_SOCKET_LAST_ERROR == EINTR) continue;
 
-            continue;
+            TCPIP_CMD_SVR_ERR("Error[%d]: Failed to wait for socket events. Socket error: %d",
+                AR_EFAILED, AR_SOCKET_LAST_ERROR);
+            break;
         }
 
-        //Start dls Server only after connecting to command server
-        start_dls_server();
+        for (int32_t i = 0; i < num_events; i++)
+        {
+            void *data = events[i].data.ptr;
 
-        TCPIP_CMD_SVR_INFO("Client connected to ATS TCPIP Command-Response Server");
-        ar_osal_mutex_unlock(connection_lock);
-        is_connected = true;
+            if (data == &wake_event_fd)
+            {
+                is_running = FALSE;
+                break;
+            }
 
-        //ar_osal_thread_t thd_transmit;
-        ar_osal_thread_start_routine r = \
-            (ar_osal_thread_start_routine)(transmit);
+            /* Accepted after the other events so that a connection slot
+             * closed by this batch is not reused before its events are done */
+            if (data == &listen_socket)
+            {
+                should_accept = TRUE;
+                continue;
+            }
 
-        std::string thd_transmit_name = "";
-        ar_osal_thread_attr_t thd_attr = \
-        {
-            (char_t*)thd_transmit_name.c_str(),
-                TCPIP_THD_STACK_SIZE,
-                TCPIP_THREAD_PRIORITY_HIGH
-        };
+            tcpip_cmd_connection_t *conn = (tcpip_cmd_connection_t*)data;
 
-        status = ar_osal_thread_create(&thd_transmit, &thd_attr, r, this);
-        if (AR_FAILED(status))
-        {
-            TCPIP_CMD_SVR_ERR("Error[%d]: Failed to create transmission thread", status);
-        }
+            /* The connection may have been closed by an earlier event */
+            if (TCPIP_CMD_CONN_STATE_CLOSED == conn->state) continue;
 
+            if (events[i].events & (EPOLLERR | EPOLLHUP))
+            {
+                TCPIP_CMD_SVR_INFO("Client socket hung up. Closing connection...");
+                close_connection(conn);
+                continue;
+            }
 
-        /* Only one client is allowed to connect to the server for now.
-         * Block until client calls QUIT on transmission thread.
-         * Allow 200 msec sleep for thd_transmit to aquire connection_lock*/
-        std::this_thread::sleep_for(std::chrono::milliseconds(200));
-        ar_osal_mutex_lock(connection_lock);
+            if (events[i].events & EPOLLOUT)
+            {
+                handle_send(conn);
+            }
 
-        status = ar_osal_thread_join_destroy(thd_transmit);
-        if (AR_FAILED(status))
+            if ((events[i].events & EPOLLIN) &&
+                TCPIP_CMD_CONN_STATE_CLOSED != conn->state)
+            {
+                handle_recv(conn);
+            }
+        }
+
+        if (should_accept && is_running)
         {
-            TCPIP_CMD_SVR_ERR("Error[%d]: Failed to destroy connection thread", status);
+            accept_connection();
         }
+        should_accept = FALSE;
+    }
+
+connect_routine_end:
+    for (uint32_t i = 0; i < TCPIP_CMD_SERVER_MAX_CLIENTS; i++)
+    {
+        if (TCPIP_CMD_CONN_STATE_CLOSED != connections[i].state)
+            close_connection(&connections[i]);
     }
 
     ar_socket_close(listen_socket);
-    ar_socket_close(accept_socket);
-    //for (int j = 0; j < MAX_TCPIP_CLIENTS_ALLOWED; j++)
-    //{
-    //    status = ar_osal_thread_join_destroy(thd_transmit);
-    //    if (AR_FAILED(status))
-    //    {
-    //        TCPIP_CMD_SVR_ERR("Error[%d]: Failed to destroy connection thread", status);
-    //    }
-    //}
+    listen_socket = INVALID_SOCKET;
+    is_listening = FALSE;
+
+    for (uint32_t i = 0; i < TCPIP_CMD_SERVER_BUFFER_POOL_COUNT; i++)
+    {
+        if (NULL != buffer_pool[i].message.buffer)
+            ar_heap_free(buffer_pool[i].message.buffer, &heap_inf);
+
+        buffer_pool[i].message.buffer = NULL;
+        buffer_pool[i].message.buffer_size = 0;
+        buffer_pool[i].in_use = FALSE;
+    }
+
+    if (NULL != recieve_buffer.buffer)
+    {
+        ar_heap_free(recieve_buffer.buffer, &heap_inf);
+        recieve_buffer.buffer = NULL;
+        recieve_buffer.buffer_size = 0;
+    }
 
     return 0;
 }
@@ -442,370 +697,447 @@ void TcpipCmdServer::stop_dls_server()
 #endif
 }
 
-void *TcpipCmdServer::transmit_routine(void *args)
+void TcpipCmdServer::accept_connection()
 {
-    __UNREFERENCED_PARAM(args);
+    int32_t flags = 0;
+    ar_socket_t socket = INVALID_SOCKET;
+    tcpip_cmd_connection_t *conn = NULL;
 
-    int32_t status = AR_EOK;
-    const uint32_t maxsize = ATS_BUFFER_LENGTH;//TODO: We need to introduce a command to change this size. 2mb is too high
-    char_t* outbuf = NULL;
+    if (AR_FAILED(tcpip_socket_util_accept_connections(
+        AR_SOCKET_ADDRESS_FAMILY, listen_socket, &socket)))
+    {
+        return;
+    }
 
-    struct ar_heap_info_t heap_inf =
+    for (uint32_t i = 0; i < TCPIP_CMD_SERVER_MAX_CLIENTS; i++)
     {
-        AR_HEAP_ALIGN_DEFAULT,
-        AR_HEAP_POOL_DEFAULT,
-        AR_HEAP_ID_DEFAULT,
-        AR_HEAP_TAG_DEFAULT
-    };
+        if (TCPIP_CMD_CONN_STATE_CLOSED == connections[i].state)
+        {
+            conn = &connections[i];
+            break;
+        }
+    }
 
-    ar_osal_mutex_lock(connection_lock);
+    /* Not expected since the listening socket is ignored while all
+     * connection slots are in use */
+    if (NULL == conn)
+    {
+        TCPIP_CMD_SVR_ERR("Error[%d]: Too many clients. Closing connection...", AR_ENORESOURCE);
+        ar_socket_close(socket);
+        return;
+    }
 
-    message_buffer.buffer_size = ATS_BUFFER_LENGTH;
-    recieve_buffer.buffer_size = TCPIP_CMD_SERVER_RECV_BUFFER_SIZE;
-    //Stores one message
-    message_buffer.buffer = (char_t*)ar_heap_malloc(message_buffer.buffer_size, &heap_inf);
-    if (NULL == message_buffer.buffer)
-        return 0;
+    flags = fcntl(socket, F_GETFL, 0);
+    if (0 > flags || 0 > fcntl(socket, F_SETFL, flags | O_NONBLOCK))
+    {
+        TCPIP_CMD_SVR_ERR("Error[%d]: Failed to make the client socket non-blocking", AR_EFAILED);
+        ar_socket_close(socket);
+        return;
+    }
 
-    recieve_buffer.buffer = (char_t*)ar_heap_malloc(recieve_buffer.buffer_size, &heap_inf);
-    if (NULL == recieve_buffer.buffer) {
-        ar_heap_free(message_buffer.buffer, &heap_inf);
-        return 0;
+    ar_mem_set(conn, 0, sizeof(tcpip_cmd_connection_t));
+    conn->socket = socket;
+    if (AR_FAILED(update_events(EPOLL_CTL_ADD, socket, conn, EPOLLIN)))
+    {
+        ar_socket_close(socket);
+        conn->socket = INVALID_SOCKET;
+        return;
     }
+    conn->state = TCPIP_CMD_CONN_STATE_RECV_HEADER;
 
-    outbuf = (char_t*)ar_heap_malloc(maxsize, &heap_inf);
-    if (NULL == outbuf) {
-        ar_heap_free(message_buffer.buffer, &heap_inf);
-        ar_heap_free(recieve_buffer.buffer, &heap_inf);
-        return 0;
+    //Start dls Server only after the first client connects to command server
+    if (0 == num_connections)
+        start_dls_server();
+
+    num_connections++;
+    TCPIP_CMD_SVR_INFO("Client connected to ATS TCPIP Command-Response Server (%d/%d)",
+        num_connections, TCPIP_CMD_SERVER_MAX_CLIENTS);
+
+    /* Leave new clients in the listening queue until a connection closes */
+    if (TCPIP_CMD_SERVER_MAX_CLIENTS == num_connections &&
+        AR_SUCCEEDED(update_events(EPOLL_CTL_MOD, listen_socket, &listen_socket, 0)))
+    {
+        is_listening = FALSE;
     }
-    ar_mem_set(outbuf, 0, 1);
+}
+
+void TcpipCmdServer::close_connection(tcpip_cmd_connection_t *conn)
+{
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, conn->socket, NULL);
+    ar_socket_close(conn->socket);
+    conn->socket = INVALID_SOCKET;
+    conn->state = TCPIP_CMD_CONN_STATE_CLOSED;
+    num_connections--;
+
+    TCPIP_CMD_SVR_INFO("Client disconnected from ATS TCPIP Command-Response Server (%d/%d)",
+        num_connections, TCPIP_CMD_SERVER_MAX_CLIENTS);
 
-    while (true)
+    if (!is_listening &&
+        AR_SUCCEEDED(update_events(EPOLL_CTL_MOD, listen_socket, &listen_socket, EPOLLIN)))
     {
-        uint32_t request_message_length = 0;
-        uint32_t response_message_length = 0;
+        is_listening = TRUE;
+    }
 
-        /* This is for readability when analyzing the logs.We want to separate each command
-         * sent by the client with a new line to understand all the operations that occur
-         * during one command */
-        TCPIP_CMD_SVR_DBG("\n");
+    release_pool_buffer(conn);
+}
 
-        status = recv_message_header(
-            message_buffer.buffer, message_buffer.buffer_size,
-            recieve_buffer.buffer, recieve_buffer.buffer_size,
-            request_message_length);
-        if (AR_FAILED(status))
+tcpip_cmd_pool_buffer_t *TcpipCmdServer::acquire_pool_buffer()
+{
+    for (uint32_t i = 0; i < TCPIP_CMD_SERVER_BUFFER_POOL_COUNT; i++)
+    {
+        if (!buffer_pool[i].in_use)
         {
-            if (AR_ETERMINATED == status)
-            {
-                TCPIP_CMD_SVR_INFO("Ending data transmission...")
-            }
-            else
-            {
-                TCPIP_CMD_SVR_ERR("Error[%d]: Failed to read message header",
-                    status);
-            }
-            break;
+            buffer_pool[i].in_use = TRUE;
+            return &buffer_pool[i];
         }
+    }
 
-        status = recv_message(
-            message_buffer.buffer, message_buffer.buffer_size,
-            recieve_buffer.buffer, recieve_buffer.buffer_size,
-            request_message_length);
-        if (AR_FAILED(status) && status != AR_ENEEDMORE)
-        {
-            TCPIP_CMD_SVR_ERR("Error[%d]: Failed to read message data", status);
-            break;
-        }
+    return NULL;
+}
 
-        status = process_message(
-            message_buffer.buffer, message_buffer.buffer_size, request_message_length,
-            (char_t**)&outbuf,
-            maxsize, response_message_length);
-        if (AR_FAILED(status))
-        {
-            TCPIP_CMD_SVR_ERR("Error[%d]: Failed to read message data", status);
-            break;
-        }
+void TcpipCmdServer::release_pool_buffer(tcpip_cmd_connection_t *conn)
+{
+    if (NULL == conn->buffer)
+        return;
 
-        status = send_message(outbuf, maxsize, response_message_length);
-        if (AR_FAILED(status))
-        {
-            TCPIP_CMD_SVR_ERR("Error[%d]: Failed to send message", status);
-            break;
-        }
+    conn->buffer->in_use = FALSE;
+    conn->buffer = NULL;
+
+    resume_waiting_connection();
+}
+
+int32_t TcpipCmdServer::reserve_pool_buffer(tcpip_cmd_connection_t *conn, uint32_t size)
+{
+    buffer_t *message = &conn->buffer->message;
+    struct ar_heap_info_t heap_inf =
+    {
+        AR_HEAP_ALIGN_DEFAULT,
+        AR_HEAP_POOL_DEFAULT,
+        AR_HEAP_ID_DEFAULT,
+        AR_HEAP_TAG_DEFAULT
+    };
+
+    if (message->buffer_size >= size)
+        return AR_EOK;
+
+    /* Pool buffers are only grown so that they settle at the message
+     * sizes used by the clients */
+    if (size < TCPIP_CMD_SERVER_MIN_MSG_BUFFER_SIZE)
+        size = TCPIP_CMD_SERVER_MIN_MSG_BUFFER_SIZE;
+
+    if (NULL != message->buffer)
+        ar_heap_free(message->buffer, &heap_inf);
+
+    message->buffer = (char_t*)ar_heap_malloc(size, &heap_inf);
+    if (NULL == message->buffer)
+    {
+        TCPIP_CMD_SVR_ERR("Error[%d]: Failed to allocate a message buffer of %d bytes",
+            AR_ENOMEMORY, size);
+        message->buffer_size = 0;
+        return AR_ENOMEMORY;
     }
 
-    //Cleanup
-    TCPIP_CMD_SVR_DBG("%s: closing thread", thd_name.c_str());
+    message->buffer_size = size;
+    return AR_EOK;
+}
 
-    ar_heap_free(message_buffer.buffer, &heap_inf);
-    ar_heap_free(recieve_buffer.buffer, &heap_inf);
+void TcpipCmdServer::resume_waiting_connection()
+{
+    for (uint32_t i = 0; i < TCPIP_CMD_SERVER_MAX_CLIENTS; i++)
+    {
+        tcpip_cmd_connection_t *conn = &connections[i];
 
-    is_connected = false;
-    ar_osal_mutex_unlock(connection_lock);
-    return 0;
+        if (TCPIP_CMD_CONN_STATE_WAIT_BUFFER != conn->state)
+            continue;
+
+        if (AR_FAILED(start_message_body(conn)))
+        {
+            close_connection(conn);
+            continue;
+        }
+
+        /* The pool is empty again */
+        if (TCPIP_CMD_CONN_STATE_WAIT_BUFFER == conn->state)
+            return;
+    }
 }
 
-int32_t TcpipCmdServer::recv_message_header(char_t *msgBuf, uint32_t msgbuflen,
-    char_t *recvbuf, uint32_t recvbuflen, uint32_t &msg_len)
+void TcpipCmdServer::handle_recv(tcpip_cmd_connection_t *conn)
 {
     int32_t status = AR_EOK;
     int32_t bytes_recieved = 0;
-    int32_t headerBytesRead = 0;
-    char svc_id_str[ATS_SEVICE_ID_STR_LEN] = { 0 };
-    uint32_t svc_cmd_id = 0;
+    char_t *buf = NULL;
+    uint32_t len = 0;
 
-    while (true)
+    /* Keep reading until the socket is drained or the connection has to
+     * wait for a pool buffer or for the response to be sent */
+    while (TCPIP_CMD_CONN_STATE_RECV_HEADER == conn->state ||
+        TCPIP_CMD_CONN_STATE_RECV_BODY == conn->state)
     {
-        //receive full message header
-        TCPIP_CMD_SVR_DBG("Waiting to recieve message...");
-
-        if (ATS_HEADER_LENGTH - headerBytesRead > (int32_t)recvbuflen)
+        if (TCPIP_CMD_CONN_STATE_RECV_HEADER == conn->state)
+        {
+            buf = conn->header + conn->header_bytes;
+            len = ATS_HEADER_LENGTH - conn->header_bytes;
+        }
+        else if (conn->discard)
         {
-            return AR_EBADPARAM;
+            buf = recieve_buffer.buffer;
+            len = conn->msg_len - conn->msg_bytes;
+            if (len > recieve_buffer.buffer_size)
+                len = recieve_buffer.buffer_size;
+        }
+        else
+        {
+            buf = conn->buffer->message.buffer + conn->msg_bytes;
+            len = conn->msg_len - conn->msg_bytes;
         }
-        status = ar_socket_recv(accept_socket, recvbuf, ATS_HEADER_LENGTH - headerBytesRead, 0, &bytes_recieved);
 
+        bytes_recieved = (int32_t)recv(conn->socket, buf, len, 0);
         if (bytes_recieved < 0)
         {
             if (AR_SOCKET_LAST_ERROR == EINTR) continue;
+            if (AR_SOCKET_LAST_ERROR == EAGAIN ||
+                AR_SOCKET_LAST_ERROR == EWOULDBLOCK) return;
 
-            TCPIP_CMD_SVR_ERR("Receive failed with error: %d\n", AR_SOCKET_LAST_ERROR);
-            ar_socket_close(accept_socket);
-            return AR_EFAILED;
+            TCPIP_CMD_SVR_ERR("Receive failed with error: %d", AR_SOCKET_LAST_ERROR);
+            close_connection(conn);
+            return;
         }
         else if (bytes_recieved == 0)
         {
             TCPIP_CMD_SVR_INFO("Client shutdown socket. Closing connection...");
-            ar_socket_close(accept_socket);
-            return AR_ETERMINATED;
+            close_connection(conn);
+            return;
         }
 
-        TCPIP_CMD_SVR_DBG("Recieved %d bytes", bytes_recieved);
+        if (TCPIP_CMD_CONN_STATE_RECV_HEADER == conn->state)
+        {
+            conn->header_bytes += bytes_recieved;
 
-        /* The client sends "QUIT" to signal end of connection. The server will close
-         * the socket and return */
-        if (ar_strcmp(recvbuf, ATS_SERVER_CMD_QUIT.c_str(), 4) == 0)
+            /* The client sends "QUIT" to signal end of connection. The server will close
+             * the socket and return */
+            if (conn->header_bytes >= ATS_SERVER_CMD_QUIT.length() &&
+                ar_strcmp(conn->header, ATS_SERVER_CMD_QUIT.c_str(), 4) == 0)
+            {
+                TCPIP_CMD_SVR_INFO("Quitting...");
+                close_connection(conn);
+                return;
+            }
+
+            if (conn->header_bytes < ATS_HEADER_LENGTH)
+                continue;
+
+            status = start_message_body(conn);
+        }
+        else
         {
-            TCPIP_CMD_SVR_INFO("Quitting...");
-            ar_socket_close(accept_socket);
-            return AR_ETERMINATED;
+            conn->msg_bytes += bytes_recieved;
+            if (conn->msg_bytes < conn->msg_len)
+                continue;
+
+            status = process_message(conn);
         }
 
-        if (headerBytesRead > (int32_t)msgbuflen)
+        if (AR_FAILED(status))
         {
-            return AR_EBADPARAM;
+            close_connection(conn);
+            return;
         }
-        ar_mem_cpy(msgBuf + headerBytesRead, bytes_recieved, recvbuf, bytes_recieved);
-        headerBytesRead += bytes_recieved;
+    }
+}
 
-        //this determines how many bytes to expect (thus determining how many times to loop).
-        if (tcpip_cmd_server_get_ats_command_length(msgBuf, bytes_recieved, &msg_len))
+void TcpipCmdServer::handle_send(tcpip_cmd_connection_t *conn)
+{
+    int32_t bytes_sent = 0;
+
+    while (conn->send_bytes < conn->send_len)
+    {
+        bytes_sent = (int32_t)send(conn->socket,
+            conn->buffer->message.buffer + conn->send_bytes,
+            conn->send_len - conn->send_bytes, MSG_NOSIGNAL);
+        if (bytes_sent < 0)
         {
-            svc_cmd_id = 0;
-            ar_mem_cpy(&svc_cmd_id, ATS_SERVICE_COMMAND_ID_LENGTH,
-                msgBuf + ATS_SERVICE_COMMAND_ID_POSITION, ATS_SERVICE_COMMAND_ID_LENGTH);
+            if (AR_SOCKET_LAST_ERROR == EINTR) continue;
+            if (AR_SOCKET_LAST_ERROR == EAGAIN ||
+                AR_SOCKET_LAST_ERROR == EWOULDBLOCK) return;
 
-            ATS_SERVICE_ID_STR(svc_id_str, ATS_SEVICE_ID_STR_LEN, svc_cmd_id);
-            TCPIP_CMD_SVR_DBG("Recieved Command[%s-%d] with length %d bytes", svc_id_str, ATS_GET_COMMAND_ID(svc_cmd_id), msg_len);
-            break;
+            TCPIP_CMD_SVR_ERR("Unable to send message. Socket error: %d", AR_SOCKET_LAST_ERROR);
+            close_connection(conn);
+            return;
         }
+
+        conn->send_bytes += bytes_sent;
     }
 
-    msg_len += ATS_HEADER_LENGTH;
+    TCPIP_CMD_SVR_DBG("Message sent");
 
-    return status;
+    conn->header_bytes = 0;
+    if (AR_FAILED(set_state(conn, TCPIP_CMD_CONN_STATE_RECV_HEADER)))
+    {
+        close_connection(conn);
+        return;
+    }
+
+    release_pool_buffer(conn);
 }
 
-int32_t TcpipCmdServer::recv_message(char_t *msgBuf, uint32_t msgbuflen,
-    char_t *recvbuf, uint32_t recvbuflen, uint32_t msg_len)
+int32_t TcpipCmdServer::start_message_body(tcpip_cmd_connection_t *conn)
 {
-    __UNREFERENCED_PARAM(recvbuflen);
     int32_t status = AR_EOK;
-    int32_t bytes_recieved = 0;
-    uint32_t message_bytes_read = 0;
-    uint32_t remaining_message_length = 0;
-    uint32_t recv_len = 0;
-    uint32_t data_length = msg_len;
-    bool_t should_write_msg = TRUE;
+    uint32_t data_length = 0;
+    uint32_t svc_cmd_id = 0;
+    char svc_id_str[ATS_SEVICE_ID_STR_LEN] = { 0 };
 
-    if (msg_len > msgbuflen)
+    tcpip_cmd_server_get_ats_command_length(conn->header, ATS_HEADER_LENGTH, &data_length);
+    if (data_length > UINT32_MAX - ATS_HEADER_LENGTH)
     {
-        /* We reject messages that are larger that what we can store in our message buffer */
-        TCPIP_CMD_SVR_ERR("Error[%d]: Not enough memory to store incoming message of %d bytes. "
-            "Use resize buffer command to update the max buffer size", AR_ENEEDMORE, msg_len);
-
-        should_write_msg = FALSE;
-        status =  AR_ENEEDMORE;
+        TCPIP_CMD_SVR_ERR("Error[%d]: Invalid message data length %d bytes",
+            AR_EBADPARAM, data_length);
+        return AR_EBADPARAM;
     }
 
-    data_length -= ATS_HEADER_LENGTH;
-    while (data_length > 0)
-    {
-        //receive rest of message
-        if (message_bytes_read > data_length)
-        {
-            TCPIP_CMD_SVR_ERR("Error[%d]: Read more than message length. Exiting..",
-                AR_ENEEDMORE);
-            ar_socket_close(accept_socket);
+    ar_mem_cpy(&svc_cmd_id, ATS_SERVICE_COMMAND_ID_LENGTH,
+        conn->header + ATS_SERVICE_COMMAND_ID_POSITION, ATS_SERVICE_COMMAND_ID_LENGTH);
+    ATS_SERVICE_ID_STR(svc_id_str, ATS_SEVICE_ID_STR_LEN, svc_cmd_id);
+    TCPIP_CMD_SVR_DBG("Recieved Command[%s-%d] with length %d bytes", svc_id_str, ATS_GET_COMMAND_ID(svc_cmd_id), data_length);
 
-            return AR_ENEEDMORE;
-        }
+    conn->msg_len = data_length + ATS_HEADER_LENGTH;
+    conn->msg_bytes = ATS_HEADER_LENGTH;
+    conn->discard = conn->msg_len > max_message_size;
 
-        remaining_message_length = data_length - message_bytes_read;
-        recv_len = remaining_message_length < TCPIP_CMD_SERVER_RECV_BUFFER_SIZE ?
-            remaining_message_length : TCPIP_CMD_SERVER_RECV_BUFFER_SIZE;
+    if (NULL == conn->buffer)
+        conn->buffer = acquire_pool_buffer();
 
-        //will receive min(TCPIP_CMD_SERVER_RECV_BUFFER_SIZE, bytes left to receive to complete message)
-        bytes_recieved = recv(accept_socket, recvbuf, recv_len, 0);
+    /* Stop reading from the client until another connection releases a buffer */
+    if (NULL == conn->buffer)
+        return set_state(conn, TCPIP_CMD_CONN_STATE_WAIT_BUFFER);
 
-        if (bytes_recieved > 0)
-        {
-            TCPIP_CMD_SVR_DBG("Recieved %d bytes", bytes_recieved);
+    if (conn->discard)
+    {
+        /* We reject messages that are larger that what we can store in our message buffer */
+        TCPIP_CMD_SVR_ERR("Error[%d]: Not enough memory to store incoming message of %d bytes. "
+            "Use resize buffer command to update the max buffer size", AR_ENEEDMORE, conn->msg_len);
+    }
 
-            if (should_write_msg)
-            {
-                if (ATS_HEADER_LENGTH + message_bytes_read > msgbuflen)
-                {
-                    TCPIP_CMD_SVR_ERR("Message bytes read + ATS Header %d bytes is greater "
-                        "than message buffer length %d bytes",
-                        ATS_HEADER_LENGTH + message_bytes_read, msgbuflen);
-                    return AR_ENEEDMORE;
-                }
-
-                ar_mem_cpy(msgBuf + ATS_HEADER_LENGTH + message_bytes_read, bytes_recieved,
-                    recvbuf, bytes_recieved);
-            }
+    status = reserve_pool_buffer(conn, conn->discard ? ATS_HEADER_LENGTH : conn->msg_len);
+    if (AR_FAILED(status))
+        return status;
 
-            message_bytes_read += bytes_recieved;
-            if (message_bytes_read == data_length)
-            {
-                break;
-            }
-        }
-        else if (bytes_recieved <= 0)
-        {
-            if (AR_SOCKET_LAST_ERROR == EINTR)
-            {
-                //TCPIP_CMD_SVR_DBG("Signal interruption detected. Continuing..");
-                continue;
-            }
+    ar_mem_cpy(conn->buffer->message.buffer, ATS_HEADER_LENGTH, conn->header, ATS_HEADER_LENGTH);
 
-            TCPIP_CMD_SVR_ERR("Receive failed with error: %d", AR_SOCKET_LAST_ERROR);
-            ar_socket_close(accept_socket);
-            return AR_EFAILED;
-        }
-    }
+    if (conn->msg_bytes == conn->msg_len)
+        return process_message(conn);
 
-    return status;
+    return set_state(conn, TCPIP_CMD_CONN_STATE_RECV_BODY);
 }
 
-int32_t TcpipCmdServer::process_message(
-    char_t* msg_buffer, uint32_t msg_buffer_size, uint32_t msg_length,
-    char_t** out_buf, uint32_t out_buf_len, uint32_t& resp_len)
+int32_t TcpipCmdServer::process_message(tcpip_cmd_connection_t *conn)
 {
-    __UNREFERENCED_PARAM(out_buf_len);
     int32_t status = AR_EOK;
-    //uint32_t recvlen_ptr = 0;
+    char_t *request = conn->buffer->message.buffer;
+    uint8_t *resp = NULL;
+    uint32_t resp_len = 0;
     uint32_t svc_cmd_id = 0;
-    uint32_t data_length = 11;//TODO: Why is this hardcoded to 11?
-    char svc_id_str[ATS_SEVICE_ID_STR_LEN] = { 0 };
-    if (msg_length > msg_buffer_size)
-    {
-        /* We reject messages that are larger that what we can store in our message buffer */
-        tcpip_cmd_server_create_error_resp(svc_cmd_id, AR_ENEEDMORE,
-            *out_buf, out_buf_len, resp_len);
-        goto process_message_end;
-    }
 
-    svc_cmd_id = 0;
     ar_mem_cpy(&svc_cmd_id, ATS_SERVICE_COMMAND_ID_LENGTH,
-        msg_buffer + ATS_SERVICE_COMMAND_ID_POSITION, ATS_SERVICE_COMMAND_ID_LENGTH);
+        conn->header + ATS_SERVICE_COMMAND_ID_POSITION, ATS_SERVICE_COMMAND_ID_LENGTH);
 
-    tcpip_cmd_server_get_ats_command_length(msg_buffer, msg_length, &data_length);
-    ATS_SERVICE_ID_STR(svc_id_str, ATS_SEVICE_ID_STR_LEN, svc_cmd_id);
-    TCPIP_CMD_SVR_DBG("Command[%s-%d]: Request data length is %d bytes", svc_id_str, ATS_GET_COMMAND_ID(svc_cmd_id), data_length);
+    if (conn->discard)
+    {
+        tcpip_cmd_server_create_error_resp(svc_cmd_id, AR_ENEEDMORE,
+            error_response, sizeof(error_response), resp_len);
+        return send_response(conn, error_response, resp_len);
+    }
 
     //Handle server commands like RESIZE_BUFFER, etc..
     if (ATS_ONLINE_SERVICE_ID == ATS_GET_SERVICE_ID(svc_cmd_id))
     {
-        status = execute_server_command(svc_cmd_id, msg_length);
+        status = execute_server_command(svc_cmd_id, request, conn->msg_len);
 
         if (AR_FAILED(status))
         {
             tcpip_cmd_server_create_error_resp(svc_cmd_id, status,
-                *out_buf, out_buf_len, resp_len);
-            status = AR_EOK;
-            goto process_message_end;
+                error_response, sizeof(error_response), resp_len);
+            return send_response(conn, error_response, resp_len);
         }
     }
 
-    //passing received data and blank output buffer to ats upcall
-    execute_command((uint8_t *)message_buffer.buffer, (uint32_t)msg_length,
-        (uint8_t**)out_buf, &resp_len);
+    /* Passing received data to ats upcall. The response is written to the ATS
+     * buffer, or streamed to the client through send_stream while the command
+     * executes in which case resp_len is 0 */
+    executing_conn = conn;
+    execute_command((uint8_t *)request, conn->msg_len, &resp, &resp_len);
+    executing_conn = NULL;
 
-    //resp_len = recvlen_ptr;
-
-process_message_end:
     TCPIP_CMD_SVR_DBG("Outbound message of length %d bytes", resp_len);
 
-    return status;
-}
-
-int32_t TcpipCmdServer::send_message(char_t* buf, uint32_t buf_len, uint32_t msg_len)
-{
-    int32_t status = AR_EOK;
-    int32_t bytes_sent = 0;
-    uint32_t data_length = 0;
-    uint32_t svc_cmd_id = 0;
-    char svc_id_str[ATS_SEVICE_ID_STR_LEN] = { 0 };
-
-    if (buf == NULL)
+    if (NULL == resp)
     {
         TCPIP_CMD_SVR_ERR("Error[%d]: The send buffer is null", AR_EBADPARAM);
         return AR_EBADPARAM;
     }
 
-    if (msg_len > buf_len)
-    {
-        TCPIP_CMD_SVR_ERR("Error[%d]: The message length %d bytes is >"
-            " the send buffer length %d", AR_EBADPARAM, msg_len, buf_len);
-        return AR_EBADPARAM;
-    }
-
-    tcpip_cmd_server_get_ats_command_length(buf, msg_len, &data_length);
+    return send_response(conn, (char_t*)resp, resp_len);
+}
 
-    ar_mem_cpy(&svc_cmd_id, ATS_SERVICE_COMMAND_ID_LENGTH,
-        buf + ATS_SERVICE_COMMAND_ID_POSITION, ATS_SERVICE_COMMAND_ID_LENGTH);
-    ATS_SERVICE_ID_STR(svc_id_str, ATS_SEVICE_ID_STR_LEN, svc_cmd_id);
-    TCPIP_CMD_SVR_DBG("Command[%s-%d]: Sending response of %d bytes", svc_id_str, ATS_GET_COMMAND_ID(svc_cmd_id), data_length);
+int32_t TcpipCmdServer::send_response(tcpip_cmd_connection_t *conn,
+    const char_t *resp, uint32_t resp_len)
+{
+    int32_t status = AR_EOK;
+    int32_t bytes_sent = 0;
+    uint32_t total_sent = 0;
 
     //Send response to client
-    status = ar_socket_send(accept_socket, buf, msg_len, 0, &bytes_sent);
-    if (AR_FAILED(status))
+    while (total_sent < resp_len)
     {
-        TCPIP_CMD_SVR_ERR("Unable to send message. Socket error: %d", AR_SOCKET_LAST_ERROR);
-        ar_socket_close(accept_socket);
+        bytes_sent = (int32_t)send(conn->socket, resp + total_sent,
+            resp_len - total_sent, MSG_NOSIGNAL);
+        if (bytes_sent < 0)
+        {
+            if (AR_SOCKET_LAST_ERROR == EINTR) continue;
+            if (AR_SOCKET_LAST_ERROR == EAGAIN ||
+                AR_SOCKET_LAST_ERROR == EWOULDBLOCK) break;
+
+            TCPIP_CMD_SVR_ERR("Unable to send message. Socket error: %d", AR_SOCKET_LAST_ERROR);
+            return AR_EFAILED;
+        }
+
+        total_sent += bytes_sent;
     }
-    else
+
+    if (total_sent == resp_len)
     {
         TCPIP_CMD_SVR_DBG("Message sent");
+
+        conn->header_bytes = 0;
+        status = set_state(conn, TCPIP_CMD_CONN_STATE_RECV_HEADER);
+        release_pool_buffer(conn);
+        return status;
     }
 
-    return status;
+    /* The socket is full. The rest of the response is moved to the pool
+     * buffer since the next command overwrites the ATS response buffer */
+    status = reserve_pool_buffer(conn, resp_len - total_sent);
+    if (AR_FAILED(status))
+        return status;
+
+    conn->send_len = resp_len - total_sent;
+    conn->send_bytes = 0;
+    ar_mem_cpy(conn->buffer->message.buffer, conn->send_len,
+        resp + total_sent, conn->send_len);
+
+    TCPIP_CMD_SVR_DBG("Queued %d bytes of the response", conn->send_len);
+    return set_state(conn, TCPIP_CMD_CONN_STATE_SEND);
 }
 
-int32_t TcpipCmdServer::execute_server_command(uint32_t service_cmd_id, uint32_t message_length)
+int32_t TcpipCmdServer::execute_server_command(uint32_t service_cmd_id,
+    const char_t *message, uint32_t message_length)
 {
     switch (service_cmd_id)
     {
     case ATS_CMD_ONC_SET_MAX_BUFFER_LENGTH:
     {
         uint32_t new_buffer_size = 0;
-        uint32_t data_length = 0;
-        uint32_t offset = 0;
         struct ar_heap_info_t heap_inf =
         {
             AR_HEAP_ALIGN_DEFAULT,
@@ -814,43 +1146,37 @@ int32_t TcpipCmdServer::execute_server_command(uint32_t service_cmd_id, uint32_t
             AR_HEAP_TAG_DEFAULT
         };
 
-        if (message_length < sizeof(uint32_t))
+        if (message_length < ATS_ACDB_BUFFER_POSITION + sizeof(uint32_t))
         {
             return AR_ENEEDMORE;
         }
 
-        ar_mem_cpy(&data_length, sizeof(uint32_t),
-            this->message_buffer.buffer + ATS_DATA_LENGTH_POSITION, sizeof(uint32_t));
         ar_mem_cpy(&new_buffer_size, sizeof(uint32_t),
-            this->message_buffer.buffer + ATS_ACDB_BUFFER_POSITION, sizeof(uint32_t));
+            message + ATS_ACDB_BUFFER_POSITION, sizeof(uint32_t));
 
         //The new buffer size needs to be between the required range to resize the message buffer:
         //range: AGWS_RECV_BUF_SIZE * 4 < new buffer size < GWS_MAX_BUFFER_SIZE
         //Largest buffer size is 2mb the GWS_MAX_BUFFER_SIZE
         //Smalleset buffer size is 4 * 1024 the recieve buffer size
-        if ((new_buffer_size > this->message_buffer.buffer_size && new_buffer_size < TCPIP_CMD_SERVER_MAX_MSG_BUFFER_SIZE) ||
-            (new_buffer_size < this->message_buffer.buffer_size && new_buffer_size > TCPIP_CMD_SERVER_MIN_MSG_BUFFER_SIZE)
+        if ((new_buffer_size > this->max_message_size && new_buffer_size < TCPIP_CMD_SERVER_MAX_MSG_BUFFER_SIZE) ||
+            (new_buffer_size < this->max_message_size && new_buffer_size > TCPIP_CMD_SERVER_MIN_MSG_BUFFER_SIZE)
             )
         {
-            ar_heap_free(message_buffer.buffer, &heap_inf);
+            max_message_size = new_buffer_size;
 
-            message_buffer.buffer_size = new_buffer_size;
-            message_buffer.buffer = (char_t*)ar_heap_malloc(message_buffer.buffer_size, &heap_inf);
-            if (NULL == message_buffer.buffer)
+            /* Free the idle pool buffers that are larger than the new limit.
+             * Buffers in use are kept until their connection is done with them */
+            for (uint32_t i = 0; i < TCPIP_CMD_SERVER_BUFFER_POOL_COUNT; i++)
             {
-                TCPIP_CMD_SVR_ERR("Error[%d]: Failed to resize gateway message buffer", AR_ENOMEMORY);
-                return AR_ENOMEMORY;
-            }
+                buffer_t *pool_message = &buffer_pool[i].message;
 
-            ar_mem_set(message_buffer.buffer, 0, message_buffer.buffer_size);
+                if (buffer_pool[i].in_use || pool_message->buffer_size <= max_message_size)
+                    continue;
 
-            /* Write the ATS command back to the resized message buffer so that the ATS Command
-             * layer can resize its buffer.*/
-            ar_mem_cpy(message_buffer.buffer, sizeof(uint32_t), &service_cmd_id, sizeof(uint32_t));
-            offset += sizeof(uint32_t);
-            ar_mem_cpy(message_buffer.buffer + offset, sizeof(uint32_t), &data_length, sizeof(uint32_t));
-            offset += sizeof(uint32_t);
-            ar_mem_cpy(message_buffer.buffer + offset, sizeof(uint32_t), &new_buffer_size, sizeof(uint32_t));
+                ar_heap_free(pool_message->buffer, &heap_inf);
+                pool_message->buffer = NULL;
+                pool_message->buffer_size = 0;
+            }
         }
     }
     break;
@@ -21,7 +21,10 @@
 #ifdef ATS_TRANSPORT_TCPIP
 #ifdef ATS_DATA_LOGGING
 
+#include <sys/socket.h>
+#include <sys/uio.h>
 #include "tcpip_dls_server.h"
+#include "ar_osal_mem_op.h"
 
 #define TCPIP_THREAD_PRIORITY_HIGH 0
 #define TCPIP_THREAD_PRIORITY_LOW 1
@@ -197,10 +200,18 @@ void* TcpipDlsServer::connect_routine(void* args)
     return 0;
 }
 
-int32_t TcpipDlsServer::send_dls_log_buffers(const char_t* buffer, uint32_t buffer_size)
+int32_t TcpipDlsServer::send_dls_log_buffers(const ats_transport_segment_t* segments, uint32_t segment_count)
 {
-    int32_t status = AR_EOK;
-    int32_t bytes_sent = 0;
+    struct iovec iov[TCPIP_DLS_SERVER_MAX_IOV_COUNT];
+    struct msghdr msg;
+    uint32_t segment_index = 0;
+    uint32_t iov_count = 0;
+    uint32_t iov_index = 0;
+    uint32_t total_bytes_sent = 0;
+    ssize_t bytes_sent = 0;
+
+    if (NULL == segments)
+        return AR_EBADPARAM;
 
     if(ar_socket_is_invalid(accept_socket))
     {
@@ -208,14 +219,58 @@ int32_t TcpipDlsServer::send_dls_log_buffers(const char_t* buffer, uint32_t buff
         return AR_EFAILED;
     }
 
-    TCPIP_DLS_DBG("Preparing to send %d bytes", buffer_size);
-    status = ar_socket_send(accept_socket, buffer, buffer_size, 0, &bytes_sent);
-    if (AR_SUCCEEDED(status) && bytes_sent >= 0)
+    ar_mem_set(&msg, 0, sizeof(msg));
+
+    /* Send the segments in batches of TCPIP_DLS_SERVER_MAX_IOV_COUNT. The log
+     * data is read straight from the caller's buffers, so nothing is copied */
+    while (segment_index < segment_count)
     {
-        TCPIP_DLS_DBG("Successfully Sent %d bytes:", bytes_sent);
-        return status;
+        iov_count = 0;
+        iov_index = 0;
+        while (segment_index < segment_count && iov_count < TCPIP_DLS_SERVER_MAX_IOV_COUNT)
+        {
+            if (0 != segments[segment_index].size)
+            {
+                iov[iov_count].iov_base = (void*)segments[segment_index].buf;
+                iov[iov_count].iov_len = segments[segment_index].size;
+                iov_count++;
+            }
+            segment_index++;
+        }
+
+        while (iov_index < iov_count)
+        {
+            msg.msg_iov = &iov[iov_index];
+            msg.msg_iovlen = iov_count - iov_index;
+
+            bytes_sent = sendmsg(accept_socket, &msg, MSG_NOSIGNAL);
+            if (bytes_sent < 0)
+            {
+                if (AR_SOCKET_LAST_ERROR == EINTR) continue;
+
+                TCPIP_DLS_ERR("Unable to send log data. Socket error: %d", AR_SOCKET_LAST_ERROR);
+                return AR_EFAILED;
+            }
+
+            total_bytes_sent += (uint32_t)bytes_sent;
+
+            /* Skip the segments that were fully written and resume from
+             * the middle of a partially written segment */
+            while (iov_index < iov_count && (size_t)bytes_sent >= iov[iov_index].iov_len)
+            {
+                bytes_sent -= (ssize_t)iov[iov_index].iov_len;
+                iov_index++;
+            }
+
+            if (iov_index < iov_count)
+            {
+                iov[iov_index].iov_base = (uint8_t*)iov[iov_index].iov_base + bytes_sent;
+                iov[iov_index].iov_len -= (size_t)bytes_sent;
+            }
+        }
     }
 
+    TCPIP_DLS_DBG("Successfully Sent %d bytes:", total_bytes_sent);
     return AR_EOK;
 }
 
@@ -40,7 +40,8 @@
 
 int32_t AcdbCmdGetGraph(
     AcdbGraphKeyVector *gkv, AcdbGetGraphRsp *getGraphRsp,
-    uint32_t rsp_struct_size);
+    uint32_t rsp_struct_size, AcdbAllocCallback alloc_cb,
+    void *alloc_context);
 
 int32_t AcdbCmdGetSubgraphData(
     AcdbSgIdGraphKeyVector *pInput,
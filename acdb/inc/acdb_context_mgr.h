@@ -19,6 +19,7 @@
 
 #include "ar_osal_types.h"
 #include "ar_osal_mutex.h"
+#include "ar_osal_rwlock.h"
 #include "acdb_common.h"
 
 /* ---------------------------------------------------------------------------
@@ -33,9 +34,15 @@
 /**< The total number of databases being managed  */
 #define ACDB_CTX_MAN_DATABASE_COUNT acdb_ctx_man_get_database_count()
 
-/**< The lock for incoming ACDB client commands.(e.g ATS online
-commands from QACT and acdb_ioctl commands from GSL */
-#define ACDB_CTX_MAN_CLIENT_CMD_LOCK acdb_ctx_man_get_client_lock()
+/**< Acquires the lock for incoming ACDB client commands.(e.g ATS online
+commands from QACT and acdb_ioctl commands from GSL). Commands that only
+read the databases take the lock shared, commands that modify calibration,
+delta data or the set of databases take it exclusively */
+#define ACDB_CTX_MAN_CLIENT_CMD_LOCK(exclusive) \
+acdb_ctx_man_client_cmd_lock(exclusive)
+
+/**< Releases the lock taken by ACDB_CTX_MAN_CLIENT_CMD_LOCK */
+#define ACDB_CTX_MAN_CLIENT_CMD_UNLOCK() acdb_ctx_man_client_cmd_unlock()
 
 #define ACDB_MAGIC_WORD 0x00ACDB00
 #define ACDB_HANDLE_MASK 0xF
@@ -60,6 +67,9 @@ typedef void *acdb_file_man_handle_t;
 /**< A handle to a delta file manager object */
 typedef void *acdb_delta_file_man_handle_t;
 
+/**< A handle to a graph key vector index object */
+typedef void *acdb_gkv_index_handle_t;
+
 /**< A context handle that holds references to the file manager,
 delta file manager, and heap objects for a database */
 typedef struct acdb_context_handle_t acdb_context_handle_t;
@@ -72,6 +82,9 @@ struct acdb_context_handle_t {
 	acdb_delta_file_man_handle_t delta_manager_handle;
 	/**< A handle to heap object*/
 	acdb_heap_handle_t heap_handle;
+	/**< A handle to the graph key vector index. NULL when the index
+	is disabled or could not be built */
+	acdb_gkv_index_handle_t gkv_index_handle;
 };
 
 typedef enum acdb_ctx_manager_command_t
@@ -121,12 +134,22 @@ acdb_context_handle_t *acdb_ctx_man_get_active_handle(void);
 
 /**
 * \brief
-*		Retrieves the active context handle
+*		Acquires the client command lock. The active context handle is
+*		kept per thread, so any number of threads can run commands under
+*		the shared lock. A thread that already holds the lock (e.g an ATS
+*		command that calls acdb_ioctl) does not acquire it again.
 *
-* \return a pointer to the active context handle, or
-*		  NULL if the context manager is not initialized
+* \param[in] exclusive: TRUE to lock out all other clients, FALSE to
+*               share the lock with other read-only commands
+*/
+void acdb_ctx_man_client_cmd_lock(bool_t exclusive);
+
+/**
+* \brief
+*		Releases the client command lock acquired by
+*		acdb_ctx_man_client_cmd_lock
 */
-ar_osal_mutex_t acdb_ctx_man_get_client_lock(void);
+void acdb_ctx_man_client_cmd_unlock(void);
 
 /**
 * \brief
@@ -136,6 +159,21 @@ ar_osal_mutex_t acdb_ctx_man_get_client_lock(void);
 */
 uint32_t acdb_ctx_man_get_database_count(void);
 
+/**
+* \brief
+*		Increments the data version. Called after any command that adds,
+*		changes or removes calibration data in the heap or the databases
+*/
+void acdb_ctx_man_update_data_version(void);
+
+/**
+* \brief
+*		Retrieves the data version
+*
+* \return the number of calibration data writes since startup
+*/
+uint32_t acdb_ctx_man_get_data_version(void);
+
 /**
 * \brief
 *		The context manager ioctl used to execute the commands
@@ -26,9 +26,9 @@
  * Global Definitions
  *--------------------------------------------------------------------------- */
 
-extern uint32_t glb_buf_1[GLB_BUF_1_LENGTH];
-extern uint32_t glb_buf_2[GLB_BUF_2_LENGTH];
-extern uint32_t glb_buf_3[GLB_BUF_3_LENGTH];
+extern ACDB_THREAD_LOCAL uint32_t glb_buf_1[GLB_BUF_1_LENGTH];
+extern ACDB_THREAD_LOCAL uint32_t glb_buf_2[GLB_BUF_2_LENGTH];
+extern ACDB_THREAD_LOCAL uint32_t glb_buf_3[GLB_BUF_3_LENGTH];
 
 /* ---------------------------------------------------------------------------
 * Type Declarations
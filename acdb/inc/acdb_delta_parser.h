@@ -28,9 +28,12 @@
  *--------------------------------------------------------------------------- */
 
 #define ACDB_DELTA_FILE_VERSION_MAJOR	0x00000001
-#define ACDB_DELTA_FILE_VERSION_MINOR	0x00000000
+#define ACDB_DELTA_FILE_VERSION_MINOR	0x00000001
 #define ACDB_DELTA_FILE_REVISION        0x00000000
 
+/**< Tag at the start of every journal record ('DJRN') */
+#define ACDB_DELTA_JOURNAL_RECORD_TAG   0x4E524A44
+
 /* ---------------------------------------------------------------------------
  * Type Declarations
  *--------------------------------------------------------------------------- */
@@ -81,12 +84,37 @@ struct _acdb_delta_file_header_t {
 #include "acdb_end_pack.h"
 ;
 
+/**< Precedes each map appended to the journal that follows the snapshot
+ * of maps at the start of a v1.1 delta file. A record that is cut short
+ * or fails its checksum marks the end of the journal. */
+typedef struct _acdb_delta_journal_record_header_t AcdbDeltaJournalRecordHeader;
+#include "acdb_begin_pack.h"
+struct _acdb_delta_journal_record_header_t {
+	/**< Always ACDB_DELTA_JOURNAL_RECORD_TAG */
+	uint32_t tag;
+	/**< Size of the map that follows the header */
+	uint32_t record_size;
+	/**< FNV-1a checksum of the map */
+	uint32_t checksum;
+}
+#include "acdb_end_pack.h"
+;
+
 /* ---------------------------------------------------------------------------
  * Function Declarations and Documentation
  *--------------------------------------------------------------------------- */
 
 int32_t acdb_delta_parser_is_file_valid(ar_fhandle fhandle, uint32_t file_size);
 
+int32_t acdb_delta_parser_read_file_header(ar_fhandle fhandle, AcdbDeltaFileHeader *file_header);
+
+/**
+* \brief
+*		Returns the size of the header and the snapshot of maps at the start
+*		of the delta file. Journal records start at this offset.
+*/
+uint32_t acdb_delta_parser_get_snapshot_size(AcdbDeltaFileHeader *file_header);
+
 int32_t acdb_delta_parser_get_file_version(ar_fhandle fhandle, uint32_t file_size, acdb_delta_file_version_t* delta_finfo);
 
 int32_t acdb_delta_parser_read_map(ar_fhandle fhandle, uint32_t *offset, acdb_delta_data_map_t *map);
@@ -95,4 +123,32 @@ int32_t acdb_delta_parser_write_file_header(ar_fhandle fhandle, acdb_delta_file_
 
 int32_t acdb_delta_parser_write_map(ar_fhandle fhandle, acdb_delta_data_map_t *map);
 
+/**
+* \brief
+*		Writes a map as a single journal record at the current file position.
+*
+* \param[in] fhandle: Handle to the delta file
+* \param[in] map: The map to write
+* \param[out] record_size: Number of bytes written including the header
+*
+* \return AR_EOK on success, non-zero on failure
+*/
+int32_t acdb_delta_parser_write_journal_record(ar_fhandle fhandle, acdb_delta_data_map_t *map, uint32_t *record_size);
+
+/**
+* \brief
+*		Reads the journal record at offset into map.
+*
+* \param[in] fhandle: Handle to the delta file
+* \param[in] file_size: Size of the delta file
+* \param[in/out] offset: Offset of the record. Moved past the record on success
+* \param[out] map: The map read from the record
+*
+* \return
+*		AR_EOK on success
+*		AR_EIODATA if the record is incomplete or fails its checksum
+*		Other non-zero values on failure
+*/
+int32_t acdb_delta_parser_read_journal_record(ar_fhandle fhandle, uint32_t file_size, uint32_t *offset, acdb_delta_data_map_t *map);
+
 #endif /* __ACDB_DELTA_PARSER_H__ */
@@ -22,6 +22,7 @@
 #include "acdb_utility.h"
 #include "acdb_context_mgr.h"
 #include "acdb_types.h"
+#include "acdb_parser.h"
 
 /* ---------------------------------------------------------------------------
  * Preprocessor Definitions and Constants
@@ -66,7 +67,10 @@ enum AcdbFileManCmd {
     /**< Sets the writable path for the specified database */
     ACDB_FILE_MAN_SET_WRITABLE_PATH,
     /**< Gets the writable path from the specified database */
-    ACDB_FILE_MAN_GET_WRITABLE_PATH
+    ACDB_FILE_MAN_GET_WRITABLE_PATH,
+    /**< Passes file data for the specified database file (*.qwsp or *.acdb)
+     * to a write callback instead of copying it into one response buffer */
+    ACDB_FILE_MAN_STREAM_DATABASE_FILE_SET
 };
 
 typedef enum _acdb_file_type_t AcdbFileType;
@@ -90,6 +94,8 @@ struct _acdb_file_man_file_info_t{
     uint32_t file_index;
     /**< The in-memory file buffer */
     acdb_buffer_t file;
+    /**< The chunks in the file sorted by chunk id */
+    acdb_chunk_directory_t chunk_directory;
 };
 
 typedef struct acdb_file_man_database_files_t
@@ -136,12 +142,36 @@ struct _acdb_file_man_rsp_t
 	uint8_t *buf;
 };
 
+/**< Receives file data for a ACDB_FILE_MAN_STREAM_DATABASE_FILE_SET request.
+ * total_size is the number of bytes the request produces across all calls.
+ * The callback is called at least once, with size 0 if there is no data */
+typedef int32_t(*AcdbFileManWriteCallback)(void *context,
+    uint32_t total_size, const uint8_t *buf, uint32_t size);
+
+typedef struct _acdb_file_man_stream_t AcdbFileManStream;
+struct _acdb_file_man_stream_t
+{
+    /*Called with each piece of file data*/
+    AcdbFileManWriteCallback write;
+    /*Passed to the write callback*/
+    void *context;
+    /*Size of the scratch buffer*/
+    uint32_t size;
+    /*Scratch buffer used to read files that are not cached in memory*/
+    uint8_t *buf;
+    /*Number of bytes passed to the write callback*/
+    uint32_t bytes_streamed;
+};
+
 /* ---------------------------------------------------------------------------
 * Function Declarations and Documentation
 *--------------------------------------------------------------------------- */
 
 int32_t acdb_fm_get_db_chunks(uint32_t count, ...);
 
+int32_t acdb_get_db_chunk(acdb_file_man_handle_t handle,
+    uint32_t chunk_id, uint32_t* chunk_offset, uint32_t* chunk_size);
+
 int32_t acdb_fm_read_db_mem(acdb_file_man_handle_t handle,
     void* buffer, size_t read_size, uint32_t* offset);
 
@@ -0,0 +1,95 @@
+#ifndef __ACDB_GKV_INDEX_H__
+#define __ACDB_GKV_INDEX_H__
+/**
+*=============================================================================
+* \file acdb_gkv_index.h
+*
+* \brief
+*		An in-memory hash index over the GKV Key Table (GKVT) and GKV
+*		Lookup Table (GKVL) chunks of a database. The index is built once
+*		when a database is added and replaces the table walk and binary
+*		search performed for every graph key vector lookup.
+*
+*		Defining ACDB_GKV_INDEX_DISABLE at build time disables the index.
+*		Lookups then fall back to searching the database tables.
+*
+* \copyright
+*  Copyright (c) Qualcomm Innovation Center, Inc. All rights reserved.
+*  SPDX-License-Identifier: BSD-3-Clause
+*
+*=============================================================================
+*/
+
+/* ---------------------------------------------------------------------------
+* Include Files
+*--------------------------------------------------------------------------- */
+#include "acdb.h"
+#include "acdb_types.h"
+#include "acdb_context_mgr.h"
+
+/* ---------------------------------------------------------------------------
+* Function Declarations and Documentation
+*--------------------------------------------------------------------------- */
+
+/**
+* \brief
+*		Builds the GKV index for a database. The index references the
+*		key ids and values stored in the database cache, so it must be
+*		destroyed before the database is unloaded.
+*
+* \param[in] fm_handle: File manager handle of the database to index
+* \param[out] index_handle: The newly created index
+*
+* \return
+*		AR_EOK on success
+*		AR_EUNSUPPORTED if the index is disabled
+*		non-zero otherwise
+*/
+int32_t acdb_gkv_index_create(acdb_file_man_handle_t fm_handle,
+    acdb_gkv_index_handle_t *index_handle);
+
+/**
+* \brief
+*		Frees all resources held by a GKV index
+*
+* \param[in] index_handle: The index to destroy. NULL is ignored
+*/
+void acdb_gkv_index_destroy(acdb_gkv_index_handle_t index_handle);
+
+/**
+* \brief
+*		Look up the key ids of a GKV and get back the offset to the
+*		key value lookup table. Equivalent to searching the GKV Key Table.
+*
+* \depends The input gkv must be sorted
+*
+* \param[in] index_handle: The database's GKV index
+* \param[in] gkv: The GKV to search for
+* \param[out] gkv_lut_offset: The offset of the input GKV's value lookup table
+*
+* \return AR_EOK on success, AR_ENOTEXIST if the key ids are not found
+*/
+int32_t acdb_gkv_index_find_lut_offset(acdb_gkv_index_handle_t index_handle,
+    AcdbGraphKeyVector *gkv, uint32_t *gkv_lut_offset);
+
+/**
+* \brief
+*		Look up the key ids and values of a GKV and get back the offsets to
+*		the subgraph list and subgraph property data list. Equivalent to
+*		searching the GKV Lookup Table at gkv_lut_offset.
+*
+* \depends The input gkv must be sorted
+*
+* \param[in] index_handle: The database's GKV index
+* \param[in] gkv: The GKV to search for
+* \param[in] gkv_lut_offset: The lookup table offset the GKV must belong to
+* \param[out] graph_info: Offset to the subgraph sequence list
+*               and subgraph property data list
+*
+* \return AR_EOK on success, AR_ENOTEXIST if the GKV is not found
+*/
+int32_t acdb_gkv_index_find_graph(acdb_gkv_index_handle_t index_handle,
+    AcdbGraphKeyVector *gkv, uint32_t gkv_lut_offset,
+    acdb_graph_info_t *graph_info);
+
+#endif /* __ACDB_GKV_INDEX_H__ */
@@ -35,6 +35,8 @@ enum AcdbHeapCmd {
 	ACDB_HEAP_CMD_GET_MAP_LIST,
 	ACDB_HEAP_CMD_REMOVE_MAP,
 	ACDB_HEAP_CMD_GET_HEAP_INFO,
+	ACDB_HEAP_CMD_SET_MAP_DIRTY,
+	ACDB_HEAP_CMD_GET_DIRTY_MAP_LIST,
 };
 
 typedef struct _acdb_tree_node_t AcdbTreeNode;
@@ -51,12 +53,15 @@ struct _acdb_tree_node_t
 typedef struct _kv_length_bin_t KVSubgraphMapBin;
 struct _kv_length_bin_t
 {
-	/**< The length of the key vector string */
-	uint32_t str_key_vector_size;
-	/**< The key vector string */
-	char_t *str_key_vector;
+	/**< Hash of the key vector. Bins are ordered by hash first */
+	uint64_t kv_hash;
+	/**< The key vector of the map. Points into map->key_vector_data */
+	AcdbGraphKeyVector key_vector;
     /**< Maps a keyvector to a subgraph containing calibration data */
     acdb_delta_data_map_t *map;
+    /**< Set when the map changes and cleared once the map is returned
+     * to be saved to the delta file */
+    bool_t is_dirty;
 };
 
 typedef struct acdb_heap_map_handle_info_t
@@ -129,7 +129,9 @@ int32_t AcdbInitUtilOpenDeltaFile(
 
 /**
 *	\brief
-*		Loads the acdb file from the file handle as a read only buffer
+*		Loads the acdb file from the file handle as a read only buffer.
+*		The file is mapped when ar_fmap is supported, otherwise it is
+*		read into a heap buffer
 *
 *   \param[in] fname: The acdb file name
 *	\param[in] fhandle: The acdb file handle
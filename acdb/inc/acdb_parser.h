@@ -242,6 +242,26 @@ typedef struct acdb_header_v1_t
     acdb_oem_info_t* oem_info;
 }acdb_header_v1_t;
 
+/**< The location of a chunk within a database file */
+typedef struct acdb_chunk_entry_t
+{
+    /**< The chunk identifier */
+    uint32_t chunk_id;
+    /**< Offset of the chunk data from the start of the file */
+    uint32_t chunk_offset;
+    /**< The size of the chunk data in bytes */
+    uint32_t chunk_size;
+}acdb_chunk_entry_t;
+
+/**< A directory of the chunks in a database file sorted by chunk id */
+typedef struct acdb_chunk_directory_t
+{
+    /**< The number of chunks in the directory */
+    uint32_t num_chunks;
+    /**< The chunks sorted by chunk id */
+    acdb_chunk_entry_t *chunks;
+}acdb_chunk_directory_t;
+
 #ifdef _MSC_VER
 #pragma warning(pop)
 #endif
@@ -255,6 +275,44 @@ int32_t acdb_parser_get_chunk(
 
 int32_t acdb_parser_validate_file(acdb_buffer_t* in_mem_file);
 
+/**
+* \brief
+*		Walks the chunk headers of an in-memory database file once and builds
+*		a directory of chunks sorted by chunk id. If a chunk id appears more
+*		than once, the first occurrence is kept to match
+*		acdb_parser_get_chunk(..).
+*
+* \param[in] in_mem_file: The in-memory database file
+* \param[out] directory: The chunk directory. Free it with
+*               acdb_parser_free_chunk_directory(..)
+*
+* \return AR_EOK on success, non-zero otherwise
+*/
+int32_t acdb_parser_build_chunk_directory(
+    acdb_buffer_t* in_mem_file, acdb_chunk_directory_t* directory);
+
+/**
+* \brief
+*		Frees the memory held by a chunk directory
+*
+* \param[in/out] directory: The chunk directory to free
+*/
+void acdb_parser_free_chunk_directory(acdb_chunk_directory_t* directory);
+
+/**
+* \brief
+*		Binary searches a chunk directory for a chunk
+*
+* \param[in] directory: The chunk directory to search
+* \param[in] chunk_id: The chunk to search for
+* \param[out] chunk_offset: Offset of the chunk data in the file
+* \param[out] chunk_size: Size of the chunk data
+*
+* \return AR_EOK on success, AR_ENOTEXIST if the chunk is not found
+*/
+int32_t acdb_parser_find_chunk(acdb_chunk_directory_t* directory,
+    uint32_t chunk_id, uint32_t *chunk_offset, uint32_t *chunk_size);
+
 int32_t acdb_parser_get_acdb_header_v1(
     acdb_buffer_t* in_mem_file, acdb_header_v1_t* header);
 
@@ -0,0 +1,59 @@
+#ifndef __ACDB_SORT_H__
+#define __ACDB_SORT_H__
+/**
+*=============================================================================
+* \file acdb_sort.h
+*
+* \brief
+*		Sorting routines for the arrays of key vectors, subgraph ids and
+*		lookup table entries that ACDB SW sorts before searching.
+*
+*		Arrays of up to ACDB_SORT_NETWORK_MAX_ELEMS elements (most key
+*		vectors) are sorted with a sorting network and do not allocate
+*		memory. Larger arrays are sorted with an introsort.
+*
+* \copyright
+*  Copyright (c) Qualcomm Innovation Center, Inc. All rights reserved.
+*  SPDX-License-Identifier: BSD-3-Clause
+*
+*=============================================================================
+*/
+
+/* ---------------------------------------------------------------------------
+* Include Files
+*--------------------------------------------------------------------------- */
+#include "ar_osal_types.h"
+
+/* ---------------------------------------------------------------------------
+* Preprocessor Definitions and Constants
+*--------------------------------------------------------------------------- */
+
+/**< Largest array that is sorted using a sorting network */
+#define ACDB_SORT_NETWORK_MAX_ELEMS 8
+
+/* ---------------------------------------------------------------------------
+* Function Declarations and Documentation
+*--------------------------------------------------------------------------- */
+
+/**
+* \brief
+*		Sorts an array of elements in ascending order of one uint32_t
+*		member of the element. The sort is stable, so elements with equal
+*		keys keep their relative order.
+*
+* \param[in/out] p_array: The array to sort
+* \param[in] sz_arr: Byte size of p_array
+* \param[in] sz_elem: Byte size of an element. Must be a multiple of
+*               sizeof(uint32_t)
+* \param[in] key_elem_pos: Position of the uint32_t sorting key within
+*               the element (e.g 0, 1, 2, etc...)
+*
+* \return
+*		AR_EOK on success
+*		AR_EBADPARAM if the parameters are invalid
+*		AR_ENOMEMORY if scratch memory for a large array cannot be allocated
+*/
+int32_t acdb_sort(void *p_array, size_t sz_arr, size_t sz_elem,
+    uint32_t key_elem_pos);
+
+#endif /* __ACDB_SORT_H__ */
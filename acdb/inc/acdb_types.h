@@ -26,6 +26,14 @@
 /**< The max character length of a string */
 #define ACDB_MAX_PATH_LENGTH 256
 
+/**< Storage class of the global scratch buffers. Each thread gets its own
+copy so that read-only acdb_ioctl commands can run in parallel */
+#if defined(_WIN32) || defined(_WIN64)
+#define ACDB_THREAD_LOCAL __declspec(thread)
+#else
+#define ACDB_THREAD_LOCAL __thread
+#endif
+
  /**< The number of elements in Global Buffer 1 */
 #define GLB_BUF_1_LENGTH 2500
 
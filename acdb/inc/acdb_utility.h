@@ -116,7 +116,7 @@ int32_t AcdbDataBinarySearch2(void *p_array, size_t sz_arr, void *p_cmd,
 
 /**
 * \brief AcdbSort
-*		Performs insertion sort on an array of basic types
+*		Sorts an array of uint32_t values in ascending order. See acdb_sort
 * \param [in/out] p_array: array to be sorted
 * \param [in] sz_arr: size of p_array
 */
@@ -124,7 +124,8 @@ void AcdbSort(void* p_array, uint32_t sz_arr);
 
 /**
 * \brief AcdbSort2
-*		Performs insertion sort on an array of basic/user defined types
+*		Stable sort of an array of basic/user defined types by one uint32_t
+*		member. See acdb_sort
 * \param [in] sz_arr: byte size of p_array
 * \param [in/out] p_array: array to be sorted
 * \param [in] sz_elem: size of an element in the array
@@ -32,6 +32,8 @@
 
 int32_t acdb_cmd_set_temp_path(AcdbSetTempPathReq *req);
 
+static bool_t acdb_is_exclusive_cmd(uint32_t cmd_id);
+
 /* ----------------------------------------------------------------------------
 * Public Function Definitions
 *--------------------------------------------------------------------------- */
@@ -91,8 +93,10 @@ int32_t acdb_deinit()
 {
 	int32_t status = AR_EOK;
 
+	ACDB_CTX_MAN_CLIENT_CMD_LOCK(TRUE);
 	status = acdb_init_ioctl(ACDB_INIT_CMD_RESET,
 		NULL, 0, NULL, 0);
+	ACDB_CTX_MAN_CLIENT_CMD_UNLOCK();
 	if (AR_FAILED(status))
 	{
 		ACDB_ERR("Error[%d]: Failed to de-initialized ACDB SW", status);
@@ -129,9 +133,11 @@ int32_t acdb_add_database(AcdbDatabaseFiles *acdb_data_files,
 		db_paths.writable_path.path = &writable_path->fileName[0];
 	}
 
+	ACDB_CTX_MAN_CLIENT_CMD_LOCK(TRUE);
 	status = acdb_init_ioctl(ACDB_INIT_CMD_ADD_DATABASE,
 		&db_paths, sizeof(acdb_init_database_paths_t),
 		acdb_handle, sizeof(acdb_handle_t));
+	ACDB_CTX_MAN_CLIENT_CMD_UNLOCK();
 	if (AR_FAILED(status))
 	{
 		ACDB_ERR("Error[%d]: Unable to add files to database.", status);
@@ -151,8 +157,10 @@ int32_t acdb_remove_database(const acdb_handle_t *acdb_handle)
 		return AR_EBADPARAM;;
 	}
 
+	ACDB_CTX_MAN_CLIENT_CMD_LOCK(TRUE);
 	status = acdb_init_ioctl(ACDB_INIT_CMD_REMOVE_DATABASE,
 		(acdb_handle_t)acdb_handle, sizeof(acdb_handle_t), NULL, 0);
+	ACDB_CTX_MAN_CLIENT_CMD_UNLOCK();
 	if (AR_FAILED(status))
 	{
 		ACDB_ERR("Error[%d]: Unable to add files to database.", status);
@@ -188,6 +196,11 @@ int32_t acdb_get_handle(AcdbFile *acdb_file, acdb_handle_t *acdb_handle)
 	return status;
 }
 
+uint32_t acdb_get_data_version(void)
+{
+	return acdb_ctx_man_get_data_version();
+}
+
 int32_t acdbCmdIsPersistenceSupported(__UNUSED uint32_t *resp)
 {
     __UNREFERENCED_PARAM(resp);
@@ -206,7 +219,7 @@ int32_t acdb_ioctl(uint32_t cmd_id,
 
 	ACDB_PKT_LOG_DATA("ACDB_IOCTL_CMD_ID", &cmd_id, sizeof(cmd_id));
 
-	ACDB_MUTEX_LOCK(ACDB_CTX_MAN_CLIENT_CMD_LOCK);
+	ACDB_CTX_MAN_CLIENT_CMD_LOCK(acdb_is_exclusive_cmd(cmd_id));
 
 	switch (cmd_id) {
 	case ACDB_CMD_GET_GRAPH:
@@ -225,7 +238,8 @@ int32_t acdb_ioctl(uint32_t cmd_id,
 				status = AR_EBADPARAM;
 			}
 			else
-				status = AcdbCmdGetGraph(req, rsp, rsp_struct_size);
+				status = AcdbCmdGetGraph(req, rsp, rsp_struct_size,
+					NULL, NULL);
 		}
 		break;
 	case ACDB_CMD_GET_SUBGRAPH_DATA:
@@ -734,7 +748,129 @@ int32_t acdb_ioctl(uint32_t cmd_id,
 		break;
 	}
 
-	ACDB_MUTEX_UNLOCK(ACDB_CTX_MAN_CLIENT_CMD_LOCK);
+	ACDB_CTX_MAN_CLIENT_CMD_UNLOCK();
+
+	return status;
+}
+
+int32_t acdb_ioctl_alloc(uint32_t cmd_id,
+	const void *cmd_struct,
+	uint32_t cmd_struct_size,
+	void *rsp_struct,
+	uint32_t rsp_struct_size,
+	AcdbAllocCallback alloc_cb,
+	void *alloc_context)
+{
+	int32_t status = AR_EOK;
+
+	if (IsNull(cmd_struct) || IsNull(rsp_struct) || IsNull(alloc_cb))
+		return AR_EBADPARAM;
+
+	ACDB_PKT_LOG_DATA("ACDB_IOCTL_ALLOC_CMD_ID", &cmd_id, sizeof(cmd_id));
+
+	/* Hold the databases for both the size query and the fill so that
+	 * the size cannot change in between */
+	ACDB_CTX_MAN_CLIENT_CMD_LOCK(FALSE);
+
+	switch (cmd_id) {
+	case ACDB_CMD_GET_GRAPH:
+		if (cmd_struct_size != sizeof(AcdbGraphKeyVector) ||
+			rsp_struct_size == 0)
+		{
+			status = AR_EBADPARAM;
+		}
+		else
+		{
+			AcdbGraphKeyVector *req = (AcdbGraphKeyVector *)cmd_struct;
+			AcdbGetGraphRsp *rsp = (AcdbGetGraphRsp *)rsp_struct;
+
+			if (req->num_keys == 0 || req->num_keys >= ACDB_MAX_KEY_COUNT ||
+				!IsNull(rsp->subgraphs))
+			{
+				status = AR_EBADPARAM;
+			}
+			else
+				status = AcdbCmdGetGraph(req, rsp, rsp_struct_size,
+					alloc_cb, alloc_context);
+		}
+		break;
+	case ACDB_CMD_GET_SUBGRAPH_CALIBRATION_DATA_NONPERSIST:
+		if (cmd_struct_size != sizeof(AcdbSgIdCalKeyVector) ||
+			rsp_struct_size == 0)
+		{
+			status = AR_EBADPARAM;
+		}
+		else
+		{
+			AcdbSgIdCalKeyVector *req = (AcdbSgIdCalKeyVector*)cmd_struct;
+			AcdbBlob *rsp = (AcdbBlob*)rsp_struct;
+
+			if ((req->num_sg_ids == 0) || (req->sg_ids == NULL) ||
+				!IsNull(rsp->buf))
+			{
+				status = AR_EBADPARAM;
+				break;
+			}
+
+			rsp->buf_size = 0;
+			status = AcdbCmdGetSubgraphCalDataNonPersist(
+				req, rsp, rsp_struct_size);
+			if (AR_FAILED(status) || rsp->buf_size == 0)
+				break;
+
+			rsp->buf = alloc_cb(rsp->buf_size, alloc_context);
+			if (IsNull(rsp->buf))
+			{
+				status = AR_ENOMEMORY;
+				break;
+			}
+
+			status = AcdbCmdGetSubgraphCalDataNonPersist(
+				req, rsp, rsp_struct_size);
+		}
+		break;
+	case ACDB_CMD_GET_PROC_SUBGRAPH_CAL_DATA_PERSIST:
+		if (cmd_struct_size != sizeof(AcdbProcSubgraphPersistCalReq) ||
+			rsp_struct_size != sizeof(AcdbSgIdPersistCalData))
+		{
+			status = AR_EBADPARAM;
+		}
+		else
+		{
+			AcdbProcSubgraphPersistCalReq* req =
+				(AcdbProcSubgraphPersistCalReq*)cmd_struct;
+			AcdbSgIdPersistCalData* rsp =
+				(AcdbSgIdPersistCalData*)rsp_struct;
+
+			if (req->num_subgraphs == 0 || !IsNull(rsp->cal_data))
+			{
+				status = AR_EBADPARAM;
+				break;
+			}
+
+			rsp->cal_data_size = 0;
+			status = AcdbCmdGetProcSubgraphCalDataPersist(req, rsp);
+			if (AR_FAILED(status) || rsp->cal_data_size == 0)
+				break;
+
+			rsp->cal_data = alloc_cb(rsp->cal_data_size, alloc_context);
+			if (IsNull(rsp->cal_data))
+			{
+				status = AR_ENOMEMORY;
+				break;
+			}
+
+			status = AcdbCmdGetProcSubgraphCalDataPersist(req, rsp);
+		}
+		break;
+	default:
+		status = AR_EUNSUPPORTED;
+		ACDB_ERR("Error[%d]: Command ID[%08X] does not support a response "
+			"allocator. Use acdb_ioctl instead", status, cmd_id);
+		break;
+	}
+
+	ACDB_CTX_MAN_CLIENT_CMD_UNLOCK();
 
 	return status;
 }
@@ -743,6 +879,30 @@ int32_t acdb_ioctl(uint32_t cmd_id,
 * Private Function Definitions
 *--------------------------------------------------------------------------- */
 
+/**
+* \brief
+*		Determines whether an acdb_ioctl command modifies calibration or
+*		delta data and must run without any other client command. All
+*		other commands only read the databases and run in parallel.
+*
+* \param[in] cmd_id: The acdb_ioctl command id
+*
+* \return TRUE if the command needs the client lock exclusively
+*/
+static bool_t acdb_is_exclusive_cmd(uint32_t cmd_id)
+{
+	switch (cmd_id)
+	{
+	case ACDB_CMD_SET_CAL_DATA:
+	case ACDB_CMD_SET_TAG_DATA:
+	case ACDB_CMD_ENABLE_PERSISTANCE:
+	case ACDB_CMD_SET_TEMP_PATH:
+		return TRUE;
+	default:
+		return FALSE;
+	}
+}
+
 int32_t acdb_cmd_set_temp_path(AcdbSetTempPathReq *req)
 {
     int32_t status = AR_EOK;
@@ -42,9 +42,9 @@
 /* ---------------------------------------------------------------------------
 * Global Data Definitions
 *--------------------------------------------------------------------------- */
-uint32_t glb_buf_1[GLB_BUF_1_LENGTH];
-uint32_t glb_buf_2[GLB_BUF_2_LENGTH];
-uint32_t glb_buf_3[GLB_BUF_3_LENGTH];
+ACDB_THREAD_LOCAL uint32_t glb_buf_1[GLB_BUF_1_LENGTH];
+ACDB_THREAD_LOCAL uint32_t glb_buf_2[GLB_BUF_2_LENGTH];
+ACDB_THREAD_LOCAL uint32_t glb_buf_3[GLB_BUF_3_LENGTH];
 
 /* ---------------------------------------------------------------------------
 * Static Variable Definitions
@@ -3906,7 +3906,8 @@ int32_t AcdbCmdGetDriverData(AcdbDriverData *req, AcdbBlob* rsp, uint32_t rsp_si
 	return status;
 }
 
-int32_t BuildGetGraphResponse(AcdbGetGraphRsp *rsp, uint32_t sg_list_offset)
+int32_t BuildGetGraphResponse(AcdbGetGraphRsp *rsp, uint32_t sg_list_offset,
+    AcdbAllocCallback alloc_cb, void *alloc_context)
 {
     int32_t status = AR_EOK;
     uint32_t offset = 0;
@@ -3943,7 +3944,18 @@ int32_t BuildGetGraphResponse(AcdbGetGraphRsp *rsp, uint32_t sg_list_offset)
 
     if (IsNull(rsp->subgraphs))
     {
-        return AR_EOK;
+        if (IsNull(alloc_cb) || rsp->size == 0)
+            return AR_EOK;
+
+        //Single call mode: fill the list found by this search
+        rsp->subgraphs = (AcdbSubgraph*)alloc_cb(rsp->size, alloc_context);
+        if (IsNull(rsp->subgraphs))
+        {
+            ACDB_ERR("Error[%d]: Unable to allocate %d bytes for the "
+                "subgraph list", AR_ENOMEMORY, rsp->size);
+            return AR_ENOMEMORY;
+        }
+        expected_size = rsp->size;
     }
 
 	if (expected_size >= rsp->size)
@@ -4116,7 +4128,7 @@ int32_t AcdbGetUsecaseSubgraphList(AcdbGraphKeyVector* gkv,
 }
 
 int32_t AcdbCmdGetGraph(AcdbGraphKeyVector *gkv, AcdbGetGraphRsp *rsp,
-    uint32_t rsp_struct_size)
+    uint32_t rsp_struct_size, AcdbAllocCallback alloc_cb, void *alloc_context)
 {
     int32_t status = AR_EOK;
     AcdbGraphKeyVector graph_kv = { 0 };
@@ -4176,7 +4188,8 @@ int32_t AcdbCmdGetGraph(AcdbGraphKeyVector *gkv, AcdbGetGraphRsp *rsp,
         return status;
     }
 
-    status = BuildGetGraphResponse(rsp, graph_info.sg_list_offset);
+    status = BuildGetGraphResponse(rsp, graph_info.sg_list_offset,
+        alloc_cb, alloc_context);
     if (AR_FAILED(status))
     {
         ACDB_ERR("Error[%d]: Failed to build response", status);
@@ -16,6 +16,7 @@
 #include "acdb_context_mgr.h"
 #include "acdb_parser.h"
 #include "acdb_data_proc.h"
+#include "acdb_gkv_index.h"
 #include "acdb_utility.h"
 
 /* ---------------------------------------------------------------------------
@@ -35,14 +36,22 @@
 typedef struct _acdb_man_context_t AcdbCtxManContext;
 struct _acdb_man_context_t
 {
-    ar_osal_mutex_t acdb_client_lock;
+    ar_osal_rwlock_t acdb_client_lock;
     ar_osal_mutex_t ctx_man_lock;
+    /**< Guards data_version. Like the client lock it outlives a reset */
+    ar_osal_mutex_t data_version_lock;
+    /**< Incremented whenever calibration data in any database is added,
+    changed or removed. Lets clients that cache ACDB data detect writes */
+    uint32_t data_version;
     /**< a bit field representing the available file slots.
     0 = taken, 1 = open */
     //uint32_t active_db_slots;
-    /**< The index of the database that the filemanager is
-    currently pointing to */
-    acdb_context_handle_t *active_db;
+    /**< The database used by threads that have not set an active
+    database of their own */
+    acdb_context_handle_t *default_db;
+    /**< Incremented whenever a database is removed. Invalidates the
+    active database of every thread */
+    uint32_t generation;
     /**< Current Number of databases being managed */
     uint32_t database_count;
     /**< Maintains handle info about each loaded database */
@@ -62,6 +71,18 @@ struct acdb_man_subgraph_location_t
 
 static AcdbCtxManContext acdb_ctx_man_context;
 
+/**< The database that the calling thread's command is pointing to. It is
+* only valid while acdb_ctx_man_active_db_generation matches the context
+* generation */
+static ACDB_THREAD_LOCAL acdb_context_handle_t *acdb_ctx_man_active_db;
+static ACDB_THREAD_LOCAL uint32_t acdb_ctx_man_active_db_generation;
+
+/**< Client command lock held by the calling thread and how many times
+* the thread has acquired it */
+static ACDB_THREAD_LOCAL ar_osal_rwlock_t acdb_ctx_man_client_lock_held;
+static ACDB_THREAD_LOCAL uint32_t acdb_ctx_man_client_lock_depth;
+static ACDB_THREAD_LOCAL bool_t acdb_ctx_man_client_lock_exclusive;
+
 /**< NOTE: In the case where setting the active handle for a list of subgraphs
 * results in more that one subgraph belonging to a different file:
 *
@@ -72,13 +93,19 @@ static AcdbCtxManContext acdb_ctx_man_context;
 * Private functions
 *--------------------------------------------------------------------------- */
 
+static void acdb_ctx_man_set_active_db(acdb_context_handle_t *handle)
+{
+    acdb_ctx_man_active_db = handle;
+    acdb_ctx_man_active_db_generation = acdb_ctx_man_context.generation;
+}
+
 int32_t acdb_ctx_man_init(void)
 {
     int32_t status = AR_EOK;
 
     if (!acdb_ctx_man_context.acdb_client_lock)
     {
-        status = ar_osal_mutex_create(&acdb_ctx_man_context.acdb_client_lock);
+        status = ar_osal_rwlock_create(&acdb_ctx_man_context.acdb_client_lock);
         if (AR_FAILED(status))
         {
             ACDB_ERR("Error[%d]: failed to create acdb client mutex",
@@ -96,6 +123,17 @@ int32_t acdb_ctx_man_init(void)
         }
     }
 
+    if (!acdb_ctx_man_context.data_version_lock)
+    {
+        status = ar_osal_mutex_create(
+            &acdb_ctx_man_context.data_version_lock);
+        if (AR_FAILED(status))
+        {
+            ACDB_ERR("Error[%d]: failed to create data version mutex",
+                status);
+        }
+    }
+
     //acdb_ctx_man_context.active_db_slots = 0xFFFFFFFF;
 
     return status;
@@ -132,14 +170,17 @@ int32_t acdb_ctx_man_add_database(acdb_context_handle_t *handle)
     db_ctx->file_manager_handle = handle->file_manager_handle;
     db_ctx->delta_manager_handle = handle->delta_manager_handle;
     db_ctx->heap_handle = handle->heap_handle;
+    db_ctx->gkv_index_handle = handle->gkv_index_handle;
 
     //ACDB_BIT_SET(acdb_ctx_man_context.active_db_slots, index);
     acdb_ctx_man_context.database_count++;
     if (1 == acdb_ctx_man_context.database_count)
-        acdb_ctx_man_context.active_db =
+        acdb_ctx_man_context.default_db =
         acdb_ctx_man_context.database_info[index];
     ACDB_MUTEX_UNLOCK(acdb_ctx_man_context.ctx_man_lock);
 
+    acdb_ctx_man_update_data_version();
+
     return status;
 }
 
@@ -156,19 +197,21 @@ int32_t acdb_ctx_man_remove_database(acdb_handle_t *handle)
     vm_id = ACDB_HANDLE_TO_UINT(handle);
     for (uint32_t i = 0; i < acdb_ctx_man_context.database_count; i++)
     {
-        ctx_handle = acdb_ctx_man_context.database_info[i];
-
-        if (IsNull(ctx_handle))
+        if (IsNull(acdb_ctx_man_context.database_info[i]))
             continue;
 
         if (vm_id == acdb_ctx_man_context.database_info[i]->vm_id)
         {
             // db_index = ctx_handle->database_index;
+            ctx_handle = acdb_ctx_man_context.database_info[i];
             acdb_ctx_man_context.database_info[i] = NULL;
             break;
         }
     }
 
+    if (!IsNull(ctx_handle))
+        acdb_gkv_index_destroy(ctx_handle->gkv_index_handle);
+
     ACDB_FREE(ctx_handle);
 
     ACDB_MUTEX_LOCK(acdb_ctx_man_context.ctx_man_lock);
@@ -180,8 +223,25 @@ int32_t acdb_ctx_man_remove_database(acdb_handle_t *handle)
         acdb_ctx_man_context.database_count--;
     }
 
+    acdb_ctx_man_context.generation++;
+    if (acdb_ctx_man_context.default_db == ctx_handle)
+    {
+        acdb_ctx_man_context.default_db = NULL;
+        for (uint32_t i = 0; i < MAX_ACDB_FILE_COUNT; i++)
+        {
+            if (IsNull(acdb_ctx_man_context.database_info[i]))
+                continue;
+
+            acdb_ctx_man_context.default_db =
+                acdb_ctx_man_context.database_info[i];
+            break;
+        }
+    }
+
     ACDB_MUTEX_UNLOCK(acdb_ctx_man_context.ctx_man_lock);
 
+    acdb_ctx_man_update_data_version();
+
     return status;
 }
 
@@ -190,6 +250,10 @@ int32_t acdb_ctx_man_reset(void)
     int32_t status = AR_EOK;
     acdb_context_handle_t *db_info = NULL;
     acdb_handle_t acdb_handle = NULL;
+    ar_osal_rwlock_t client_lock = NULL;
+    ar_osal_mutex_t data_version_lock = NULL;
+    uint32_t generation = 0;
+    uint32_t data_version = 0;
 
     for (uint32_t i = 0; i < acdb_ctx_man_context.database_count; i++)
     {
@@ -209,8 +273,23 @@ int32_t acdb_ctx_man_reset(void)
     }
 
     ar_osal_mutex_destroy(acdb_ctx_man_context.ctx_man_lock);
-    ar_osal_mutex_destroy(acdb_ctx_man_context.acdb_client_lock);
+
+    /* The client lock outlives a reset since the reset itself can be
+     * requested by a client holding it (e.g ATS re-init). The generation
+     * must keep increasing so that no thread's active database survives.
+     * The data version must keep increasing so that clients caching ACDB
+     * data never match a version from before the reset */
+    client_lock = acdb_ctx_man_context.acdb_client_lock;
+    generation = acdb_ctx_man_context.generation;
+    data_version_lock = acdb_ctx_man_context.data_version_lock;
+    ACDB_MUTEX_LOCK(data_version_lock);
+    data_version = acdb_ctx_man_context.data_version;
     ar_mem_set(&acdb_ctx_man_context, 0, sizeof(AcdbCtxManContext));
+    acdb_ctx_man_context.acdb_client_lock = client_lock;
+    acdb_ctx_man_context.data_version_lock = data_version_lock;
+    acdb_ctx_man_context.generation = generation + 1;
+    acdb_ctx_man_context.data_version = data_version + 1;
+    ACDB_MUTEX_UNLOCK(data_version_lock);
     return status;
 }
 
@@ -291,8 +370,8 @@ int32_t acdb_ctx_man_set_context_handle(acdb_handle_t *handle)
         if (vm_id != acdb_ctx_man_context.database_info[i]->vm_id)
             continue;
 
-        acdb_ctx_man_context.active_db =
-            acdb_ctx_man_context.database_info[i];
+        acdb_ctx_man_set_active_db(
+            acdb_ctx_man_context.database_info[i]);
         break;
     }
 
@@ -306,10 +385,10 @@ int32_t acdb_ctx_man_set_context_handle_using_index(uint32_t db_index)
     if (db_index > acdb_ctx_man_context.database_count)
         return AR_EBADPARAM;
 
-    acdb_ctx_man_context.active_db =
-        acdb_ctx_man_context.database_info[db_index];
+    acdb_ctx_man_set_active_db(
+        acdb_ctx_man_context.database_info[db_index]);
 
-    if (IsNull(acdb_ctx_man_context.active_db))
+    if (IsNull(acdb_ctx_man_active_db))
     {
         ACDB_ERR("Error[%d]: No database context was found at "
             "index %d", db_index);
@@ -332,8 +411,8 @@ int32_t acdb_ctx_man_set_handle_using_gkv(
 
     for (uint32_t i = 0; i < acdb_ctx_man_context.database_count; i++)
     {
-        acdb_ctx_man_context.active_db =
-            acdb_ctx_man_context.database_info[i];
+        acdb_ctx_man_set_active_db(
+            acdb_ctx_man_context.database_info[i]);
 
         status = DataProcSearchGkvKeyTable(gkv, &gkv_lut_offset);
         if (AR_ENOTEXIST == status)
@@ -378,8 +457,8 @@ int32_t acdb_ctx_man_set_handle_using_subgraph(
 
     if (acdb_ctx_man_context.database_count == 1)
     {
-        acdb_ctx_man_context.active_db =
-            acdb_ctx_man_context.database_info[0];
+        acdb_ctx_man_set_active_db(
+            acdb_ctx_man_context.database_info[0]);
         return AR_EOK;
     }
 
@@ -392,8 +471,8 @@ int32_t acdb_ctx_man_set_handle_using_subgraph(
     for (uint32_t i = 0; i < acdb_ctx_man_context.database_count; i++)
     {
         num_subgraphs_found = 0;
-        acdb_ctx_man_context.active_db =
-            acdb_ctx_man_context.database_info[i];
+        acdb_ctx_man_set_active_db(
+            acdb_ctx_man_context.database_info[i]);
 
         if (1 == subgraph_id_list->count)
         {
@@ -468,8 +547,8 @@ int32_t acdb_ctx_man_set_handle_using_driver_module(
 
     for (uint32_t i = 0; i < acdb_ctx_man_context.database_count; i++)
     {
-        acdb_ctx_man_context.active_db =
-            acdb_ctx_man_context.database_info[i];
+        acdb_ctx_man_set_active_db(
+            acdb_ctx_man_context.database_info[i]);
 
         status = DriverDataFindFirstOfModuleID(
             cal_lut_entry, cal_lut_entry_offset);
@@ -492,12 +571,62 @@ int32_t acdb_ctx_man_set_handle_using_driver_module(
 
 acdb_context_handle_t *acdb_ctx_man_get_active_handle(void)
 {
-    return acdb_ctx_man_context.active_db;
+    if (!IsNull(acdb_ctx_man_active_db) &&
+        acdb_ctx_man_active_db_generation == acdb_ctx_man_context.generation)
+        return acdb_ctx_man_active_db;
+
+    return acdb_ctx_man_context.default_db;
+}
+
+void acdb_ctx_man_client_cmd_lock(bool_t exclusive)
+{
+    int32_t status = AR_EOK;
+    ar_osal_rwlock_t lock = acdb_ctx_man_context.acdb_client_lock;
+
+    if (acdb_ctx_man_client_lock_depth++ > 0)
+    {
+        if (exclusive && !acdb_ctx_man_client_lock_exclusive)
+        {
+            ACDB_ERR("Error[%d]: The client command lock is held shared "
+                "and cannot be upgraded", AR_EFAILED);
+        }
+        return;
+    }
+
+    if (IsNull(lock))
+        return;
+
+    status = exclusive ?
+        ar_osal_rwlock_write_lock(lock) : ar_osal_rwlock_read_lock(lock);
+    if (AR_FAILED(status))
+    {
+        ACDB_DBG("Error[%d]: Failed to obtain lock", status);
+        return;
+    }
+
+    acdb_ctx_man_client_lock_held = lock;
+    acdb_ctx_man_client_lock_exclusive = exclusive;
 }
 
-ar_osal_mutex_t acdb_ctx_man_get_client_lock(void)
+void acdb_ctx_man_client_cmd_unlock(void)
 {
-    return acdb_ctx_man_context.acdb_client_lock;
+    int32_t status = AR_EOK;
+
+    if (acdb_ctx_man_client_lock_depth == 0 ||
+        --acdb_ctx_man_client_lock_depth > 0)
+        return;
+
+    if (IsNull(acdb_ctx_man_client_lock_held))
+        return;
+
+    status = ar_osal_rwlock_unlock(acdb_ctx_man_client_lock_held);
+    if (AR_FAILED(status))
+    {
+        ACDB_DBG("Error[%d]: Failed to release lock", status);
+    }
+
+    acdb_ctx_man_client_lock_held = NULL;
+    acdb_ctx_man_client_lock_exclusive = FALSE;
 }
 
 uint32_t acdb_ctx_man_get_database_count(void)
@@ -505,6 +634,24 @@ uint32_t acdb_ctx_man_get_database_count(void)
     return acdb_ctx_man_context.database_count;
 }
 
+void acdb_ctx_man_update_data_version(void)
+{
+    ACDB_MUTEX_LOCK(acdb_ctx_man_context.data_version_lock);
+    acdb_ctx_man_context.data_version++;
+    ACDB_MUTEX_UNLOCK(acdb_ctx_man_context.data_version_lock);
+}
+
+uint32_t acdb_ctx_man_get_data_version(void)
+{
+    uint32_t data_version = 0;
+
+    ACDB_MUTEX_LOCK(acdb_ctx_man_context.data_version_lock);
+    data_version = acdb_ctx_man_context.data_version;
+    ACDB_MUTEX_UNLOCK(acdb_ctx_man_context.data_version_lock);
+
+    return data_version;
+}
+
 int32_t acdb_ctx_man_ioctl(uint32_t cmd_id,
 	void* req,
 	uint32_t req_size,
@@ -17,6 +17,7 @@
 #include "acdb_heap.h"
 #include "acdb_common.h"
 #include "acdb_delta_file_mgr.h"
+#include "acdb_gkv_index.h"
 
 /**
 * \brief AcdbBlobToCalData
@@ -882,6 +883,11 @@ int32_t UpdateHeap(acdb_delta_data_map_t *req_map)
             req_sg_data_node = req_sg_data_node->p_next;
         }
 
+        //Mark the heap map to be written to the delta file journal
+        (void)acdb_heap_ioctl(ACDB_HEAP_CMD_SET_MAP_DIRTY,
+            (uint8_t*)get_key_vector_from_map(heap_map),
+            sizeof(AcdbGraphKeyVector), NULL, 0);
+
         //Free Request Map
         acdb_heap_free_map(req_map);
         req_map = NULL;
@@ -896,6 +902,8 @@ int32_t DataProcSetMapToHeap(acdb_delta_data_map_t *map)
 
     status = UpdateHeap(map);
 
+    acdb_ctx_man_update_data_version();
+
     return status;
 }
 
@@ -951,6 +959,8 @@ int32_t SetSubraphData(void *req, KeyVectorType key_vector_type,
 
     status = UpdateHeap(req_map);
 
+    acdb_ctx_man_update_data_version();
+
 	return status;
 }
 
@@ -2244,6 +2254,7 @@ int32_t DataProcSearchGkvKeyTable(
     KeyTableHeader key_table_header = { 0 };
     AcdbTableInfo table_info = { 0 };
     AcdbTableSearchInfo search_info = { 0 };
+    acdb_context_handle_t *ctx_handle = NULL;
 
     if (IsNull(gkv) || IsNull(gkv_lut_offset))
     {
@@ -2252,6 +2263,13 @@ int32_t DataProcSearchGkvKeyTable(
         return AR_EBADPARAM;
     }
 
+    ctx_handle = acdb_ctx_man_get_active_handle();
+    if (!IsNull(ctx_handle) && !IsNull(ctx_handle->gkv_index_handle))
+    {
+        return acdb_gkv_index_find_lut_offset(
+            ctx_handle->gkv_index_handle, gkv, gkv_lut_offset);
+    }
+
     if (gkv->num_keys >= GLB_BUF_2_LENGTH / 2)
     {
         ACDB_ERR("Error[%d]: The number of keys %d is greater "
@@ -2364,6 +2382,7 @@ int32_t DataProcSearchGkvLut(AcdbGraphKeyVector* gkv,
     KeyTableHeader key_table_header = { 0 };
     AcdbTableInfo table_info = { 0 };
     AcdbTableSearchInfo search_info = { 0 };
+    acdb_context_handle_t *ctx_handle = NULL;
 
     if (IsNull(gkv) || IsNull(graph_info))
     {
@@ -2372,6 +2391,13 @@ int32_t DataProcSearchGkvLut(AcdbGraphKeyVector* gkv,
         return AR_EBADPARAM;
     }
 
+    ctx_handle = acdb_ctx_man_get_active_handle();
+    if (!IsNull(ctx_handle) && !IsNull(ctx_handle->gkv_index_handle))
+    {
+        return acdb_gkv_index_find_graph(ctx_handle->gkv_index_handle,
+            gkv, gkv_lut_offset, graph_info);
+    }
+
     if (gkv->num_keys + 1 >= GLB_BUF_2_LENGTH / 2)
     {
         ACDB_ERR("Error[%d]: The number of keys %d is greater "
@@ -28,6 +28,14 @@
 *--------------------------------------------------------------------------- */
 #define INF 4294967295U
 
+/**< Suffix of the file that a compacted delta file is written to before it
+ * is renamed over the delta file */
+#define ACDB_DELTA_TEMP_FILE_EXT ".tmp"
+
+/**< The journal is compacted into a new snapshot once it grows past
+ * this size and past the size of the snapshot itself */
+#define ACDB_DELTA_JOURNAL_MIN_COMPACT_SIZE (64 * 1024)
+
 /**< A File Manager macro that simplifies accessing the database info within the
  * File Manager context structure.
  *
@@ -64,6 +72,13 @@ struct _acdb_delta_file_man_database_info_t {
     acdb_path_t delta_file_path;
     /**< Delta file version information */
     acdb_delta_file_version_t file_info;
+    /**< Size of the header and snapshot of maps at the start of the file */
+    uint32_t snapshot_size;
+    /**< Size of the journal records appended after the snapshot */
+    uint32_t journal_size;
+    /**< Set when the heap can differ from the delta file by more than the
+     * dirty maps. The next save then rewrites the whole file */
+    bool_t needs_compaction;
 };
 
 typedef struct _acdb_delta_file_man_context_t AcdbDeltaFileManContext;
@@ -155,6 +170,7 @@ int32_t AcdbDeltaAddDatabase(AcdbDeltaFileManFileInfo *info,
         info->delta_file_path.path_length;
     db_info->delta_file_path.path =
         info->delta_file_path.path;
+    db_info->needs_compaction = TRUE;
 
     *handle = db_info;
     ACDB_MUTEX_UNLOCK(acdb_delta_file_man_context.delta_lock);
@@ -281,130 +297,250 @@ int32_t AcdbDeltaDataCmdGetDeltaVersion(uint32_t findex, uint32_t *delta_major,
 	return result;
 }
 
-int32_t AcdbDeltaDataCmdSave(void)
+/**
+* \brief
+*		Writes every map in the heap to a temporary file and renames it over
+*		the delta file. A crash leaves either the old or the new delta file
+*		in place.
+*/
+int32_t AcdbDeltaCompact(AcdbDeltaFileManDatabaseInfo *db_info)
 {
-	int32_t status = AR_EOK;
-    ar_fhandle *fhandle = NULL;
-	uint32_t fsize = 0;
-	uint32_t fdata_size = 0; ;
-	LinkedList *p_map_list = NULL;
-	LinkedList map_list = { 0 };
-	LinkedListNode *cur_node = NULL;
-	//acdb_path_256_t file_name_info = { 0 };
-	acdb_delta_data_map_t *map = NULL;
-    AcdbInitUtilDeltaInfo delta_info = { 0 };
-    acdb_context_handle_t *context_handle = NULL;
-    AcdbDeltaFileManDatabaseInfo *db_info = NULL;
-
-    context_handle = acdb_ctx_man_get_active_handle();
+    int32_t status = AR_EOK;
+    ar_fhandle tmp_fhandle = NULL;
+    uint32_t fsize = 0;
+    uint32_t fdata_size = 0;
+    uint32_t tmp_path_size = 0;
+    char_t *tmp_path = NULL;
+    LinkedList *p_map_list = NULL;
+    LinkedList map_list = { 0 };
+    LinkedListNode *cur_node = NULL;
+
+    tmp_path_size = db_info->delta_file_path.path_length
+        + sizeof(ACDB_DELTA_TEMP_FILE_EXT);
+    tmp_path = ACDB_MALLOC(char_t, tmp_path_size);
+    if (IsNull(tmp_path))
+    {
+        ACDB_ERR("Error[%d]: Unable to allocate the temporary delta file "
+            "path", AR_ENOMEMORY);
+        return AR_ENOMEMORY;
+    }
+
+    if (0 > ar_sprintf(tmp_path, tmp_path_size, "%s%s",
+        db_info->delta_file_path.path, ACDB_DELTA_TEMP_FILE_EXT))
+    {
+        status = AR_EFAILED;
+        ACDB_ERR("Error[%d]: Unable to create the temporary delta file "
+            "path", status);
+        goto end;
+    }
 
-    if (IsNull(context_handle) || IsNull(context_handle->delta_manager_handle))
+    status = ar_fopen(&tmp_fhandle, tmp_path, AR_FOPEN_WRITE_ONLY);
+    if (AR_FAILED(status))
     {
-        ACDB_ERR("Warning[%d]: Unable to save delta file. There is no delta file",
-            AR_EHANDLE);
-        return AR_EOK;
+        ACDB_ERR("Error[%d]: Failed to create %s", status, tmp_path);
+        goto end;
     }
 
-    db_info = (AcdbDeltaFileManDatabaseInfo*)
-        context_handle->delta_manager_handle;
+    status = acdb_delta_parser_write_file_header(
+        tmp_fhandle, &db_info->file_info, 0, 0);
+    if (AR_FAILED(status)) goto end;
+
+    p_map_list = &map_list;
 
-    fhandle = &db_info->file_handle;
+    status = acdb_heap_ioctl(ACDB_HEAP_CMD_GET_MAP_LIST, NULL, 0,
+        (uint8_t*)&p_map_list, sizeof(LinkedList));
+    if (AR_EOK != status) goto end;
 
-	//Close and delete old delta file
-	ar_fclose(*fhandle);
+    cur_node = p_map_list->p_head;
 
-    status = ar_fdelete(db_info->delta_file_path.path);
+    while (cur_node != NULL)
+    {
+        status = acdb_delta_parser_write_map(tmp_fhandle,
+            (acdb_delta_data_map_t*)cur_node->p_struct);
+        if (AR_EOK != status) goto end;
+        cur_node = cur_node->p_next;
+    }
 
+    status = ar_fseek(tmp_fhandle, 0, AR_FSEEK_BEGIN);
     if (AR_FAILED(status))
     {
-        ACDB_ERR("Error[%d]: Failed to delete delta file", status);
-        return status;
+        ACDB_ERR("Error[%d]: Failed to seek delta file", status);
+        goto end;
     }
 
-	/* Create new delta file and set ar_fhandle to acdb_delta_file_man_context
-	 * at findex. Check to see if file exists otherwise create it */
-    delta_info.properties.file_access_io_flag = ACDB_FUNC_IO_IN;
-    delta_info.properties.file_access = AR_FOPEN_WRITE_ONLY;
-    delta_info.delta_path = db_info->delta_file_path;
+    fsize = (uint32_t)ar_fsize(tmp_fhandle);
+    fdata_size = fsize - sizeof(AcdbDeltaFileHeader) + sizeof(uint32_t);
+
+    status = acdb_delta_parser_write_file_header(
+        tmp_fhandle, &db_info->file_info, fdata_size, p_map_list->length);
+    if (AR_EOK != status) goto end;
 
-	status = AcdbInitUtilGetDeltaInfo2(
-        &db_info->delta_file_path, &delta_info.properties);
+    status = ar_fsync(tmp_fhandle);
+    if (AR_FAILED(status)) goto end;
+
+    status = ar_fclose(tmp_fhandle);
+    tmp_fhandle = NULL;
+    if (AR_FAILED(status)) goto end;
+
+    if (!IsNull(db_info->file_handle))
+    {
+        (void)ar_fclose(db_info->file_handle);
+        db_info->file_handle = NULL;
+    }
+
+    status = ar_frename(tmp_path, db_info->delta_file_path.path);
     if (AR_FAILED(status))
-	{
-		ACDB_ERR_MSG_1("Unable to create a new delta acdb file", status);
-        return status;
-	}
+    {
+        ACDB_ERR("Error[%d]: Failed to replace the delta file with %s",
+            status, tmp_path);
+    }
+
+    /* Reopen whichever file is in place so that the next save can
+     * append to it */
+    if (AR_FAILED(ar_fopen(&db_info->file_handle,
+        db_info->delta_file_path.path, AR_FOPEN_READ_ONLY_WRITE)))
+    {
+        ACDB_ERR("Error[%d]: Failed to reopen delta file", AR_EFAILED);
+        db_info->file_handle = NULL;
+        status = AR_EFAILED;
+    }
+
+    if (AR_FAILED(status)) goto end;
 
-    fsize = delta_info.properties.file_size;
-    delta_info.properties.file_access = AR_FOPEN_READ_ONLY_WRITE;
+    db_info->exists = TRUE;
+    db_info->is_updated = TRUE;
+    db_info->file_size = fsize;
+    db_info->snapshot_size = fsize;
+    db_info->journal_size = 0;
+    db_info->needs_compaction = FALSE;
 
-	status = AcdbInitUtilOpenDeltaFile(&delta_info, fhandle);
+end:
+    /* The dirty flags of the maps may already be cleared. Compact again on
+     * the next save so that no change is lost */
     if (AR_FAILED(status))
+        db_info->needs_compaction = TRUE;
+
+    if (!IsNull(tmp_fhandle))
     {
-        ACDB_ERR("Error[%d]: Failed to open delta file", status);
-        return status;
+        (void)ar_fclose(tmp_fhandle);
+        (void)ar_fdelete(tmp_path);
     }
 
-	db_info->file_handle = *fhandle;
+    if (!IsNull(p_map_list))
+        AcdbListClear(p_map_list);
 
-	status = acdb_delta_parser_write_file_header(
-		db_info->file_handle,
-		&db_info->file_info, 0, 0);
+    ACDB_FREE(tmp_path);
+    return status;
+}
 
-    if (AR_FAILED(status)) goto end;
+/**
+* \brief
+*		Appends a journal record for each map that changed since the last
+*		save
+*/
+int32_t AcdbDeltaAppendJournal(AcdbDeltaFileManDatabaseInfo *db_info)
+{
+    int32_t status = AR_EOK;
+    uint32_t record_size = 0;
+    LinkedList *p_map_list = NULL;
+    LinkedList map_list = { 0 };
+    LinkedListNode *cur_node = NULL;
 
-	p_map_list = &map_list;
+    p_map_list = &map_list;
 
-	status = acdb_heap_ioctl(ACDB_HEAP_CMD_GET_MAP_LIST, NULL, 0,
+    status = acdb_heap_ioctl(ACDB_HEAP_CMD_GET_DIRTY_MAP_LIST, NULL, 0,
         (uint8_t*)&p_map_list, sizeof(LinkedList));
-	if (AR_EOK != status) goto end;
-
-	cur_node = p_map_list->p_head;
+    if (AR_EOK != status) goto end;
 
-	while (cur_node != NULL)
-	{
-        map = ((acdb_delta_data_map_t*)cur_node->p_struct);
-        status = acdb_delta_parser_write_map(*fhandle, map);
-        if (AR_EOK != status) break;
-		cur_node = cur_node->p_next;
-	}
+    if (p_map_list->length == 0) goto end;
 
-	status = ar_fseek(*fhandle, 0, AR_FSEEK_BEGIN);
+    status = ar_fseek(db_info->file_handle,
+        db_info->snapshot_size + db_info->journal_size, AR_FSEEK_BEGIN);
     if (AR_FAILED(status))
     {
         ACDB_ERR("Error[%d]: Failed to seek delta file", status);
         goto end;
     }
 
-	fsize = (uint32_t)ar_fsize(*fhandle);
-	fdata_size = fsize - sizeof(AcdbDeltaFileHeader) + sizeof(uint32_t);
+    cur_node = p_map_list->p_head;
 
-	status = acdb_delta_parser_write_file_header(
-		db_info->file_handle,
-		&db_info->file_info, fdata_size, p_map_list->length);
+    while (cur_node != NULL)
+    {
+        status = acdb_delta_parser_write_journal_record(db_info->file_handle,
+            (acdb_delta_data_map_t*)cur_node->p_struct, &record_size);
+        if (AR_EOK != status) goto end;
+
+        db_info->journal_size += record_size;
+        cur_node = cur_node->p_next;
+    }
 
-	if (AR_EOK != status) goto end;
+    status = ar_fsync(db_info->file_handle);
+    if (AR_FAILED(status)) goto end;
 
-	db_info->is_updated = TRUE;
-	db_info->file_size = fsize;
+    db_info->is_updated = TRUE;
+    db_info->file_size = db_info->snapshot_size + db_info->journal_size;
 
 end:
+    /* The dirty flags of the maps are already cleared. Rewrite the whole
+     * file on the next save so that no change is lost */
+    if (AR_FAILED(status))
+        db_info->needs_compaction = TRUE;
+
     AcdbListClear(p_map_list);
-    p_map_list = NULL;
+    return status;
+}
 
-	return status;
+int32_t AcdbDeltaDataCmdSave(void)
+{
+    acdb_context_handle_t *context_handle = NULL;
+    AcdbDeltaFileManDatabaseInfo *db_info = NULL;
+
+    context_handle = acdb_ctx_man_get_active_handle();
+
+    if (IsNull(context_handle) || IsNull(context_handle->delta_manager_handle))
+    {
+        ACDB_ERR("Warning[%d]: Unable to save delta file. There is no delta file",
+            AR_EHANDLE);
+        return AR_EOK;
+    }
+
+    db_info = (AcdbDeltaFileManDatabaseInfo*)
+        context_handle->delta_manager_handle;
+
+    /* Append the changed maps to the journal. The whole heap is written
+     * when the file is new, when the heap was loaded from elsewhere or
+     * when the journal has outgrown the snapshot */
+    if (db_info->needs_compaction || IsNull(db_info->file_handle) ||
+        (db_info->journal_size >= ACDB_DELTA_JOURNAL_MIN_COMPACT_SIZE &&
+        db_info->journal_size >= db_info->snapshot_size))
+    {
+        return AcdbDeltaCompact(db_info);
+    }
+
+    return AcdbDeltaAppendJournal(db_info);
 }
-int32_t AcdbDeltaInitHeap(acdb_context_handle_t *handle)
+
+/**
+* \brief
+*		Loads the snapshot of maps and then replays the journal records in
+*		the delta file. A journal record that is incomplete or fails its
+*		checksum (e.g the device lost power during a save) ends the journal.
+*
+* \param[in] handle: The database context
+* \param[in] should_merge: Merge the maps into the data already in the heap
+*           instead of adding them directly
+*/
+int32_t AcdbDeltaLoadFile(acdb_context_handle_t *handle, bool_t should_merge)
 {
     int32_t status = AR_EOK;
     uint32_t foffset = sizeof(AcdbDeltaFileHeader);
+    uint32_t snapshot_size = 0;
+    bool_t is_journal = FALSE;
     acdb_delta_data_map_t *map = NULL;
     AcdbDeltaFileManDatabaseInfo *db_info = NULL;
+    AcdbDeltaFileHeader file_header = { 0 };
     acdb_heap_map_handle_info_t map_handle_info = { 0 };
 
-    /* todo: read entire delta file into memory, close file,
-     * and write that memory into the heap format */
-
     if (IsNull(handle))
         return AR_EBADPARAM;
 
@@ -413,9 +549,31 @@ int32_t AcdbDeltaInitHeap(acdb_context_handle_t *handle)
     if (IsNull(db_info))
         return AR_EHANDLE;
 
+    /* A new or empty delta file gets its header on the first save */
+    if (IsNull(db_info->file_handle) ||
+        db_info->file_size < sizeof(AcdbDeltaFileHeader))
+    {
+        db_info->needs_compaction = TRUE;
+        return AR_EOK;
+    }
+
+    status = acdb_delta_parser_read_file_header(
+        db_info->file_handle, &file_header);
+    if (AR_FAILED(status))
+    {
+        ACDB_ERR("Error[%d]: Failed to read the delta file header", status);
+        return status;
+    }
+
+    snapshot_size = acdb_delta_parser_get_snapshot_size(&file_header);
+    if (snapshot_size > db_info->file_size)
+        snapshot_size = db_info->file_size;
+
     map_handle_info.handle = handle->heap_handle;
     while (foffset < db_info->file_size)
     {
+        is_journal = foffset >= snapshot_size;
+
         map = ACDB_MALLOC(acdb_delta_data_map_t, 1);
         map_handle_info.map = map;
 
@@ -429,8 +587,26 @@ int32_t AcdbDeltaInitHeap(acdb_context_handle_t *handle)
 
         ACDB_CLEAR_BUFFER(*map);
 
-        status = acdb_delta_parser_read_map(
-            db_info->file_handle, &foffset, map);
+        if (is_journal)
+        {
+            status = acdb_delta_parser_read_journal_record(
+                db_info->file_handle, db_info->file_size, &foffset, map);
+            if (AR_EIODATA == status)
+            {
+                ACDB_ERR("Warning[%d]: Ignoring %d bytes of incomplete "
+                    "journal data at the end of the *.acdbdelta file",
+                    status, db_info->file_size - foffset);
+                ACDB_FREE(map);
+                status = AR_EOK;
+                break;
+            }
+        }
+        else
+        {
+            status = acdb_delta_parser_read_map(
+                db_info->file_handle, &foffset, map);
+        }
+
         if (AR_FAILED(status))
         {
             ACDB_ERR("Error[%d]: Failed to read map "
@@ -438,8 +614,16 @@ int32_t AcdbDeltaInitHeap(acdb_context_handle_t *handle)
             break;
         }
 
-        status = acdb_heap_ioctl(ACDB_HEAP_CMD_ADD_MAP_USING_HANDLE,
-            &map_handle_info, sizeof(acdb_delta_data_map_t), NULL, 0);
+        if (should_merge)
+        {
+            status = DataProcSetMapToHeap(map);
+        }
+        else
+        {
+            status = acdb_heap_ioctl(ACDB_HEAP_CMD_ADD_MAP_USING_HANDLE,
+                &map_handle_info, sizeof(acdb_delta_data_map_t), NULL, 0);
+        }
+
         if (AR_FAILED(status))
         {
             ACDB_ERR("Error[%d]: Failed to add map to the heap.", status);
@@ -449,74 +633,38 @@ int32_t AcdbDeltaInitHeap(acdb_context_handle_t *handle)
 
     if (AR_FAILED(status))
     {
-        uint32_t status2 = acdb_heap_ioctl(ACDB_HEAP_CMD_CLEAR_DATABASE_HEAP,
+        int32_t status2 = acdb_heap_ioctl(ACDB_HEAP_CMD_CLEAR_DATABASE_HEAP,
             handle->heap_handle, sizeof(acdb_heap_handle_t), NULL, 0);
         if (AR_FAILED(status2))
         {
             ACDB_ERR("Error[%d]: Unable to clear the heap.", status2);
         }
+
+        db_info->needs_compaction = TRUE;
+        return status;
     }
 
+    db_info->snapshot_size = snapshot_size;
+    db_info->journal_size = foffset > snapshot_size ?
+        foffset - snapshot_size : 0;
+
+    /* Merged data, an older file version or a damaged journal tail all
+     * require the next save to rewrite the file */
+    db_info->needs_compaction = should_merge ||
+        file_header.delta_minor < ACDB_DELTA_FILE_VERSION_MINOR ||
+        foffset != db_info->file_size;
+
     return status;
 }
 
-int32_t AcdbDeltaUpdateHeap(acdb_context_handle_t* handle)
+int32_t AcdbDeltaInitHeap(acdb_context_handle_t *handle)
 {
-    int32_t status = AR_EOK;
-    uint32_t foffset = sizeof(AcdbDeltaFileHeader);
-    acdb_delta_data_map_t* map = NULL;
-    AcdbDeltaFileManDatabaseInfo* db_info = NULL;
-
-    if (IsNull(handle))
-        return AR_EBADPARAM;
-
-    db_info = (AcdbDeltaFileManDatabaseInfo*)handle->delta_manager_handle;
-
-    if (IsNull(db_info))
-        return AR_EHANDLE;
-
-    while (foffset < db_info->file_size)
-    {
-        map = ACDB_MALLOC(acdb_delta_data_map_t, 1);
-
-        if (IsNull(map))
-        {
-            ACDB_ERR("Error[%d]: Failed to allocate memory "
-                "for delta data map.", status);
-            status = AR_ENOMEMORY;
-            break;
-        }
-
-        ACDB_CLEAR_BUFFER(*map);
-
-        status = acdb_delta_parser_read_map(
-            db_info->file_handle, &foffset, map);
-        if (AR_FAILED(status))
-        {
-            ACDB_ERR("Error[%d]: Failed to read map "
-                "from the *.acdbdelta file.", status);
-            break;
-        }
-
-        status = DataProcSetMapToHeap(map);
-        if (AR_FAILED(status))
-        {
-            ACDB_ERR("Error[%d]: Unable to set map to the heap.", status);
-            break;
-        }
-    }
-
-    if (AR_EOK != status)
-    {
-        status = acdb_heap_ioctl(ACDB_HEAP_CMD_CLEAR_DATABASE_HEAP,
-            handle->heap_handle, sizeof(acdb_heap_handle_t), NULL, 0);
-        if (AR_FAILED(status))
-        {
-            ACDB_ERR("Error[%d]: Unable to clear the heap.", status);
-        }
-    }
+    return AcdbDeltaLoadFile(handle, FALSE);
+}
 
-    return status;
+int32_t AcdbDeltaUpdateHeap(acdb_context_handle_t* handle)
+{
+    return AcdbDeltaLoadFile(handle, TRUE);
 }
 
 int32_t AcdbDeltaDeleteFile(uint32_t database_index)
@@ -549,6 +697,8 @@ int32_t AcdbDeltaDeleteFile(uint32_t database_index)
         return status;
     }
 
+    *fhandle = NULL;
+
     status = AcdbInitUtilDeleteDeltaFileData(
         file_name_info.path, file_name_info.path_len,
         &ACDB_DFM_DB_INFO_AT_INDEX(database_index)->delta_file_path);
@@ -557,6 +707,7 @@ int32_t AcdbDeltaDeleteFile(uint32_t database_index)
 
     ACDB_DFM_DB_INFO_AT_INDEX(database_index)->exists = FALSE;
     ACDB_DFM_DB_INFO_AT_INDEX(database_index)->is_updated = FALSE;
+    ACDB_DFM_DB_INFO_AT_INDEX(database_index)->needs_compaction = TRUE;
 
     return status;
 }
@@ -630,6 +781,11 @@ int32_t AcdbDeltaDataSwapDelta(AcdbDeltaDataSwapInfo *swap_info)
     db_info->file_size = delta_info.properties.file_size;
     db_info->delta_file_path = delta_info.delta_path;
 
+    /* The heap does not reflect the new file until it is loaded */
+    db_info->snapshot_size = 0;
+    db_info->journal_size = 0;
+    db_info->needs_compaction = TRUE;
+
     return status;
 }
 
@@ -749,11 +905,13 @@ int32_t acdb_delta_data_ioctl(uint32_t cmd_id,
         }
 
         acdb_delta_persist_state = *(AcdbDeltaPersistState*)req;
+        acdb_ctx_man_update_data_version();
     }
     break;
     case ACDB_DELTA_DATA_CMD_RESET:
     {
         status = AcdbDeltaDataCmdReset();
+        acdb_ctx_man_update_data_version();
     }
     break;
     case ACDB_DELTA_DATA_CMD_GET_FILE_VERSION:
@@ -816,6 +974,7 @@ int32_t acdb_delta_data_ioctl(uint32_t cmd_id,
     case ACDB_DELTA_DATA_CMD_DELETE_ALL_FILES:
     {
         status = AcdbDeltaDeleteFile(0);//todo: check this last
+        acdb_ctx_man_update_data_version();
     }
     break;
     case ACDB_DELTA_DATA_CMD_GET_FILE_COUNT:
@@ -836,6 +995,7 @@ int32_t acdb_delta_data_ioctl(uint32_t cmd_id,
         }
 
         status = AcdbDeltaDataSwapDelta((AcdbDeltaDataSwapInfo*)req);
+        acdb_ctx_man_update_data_version();
     }
     break;
     case ACDB_DELTA_DATA_CMD_IS_FILE_AT_PATH:
@@ -28,6 +28,9 @@
   * Preprocessor Definitions and Constants
   *--------------------------------------------------------------------------- */
 
+#define ACDB_DELTA_FNV_OFFSET_BASIS 0x811c9dc5
+#define ACDB_DELTA_FNV_PRIME 0x01000193
+
 /* ---------------------------------------------------------------------------
  * Type Declarations
  *--------------------------------------------------------------------------- */
@@ -70,8 +73,8 @@ int32_t acdb_delta_parser_verify_file_version(
 
 	//File version must not be higher than the Software File Version
 
-	if ((header->delta_major == 1 && header->delta_minor == 0) // ||
-		/*(header->major == ?? && header->minor == ??)*/)
+	//v1.1 appends a journal to the v1.0 snapshot of maps
+	if (header->delta_major == 1 && header->delta_minor <= 1)
 	{
 		status =  ACDB_PARSE_SUCCESS;
 	}
@@ -128,8 +131,10 @@ int32_t acdb_delta_parser_is_file_valid(
 		return ACDB_PARSE_INVALID_FILE;
 	}
 
-	if (file_size != file_header.file_data_size
-        + (sizeof(AcdbDeltaFileHeader) - sizeof(uint32_t)))
+	/* Only v1.1 files have journal records after the snapshot */
+	if (file_size < acdb_delta_parser_get_snapshot_size(&file_header) ||
+		(file_header.delta_minor == 0 &&
+		file_size != acdb_delta_parser_get_snapshot_size(&file_header)))
 	{
 		ACDB_ERR("Error[%d]: The delta file data section size %d is incorrect."
             " It should be %d bytes",
@@ -141,6 +146,12 @@ int32_t acdb_delta_parser_is_file_valid(
 	return status;
 }
 
+uint32_t acdb_delta_parser_get_snapshot_size(AcdbDeltaFileHeader *file_header)
+{
+	return file_header->file_data_size
+		+ (sizeof(AcdbDeltaFileHeader) - sizeof(uint32_t));
+}
+
 int32_t acdb_delta_parser_get_file_version(
 	ar_fhandle fhandle, uint32_t file_size,
 	acdb_delta_file_version_t* delta_finfo)
@@ -520,188 +531,316 @@ int32_t acdb_delta_parser_write_file_header(
 	return AR_EOK;
 }
 
-int32_t acdb_delta_parser_write_delta_data(
-	ar_fhandle fhandle, AcdbDeltaPersistanceData *persist_data)
+static uint32_t acdb_delta_parser_get_delta_data_size(
+	AcdbDeltaPersistanceData *persist_data)
 {
-	int32_t status = AR_EOK;
-	size_t bytes_written = 0;
-	AcdbDeltaModuleCalData cal_data;
+	uint32_t size = sizeof(uint32_t);
+	AcdbDeltaModuleCalData *cal_data = NULL;
+	LinkedListNode *cur_node = persist_data->cal_data_list.p_head;
 
-	status = ar_fwrite(fhandle, &persist_data->data_size, sizeof(uint32_t), &bytes_written);
-	if (AR_EOK != status)
+	if (persist_data->data_size == 0)
+		return size;
+
+	while (!IsNull(cur_node))
 	{
-		ACDB_ERR_MSG_1("Unable to write global/non-global data size.", status);
-		return AR_EFAILED;
+		cal_data = (AcdbDeltaModuleCalData*)cur_node->p_struct;
+		size += 3 * sizeof(uint32_t) + cal_data->param_size;
+		cur_node = cur_node->p_next;
 	}
 
-	if (persist_data->data_size == 0)
+	return size;
+}
+
+static AcdbGraphKeyVector *acdb_delta_parser_get_map_key_vector(
+	acdb_delta_data_map_t *map)
+{
+	switch (map->key_vector_type)
 	{
-		return AR_EOK;
+	case TAG_KEY_VECTOR:
+		return &((AcdbModuleTag*)map->key_vector_data)->tag_key_vector;
+	case CAL_KEY_VECTOR:
+		return (AcdbGraphKeyVector*)map->key_vector_data;
+	default:
+		return NULL;
 	}
+}
 
+/**
+* \brief
+*		Returns the number of bytes acdb_delta_parser_serialize_map
+*		writes for map, or zero if the map has no key vector
+*/
+static uint32_t acdb_delta_parser_get_map_size(acdb_delta_data_map_t *map)
+{
+	uint32_t size = 0;
+	AcdbGraphKeyVector *key_vector = NULL;
+	AcdbDeltaSubgraphData *sg_data = NULL;
+	LinkedListNode *sg_data_node = NULL;
+
+	if (IsNull(map->key_vector_data))
+		return 0;
+
+	key_vector = acdb_delta_parser_get_map_key_vector(map);
+	if (IsNull(key_vector))
+		return 0;
+
+	//<kv type, [tag id], num keys, key vector, map size, num subgraphs>
+	size = sizeof(uint32_t);
+	if (TAG_KEY_VECTOR == map->key_vector_type)
+		size += sizeof(uint32_t);
+	size += sizeof(uint32_t) + key_vector->num_keys * sizeof(AcdbKeyValuePair);
+	size += 2 * sizeof(uint32_t);
+
+	sg_data_node = map->subgraph_data_list.p_head;
+	while (!IsNull(sg_data_node))
+	{
+		sg_data = (AcdbDeltaSubgraphData*)sg_data_node->p_struct;
+		size += 2 * sizeof(uint32_t);
+		size += acdb_delta_parser_get_delta_data_size(&sg_data->non_global_data);
+		size += acdb_delta_parser_get_delta_data_size(&sg_data->global_data);
+		sg_data_node = sg_data_node->p_next;
+	}
+
+	return size;
+}
+
+static void acdb_delta_parser_put(
+	uint8_t *buf, uint32_t *offset, const void *src, uint32_t size)
+{
+	if (size == 0)
+		return;
+
+	ACDB_MEM_CPY_SAFE(buf + *offset, size, src, size);
+	*offset += size;
+}
+
+static void acdb_delta_parser_serialize_delta_data(uint8_t *buf, uint32_t *offset,
+	AcdbDeltaPersistanceData *persist_data)
+{
+	AcdbDeltaModuleCalData *cal_data = NULL;
 	LinkedListNode *cur_node = persist_data->cal_data_list.p_head;
+
+	acdb_delta_parser_put(buf, offset,
+		&persist_data->data_size, sizeof(uint32_t));
+
+	if (persist_data->data_size == 0)
+		return;
+
 	while (!IsNull(cur_node))
 	{
-		cal_data = *((AcdbDeltaModuleCalData*)cur_node->p_struct);
+		cal_data = (AcdbDeltaModuleCalData*)cur_node->p_struct;
 
-		status = ar_fwrite(fhandle, &cal_data.module_iid, sizeof(uint32_t), &bytes_written);
-		if (AR_EOK != status)
-		{
-			ACDB_ERR_MSG_1("Unable to write Module Instance ID.", status);
-			return AR_EFAILED;
-		}
+		//<iid, pid, param size, payload>
+		acdb_delta_parser_put(buf, offset, cal_data, 3 * sizeof(uint32_t));
+		acdb_delta_parser_put(buf, offset,
+			cal_data->param_payload, cal_data->param_size);
 
-		status = ar_fwrite(fhandle, &cal_data.param_id, sizeof(uint32_t), &bytes_written);
-		if (AR_EOK != status)
-		{
-			ACDB_ERR_MSG_1("Unable to write Parameter ID.", status);
-			return AR_EFAILED;
-		}
+		cur_node = cur_node->p_next;
+	}
+}
 
-		status = ar_fwrite(fhandle, &cal_data.param_size, sizeof(uint32_t), &bytes_written);
-		if (AR_EOK != status)
-		{
-			ACDB_ERR_MSG_1("Unable to write Parameter Size.", status);
-			return AR_EFAILED;
-		}
+/**
+* \brief
+*		Writes map into buf in the delta file map format. buf must hold at
+*		least acdb_delta_parser_get_map_size(map) bytes
+*/
+static void acdb_delta_parser_serialize_map(
+	acdb_delta_data_map_t *map, uint8_t *buf, uint32_t *offset)
+{
+	AcdbGraphKeyVector *key_vector = acdb_delta_parser_get_map_key_vector(map);
+	AcdbDeltaSubgraphData *sg_data = NULL;
+	LinkedListNode *sg_data_node = NULL;
 
-		status = ar_fwrite(fhandle, (uint8_t*)cal_data.param_payload, (size_t)cal_data.param_size, &bytes_written);
-		if (AR_EOK != status)
-		{
-			ACDB_ERR_MSG_1("Unable to write Parameter Payload.", status);
-			return AR_EFAILED;
-		}
+	acdb_delta_parser_put(buf, offset, &map->key_vector_type, sizeof(uint32_t));
 
-		cur_node = cur_node->p_next;
+	if (TAG_KEY_VECTOR == map->key_vector_type)
+	{
+		acdb_delta_parser_put(buf, offset,
+			&((AcdbModuleTag*)map->key_vector_data)->tag_id, sizeof(uint32_t));
 	}
 
-	return AR_EOK;
+	acdb_delta_parser_put(buf, offset, &key_vector->num_keys, sizeof(uint32_t));
+	acdb_delta_parser_put(buf, offset, key_vector->graph_key_vector,
+		key_vector->num_keys * sizeof(AcdbKeyValuePair));
+	acdb_delta_parser_put(buf, offset, &map->map_size, sizeof(uint32_t));
+	acdb_delta_parser_put(buf, offset, &map->num_subgraphs, sizeof(uint32_t));
+
+	sg_data_node = map->subgraph_data_list.p_head;
+	while (!IsNull(sg_data_node))
+	{
+		sg_data = (AcdbDeltaSubgraphData*)sg_data_node->p_struct;
+
+		acdb_delta_parser_put(buf, offset,
+			&sg_data->subgraph_id, sizeof(uint32_t));
+		acdb_delta_parser_put(buf, offset,
+			&sg_data->subgraph_data_size, sizeof(uint32_t));
+		acdb_delta_parser_serialize_delta_data(
+			buf, offset, &sg_data->non_global_data);
+		acdb_delta_parser_serialize_delta_data(
+			buf, offset, &sg_data->global_data);
+
+		sg_data_node = sg_data_node->p_next;
+	}
 }
 
-int32_t acdb_delta_parser_write_map(
-	ar_fhandle fhandle, acdb_delta_data_map_t *map)
+static uint32_t acdb_delta_parser_checksum(const uint8_t *buf, uint32_t size)
 {
-	int32_t status = AR_EOK;
-    AcdbModuleTag* module_tag = NULL;
-    AcdbGraphKeyVector* key_vector = NULL;
-	if (IsNull(map)) return AR_EBADPARAM;
+	uint32_t checksum = ACDB_DELTA_FNV_OFFSET_BASIS;
 
-	uint32_t i = 0;
-	size_t bytes_written = 0;
+	for (uint32_t i = 0; i < size; i++)
+	{
+		checksum ^= buf[i];
+		checksum *= ACDB_DELTA_FNV_PRIME;
+	}
 
-    status = ar_fwrite(fhandle, &map->key_vector_type, sizeof(uint32_t), &bytes_written);
-    if (AR_EOK != status)
-    {
-        ACDB_ERR_MSG_1("Unable to write key vector type", status);
-        return AR_EFAILED;
-    }
+	return checksum;
+}
 
-    //Write Module Tag or Graph Key Vector depending on KV type
-    switch (map->key_vector_type)
-    {
-    case TAG_KEY_VECTOR:
-        module_tag = ((AcdbModuleTag*)map->key_vector_data);
-        status = ar_fwrite(fhandle, &module_tag->tag_id, sizeof(uint32_t), &bytes_written);
-        if (AR_EOK != status)
-        {
-            ACDB_ERR_MSG_1("Unable to write module tag", status);
-            return AR_EFAILED;
-        }
+/**
+* \brief
+*		Serializes map after header_size reserved bytes and writes the
+*		result with a single write so the map is never partially flushed
+*		field by field
+*/
+static int32_t acdb_delta_parser_write_map_buffer(ar_fhandle fhandle,
+	acdb_delta_data_map_t *map, AcdbDeltaJournalRecordHeader *header,
+	uint32_t *bytes)
+{
+	int32_t status = AR_EOK;
+	uint32_t map_size = 0;
+	uint32_t header_size = IsNull(header) ? 0 :
+		sizeof(AcdbDeltaJournalRecordHeader);
+	uint32_t offset = header_size;
+	size_t bytes_written = 0;
+	uint8_t *buf = NULL;
 
-        key_vector = &module_tag->tag_key_vector;
+	if (IsNull(map)) return AR_EBADPARAM;
 
-        if (IsNull(key_vector))
-        {
-            ACDB_ERR("Map Tag Key Vector is null");
-            return AR_EBADPARAM;
-        }
-        break;
-    case CAL_KEY_VECTOR:
-        key_vector = ((AcdbGraphKeyVector*)map->key_vector_data);
+	map_size = acdb_delta_parser_get_map_size(map);
+	if (map_size == 0)
+	{
+		ACDB_ERR("Error[%d]: The Map Key Vector is null", AR_EBADPARAM);
+		return AR_EBADPARAM;
+	}
 
-        if (IsNull(key_vector))
-        {
-            ACDB_ERR("Map Calibration Key Vector is null");
-            return AR_EBADPARAM;
-        }
-        break;
-    default:
-        break;
-    }
+	buf = ACDB_MALLOC(uint8_t, (header_size + map_size));
+	if (IsNull(buf))
+	{
+		ACDB_ERR("Error[%d]: Unable to allocate %d bytes to write map",
+			AR_ENOMEMORY, header_size + map_size);
+		return AR_ENOMEMORY;
+	}
 
-    if (IsNull(key_vector))
-    {
-        ACDB_ERR("The Map Key Vector is null");
-        return AR_EBADPARAM;
-    }
+	acdb_delta_parser_serialize_map(map, buf, &offset);
 
-	status = ar_fwrite(fhandle, &key_vector->num_keys, sizeof(uint32_t), &bytes_written);
-	if (AR_EOK != status)
+	if (!IsNull(header))
 	{
-		ACDB_ERR_MSG_1("Unable to write number of cal key vector key pairs", status);
-		return AR_EFAILED;
+		header->tag = ACDB_DELTA_JOURNAL_RECORD_TAG;
+		header->record_size = map_size;
+		header->checksum = acdb_delta_parser_checksum(
+			buf + header_size, map_size);
+		ACDB_MEM_CPY_SAFE(buf, header_size, header, header_size);
 	}
 
-	for (i = 0; i < key_vector->num_keys; i++)
+	status = ar_fwrite(fhandle, buf, header_size + map_size, &bytes_written);
+	if (AR_EOK != status || bytes_written != header_size + map_size)
 	{
-		status = ar_fwrite(fhandle, &key_vector->graph_key_vector[i], sizeof(AcdbKeyValuePair), &bytes_written);
-		if (AR_EOK != status)
-		{
-			ACDB_ERR_MSG_1("Unable to write the calibration key vector", status);
-			return AR_EFAILED;
-		}
+		ACDB_ERR_MSG_1("Unable to write map", status);
+		status = AR_EFAILED;
 	}
-
-	status = ar_fwrite(fhandle, &map->map_size, sizeof(uint32_t), &bytes_written);
-	if (AR_EOK != status)
+	else if (!IsNull(bytes))
 	{
-		ACDB_ERR_MSG_1("Unable to write map size", status);
-		return AR_EFAILED;
+		*bytes = header_size + map_size;
 	}
 
-	status = ar_fwrite(fhandle, &map->num_subgraphs, sizeof(uint32_t), &bytes_written);
-	if (AR_EOK != status)
+	ACDB_FREE(buf);
+	return status;
+}
+
+int32_t acdb_delta_parser_write_map(
+	ar_fhandle fhandle, acdb_delta_data_map_t *map)
+{
+	return acdb_delta_parser_write_map_buffer(fhandle, map, NULL, NULL);
+}
+
+int32_t acdb_delta_parser_write_journal_record(
+	ar_fhandle fhandle, acdb_delta_data_map_t *map, uint32_t *record_size)
+{
+	AcdbDeltaJournalRecordHeader header = { 0 };
+
+	return acdb_delta_parser_write_map_buffer(
+		fhandle, map, &header, record_size);
+}
+
+int32_t acdb_delta_parser_read_journal_record(
+	ar_fhandle fhandle, uint32_t file_size, uint32_t *offset,
+	acdb_delta_data_map_t *map)
+{
+	int32_t status = AR_EOK;
+	uint32_t bytes_read = 0;
+	uint32_t map_offset = 0;
+	uint8_t *buf = NULL;
+	AcdbDeltaJournalRecordHeader header = { 0 };
+
+	if (IsNull(offset) || IsNull(map))
+		return AR_EBADPARAM;
+
+	if (*offset > file_size ||
+		file_size - *offset < sizeof(AcdbDeltaJournalRecordHeader))
+		return AR_EIODATA;
+
+	bytes_read = *offset;
+	status = file_seek_read(fhandle, &header,
+		sizeof(AcdbDeltaJournalRecordHeader), &bytes_read);
+	if (AR_FAILED(status))
 	{
-		ACDB_ERR_MSG_1("Unable to write number of subgraph", status);
-		return AR_EFAILED;
+		ACDB_ERR("Error[%d]: Unable to read journal record header", status);
+		return status;
 	}
 
-	LinkedListNode *sg_data_node = map->subgraph_data_list.p_head;
-	AcdbDeltaSubgraphData *sg_data = NULL;
+	map_offset = bytes_read;
 
-	do
+	if (header.tag != ACDB_DELTA_JOURNAL_RECORD_TAG ||
+		header.record_size == 0 ||
+		header.record_size > file_size - map_offset)
+		return AR_EIODATA;
+
+	buf = ACDB_MALLOC(uint8_t, header.record_size);
+	if (IsNull(buf))
 	{
-		sg_data = (AcdbDeltaSubgraphData*)sg_data_node->p_struct;
+		ACDB_ERR("Error[%d]: Unable to allocate %d bytes to read journal "
+			"record", AR_ENOMEMORY, header.record_size);
+		return AR_ENOMEMORY;
+	}
 
-		status = ar_fwrite(fhandle, &sg_data->subgraph_id, sizeof(uint32_t), &bytes_written);
-		if (AR_EOK != status)
-		{
-			ACDB_ERR_MSG_1("Unable to write the subgraph ID", status);
-			return AR_EFAILED;
-		}
+	status = file_seek_read(fhandle, buf, header.record_size, &bytes_read);
+	if (AR_SUCCEEDED(status) &&
+		(bytes_read - map_offset != header.record_size ||
+		header.checksum !=
+		acdb_delta_parser_checksum(buf, header.record_size)))
+	{
+		status = AR_EIODATA;
+	}
 
-		status = ar_fwrite(fhandle, &sg_data->subgraph_data_size, sizeof(uint32_t), &bytes_written);
-		if (AR_EOK != status)
-		{
-			ACDB_ERR_MSG_1("Unable to write the subgraph data size", status);
-			return AR_EFAILED;
-		}
+	ACDB_FREE(buf);
 
-		status = acdb_delta_parser_write_delta_data(fhandle, &sg_data->non_global_data);
-		if (AR_EOK != status)
-		{
-			ACDB_ERR_MSG_1("Unable to write non-global persistance data", status);
-			return AR_EFAILED;
-		}
+	if (AR_FAILED(status))
+		return status;
 
-		status = acdb_delta_parser_write_delta_data(fhandle, &sg_data->global_data);
-		if (AR_EOK != status)
-		{
-			ACDB_ERR_MSG_1("Unable to write global persistance data", status);
-			return AR_EFAILED;
-		}
+	status = acdb_delta_parser_read_map(fhandle, &map_offset, map);
+	if (AR_FAILED(status))
+		return status;
 
-	} while (TRUE != AcdbListSetNext(&sg_data_node));
+	/* The checksum matched, so a size mismatch is a writer bug rather
+	 * than a record cut short by a crash */
+	if (map_offset != bytes_read)
+	{
+		ACDB_ERR("Error[%d]: The journal record at offset %d holds %d "
+			"bytes but its map ends at offset %d", AR_EFAILED, *offset,
+			header.record_size, map_offset);
+		return AR_EFAILED;
+	}
 
-	return AR_EOK;
+	*offset = bytes_read;
+	return status;
 }
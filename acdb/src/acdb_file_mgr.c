@@ -121,6 +121,8 @@ struct _acdb_file_man_database_info_t {
     uint32_t database_cache_size;
     /**< A pointer to the database file cached in memory */
     void* database_cache;
+    /**< The chunks in the database sorted by chunk id */
+    acdb_chunk_directory_t chunk_directory;
     /**< The path to the database file */
     acdb_path_256_t database_file;
     /**< The path where the database files reside */
@@ -536,6 +538,7 @@ int32_t AcdbFileManAddAcdb(int32_t index, uint32_t *vm_id,
     db_info->file_index = index;
     db_info->database_cache = file_info->file.buffer;
     db_info->database_cache_size = file_info->file.size;
+    db_info->chunk_directory = file_info->chunk_directory;
     db_info->file_handle = file_info->file_handle;
     db_info->file_type = file_info->file_type;
     db_info->database_file.path_len = file_info->path_length;
@@ -705,6 +708,7 @@ int32_t AcdbFileManRemoveDatabase(acdb_file_man_handle_t *fm_handle)
     bool_t had_workspace = 0;
     AcdbFileManDatabaseInfo *db_info = NULL;
     AcdbFileManWorkspaceInfo *ws_info = NULL;
+    acdb_buffer_t database_cache = { 0 };
 
     if (IsNull(fm_handle))
         return AR_EBADPARAM;
@@ -719,7 +723,10 @@ int32_t AcdbFileManRemoveDatabase(acdb_file_man_handle_t *fm_handle)
     if (!IsNull(db_info->file_handle))
         (void)ar_fclose(db_info->file_handle);
 
-    AcbdInitUnloadInMemFile(db_info->database_cache);
+    database_cache.buffer = db_info->database_cache;
+    database_cache.size = db_info->database_cache_size;
+    (void)AcbdInitUnloadInMemFile(&database_cache);
+    acdb_parser_free_chunk_directory(&db_info->chunk_directory);
     ACDB_FREE(db_info);
 
     if (!IsNull(ws_info))
@@ -1381,6 +1388,11 @@ int32_t AcdbFileManGetQwspFileData(AcdbFileManWorkspaceInfo* ws_info,
         data_copy_size = (size_t)req->file_data_len;
     }
 
+    if (data_copy_size > rsp->size)
+    {
+        data_copy_size = (size_t)rsp->size;
+    }
+
     status = AcdbFileManQwspFileIO(ws_info, ACDB_FM_FILE_OP_OPEN);
     if (AR_FAILED(status)) return status;
 
@@ -1444,6 +1456,11 @@ int32_t AcdbFileManGetAcdbFileData(AcdbFileManDatabaseInfo *db_info,
         data_copy_size = (size_t)req->file_data_len;
     }
 
+    if (data_copy_size > rsp->size)
+    {
+        data_copy_size = (size_t)rsp->size;
+    }
+
     status = acdb_fm_read_db_mem((acdb_file_man_handle_t)db_info, rsp->buf,
         data_copy_size, &req->file_offset);
     if (AR_FAILED(status))
@@ -1457,8 +1474,168 @@ int32_t AcdbFileManGetAcdbFileData(AcdbFileManDatabaseInfo *db_info,
     return status;
 }
 
-int32_t AcdbFileManGetDatabaseFileSet(
-    AcdbFileManGetFileDataReq* req, AcdbFileManBlob* rsp)
+int32_t AcdbFileManStreamQwspFileData(AcdbFileManWorkspaceInfo* ws_info,
+    AcdbFileManGetFileDataReq* req, AcdbFileManStream *stream)
+{
+    int32_t status = AR_EOK;
+    uint32_t total_size = 0;
+    size_t read_size = 0;
+    size_t bytes_read = 0;
+
+    if (IsNull(req) || IsNull(ws_info) || IsNull(stream) || IsNull(stream->write))
+    {
+        ACDB_ERR("Error[%d]: One or more input parameters are null",
+            AR_EBADPARAM);
+        return AR_EBADPARAM;
+    }
+
+    if (ws_info->file_size < req->file_offset)
+    {
+        ACDB_ERR("Error[%d]: The provided offset is past the end of the file",
+            AR_EBADPARAM);
+        return AR_EBADPARAM;
+    }
+
+    total_size = ws_info->file_size - req->file_offset;
+    if (total_size > req->file_data_len)
+    {
+        total_size = req->file_data_len;
+    }
+
+    if (total_size > 0 && (IsNull(stream->buf) || 0 == stream->size))
+    {
+        ACDB_ERR("Error[%d]: A scratch buffer is required to read %s",
+            AR_EBADPARAM, ws_info->workspace_file.path);
+        return AR_EBADPARAM;
+    }
+
+    status = AcdbFileManQwspFileIO(ws_info, ACDB_FM_FILE_OP_OPEN);
+    if (AR_FAILED(status)) return status;
+
+    status = ar_fseek(ws_info->file_handle,
+        req->file_offset, AR_FSEEK_BEGIN);
+    if (AR_FAILED(status))
+    {
+        ACDB_ERR("Error[%d]: Failed to seek to file offset %d",
+            status, req->file_offset);
+        goto end;
+    }
+
+    /* The workspace file is not cached, so it is read one scratch buffer
+     * at a time */
+    do
+    {
+        read_size = (size_t)(total_size - stream->bytes_streamed);
+        if (read_size > stream->size)
+        {
+            read_size = (size_t)stream->size;
+        }
+
+        if (read_size > 0)
+        {
+            bytes_read = 0;
+            status = ar_fread(ws_info->file_handle,
+                (void*)stream->buf, read_size, &bytes_read);
+            if (AR_FAILED(status) || bytes_read != read_size)
+            {
+                ACDB_ERR("Error[%d]: Failed to read data for %s. "
+                    "Expected %d bytes, but read %d bytes",
+                    status, ws_info->workspace_file.path,
+                    read_size, bytes_read);
+                status = AR_FAILED(status) ? status : AR_EFAILED;
+                goto end;
+            }
+        }
+
+        status = stream->write(stream->context, total_size,
+            stream->buf, (uint32_t)read_size);
+        if (AR_FAILED(status))
+        {
+            ACDB_ERR("Error[%d]: Failed to write data for %s",
+                status, ws_info->workspace_file.path);
+            goto end;
+        }
+
+        stream->bytes_streamed += (uint32_t)read_size;
+    } while (stream->bytes_streamed < total_size);
+
+end:
+
+    AcdbFileManQwspFileIO(ws_info, ACDB_FM_FILE_OP_CLOSE);
+    return status;
+}
+
+int32_t AcdbFileManStreamAcdbFileData(AcdbFileManDatabaseInfo *db_info,
+    AcdbFileManGetFileDataReq* req, AcdbFileManStream *stream)
+{
+    int32_t status = AR_EOK;
+    uint32_t total_size = 0;
+    uint32_t offset = 0;
+    void *file_ptr = NULL;
+
+    if (IsNull(req) || IsNull(db_info) || IsNull(stream) || IsNull(stream->write))
+    {
+        ACDB_ERR("Error[%d]: One or more input parameters are null",
+            AR_EBADPARAM);
+        return AR_EBADPARAM;
+    }
+
+    if (db_info->database_cache_size < req->file_offset)
+    {
+        ACDB_ERR("Error[%d]: The provided offset is past the end of the file",
+            AR_EBADPARAM);
+        return AR_EBADPARAM;
+    }
+
+    total_size = db_info->database_cache_size - req->file_offset;
+    if (total_size > req->file_data_len)
+    {
+        total_size = req->file_data_len;
+    }
+
+    /* The database is cached in memory, so the data is passed to the
+     * callback without copying it */
+    offset = req->file_offset;
+    status = acdb_fm_get_db_mem_ptr((acdb_file_man_handle_t)db_info,
+        &file_ptr, total_size, &offset);
+    if (AR_FAILED(status))
+    {
+        ACDB_ERR("Error[%d]: Failed to get data from %s",
+            status, db_info->database_file.path);
+        return status;
+    }
+
+    status = stream->write(stream->context, total_size,
+        (const uint8_t*)file_ptr, total_size);
+    if (AR_FAILED(status))
+    {
+        ACDB_ERR("Error[%d]: Failed to write data for %s",
+            status, db_info->database_file.path);
+        return status;
+    }
+
+    stream->bytes_streamed += total_size;
+    return status;
+}
+
+/**
+* \brief
+*       Finds the loaded database file (*.qwsp or *.acdb) named in a
+*       file data request
+*
+* \param[in] req: The file data request
+* \param[out] db_info: The database that owns the file
+* \param[out] ws_info: The workspace of the database
+* \param[out] path_type: Indicates whether the file is the workspace
+*                        or the database file
+*
+* \return AR_EOK on success, non-zero otherwise
+*/
+static int32_t AcdbFileManFindDatabaseFile(
+    AcdbFileManGetFileDataReq* req,
+    AcdbFileManDatabaseInfo** db_info_out,
+    AcdbFileManWorkspaceInfo** ws_info_out,
+    AcdbPathType* path_type_out)
 {
     int32_t status = AR_EOK;
     char_t* fname = NULL;
@@ -1473,12 +1650,6 @@ int32_t AcdbFileManGetDatabaseFileSet(
     const char* WKSP_FILE_NAME_EXT = ".qwsp";
     const char* ACDB_FILE_NAME_EXT = ".acdb";
 
-    if (req == NULL || rsp == NULL)
-    {
-        ACDB_ERR("Error[%d]: One or more input parameter(s) are null");
-        return AR_EBADPARAM;
-    }
-
     for (uint32_t i = 0; i < db_count; i++)
     {
         db_info = ACDB_FM_DB_INFO_AT_INDEX(i);
@@ -1533,7 +1704,31 @@ int32_t AcdbFileManGetDatabaseFileSet(
         return AR_ENOTEXIST;
     }
 
-    status = AR_EOK;
+    *db_info_out = db_info;
+    *ws_info_out = ws_info;
+    *path_type_out = path_type;
+    return AR_EOK;
+}
+
+int32_t AcdbFileManGetDatabaseFileSet(
+    AcdbFileManGetFileDataReq* req, AcdbFileManBlob* rsp)
+{
+    int32_t status = AR_EOK;
+    AcdbFileManDatabaseInfo* db_info = NULL;
+    AcdbFileManWorkspaceInfo* ws_info = NULL;
+    AcdbPathType path_type = ACDB_PATH_TYPE_NONE;
+
+    if (req == NULL || rsp == NULL)
+    {
+        ACDB_ERR("Error[%d]: One or more input parameter(s) are null");
+        return AR_EBADPARAM;
+    }
+
+    status = AcdbFileManFindDatabaseFile(req, &db_info, &ws_info, &path_type);
+    if (AR_FAILED(status))
+    {
+        return status;
+    }
 
     switch (path_type)
     {
@@ -1556,6 +1751,44 @@ int32_t AcdbFileManGetDatabaseFileSet(
     return status;
 }
 
+int32_t AcdbFileManStreamDatabaseFileSet(
+    AcdbFileManGetFileDataReq* req, AcdbFileManStream* stream)
+{
+    int32_t status = AR_EOK;
+    AcdbFileManDatabaseInfo* db_info = NULL;
+    AcdbFileManWorkspaceInfo* ws_info = NULL;
+    AcdbPathType path_type = ACDB_PATH_TYPE_NONE;
+
+    if (req == NULL || stream == NULL)
+    {
+        ACDB_ERR("Error[%d]: One or more input parameter(s) are null",
+            AR_EBADPARAM);
+        return AR_EBADPARAM;
+    }
+
+    status = AcdbFileManFindDatabaseFile(req, &db_info, &ws_info, &path_type);
+    if (AR_FAILED(status))
+    {
+        return status;
+    }
+
+    switch (path_type)
+    {
+    case ACDB_PATH_TYPE_QWSP_FILE:
+        status = AcdbFileManStreamQwspFileData(ws_info, req, stream);
+        break;
+    case ACDB_PATH_TYPE_ACDB_FILE:
+        status = AcdbFileManStreamAcdbFileData(db_info, req, stream);
+        break;
+    default:
+        ACDB_ERR("Error[%d]: The file type for %s is unknown",
+            AR_EUNEXPECTED, db_info->database_file.path);
+        return AR_EUNEXPECTED;
+    }
+
+    return status;
+}
+
 int32_t AcdbFileManSetWritablePath(
     acdb_file_man_writable_path_info_t* info)
 {
@@ -1696,11 +1929,21 @@ int32_t acdb_get_db_chunk(acdb_file_man_handle_t handle,
         return AR_EBADPARAM;
 
     AcdbFileManDatabaseInfo* db = (AcdbFileManDatabaseInfo*)handle;
+    int32_t status = AR_EOK;
+
+    if (!IsNull(db->chunk_directory.chunks))
+    {
+        status = acdb_parser_find_chunk(&db->chunk_directory,
+            chunk_id, chunk_offset, chunk_size);
+    }
+    else
+    {
+        status = acdb_parser_get_chunk(
+            db->database_cache,
+            db->database_cache_size,
+            chunk_id, chunk_offset, chunk_size);
+    }
 
-    int32_t status = acdb_parser_get_chunk(
-        db->database_cache,
-        db->database_cache_size,
-        chunk_id, chunk_offset, chunk_size);
     if (AR_FAILED(status))
     {
         ACDB_DBG("Error[%d]: Failed to get information for Chunk[0x%x]",
@@ -2099,6 +2342,19 @@ int32_t acdb_file_man_ioctl(uint32_t cmd_id,
         status = AcdbFileManGetWritablePath(req);
         break;
     }
+    case ACDB_FILE_MAN_STREAM_DATABASE_FILE_SET:
+    {
+        if (req == NULL || req_size == 0 ||
+            rsp == NULL || rsp_size != sizeof(AcdbFileManStream))
+        {
+            return AR_EBADPARAM;
+        }
+
+        status = AcdbFileManStreamDatabaseFileSet(
+            (AcdbFileManGetFileDataReq*)req,
+            (AcdbFileManStream*)rsp);
+        break;
+    }
     default:
         status = AR_EUNSUPPORTED;
         ACDB_ERR("Error[%d]: Unsupported Command[%08X]", status, cmd_id);
@@ -0,0 +1,482 @@
+/**
+*=============================================================================
+* \file acdb_gkv_index.c
+*
+* \brief
+*		Implements the in-memory hash index over the GKV Key Table and
+*		GKV Lookup Table chunks of a database.
+*
+* \copyright
+*  Copyright (c) Qualcomm Innovation Center, Inc. All rights reserved.
+*  SPDX-License-Identifier: BSD-3-Clause
+*
+*=============================================================================
+*/
+
+/* ---------------------------------------------------------------------------
+* Include Files
+*--------------------------------------------------------------------------- */
+
+#include "acdb_gkv_index.h"
+#include "acdb_file_mgr.h"
+#include "acdb_parser.h"
+#include "acdb_common.h"
+
+/* ---------------------------------------------------------------------------
+* Preprocessor Definitions and Constants
+*--------------------------------------------------------------------------- */
+
+/**< The smallest number of slots in an index table */
+#define ACDB_GKV_INDEX_MIN_CAPACITY 16
+
+/**< Hash value reserved for empty slots */
+#define ACDB_GKV_INDEX_EMPTY_SLOT 0
+
+/* ---------------------------------------------------------------------------
+* Type Declarations
+*--------------------------------------------------------------------------- */
+
+typedef struct _acdb_gkv_index_entry_t AcdbGkvIndexEntry;
+struct _acdb_gkv_index_entry_t
+{
+    /**< Hash of the key ids (and values for lookup table entries).
+    ACDB_GKV_INDEX_EMPTY_SLOT marks an unused slot */
+    uint32_t hash;
+    /**< Number of keys in the key vector */
+    uint32_t num_keys;
+    /**< Key ids stored in the GKV Key Table of the database cache */
+    const uint32_t *key_ids;
+    /**< Values stored in the GKV Lookup Table of the database cache.
+    NULL for key table entries */
+    const uint32_t *values;
+    /**< Key table entries: offset of the value lookup table.
+    Lookup table entries: offset of the value lookup table the
+    entry belongs to */
+    uint32_t lut_offset;
+    /**< Lookup table entries: the subgraph list and property data offsets */
+    acdb_graph_info_t graph_info;
+};
+
+typedef struct _acdb_gkv_index_table_t AcdbGkvIndexTable;
+struct _acdb_gkv_index_table_t
+{
+    /**< Number of slots. Always a power of two */
+    uint32_t capacity;
+    /**< Number of used slots */
+    uint32_t count;
+    /**< The slots of the open-addressing table */
+    AcdbGkvIndexEntry *entries;
+};
+
+typedef struct _acdb_gkv_index_t AcdbGkvIndex;
+struct _acdb_gkv_index_t
+{
+    /**< Maps a list of key ids to a value lookup table offset */
+    AcdbGkvIndexTable key_table;
+    /**< Maps a list of key ids and values to graph info */
+    AcdbGkvIndexTable lut_table;
+};
+
+/* ---------------------------------------------------------------------------
+* Static Functions
+*--------------------------------------------------------------------------- */
+
+static uint32_t acdb_gkv_index_mix(uint32_t hash, uint32_t word)
+{
+    hash ^= word;
+    hash *= 0x01000193;
+    return hash;
+}
+
+static uint32_t acdb_gkv_index_finalize(uint32_t hash)
+{
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6b;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35;
+    hash ^= hash >> 16;
+
+    return hash == ACDB_GKV_INDEX_EMPTY_SLOT ? 1 : hash;
+}
+
+static uint32_t acdb_gkv_index_hash_table_row(uint32_t num_keys,
+    const uint32_t *key_ids, const uint32_t *values)
+{
+    uint32_t hash = 0x811c9dc5;
+
+    hash = acdb_gkv_index_mix(hash, num_keys);
+    for (uint32_t i = 0; i < num_keys; i++)
+    {
+        hash = acdb_gkv_index_mix(hash, key_ids[i]);
+        if (!IsNull(values))
+            hash = acdb_gkv_index_mix(hash, values[i]);
+    }
+
+    return acdb_gkv_index_finalize(hash);
+}
+
+static uint32_t acdb_gkv_index_hash_gkv(AcdbGraphKeyVector *gkv,
+    bool_t include_values)
+{
+    uint32_t hash = 0x811c9dc5;
+
+    hash = acdb_gkv_index_mix(hash, gkv->num_keys);
+    for (uint32_t i = 0; i < gkv->num_keys; i++)
+    {
+        hash = acdb_gkv_index_mix(hash, gkv->graph_key_vector[i].key);
+        if (include_values)
+            hash = acdb_gkv_index_mix(hash, gkv->graph_key_vector[i].value);
+    }
+
+    return acdb_gkv_index_finalize(hash);
+}
+
+static bool_t acdb_gkv_index_entry_matches(AcdbGkvIndexEntry *entry,
+    AcdbGraphKeyVector *gkv)
+{
+    if (entry->num_keys != gkv->num_keys)
+        return FALSE;
+
+    for (uint32_t i = 0; i < gkv->num_keys; i++)
+    {
+        if (entry->key_ids[i] != gkv->graph_key_vector[i].key)
+            return FALSE;
+
+        if (!IsNull(entry->values) &&
+            entry->values[i] != gkv->graph_key_vector[i].value)
+            return FALSE;
+    }
+
+    return TRUE;
+}
+
+static int32_t acdb_gkv_index_table_alloc(AcdbGkvIndexTable *table,
+    uint32_t num_entries)
+{
+    uint32_t capacity = ACDB_GKV_INDEX_MIN_CAPACITY;
+
+    /* Keep the load factor at or below 0.5 to bound probe lengths */
+    while (capacity < 2 * num_entries)
+        capacity <<= 1;
+
+    table->entries = ACDB_MALLOC(AcdbGkvIndexEntry, capacity);
+    if (IsNull(table->entries))
+        return AR_ENOMEMORY;
+
+    ar_mem_set(table->entries, 0, capacity * sizeof(AcdbGkvIndexEntry));
+    table->capacity = capacity;
+    table->count = 0;
+
+    return AR_EOK;
+}
+
+static void acdb_gkv_index_table_insert(AcdbGkvIndexTable *table,
+    AcdbGkvIndexEntry *new_entry)
+{
+    uint32_t mask = table->capacity - 1;
+    uint32_t slot = new_entry->hash & mask;
+    AcdbGkvIndexEntry *entry = NULL;
+
+    for (uint32_t probe = 0; probe < table->capacity; probe++)
+    {
+        entry = &table->entries[slot];
+
+        if (ACDB_GKV_INDEX_EMPTY_SLOT == entry->hash)
+        {
+            *entry = *new_entry;
+            table->count++;
+            return;
+        }
+
+        /* Keep the first occurrence of a duplicate row to match the
+        * result of searching the table */
+        if (entry->hash == new_entry->hash &&
+            entry->num_keys == new_entry->num_keys &&
+            0 == ar_mem_cmp((void*)entry->key_ids, (void*)new_entry->key_ids,
+                entry->num_keys * sizeof(uint32_t)) &&
+            (IsNull(entry->values) ||
+            0 == ar_mem_cmp((void*)entry->values, (void*)new_entry->values,
+                entry->num_keys * sizeof(uint32_t))))
+        {
+            return;
+        }
+
+        slot = (slot + 1) & mask;
+    }
+}
+
+static AcdbGkvIndexEntry *acdb_gkv_index_table_find(AcdbGkvIndexTable *table,
+    uint32_t hash, AcdbGraphKeyVector *gkv)
+{
+    uint32_t mask = 0;
+    uint32_t slot = 0;
+    AcdbGkvIndexEntry *entry = NULL;
+
+    if (0 == table->capacity)
+        return NULL;
+
+    mask = table->capacity - 1;
+    slot = hash & mask;
+
+    for (uint32_t probe = 0; probe < table->capacity; probe++)
+    {
+        entry = &table->entries[slot];
+
+        if (ACDB_GKV_INDEX_EMPTY_SLOT == entry->hash)
+            return NULL;
+
+        if (entry->hash == hash && acdb_gkv_index_entry_matches(entry, gkv))
+            return entry;
+
+        slot = (slot + 1) & mask;
+    }
+
+    return NULL;
+}
+
+/**
+* \brief
+*		Walks the GKV Key Table and, for each key table row, the GKV Lookup
+*		Table it references. When build is FALSE the rows are only counted.
+*/
+static int32_t acdb_gkv_index_walk(acdb_file_man_handle_t fm_handle,
+    AcdbGkvIndex *index, bool_t build,
+    uint32_t *num_key_rows, uint32_t *num_lut_rows)
+{
+    int32_t status = AR_EOK;
+    uint32_t offset = 0;
+    uint32_t lut_offset = 0;
+    uint32_t lut_read_offset = 0;
+    uint32_t num_key_tables = 0;
+    uint32_t key_entry_words = 0;
+    uint32_t lut_entry_words = 0;
+    uint32_t key_chunk_offset = 0;
+    uint32_t key_chunk_size = 0;
+    uint32_t lut_chunk_offset = 0;
+    uint32_t lut_chunk_size = 0;
+    uint32_t *key_rows = NULL;
+    uint32_t *key_row = NULL;
+    uint32_t *lut_rows = NULL;
+    uint32_t *lut_row = NULL;
+    KeyTableHeader key_table_header = { 0 };
+    KeyTableHeader lut_header = { 0 };
+    AcdbGkvIndexEntry entry = { 0 };
+
+    *num_key_rows = 0;
+    *num_lut_rows = 0;
+
+    status = acdb_get_db_chunk(fm_handle, ACDB_CHUNKID_GKVKEYTBL,
+        &key_chunk_offset, &key_chunk_size);
+    if (AR_FAILED(status))
+        return status;
+
+    status = acdb_get_db_chunk(fm_handle, ACDB_CHUNKID_GKVLUTTBL,
+        &lut_chunk_offset, &lut_chunk_size);
+    if (AR_FAILED(status))
+        return status;
+
+    offset = key_chunk_offset;
+    status = acdb_fm_read_db_mem(fm_handle,
+        &num_key_tables, sizeof(uint32_t), &offset);
+    if (AR_FAILED(status))
+        return status;
+
+    if (num_key_tables > key_chunk_size)
+    {
+        ACDB_ERR("Error[%d]: Number of GKV tables %d is greater than the "
+            "table size %d.", AR_EFAILED, num_key_tables, key_chunk_size);
+        return AR_EFAILED;
+    }
+
+    for (uint32_t i = 0; i < num_key_tables; i++)
+    {
+        status = acdb_fm_read_db_mem(fm_handle,
+            &key_table_header, sizeof(KeyTableHeader), &offset);
+        if (AR_FAILED(status))
+            return status;
+
+        //Key IDs + GKVLUT Offset
+        key_entry_words = key_table_header.num_keys + 1;
+        status = acdb_fm_get_db_mem_ptr(fm_handle, (void**)&key_rows,
+            (size_t)key_table_header.num_entries
+            * key_entry_words * sizeof(uint32_t), &offset);
+        if (AR_FAILED(status))
+            return status;
+
+        for (uint32_t j = 0; j < key_table_header.num_entries; j++)
+        {
+            key_row = key_rows + (size_t)j * key_entry_words;
+            lut_offset = key_row[key_table_header.num_keys];
+            (*num_key_rows)++;
+
+            if (build)
+            {
+                ar_mem_set(&entry, 0, sizeof(AcdbGkvIndexEntry));
+                entry.num_keys = key_table_header.num_keys;
+                entry.key_ids = key_row;
+                entry.lut_offset = lut_offset;
+                entry.hash = acdb_gkv_index_hash_table_row(
+                    entry.num_keys, entry.key_ids, NULL);
+                acdb_gkv_index_table_insert(&index->key_table, &entry);
+            }
+
+            lut_read_offset = lut_chunk_offset + lut_offset;
+            status = acdb_fm_read_db_mem(fm_handle,
+                &lut_header, sizeof(KeyTableHeader), &lut_read_offset);
+            if (AR_FAILED(status))
+                return status;
+
+            /* Mismatched tables can never satisfy a lookup */
+            if (lut_header.num_keys != key_table_header.num_keys)
+                continue;
+
+            //Values + SG List Offset + SG Data Offset
+            lut_entry_words = lut_header.num_keys + 2;
+            status = acdb_fm_get_db_mem_ptr(fm_handle, (void**)&lut_rows,
+                (size_t)lut_header.num_entries
+                * lut_entry_words * sizeof(uint32_t), &lut_read_offset);
+            if (AR_FAILED(status))
+                return status;
+
+            *num_lut_rows += lut_header.num_entries;
+
+            if (!build)
+                continue;
+
+            for (uint32_t k = 0; k < lut_header.num_entries; k++)
+            {
+                lut_row = lut_rows + (size_t)k * lut_entry_words;
+
+                ar_mem_set(&entry, 0, sizeof(AcdbGkvIndexEntry));
+                entry.num_keys = lut_header.num_keys;
+                entry.key_ids = key_row;
+                entry.values = lut_row;
+                entry.lut_offset = lut_offset;
+                entry.graph_info.sg_list_offset =
+                    lut_row[lut_header.num_keys];
+                entry.graph_info.sg_prop_data_offset =
+                    lut_row[lut_header.num_keys + 1];
+                entry.hash = acdb_gkv_index_hash_table_row(
+                    entry.num_keys, entry.key_ids, entry.values);
+                acdb_gkv_index_table_insert(&index->lut_table, &entry);
+            }
+        }
+    }
+
+    return status;
+}
+
+/* ---------------------------------------------------------------------------
+* Public Functions
+*--------------------------------------------------------------------------- */
+
+int32_t acdb_gkv_index_create(acdb_file_man_handle_t fm_handle,
+    acdb_gkv_index_handle_t *index_handle)
+{
+#ifdef ACDB_GKV_INDEX_DISABLE
+    __UNREFERENCED_PARAM(fm_handle);
+    if (!IsNull(index_handle))
+        *index_handle = NULL;
+    return AR_EUNSUPPORTED;
+#else
+    int32_t status = AR_EOK;
+    uint32_t num_key_rows = 0;
+    uint32_t num_lut_rows = 0;
+    AcdbGkvIndex *index = NULL;
+
+    if (IsNull(fm_handle) || IsNull(index_handle))
+        return AR_EBADPARAM;
+
+    *index_handle = NULL;
+
+    status = acdb_gkv_index_walk(fm_handle, NULL, FALSE,
+        &num_key_rows, &num_lut_rows);
+    if (AR_FAILED(status))
+    {
+        ACDB_ERR("Error[%d]: Unable to read the GKV tables", status);
+        return status;
+    }
+
+    index = ACDB_MALLOC(AcdbGkvIndex, 1);
+    if (IsNull(index))
+        return AR_ENOMEMORY;
+
+    ar_mem_set(index, 0, sizeof(AcdbGkvIndex));
+
+    status = acdb_gkv_index_table_alloc(&index->key_table, num_key_rows);
+    if (AR_FAILED(status))
+        goto end;
+
+    status = acdb_gkv_index_table_alloc(&index->lut_table, num_lut_rows);
+    if (AR_FAILED(status))
+        goto end;
+
+    status = acdb_gkv_index_walk(fm_handle, index, TRUE,
+        &num_key_rows, &num_lut_rows);
+    if (AR_FAILED(status))
+        goto end;
+
+    ACDB_DBG("Indexed %d GKV key table entries and %d GKV lookup table "
+        "entries", index->key_table.count, index->lut_table.count);
+
+    *index_handle = (acdb_gkv_index_handle_t)index;
+
+end:
+    if (AR_FAILED(status))
+    {
+        ACDB_ERR("Error[%d]: Unable to build the GKV index", status);
+        acdb_gkv_index_destroy((acdb_gkv_index_handle_t)index);
+    }
+
+    return status;
+#endif
+}
+
+void acdb_gkv_index_destroy(acdb_gkv_index_handle_t index_handle)
+{
+    AcdbGkvIndex *index = (AcdbGkvIndex*)index_handle;
+
+    if (IsNull(index))
+        return;
+
+    ACDB_FREE(index->key_table.entries);
+    ACDB_FREE(index->lut_table.entries);
+    ACDB_FREE(index);
+}
+
+int32_t acdb_gkv_index_find_lut_offset(acdb_gkv_index_handle_t index_handle,
+    AcdbGraphKeyVector *gkv, uint32_t *gkv_lut_offset)
+{
+    AcdbGkvIndex *index = (AcdbGkvIndex*)index_handle;
+    AcdbGkvIndexEntry *entry = NULL;
+
+    if (IsNull(index) || IsNull(gkv) || IsNull(gkv_lut_offset))
+        return AR_EBADPARAM;
+
+    entry = acdb_gkv_index_table_find(&index->key_table,
+        acdb_gkv_index_hash_gkv(gkv, FALSE), gkv);
+    if (IsNull(entry))
+        return AR_ENOTEXIST;
+
+    *gkv_lut_offset = entry->lut_offset;
+    return AR_EOK;
+}
+
+int32_t acdb_gkv_index_find_graph(acdb_gkv_index_handle_t index_handle,
+    AcdbGraphKeyVector *gkv, uint32_t gkv_lut_offset,
+    acdb_graph_info_t *graph_info)
+{
+    AcdbGkvIndex *index = (AcdbGkvIndex*)index_handle;
+    AcdbGkvIndexEntry *entry = NULL;
+
+    if (IsNull(index) || IsNull(gkv) || IsNull(graph_info))
+        return AR_EBADPARAM;
+
+    entry = acdb_gkv_index_table_find(&index->lut_table,
+        acdb_gkv_index_hash_gkv(gkv, TRUE), gkv);
+    if (IsNull(entry) || entry->lut_offset != gkv_lut_offset)
+        return AR_ENOTEXIST;
+
+    *graph_info = entry->graph_info;
+    return AR_EOK;
+}
@@ -24,7 +24,8 @@
 
 #define ACDB_MAX(a,b) (((a) > (b)) ? (a) : (b))
 #define ACDB_MIN(a,b) (((a) < (b)) ? (a) : (b))
-#define HEX_DIGITS 8
+#define ACDB_HEAP_FNV_OFFSET_BASIS 0xcbf29ce484222325ULL
+#define ACDB_HEAP_FNV_PRIME 0x100000001b3ULL
 #define ACDB_MAX_ACDB_FILES 16
 
 /**< A File Manager macro that simplifies accessing the database info within the
@@ -95,64 +96,37 @@ int32_t acdb_heap_clear(acdb_heap_handle_t handle);
 
 /**
 * \breif
-*	Converts a key vector to a string.
-*	Caller is responsible for freeing the returned string pointer
+*	Computes a 64-bit FNV-1a hash over the number of keys and the
+*	binary <key, value> pairs of a key vector.
 *
-* \return pointer to key vector string on succes, null on failure
+* \return the key vector hash
 */
-char *acdb_heap_key_vector_to_string(
-    const AcdbGraphKeyVector *key_vector, size_t *sz_str_key_vector)
+static uint64_t acdb_heap_hash_key_vector(const AcdbGraphKeyVector *key_vector)
 {
-	/* Example
-	Format	: <key, value>...<key, value>
-	Input	: <0xA, 0x1><0xB, 0x1><0xC, 0x1>
-	Output  : 'A1B1C1' in Big Endian
-	*/
-	if (IsNull(key_vector)) return NULL;
-
-	uint32_t offset = 0;
-	//Max Key Vector String length = 8 * 2 * key_vector->num_keys;
-	size_t str_size = 0;
-	//8 Hex Digits in 32-bit integer * 2 members in <key,value>
-    uint32_t sz_str_kv_pair = 16 + 1;
-	char tmp[16 + 1] = "";
-	char *key_vector_str = NULL;
-
-	for (uint32_t i = 0; i < key_vector->num_keys; i++)
-	{
-        if (0 > ar_sprintf(tmp, sz_str_kv_pair, "%08x%08x",
-            key_vector->graph_key_vector[i].key,
-            key_vector->graph_key_vector[i].value))
-        {
-            return NULL;
-        }
-        str_size += ar_strlen(tmp, (size_t)sz_str_kv_pair);
-	}
+    uint64_t hash = ACDB_HEAP_FNV_OFFSET_BASIS;
+    const uint8_t *byte = NULL;
+    size_t size = 0;
 
-	str_size += 1;// '\0'
+    if (IsNull(key_vector)) return hash;
 
-	key_vector_str = ACDB_MALLOC(char, str_size);
-	if (IsNull(key_vector_str)) return NULL;
-	memset(key_vector_str, 0, str_size);
+    byte = (const uint8_t*)&key_vector->num_keys;
+    for (size_t i = 0; i < sizeof(key_vector->num_keys); i++)
+    {
+        hash ^= byte[i];
+        hash *= ACDB_HEAP_FNV_PRIME;
+    }
 
-	for (uint32_t i = 0; i < key_vector->num_keys; i++)
-	{
-        if (key_vector_str + offset < key_vector_str + str_size)
-        {
-            if (0 > ar_sprintf(key_vector_str + offset, sz_str_kv_pair,
-                "%08x%08x",
-                key_vector->graph_key_vector[i].key,
-                key_vector->graph_key_vector[i].value))
-            {
-                ACDB_FREE(key_vector_str);
-                return NULL;
-            }
-            offset = (uint32_t)ar_strlen(key_vector_str, str_size);
-        }
-	}
+    if (IsNull(key_vector->graph_key_vector)) return hash;
+
+    byte = (const uint8_t*)key_vector->graph_key_vector;
+    size = key_vector->num_keys * sizeof(AcdbKeyValuePair);
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= byte[i];
+        hash *= ACDB_HEAP_FNV_PRIME;
+    }
 
-	*sz_str_key_vector = offset;
-	return key_vector_str;
+    return hash;
 }
 
 /**
@@ -188,22 +162,6 @@ AcdbGraphKeyVector *get_key_vector_from_map(
     return kv;
 }
 
-bool_t acdb_tree_is_leaf(AcdbTreeNode *tnode)
-{
-    if (tnode == NULL)
-        return FALSE;
-
-    //or if the depth of the node is zero
-
-    //No left or right subtrees, but has a parent, so it must be a leaf
-    if (IsNull(tnode->left) && IsNull(tnode->right) &&
-        !IsNull(tnode->parent))
-    {
-        return TRUE;
-    }
-    return FALSE;
-}
-
 bool_t acdb_tree_is_tree_empty(AcdbTreeNode *root)
 {
     if (IsNull(root) ||
@@ -217,77 +175,23 @@ bool_t acdb_tree_is_tree_empty(AcdbTreeNode *root)
     return FALSE;
 }
 
-bool_t acdb_tree_is_tree(AcdbTreeNode *tnode)
+int32_t acdb_tree_depth(AcdbTreeNode *tnode)
 {
-    return !acdb_tree_is_leaf(tnode);
+    return IsNull(tnode) ? 0 : tnode->depth;
 }
 
-bool_t acdb_tree_is_balanced(AcdbTreeNode *tnode, int32_t *factor)
+void acdb_tree_update_depth(AcdbTreeNode *tnode)
 {
-    //difference = right.depth - left.depth
-    //-1 - left heavy
-    // 0 - balanced
-    // 1 - right heavy
-    int32_t diff = 0;
-
-    //if both left and right are non-null this is the equivalent of
-    //diff = tnode->right->depth - tnode->left->depth;
-    if (!acdb_tree_is_leaf(tnode))
-    {
-        if (!IsNull(tnode->right))
-        {
-            diff += tnode->right->depth;
-        }
-        if (!IsNull(tnode->left))
-        {
-            diff += -1 * tnode->left->depth;
-        }
-    }
-
-    *factor = diff;
-
-    if (diff < -1 || diff > 1)
-        return FALSE;
-
-    return TRUE;
+    tnode->depth = 1 + ACDB_MAX(
+        acdb_tree_depth(tnode->left), acdb_tree_depth(tnode->right));
 }
 
-void acdb_tree_update_depth(AcdbTreeNode *tnode)
+int32_t acdb_tree_balance_factor(AcdbTreeNode *tnode)
 {
-    AcdbTreeNode *p_cur_node;
-    p_cur_node = tnode;
-
-    while (p_cur_node != NULL)
-    {
-        if (IsNull(p_cur_node))
-        {
-            break;
-        }
-
-        if (!acdb_tree_is_leaf(p_cur_node) && !IsNull(p_cur_node))
-        {
-            if (IsNull(p_cur_node->right))
-            {
-                p_cur_node->depth = 1 + p_cur_node->left->depth;
-            }
-            else if (IsNull(p_cur_node->left))
-            {
-                p_cur_node->depth = 1 + p_cur_node->right->depth;
-            }
-            else
-            {
-                p_cur_node->depth = 1 + ACDB_MAX(p_cur_node->left->depth, p_cur_node->right->depth);
-            }
-        }
-        else if (acdb_tree_is_leaf(p_cur_node) && !IsNull(p_cur_node))
-        {
-            p_cur_node->depth = 1;
-        }
-
-        p_cur_node = p_cur_node->parent;
-    }
-
-    p_cur_node = NULL;
+    //-1 - left heavy
+    // 0 - balanced
+    // 1 - right heavy
+    return acdb_tree_depth(tnode->right) - acdb_tree_depth(tnode->left);
 }
 
 int32_t acdb_tree_direction(AcdbTreeNode *p_x, AcdbTreeNode *p_y)
@@ -301,9 +205,28 @@ int32_t acdb_tree_direction(AcdbTreeNode *p_x, AcdbTreeNode *p_y)
         return TREE_DIR_NONE;
     }
 
-    int32_t direction = strcmp(
-        ((KVSubgraphMapBin*)p_x->p_struct)->str_key_vector,
-        ((KVSubgraphMapBin*)p_y->p_struct)->str_key_vector);
+    /* Order by hash, then by length and finally by the binary key vector.
+     * Only bins with equal hashes fall through to the memory compare */
+    int32_t direction = 0;
+    KVSubgraphMapBin *bin_x = (KVSubgraphMapBin*)p_x->p_struct;
+    KVSubgraphMapBin *bin_y = (KVSubgraphMapBin*)p_y->p_struct;
+
+    if (bin_x->kv_hash != bin_y->kv_hash)
+    {
+        direction = bin_x->kv_hash < bin_y->kv_hash ? -1 : 1;
+    }
+    else if (bin_x->key_vector.num_keys != bin_y->key_vector.num_keys)
+    {
+        direction = bin_x->key_vector.num_keys <
+            bin_y->key_vector.num_keys ? -1 : 1;
+    }
+    else if (bin_x->key_vector.num_keys != 0)
+    {
+        direction = ACDB_MEM_CMP(
+            bin_x->key_vector.graph_key_vector,
+            bin_y->key_vector.graph_key_vector,
+            bin_x->key_vector.num_keys * sizeof(AcdbKeyValuePair));
+    }
 
     if (direction < 0)
     {
@@ -317,127 +240,100 @@ int32_t acdb_tree_direction(AcdbTreeNode *p_x, AcdbTreeNode *p_y)
     return TREE_DIR_NONE;
 }
 
-void acdb_tree_rotate_right(AcdbTreeNode *p_a, AcdbTreeNode *p_c)
+/**
+* \breif
+*	Points the parent of p_old (or the root of the heap) at p_new
+*/
+void acdb_tree_replace_child(AcdbHeapInfo *db_heap,
+    AcdbTreeNode *p_old, AcdbTreeNode *p_new)
+{
+    AcdbTreeNode *p_parent = p_old->parent;
+
+    p_new->parent = p_parent;
+
+    if (IsNull(p_parent))
+        db_heap->root = p_new;
+    else if (p_parent->left == p_old)
+        p_parent->left = p_new;
+    else
+        p_parent->right = p_new;
+}
+
+AcdbTreeNode *acdb_tree_rotate_right(AcdbHeapInfo *db_heap,
+    AcdbTreeNode *p_a)
 {
     //Left heavy means right rotation
     //rotate right
     //    a
     //  b     =>  b
     //c         c   a
+    AcdbTreeNode *p_b = p_a->left;
 
-    AcdbTreeNode *p_b = p_c->parent;
-
-    p_b->parent = p_a->parent;
-    p_a->parent = p_b;
-
+    p_a->left = p_b->right;
     if (!IsNull(p_b->right))
-    {
         p_b->right->parent = p_a;
-    }
 
-    p_a->left = p_b->right;
+    acdb_tree_replace_child(db_heap, p_a, p_b);
     p_b->right = p_a;
-
-    if (TREE_DIR_LEFT == acdb_tree_direction(p_b, p_b->parent))
-    {
-        p_b->parent->left = p_b;
-    }
-    else if (TREE_DIR_RIGHT == acdb_tree_direction(p_b, p_b->parent))
-    {
-        p_b->parent->right = p_b;
-    }
+    p_a->parent = p_b;
 
     acdb_tree_update_depth(p_a);
-    acdb_tree_update_depth(p_c);
+    acdb_tree_update_depth(p_b);
+    return p_b;
 }
 
-void acdb_tree_rotate_left(AcdbTreeNode *p_a, AcdbTreeNode *p_c)
+AcdbTreeNode *acdb_tree_rotate_left(AcdbHeapInfo *db_heap,
+    AcdbTreeNode *p_a)
 {
     //Right heavy means left rotation
     //rotate left
     //a
     //  b     =>     b
     //   c         a   c
-    AcdbTreeNode *p_b = p_c->parent;
-
-    p_b->parent = p_a->parent;
-    p_a->parent = p_b;
+    AcdbTreeNode *p_b = p_a->right;
 
+    p_a->right = p_b->left;
     if (!IsNull(p_b->left))
-    {
         p_b->left->parent = p_a;
-    }
 
-    p_a->right = p_b->left;
+    acdb_tree_replace_child(db_heap, p_a, p_b);
     p_b->left = p_a;
-
-    if (TREE_DIR_LEFT == acdb_tree_direction(p_b, p_b->parent))
-    {
-        p_b->parent->left = p_b;
-    }
-    else if (TREE_DIR_RIGHT == acdb_tree_direction(p_b, p_b->parent))
-    {
-        p_b->parent->right = p_b;
-    }
+    p_a->parent = p_b;
 
     acdb_tree_update_depth(p_a);
-    acdb_tree_update_depth(p_c);
+    acdb_tree_update_depth(p_b);
+    return p_b;
 }
 
-void acdb_tree_rotate(AcdbTreeNode *p_a, AcdbTreeNode *p_c, int32_t factor)
+/**
+* \breif
+*	Rebalances the subtree rooted at p_a if it is more than one level
+*	heavier on one side
+*
+* \return the root of the subtree after rebalancing
+*/
+AcdbTreeNode *acdb_tree_rotate(AcdbHeapInfo *db_heap, AcdbTreeNode *p_a)
 {
-    //a - grand parent
-    //b - parent
-    //c - child
-    AcdbTreeNode *p_b = p_c->parent;
+    int32_t factor = acdb_tree_balance_factor(p_a);
 
-    //Single Rotation (Left, Right)
-    if (factor < -1 && TREE_DIR_LEFT == acdb_tree_direction(p_c, p_b))
+    if (factor < -1)
     {
-        acdb_tree_rotate_right(p_a, p_c);
-    }
-    else if (factor > 1 && TREE_DIR_RIGHT == acdb_tree_direction(p_c, p_b))
-    {
-        acdb_tree_rotate_left(p_a, p_c);
-    }
+        //Left-Right: rotate the left child left first
+        if (acdb_tree_balance_factor(p_a->left) > 0)
+            acdb_tree_rotate_left(db_heap, p_a->left);
 
-    //Double Rotation (Left-Right, Right-Left)
-    else if (factor < -1 && TREE_DIR_RIGHT == acdb_tree_direction(p_c, p_b))
-    {
-        //Left heavy means right rotation
-        //Left-Right, rotate left, the rotate right
-        //    a         a
-        //  b     =>  c      =>    c
-        //    c     b            b   a
-        //rotate_left(p_b, p_c);
-
-        p_c->parent = p_b->parent;
-        p_b->parent = p_c;
-        p_a->left = p_c;
-
-        p_b->right = p_c->left;
-        p_c->left = p_b;
-
-        acdb_tree_rotate_right(p_a, p_b);
+        return acdb_tree_rotate_right(db_heap, p_a);
     }
-    else if (factor > 1 && TREE_DIR_LEFT == acdb_tree_direction(p_c, p_b))
+    else if (factor > 1)
     {
-        //Right heavy means left rotation
-        //Right-Left, rotate right, the rotate left
-        //a           a
-        //  b     =>    c      =>    c
-        //c               b        a   b
-        //rotate_right(p_b, p_c);
+        //Right-Left: rotate the right child right first
+        if (acdb_tree_balance_factor(p_a->right) < 0)
+            acdb_tree_rotate_right(db_heap, p_a->right);
 
-        p_c->parent = p_b->parent;
-        p_b->parent = p_c;
-        p_a->right = p_c;
-
-        p_b->left = p_c->right;
-        p_c->right = p_b;
-
-        acdb_tree_rotate_left(p_a, p_b);
+        return acdb_tree_rotate_left(db_heap, p_a);
     }
+
+    return p_a;
 }
 
 int32_t acdb_stack_push(LinkedList* stack, LinkedListNode* node)
@@ -495,9 +391,11 @@ KVSubgraphMapBin *acdb_heap_create_map_bin(void)
     if (IsNull(bin))
         return NULL;
 
-    bin->str_key_vector_size = 0;
-    bin->str_key_vector = NULL;
+    bin->kv_hash = 0;
+    bin->key_vector.num_keys = 0;
+    bin->key_vector.graph_key_vector = NULL;
     bin->map = NULL;
+    bin->is_dirty = FALSE;
 
     return bin;
 }
@@ -624,7 +522,6 @@ void acdb_heap_free_map(acdb_delta_data_map_t *map)
 void acdb_heap_free_bin(KVSubgraphMapBin **bin)
 {
     acdb_heap_free_map((*bin)->map);
-    ACDB_FREE((*bin)->str_key_vector);
     ACDB_FREE(*bin);
     *bin = NULL;
 }
@@ -637,9 +534,8 @@ void acdb_heap_free_bin(KVSubgraphMapBin **bin)
 */
 int32_t acdb_heap_insert(acdb_heap_handle_t handle, AcdbTreeNode *tnode)
 {
-    int32_t factor = 0;
+    int32_t tree_dir = TREE_DIR_NONE;
     AcdbTreeNode *t = NULL;
-    AcdbTreeNode *u = NULL;
     AcdbHeapInfo* db_heap = NULL;
 
     if (IsNull(handle))
@@ -656,65 +552,42 @@ int32_t acdb_heap_insert(acdb_heap_handle_t handle, AcdbTreeNode *tnode)
 
     while (TRUE)
     {
-        if (TREE_DIR_LEFT == acdb_tree_direction(tnode, t))
+        tree_dir = acdb_tree_direction(tnode, t);
+
+        if (TREE_DIR_LEFT == tree_dir)
         {
             if (t->left == NULL)
             {
                 t->left = tnode;
-                tnode->parent = t;
-                acdb_tree_update_depth(t);
                 break;
             }
-            else
-            {
-                t = t->left;
-            }
+
+            t = t->left;
         }
-        else if (TREE_DIR_RIGHT == acdb_tree_direction(tnode, t))
+        else if (TREE_DIR_RIGHT == tree_dir)
         {
             if (t->right == NULL)
             {
                 t->right = tnode;
-                tnode->parent = t;
-                acdb_tree_update_depth(t);
                 break;
             }
-            else
-            {
-                t = t->right;
-            }
+
+            t = t->right;
         }
         else
         {
-            break;
+            return AR_EALREADY;
         }
     }
 
-    //Check balance and rotate when nessesary. Set the new root
-    u = tnode;
+    tnode->parent = t;
+
+    //Update depths up to the root and rotate where nessesary
     while (t != NULL)
     {
-        if (acdb_tree_is_balanced(t, &factor))
-        {
-            if (t->parent == NULL)
-            {
-                db_heap->root = t;
-            }
-
-            if (t->depth - u->depth >= 2)
-            {
-                u = u->parent;
-            }
-
-            t = t->parent;
-        }
-        else
-        {
-            //t - grandparent
-            //  - parent
-            //u - child
-            acdb_tree_rotate(t, u, factor);
-        }
+        acdb_tree_update_depth(t);
+        t = acdb_tree_rotate(db_heap, t);
+        t = t->parent;
     }
 
     return AR_EOK;
@@ -729,8 +602,8 @@ int32_t acdb_heap_insert(acdb_heap_handle_t handle, AcdbTreeNode *tnode)
 //}
 
 int32_t acdb_heap_get_bin(acdb_heap_handle_t handle,
-    size_t size_str_key_vector,
-    char* str_key_vector, KVSubgraphMapBin **bin)
+    uint64_t kv_hash, const AcdbGraphKeyVector *key_vector,
+    KVSubgraphMapBin **bin)
 {
     int32_t status = AR_EOK;
     int32_t tree_dir = TREE_DIR_NONE;
@@ -750,8 +623,9 @@ int32_t acdb_heap_get_bin(acdb_heap_handle_t handle,
         return AR_ENOTEXIST;
     }
 
-    tmp_bin.str_key_vector = str_key_vector;
-    tmp_bin.str_key_vector_size = (uint32_t)(size_str_key_vector);
+    tmp_bin.kv_hash = kv_hash;
+    tmp_bin.key_vector = *key_vector;
+    tmp_bin.map = NULL;
     tnode.depth = 1;
     tnode.left = NULL;
     tnode.right = NULL;
@@ -799,8 +673,6 @@ int32_t acdb_heap_get_bin(acdb_heap_handle_t handle,
             AR_EOK != status) break;
     }
 
-    tmp_bin.str_key_vector = NULL;
-    tmp_bin.str_key_vector_size = 0;
     t = NULL;
 
     return status;
@@ -889,13 +761,25 @@ int32_t acdb_heap_remove_database(acdb_heap_handle_t *handle)
     return status;
 }
 
+/**
+* \brief acdb_heap_add_delta_data_map
+*	Adds a map to the heap. If the heap already has a map for the key
+*	vector it is replaced, which is how newer delta file journal records
+*	override older ones.
+*
+* \param[in] should_use_active_handle: Use the active database heap
+*           instead of info->handle
+* \param[in] info: The heap handle and the map to add
+* \param[in] is_dirty: Whether the map needs to be saved to the delta file
+*
+* \return 0 on succes, non-zero on failure
+*/
 int32_t acdb_heap_add_delta_data_map(
     bool_t should_use_active_handle,
-    acdb_heap_map_handle_info_t* info)
+    acdb_heap_map_handle_info_t* info, bool_t is_dirty)
 {
     int32_t status = AR_EOK;
-    size_t size_str_key_vector = 0;
-    char_t* str_key_vector = NULL;
+    uint64_t kv_hash = 0;
     AcdbTreeNode* bin_node = NULL;
     KVSubgraphMapBin* bin = NULL;
     AcdbGraphKeyVector *map_key_vector = NULL;
@@ -921,15 +805,22 @@ int32_t acdb_heap_add_delta_data_map(
     if (IsNull(map_key_vector))
         return AR_EBADPARAM;
 
-    str_key_vector = acdb_heap_key_vector_to_string(
-        map_key_vector, &size_str_key_vector);
+    kv_hash = acdb_heap_hash_key_vector(map_key_vector);
 
     /* Check to see if Tree has the appropriate bin
      * Locate bin and append to linked list */
     status = acdb_heap_get_bin(heap_handle,
-        size_str_key_vector, str_key_vector, &bin);
+        kv_hash, map_key_vector, &bin);
     if (AR_SUCCEEDED(status))
     {
+        if (bin->map != info->map)
+        {
+            acdb_heap_free_map(bin->map);
+            bin->key_vector = *map_key_vector;
+            bin->map = info->map;
+        }
+
+        bin->is_dirty = bin->is_dirty || is_dirty;
         goto end;
     }
     else
@@ -949,12 +840,14 @@ int32_t acdb_heap_add_delta_data_map(
             goto end;
         }
 
-        bin->str_key_vector = str_key_vector;
-        bin->str_key_vector_size = (uint32_t)(size_str_key_vector);
+        /* The bin is freed together with the map, so it can refer to the
+         * key vector owned by the map instead of keeping a copy */
+        bin->kv_hash = kv_hash;
+        bin->key_vector = *map_key_vector;
         bin->map = info->map;
+        bin->is_dirty = is_dirty;
 
-        acdb_heap_insert(heap_handle, bin_node);
-        status = AR_EOK;
+        status = acdb_heap_insert(heap_handle, bin_node);
     }
 
 end:
@@ -962,7 +855,6 @@ end:
     {
         ACDB_FREE(bin_node);
         ACDB_FREE(bin);
-        ACDB_FREE(str_key_vector);
     }
 
     return status;
@@ -974,82 +866,60 @@ int32_t acdb_heap_get_ckv_subgraph_map(
 {
     int32_t status = AR_EOK;
     KVSubgraphMapBin *bin = NULL;
-    AcdbGraphKeyVector *map_key_vector = NULL;
-    acdb_delta_data_map_t *tmp_map = NULL;
-    size_t size_str_key_vector = 0;
     acdb_context_handle_t* handle = NULL;
-    char* str_key_vector = NULL;
 
     handle = acdb_ctx_man_get_active_handle();
 
     if (IsNull(handle) || IsNull(handle->heap_handle))
         return AR_EHANDLE;
 
-    str_key_vector = acdb_heap_key_vector_to_string(
-        cal_key_vector, &size_str_key_vector);
+    if (IsNull(cal_key_vector))
+        return AR_EBADPARAM;
 
+    /* A bin is only found when its key vector matches the
+     * cal key vector exactly */
     status = acdb_heap_get_bin(handle->heap_handle,
-        size_str_key_vector, str_key_vector, &bin);
+        acdb_heap_hash_key_vector(cal_key_vector), cal_key_vector, &bin);
 
     if (AR_EOK != status)
     {
         //ACDB_ERR("Key Vector not found in heap");
         //LogKeyVector(cal_key_vector);
-        goto end;
+        return status;
     }
 
-    tmp_map = (acdb_delta_data_map_t*)bin->map;
-
-    if (IsNull(tmp_map->key_vector_data))
+    if (IsNull(bin->map) || IsNull(bin->map->key_vector_data))
     {
-        if (!IsNull(str_key_vector))
-            ACDB_DBG("Map key vector data is null for "
-                "Key Vector<%s>", str_key_vector);
-        status = AR_ENOTEXIST;
-        goto end;
+        ACDB_DBG("Map key vector data is null for Key Vector with "
+            "%d keys", cal_key_vector->num_keys);
+        return AR_ENOTEXIST;
     }
 
-    switch (tmp_map->key_vector_type)
-    {
-    case TAG_KEY_VECTOR:
-        map_key_vector = &((AcdbModuleTag*)tmp_map->key_vector_data)->tag_key_vector;
-        break;
-    case CAL_KEY_VECTOR:
-        map_key_vector = ((AcdbGraphKeyVector*)tmp_map->key_vector_data);
-        break;
-    default:
-        if (!IsNull(str_key_vector))
-            ACDB_DBG("Unable to determine Key Vector type "
-                "for Key Vector<%s>", str_key_vector);
-        status = AR_ENOTEXIST;
-        goto end;
-    }
+    *map = bin->map;
 
-    //Compare Sorted Key Vectors and values
-    if (0 == ACDB_MEM_CMP(
-        cal_key_vector->graph_key_vector,
-        map_key_vector->graph_key_vector,
-        map_key_vector->num_keys * sizeof(AcdbKeyValuePair)))
-    {
-        *map = tmp_map;
-        tmp_map = NULL;
-    }
+    return status;
+}
 
-    if (IsNull(*map))
-    {
-        if(!IsNull(str_key_vector))
-            ACDB_DBG("KV Map does not exist for "
-                "Key Vector<%s>", str_key_vector);
-        status = AR_ENOTEXIST;
-    }
+int32_t acdb_heap_set_map_dirty(const AcdbGraphKeyVector *key_vector)
+{
+    int32_t status = AR_EOK;
+    KVSubgraphMapBin *bin = NULL;
+    acdb_context_handle_t* handle = NULL;
 
-    end:
-    if (!IsNull(str_key_vector))
-    {
-        ACDB_FREE(str_key_vector);
-        str_key_vector = NULL;
-    }
+    handle = acdb_ctx_man_get_active_handle();
+
+    if (IsNull(handle) || IsNull(handle->heap_handle))
+        return AR_EHANDLE;
 
+    if (IsNull(key_vector))
+        return AR_EBADPARAM;
+
+    status = acdb_heap_get_bin(handle->heap_handle,
+        acdb_heap_hash_key_vector(key_vector), key_vector, &bin);
+    if (AR_FAILED(status))
+        return status;
+
+    bin->is_dirty = TRUE;
     return status;
 }
 
@@ -1057,13 +927,17 @@ int32_t acdb_heap_get_ckv_subgraph_map(
 * \brief  acdb_heap_get_map_list
 *           Returns an aggregated list of all the maps in the tree using an
 *			inoder tree traversal(Left, Root, Right). Each node in map_list must be freed by caller.
+*           The dirty flag of every returned map is cleared since the
+*           maps are collected to be saved.
 * \param[out] map_list: A linked list of CKV Bin linked lists
+* \param[in] dirty_only: Only return the maps that changed since they
+*           were last returned
 *
 * \return
 * 0 -- Success
 * Nonzero -- Failure
 */
-int32_t acdb_heap_get_map_list(LinkedList **map_list)
+int32_t acdb_heap_get_map_list(LinkedList **map_list, bool_t dirty_only)
 {
     int32_t status = AR_EOK;
     AcdbTreeNode *cur_node = NULL;
@@ -1103,14 +977,19 @@ int32_t acdb_heap_get_map_list(LinkedList **map_list)
             ACDB_FREE(item_node);
 
             //Collect Key Vector Subgraph Maps and add/append to list
-            LinkedListNode *node = acdb_heap_create_list_node(
-                ((KVSubgraphMapBin*)cur_node->p_struct)->map);
+            KVSubgraphMapBin *bin = (KVSubgraphMapBin*)cur_node->p_struct;
+            cur_node = cur_node->right;
+
+            if (dirty_only && !bin->is_dirty)
+                continue;
+
+            LinkedListNode *node = acdb_heap_create_list_node(bin->map);
 			if (IsNull(node))
 			{
 				return AR_ENOMEMORY;
 			}
             AcdbListAppend(*map_list, node);
-            cur_node = cur_node->right;
+            bin->is_dirty = FALSE;
         }
     }
 
@@ -1266,37 +1145,22 @@ int32_t acdb_heap_get_heap_info(AcdbBufferContext *rsp)
 
             num_nodes++;
 
-            char* next_int = bin->str_key_vector;
-            char tmp[HEX_DIGITS + 1];
-            uint32_t num_keys = 0;
-
-            offset += sizeof(num_keys);//Make room to write number of keys
-            /** Get Key Vector
-             * This loop will write key followed by value for each key value pair.
-             * The str_key_vector is in the form A0000000A0000001B0000000B0000001 where
-             * key1.ID = A0000000 key1.Value = A0000001
-             * key2.ID = B0000000 key2.Value = B0000001
-             */
-            while (*next_int != '\0')
-            {
-                ACDB_MEM_CPY_SAFE(&tmp[0], HEX_DIGITS, next_int, HEX_DIGITS);//8 bytes for 8 hex digits
-
-                uint32_t key = 0;//(uint32_t)strtoul(&tmp[0], NULL, 16);
+            uint32_t num_keys = bin->key_vector.num_keys;
+            uint32_t sz_key_vector =
+                num_keys * (uint32_t)sizeof(AcdbKeyValuePair);
 
-                ar_sscanf(&tmp[0], "%08x", &key);
-                next_int += HEX_DIGITS;
+            /* Write the number of keys followed by the <key, value> pairs */
+            ACDB_MEM_CPY_SAFE(&rsp->buf[offset], sizeof(num_keys),
+                &num_keys, sizeof(num_keys));
+            offset += sizeof(num_keys);
 
-                //write to rsp buf
-                ACDB_MEM_CPY_SAFE(&rsp->buf[offset], sizeof(key), &key, sizeof(key));
-                offset += sizeof(key);
-                num_keys++;
+            if (sz_key_vector > 0)
+            {
+                ACDB_MEM_CPY_SAFE(&rsp->buf[offset], sz_key_vector,
+                    bin->key_vector.graph_key_vector, sz_key_vector);
+                offset += sz_key_vector;
             }
 
-            next_int = NULL;
-            num_keys = num_keys / 2;
-            ACDB_MEM_CPY_SAFE(&rsp->buf[offset - (num_keys * sizeof(AcdbKeyValuePair) + sizeof(num_keys))],
-                sizeof(num_keys), &num_keys, sizeof(num_keys));
-
             //Get Size of map
             acdb_delta_data_map_t *map =
                 (acdb_delta_data_map_t*)bin->map;
@@ -1372,7 +1236,7 @@ int32_t acdb_heap_ioctl(uint32_t cmd_id,
             NULL,
             (acdb_delta_data_map_t*)req
         };
-        status = acdb_heap_add_delta_data_map(TRUE, &info);
+        status = acdb_heap_add_delta_data_map(TRUE, &info, TRUE);
         break;
     }
     case ACDB_HEAP_CMD_ADD_MAP_USING_HANDLE:
@@ -1381,7 +1245,7 @@ int32_t acdb_heap_ioctl(uint32_t cmd_id,
             return AR_EBADPARAM;
 
         status = acdb_heap_add_delta_data_map(FALSE,
-            (acdb_heap_map_handle_info_t*)req);
+            (acdb_heap_map_handle_info_t*)req, FALSE);
         break;
     }
     case ACDB_HEAP_CMD_REMOVE_MAP:
@@ -1406,7 +1270,23 @@ int32_t acdb_heap_ioctl(uint32_t cmd_id,
         if (IsNull(rsp) || rsp_size < sizeof(LinkedList))
             return AR_EBADPARAM;
 
-        status = acdb_heap_get_map_list((LinkedList**)rsp);
+        status = acdb_heap_get_map_list((LinkedList**)rsp, FALSE);
+        break;
+    }
+    case ACDB_HEAP_CMD_GET_DIRTY_MAP_LIST:
+    {
+        if (IsNull(rsp) || rsp_size < sizeof(LinkedList))
+            return AR_EBADPARAM;
+
+        status = acdb_heap_get_map_list((LinkedList**)rsp, TRUE);
+        break;
+    }
+    case ACDB_HEAP_CMD_SET_MAP_DIRTY:
+    {
+        if (IsNull(req) || req_size < sizeof(AcdbGraphKeyVector))
+            return AR_EBADPARAM;
+
+        status = acdb_heap_set_map_dirty((AcdbGraphKeyVector*)req);
         break;
     }
 
@@ -20,6 +20,7 @@
 #include "acdb_file_mgr.h"
 #include "acdb_delta_file_mgr.h"
 #include "acdb_heap.h"
+#include "acdb_gkv_index.h"
 
 /* ---------------------------------------------------------------------------
 * Global Data Definitions
@@ -54,8 +55,8 @@ void AcdbInitUnloadAcdbFile(AcdbFileManFileInfo* acdb_file_info)
 	}
 
 	acdb_file_info->file_handle = NULL;
-	ACDB_FREE(acdb_file_info->file.buffer);
-	acdb_file_info->file.buffer = NULL;
+	(void)AcbdInitUnloadInMemFile(&acdb_file_info->file);
+	acdb_parser_free_chunk_directory(&acdb_file_info->chunk_directory);
 }
 
 void AcdbInitUnloadDeltaFile(AcdbDeltaFileManFileInfo* delta_file_info)
@@ -103,6 +104,13 @@ int32_t AcdbInitLoadAcdbFile(AcdbFileManFileInfo *acdb_cmd_finfo,
 		if (AR_FAILED(status))
 			return status;
 
+		/* Index the chunks once so chunk lookups do not need to walk
+		 * the file */
+		status = acdb_parser_build_chunk_directory(
+			&acdb_cmd_finfo->file, &acdb_cmd_finfo->chunk_directory);
+		if (AR_FAILED(status))
+			return status;
+
 		status = acdb_parser_get_acdb_header_v1(
 			&acdb_cmd_finfo->file,
 			&header_v1);
@@ -411,11 +419,26 @@ int32_t acdb_init_add_database(acdb_init_database_paths_t *database_paths,
 
 		ctx_handle.vm_id = fm_ctx_handle.vm_id;
 		ctx_handle.file_manager_handle = fm_ctx_handle.file_man_handle;
+
+		/* Index the GKV tables once so graph lookups do not need to walk
+		 * the tables. Lookups fall back to the table search without it */
+		status = acdb_gkv_index_create(ctx_handle.file_manager_handle,
+			&ctx_handle.gkv_index_handle);
+		if (AR_FAILED(status))
+		{
+			if (AR_EUNSUPPORTED != status)
+				ACDB_INFO("Warning[%d]: Unable to build the GKV index. "
+					"Falling back to GKV table search", status);
+			ctx_handle.gkv_index_handle = NULL;
+			status = AR_EOK;
+		}
+
 		status = acdb_ctx_man_ioctl(ACDB_CTX_MAN_CMD_ADD_DATABASE,
 			(void*)&ctx_handle, sizeof(acdb_context_handle_t), NULL, 0);
 		if (AR_FAILED(status))
 		{
 			//the context manager should not fail. This is a serious error
+			acdb_gkv_index_destroy(ctx_handle.gkv_index_handle);
 			ACDB_ERR("Error[%d]: Unable to update context manager "
 				"with new database", status);
 			goto end;
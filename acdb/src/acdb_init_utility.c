@@ -27,6 +27,8 @@
 
 int32_t AcbdInitLoadInMemFile(const char_t* fname, ar_fhandle fhandle, acdb_buffer_t* in_mem_file)
 {
+    size_t bytes_read = 0;
+
     in_mem_file->size = (uint32_t)ar_fsize(fhandle);
 
     if (in_mem_file->size == 0)
@@ -35,21 +37,45 @@ int32_t AcbdInitLoadInMemFile(const char_t* fname, ar_fhandle fhandle, acdb_buff
         return AR_EBADPARAM;
     }
 
-    int32_t status = ar_fmap(fhandle, &in_mem_file->buffer);
-    if (AR_EUNSUPPORTED == status)
+    /* The mapped pages are read-only and are served to the file manager
+     * as-is, so there is nothing to read when the map succeeds */
+    int32_t status = ar_fmap(fhandle, (const void**)&in_mem_file->buffer);
+    if (AR_EOK == status)
+        return status;
+
+    if (AR_EUNSUPPORTED != status)
     {
-        in_mem_file->buffer = (void*)ACDB_MALLOC(uint8_t, in_mem_file->size);
+        ACDB_ERR("Error[%d]: Failed to map memory for file %s", status, fname);
+        in_mem_file->buffer = NULL;
+        in_mem_file->size = 0;
+        return status;
+    }
 
-        if (IsNull(in_mem_file->buffer))
-        {
-            ACDB_ERR("Error[%d]: Not enough memory to allocate for file %s", AR_ENOMEMORY, fname);
-            return AR_ENOMEMORY;
-        }
-        status = AR_EOK;
+    in_mem_file->buffer = (void*)ACDB_MALLOC(uint8_t, in_mem_file->size);
+
+    if (IsNull(in_mem_file->buffer))
+    {
+        ACDB_ERR("Error[%d]: Not enough memory to allocate for file %s", AR_ENOMEMORY, fname);
+        return AR_ENOMEMORY;
     }
-    else if (AR_FAILED(status))
+
+    status = ar_fread(fhandle, in_mem_file->buffer, in_mem_file->size, &bytes_read);
+    if (AR_FAILED(status))
     {
-        ACDB_ERR("Error[%d]: Failed to map memory for file %s", status, fname);
+        ACDB_ERR("Error[%d]: Unable to read file: %s", status, fname);
+    }
+    else if (bytes_read != in_mem_file->size)
+    {
+        status = AR_EBADPARAM;
+        ACDB_ERR("Error[%d]: File size does not match "
+            "the number of bytes read: %s", status, fname);
+    }
+
+    if (AR_FAILED(status))
+    {
+        ACDB_FREE(in_mem_file->buffer);
+        in_mem_file->buffer = NULL;
+        in_mem_file->size = 0;
     }
 
     return status;
@@ -65,16 +91,21 @@ int32_t AcbdInitUnloadInMemFile(acdb_buffer_t* in_mem_file)
 
     in_mem_file->size = 0;
 
+    if (IsNull(in_mem_file->buffer))
+        return AR_EOK;
+
     int32_t status = ar_funmap(in_mem_file->buffer);
     if (AR_EUNSUPPORTED == status)
     {
         ACDB_FREE(in_mem_file->buffer);
+        status = AR_EOK;
     }
     else if (AR_FAILED(status))
     {
         ACDB_ERR("Error[%d]: Failed to unmap memory for in_mem_file", status);
     }
 
+    in_mem_file->buffer = NULL;
     return status;
 }
 
@@ -186,7 +217,6 @@ int32_t AcdbInitUtilGetFileData(const char_t* fname, ar_fhandle* fhandle,
     acdb_buffer_t *in_mem_file)
 {
     int32_t status = AR_EOK;
-    size_t bytes_read = 0;
 
     if (IsNull(fname) || IsNull(in_mem_file))
     {
@@ -213,27 +243,6 @@ int32_t AcdbInitUtilGetFileData(const char_t* fname, ar_fhandle* fhandle,
     if (AR_FAILED(status))
     {
         ACDB_ERR("ERROR[%d]: Failed to load in_mem_file %s", status, fname);
-        return status;
-    }
-
-    status = ar_fread(*fhandle, in_mem_file->buffer, in_mem_file->size, &bytes_read);
-    if (AR_FAILED(status))
-    {
-        ACDB_ERR("Error[%d]: Unable to read file: %s", status, fname);
-        goto end;
-    }
-
-    if (bytes_read != in_mem_file->size)
-    {
-        status = AR_EBADPARAM;
-        ACDB_ERR("Error[%d]: File size does not match "
-            "the number of bytes read: %s", status, fname);
-    }
-
-end:
-    if (AR_FAILED(status))
-    {
-        AcbdInitUnloadInMemFile(in_mem_file);
     }
 
     return status;
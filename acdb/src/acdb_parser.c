@@ -99,6 +99,143 @@ int32_t acdb_parser_get_chunk(
     return status;
 }
 
+int32_t acdb_parser_build_chunk_directory(
+    acdb_buffer_t *in_mem_file, acdb_chunk_directory_t *directory)
+{
+    uint32_t num_chunks = 0;
+    uint32_t chunk_id = 0;
+    uint32_t i = 0;
+    uint32_t j = 0;
+    uint8_t *start_ptr = NULL;
+    uint8_t *end_ptr = NULL;
+    acdb_chunk_header_t *header = NULL;
+    acdb_chunk_entry_t entry = { 0 };
+    acdb_chunk_entry_t *chunks = NULL;
+
+    if (IsNull(in_mem_file) || IsNull(directory) ||
+        IsNull(in_mem_file->buffer) ||
+        in_mem_file->size < sizeof(acdb_file_properties_t))
+    {
+        ACDB_ERR("Error[%d]: One or more input parameters are invalid",
+            AR_EBADPARAM);
+        return AR_EBADPARAM;
+    }
+
+    directory->num_chunks = 0;
+    directory->chunks = NULL;
+
+    start_ptr = (uint8_t*)in_mem_file->buffer
+        + sizeof(acdb_file_properties_t);
+    end_ptr = (uint8_t*)in_mem_file->buffer + in_mem_file->size;
+
+    //Count the chunks to size the directory
+    while ((size_t)(end_ptr - start_ptr) >= sizeof(acdb_chunk_header_t))
+    {
+        header = (acdb_chunk_header_t*)start_ptr;
+        num_chunks++;
+
+        if (header->size > (size_t)(end_ptr - start_ptr)
+            - sizeof(acdb_chunk_header_t))
+            break;
+
+        start_ptr += sizeof(acdb_chunk_header_t) + header->size;
+    }
+
+    if (0 == num_chunks)
+        return AR_EOK;
+
+    chunks = ACDB_MALLOC(acdb_chunk_entry_t, num_chunks);
+    if (IsNull(chunks))
+    {
+        ACDB_ERR("Error[%d]: Unable to allocate the chunk directory",
+            AR_ENOMEMORY);
+        return AR_ENOMEMORY;
+    }
+
+    num_chunks = 0;
+    start_ptr = (uint8_t*)in_mem_file->buffer
+        + sizeof(acdb_file_properties_t);
+
+    while ((size_t)(end_ptr - start_ptr) >= sizeof(acdb_chunk_header_t))
+    {
+        header = (acdb_chunk_header_t*)start_ptr;
+        chunk_id = header->id;
+
+        /* Insert sorted by chunk id. Duplicates keep the first
+         * occurrence */
+        for (i = 0; i < num_chunks; i++)
+        {
+            if (chunks[i].chunk_id >= chunk_id)
+                break;
+        }
+
+        if (i == num_chunks || chunks[i].chunk_id != chunk_id)
+        {
+            for (j = num_chunks; j > i; j--)
+                chunks[j] = chunks[j - 1];
+
+            entry.chunk_id = chunk_id;
+            entry.chunk_offset = (uint32_t)(start_ptr
+                - (uint8_t*)in_mem_file->buffer
+                + sizeof(acdb_chunk_header_t));
+            entry.chunk_size = header->size;
+            chunks[i] = entry;
+            num_chunks++;
+        }
+
+        if (header->size > (size_t)(end_ptr - start_ptr)
+            - sizeof(acdb_chunk_header_t))
+            break;
+
+        start_ptr += sizeof(acdb_chunk_header_t) + header->size;
+    }
+
+    directory->num_chunks = num_chunks;
+    directory->chunks = chunks;
+
+    return AR_EOK;
+}
+
+void acdb_parser_free_chunk_directory(acdb_chunk_directory_t *directory)
+{
+    if (IsNull(directory))
+        return;
+
+    ACDB_FREE(directory->chunks);
+    directory->chunks = NULL;
+    directory->num_chunks = 0;
+}
+
+int32_t acdb_parser_find_chunk(acdb_chunk_directory_t *directory,
+    uint32_t chunk_id, uint32_t *chunk_offset, uint32_t *chunk_size)
+{
+    uint32_t low = 0;
+    uint32_t high = 0;
+    uint32_t mid = 0;
+
+    if (IsNull(directory) || IsNull(chunk_offset) || IsNull(chunk_size))
+        return AR_EBADPARAM;
+
+    high = directory->num_chunks;
+    while (low < high)
+    {
+        mid = low + (high - low) / 2;
+
+        if (directory->chunks[mid].chunk_id < chunk_id)
+            low = mid + 1;
+        else if (directory->chunks[mid].chunk_id > chunk_id)
+            high = mid;
+        else
+        {
+            *chunk_offset = directory->chunks[mid].chunk_offset;
+            *chunk_size = directory->chunks[mid].chunk_size;
+            return AR_EOK;
+        }
+    }
+
+    return AR_ENOTEXIST;
+}
+
 int32_t acdb_parser_validate_file(acdb_buffer_t *in_mem_file)
 {
 	int32_t status = AR_EOK;
@@ -0,0 +1,362 @@
+/**
+*=============================================================================
+* \file acdb_sort.c
+*
+* \brief
+*		Implements the sorting network and introsort used to sort arrays
+*		of key vectors, subgraph ids and lookup table entries.
+*
+*		Every element is reduced to a 64-bit sort key made up of its
+*		uint32_t sorting key and its original index. The sort keys are
+*		unique, which keeps both paths stable, and they are sorted instead
+*		of the elements. The elements are then moved into place once by
+*		following the cycles of the resulting permutation.
+*
+* \copyright
+*  Copyright (c) Qualcomm Innovation Center, Inc. All rights reserved.
+*  SPDX-License-Identifier: BSD-3-Clause
+*
+*=============================================================================
+*/
+
+/* ---------------------------------------------------------------------------
+* Include Files
+*--------------------------------------------------------------------------- */
+
+#include "acdb_sort.h"
+#include "acdb_utility.h"
+#include "acdb_common.h"
+
+/* ---------------------------------------------------------------------------
+* Preprocessor Definitions and Constants
+*--------------------------------------------------------------------------- */
+
+/**< Number of sort keys kept on the stack before falling back to the heap */
+#define ACDB_SORT_STACK_KEYS 64
+
+/**< Largest element (in words) that can be held in the stack temp element */
+#define ACDB_SORT_STACK_ELEM_WORDS 16
+
+/**< Partitions at or below this size are left to the final insertion sort */
+#define ACDB_SORT_INSERTION_THRESHOLD 16
+
+#define ACDB_SORT_KEY(key, index) (((uint64_t)(key) << 32) | (uint64_t)(index))
+#define ACDB_SORT_KEY_INDEX(sort_key) ((uint32_t)((sort_key) & 0xFFFFFFFFUL))
+
+/* ---------------------------------------------------------------------------
+* Globals
+*--------------------------------------------------------------------------- */
+
+/**< Comparator pairs of the sorting networks for 2 to 8 elements */
+static const uint8_t acdb_sort_network_2[][2] = {
+    {0, 1}
+};
+
+static const uint8_t acdb_sort_network_3[][2] = {
+    {0, 2}, {0, 1}, {1, 2}
+};
+
+static const uint8_t acdb_sort_network_4[][2] = {
+    {0, 1}, {2, 3}, {0, 2}, {1, 3}, {1, 2}
+};
+
+static const uint8_t acdb_sort_network_5[][2] = {
+    {0, 1}, {3, 4}, {2, 4}, {2, 3}, {1, 4}, {0, 3}, {0, 2}, {1, 3}, {1, 2}
+};
+
+static const uint8_t acdb_sort_network_6[][2] = {
+    {1, 2}, {4, 5}, {0, 2}, {3, 5}, {0, 1}, {3, 4},
+    {2, 5}, {0, 3}, {1, 4}, {2, 4}, {1, 3}, {2, 3}
+};
+
+static const uint8_t acdb_sort_network_7[][2] = {
+    {1, 2}, {3, 4}, {5, 6}, {0, 2}, {3, 5}, {4, 6}, {0, 1}, {4, 5},
+    {2, 6}, {0, 4}, {1, 5}, {0, 3}, {2, 5}, {1, 3}, {2, 4}, {2, 3}
+};
+
+static const uint8_t acdb_sort_network_8[][2] = {
+    {0, 2}, {1, 3}, {4, 6}, {5, 7}, {0, 4}, {1, 5}, {2, 6}, {3, 7},
+    {0, 1}, {2, 3}, {4, 5}, {6, 7}, {2, 4}, {3, 5}, {1, 4}, {3, 6},
+    {1, 2}, {3, 4}, {5, 6}
+};
+
+typedef struct _acdb_sort_network_t
+{
+    uint32_t num_comparators;
+    const uint8_t (*comparators)[2];
+} AcdbSortNetwork;
+
+static const AcdbSortNetwork acdb_sort_networks[ACDB_SORT_NETWORK_MAX_ELEMS + 1] = {
+    { 0, NULL },
+    { 0, NULL },
+    { 1, acdb_sort_network_2 },
+    { 3, acdb_sort_network_3 },
+    { 5, acdb_sort_network_4 },
+    { 9, acdb_sort_network_5 },
+    { 12, acdb_sort_network_6 },
+    { 16, acdb_sort_network_7 },
+    { 19, acdb_sort_network_8 }
+};
+
+/* ---------------------------------------------------------------------------
+* Static Functions
+*--------------------------------------------------------------------------- */
+
+static void acdb_sort_network(uint64_t *keys, uint32_t count)
+{
+    const AcdbSortNetwork *network = &acdb_sort_networks[count];
+    uint64_t a = 0;
+    uint64_t b = 0;
+
+    for (uint32_t i = 0; i < network->num_comparators; i++)
+    {
+        a = keys[network->comparators[i][0]];
+        b = keys[network->comparators[i][1]];
+        keys[network->comparators[i][0]] = a < b ? a : b;
+        keys[network->comparators[i][1]] = a < b ? b : a;
+    }
+}
+
+static void acdb_sort_insertion(uint64_t *keys, uint32_t count)
+{
+    uint64_t key = 0;
+    uint32_t j = 0;
+
+    for (uint32_t i = 1; i < count; i++)
+    {
+        key = keys[i];
+        for (j = i; j > 0 && keys[j - 1] > key; j--)
+            keys[j] = keys[j - 1];
+        keys[j] = key;
+    }
+}
+
+static void acdb_sort_sift_down(uint64_t *keys, uint32_t root, uint32_t count)
+{
+    uint64_t key = keys[root];
+    uint32_t child = 0;
+
+    while ((child = 2 * root + 1) < count)
+    {
+        if (child + 1 < count && keys[child] < keys[child + 1])
+            child++;
+
+        if (key >= keys[child])
+            break;
+
+        keys[root] = keys[child];
+        root = child;
+    }
+
+    keys[root] = key;
+}
+
+static void acdb_sort_heapsort(uint64_t *keys, uint32_t count)
+{
+    uint64_t key = 0;
+
+    for (uint32_t i = count / 2; i > 0; i--)
+        acdb_sort_sift_down(keys, i - 1, count);
+
+    for (uint32_t i = count - 1; i > 0; i--)
+    {
+        key = keys[0];
+        keys[0] = keys[i];
+        keys[i] = key;
+        acdb_sort_sift_down(keys, 0, i);
+    }
+}
+
+/**
+* \brief
+*		Quicksorts keys[lo, hi) until every partition is at most
+*		ACDB_SORT_INSERTION_THRESHOLD keys long. A partition that
+*		exceeds depth_limit is heapsorted instead.
+*/
+static void acdb_sort_introsort(uint64_t *keys, uint32_t lo, uint32_t hi,
+    uint32_t depth_limit)
+{
+    uint64_t pivot = 0;
+    uint64_t tmp = 0;
+    uint32_t mid = 0;
+    uint32_t i = 0;
+    uint32_t j = 0;
+
+    while (hi - lo > ACDB_SORT_INSERTION_THRESHOLD)
+    {
+        if (depth_limit == 0)
+        {
+            acdb_sort_heapsort(&keys[lo], hi - lo);
+            return;
+        }
+        depth_limit--;
+
+        /* Median of three. keys[lo] and keys[hi - 1] become the
+         * sentinels that bound the partition scans */
+        mid = lo + (hi - lo) / 2;
+        if (keys[mid] < keys[lo])
+        {
+            tmp = keys[mid]; keys[mid] = keys[lo]; keys[lo] = tmp;
+        }
+        if (keys[hi - 1] < keys[lo])
+        {
+            tmp = keys[hi - 1]; keys[hi - 1] = keys[lo]; keys[lo] = tmp;
+        }
+        if (keys[hi - 1] < keys[mid])
+        {
+            tmp = keys[hi - 1]; keys[hi - 1] = keys[mid]; keys[mid] = tmp;
+        }
+        pivot = keys[mid];
+
+        i = lo;
+        j = hi - 1;
+        for (;;)
+        {
+            while (keys[++i] < pivot);
+            while (pivot < keys[--j]);
+            if (i >= j)
+                break;
+            tmp = keys[i]; keys[i] = keys[j]; keys[j] = tmp;
+        }
+
+        /* Recurse into the smaller partition to bound the stack depth */
+        if (i - lo < hi - i)
+        {
+            acdb_sort_introsort(keys, lo, i, depth_limit);
+            lo = i;
+        }
+        else
+        {
+            acdb_sort_introsort(keys, i, hi, depth_limit);
+            hi = i;
+        }
+    }
+}
+
+/**
+* \brief
+*		Moves every element to the position of its sort key. The index
+*		of each sort key is reset to its own position once the element
+*		has been placed, which marks the position as done.
+*/
+static void acdb_sort_permute(uint32_t *lst, uint64_t *keys, uint32_t count,
+    uint32_t elem_words, uint32_t *tmp_elem)
+{
+    uint32_t cur = 0;
+    uint32_t src = 0;
+    uint32_t w = 0;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (ACDB_SORT_KEY_INDEX(keys[i]) == i)
+            continue;
+
+        for (w = 0; w < elem_words; w++)
+            tmp_elem[w] = lst[i * elem_words + w];
+
+        cur = i;
+        for (;;)
+        {
+            src = ACDB_SORT_KEY_INDEX(keys[cur]);
+            keys[cur] = ACDB_SORT_KEY(0, cur);
+            if (src == i)
+            {
+                for (w = 0; w < elem_words; w++)
+                    lst[cur * elem_words + w] = tmp_elem[w];
+                break;
+            }
+
+            for (w = 0; w < elem_words; w++)
+                lst[cur * elem_words + w] = lst[src * elem_words + w];
+            cur = src;
+        }
+    }
+}
+
+/* ---------------------------------------------------------------------------
+* Public Functions
+*--------------------------------------------------------------------------- */
+
+int32_t acdb_sort(void *p_array, size_t sz_arr, size_t sz_elem,
+    uint32_t key_elem_pos)
+{
+    uint32_t *lst = (uint32_t*)p_array;
+    uint32_t elem_count = 0;
+    uint32_t elem_words = 0;
+    uint32_t depth_limit = 0;
+    bool_t is_sorted = TRUE;
+    uint64_t stack_keys[ACDB_SORT_STACK_KEYS];
+    uint32_t stack_elem[ACDB_SORT_STACK_ELEM_WORDS];
+    uint64_t *keys = stack_keys;
+    uint32_t *tmp_elem = stack_elem;
+
+    if (IsNull(p_array) || sz_arr == 0 || sz_elem == 0 || sz_arr < sz_elem
+        || sz_elem % sizeof(uint32_t) != 0)
+        return AR_EBADPARAM;
+
+    elem_count = (uint32_t)(sz_arr / sz_elem);
+    elem_words = (uint32_t)(sz_elem / sizeof(uint32_t));
+
+    if (key_elem_pos >= elem_words)
+        return AR_EBADPARAM;
+
+    if (elem_count == 1)
+        return AR_EOK;
+
+    /* Key vectors usually arrive sorted already */
+    for (uint32_t i = 1; i < elem_count; i++)
+    {
+        if (lst[(i - 1) * elem_words + key_elem_pos] >
+            lst[i * elem_words + key_elem_pos])
+        {
+            is_sorted = FALSE;
+            break;
+        }
+    }
+
+    if (is_sorted)
+        return AR_EOK;
+
+    if (elem_count > ACDB_SORT_STACK_KEYS)
+    {
+        keys = ACDB_MALLOC(uint64_t, elem_count);
+        if (IsNull(keys))
+            return AR_ENOMEMORY;
+    }
+
+    if (elem_words > ACDB_SORT_STACK_ELEM_WORDS)
+    {
+        tmp_elem = ACDB_MALLOC(uint32_t, elem_words);
+        if (IsNull(tmp_elem))
+        {
+            if (keys != stack_keys)
+                ACDB_FREE(keys);
+            return AR_ENOMEMORY;
+        }
+    }
+
+    for (uint32_t i = 0; i < elem_count; i++)
+        keys[i] = ACDB_SORT_KEY(lst[i * elem_words + key_elem_pos], i);
+
+    if (elem_count <= ACDB_SORT_NETWORK_MAX_ELEMS)
+    {
+        acdb_sort_network(keys, elem_count);
+    }
+    else
+    {
+        for (uint32_t n = elem_count; n > 1; n >>= 1)
+            depth_limit += 2;
+
+        acdb_sort_introsort(keys, 0, elem_count, depth_limit);
+        acdb_sort_insertion(keys, elem_count);
+    }
+
+    acdb_sort_permute(lst, keys, elem_count, elem_words, tmp_elem);
+
+    if (keys != stack_keys)
+        ACDB_FREE(keys);
+    if (tmp_elem != stack_elem)
+        ACDB_FREE(tmp_elem);
+
+    return AR_EOK;
+}
@@ -18,6 +18,7 @@
 
 #include "acdb_utility.h"
 #include "acdb_common.h"
+#include "acdb_sort.h"
 //#include <stdarg.h>
 
 /* ---------------------------------------------------------------------------
@@ -256,64 +257,12 @@ int32_t AcdbDataBinarySearch2(void *p_array, size_t sz_arr, void *p_cmd,
 
 void AcdbSort(void* p_array, uint32_t sz_arr)
 {
-	//insertion sort
-
-	uint32_t* lst = (uint32_t*)p_array;
-	uint32_t tmp = 0;
-	int32_t j = 0;
-	uint32_t elem_count = sz_arr / sizeof(uint32_t);
-
-	for (uint32_t i = 0; i + 1UL < elem_count; i++)
-	{
-		j = i;
-		while (j > -1)
-		{
-			if (lst[j] > lst[j + 1])
-			{
-				tmp = lst[j];
-				lst[j] = lst[j + 1];
-				lst[j + 1] = tmp;
-			}
-			j--;
-		}
-	}
+	(void)acdb_sort(p_array, sz_arr, sizeof(uint32_t), 0);
 }
 
 int32_t AcdbSort2(size_t sz_arr, void* p_array, size_t sz_elem, uint32_t key_elem_pos)
 {
-	if (IsNull(p_array) || sz_arr == 0 || sz_elem == 0 || sz_arr < sz_elem)
-		return AR_EBADPARAM;
-
-	if (1 == sz_arr / sz_elem) return AR_EOK;
-
-	uint32_t* lst = (uint32_t*)p_array;
-	uint32_t elem_count = (uint32_t)sz_arr / (uint32_t)sz_elem;
-	int32_t elem_member_count = (uint32_t)sz_elem / sizeof(uint32_t);
-	int32_t lst_len = elem_count * elem_member_count;
-    uint32_t *tmp_elem = ACDB_MALLOC(uint32_t, elem_member_count);
-	int32_t j = 0;
-
-	if (IsNull(tmp_elem)) return AR_ENOMEMORY;
-
-	for (int32_t i = 0; i < lst_len - elem_member_count; i += elem_member_count)
-	{
-		j = i;
-		while (j > -1)
-		{
-			uint32_t a = lst[j + key_elem_pos];
-			uint32_t b = lst[j + key_elem_pos + elem_member_count];
-			if (a > b)
-			{
-				ACDB_MEM_CPY_SAFE((void*)tmp_elem, sz_elem, &lst[j], sz_elem);
-				ACDB_MEM_CPY_SAFE(&lst[j], sz_elem, &lst[j + elem_member_count], sz_elem);
-				ACDB_MEM_CPY_SAFE(&lst[j + elem_member_count], sz_elem, tmp_elem, sz_elem);
-			}
-			j -= elem_member_count;
-		}
-	}
-
-	ACDB_FREE(tmp_elem);
-	return AR_EOK;
+	return acdb_sort(p_array, sz_arr, sz_elem, key_elem_pos);
 }
 
 uint32_t AcdbAlign(uint32_t byte_alignment, uint32_t byte_size)
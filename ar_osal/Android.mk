@@ -38,6 +38,7 @@ LOCAL_C_INCLUDES += $(TARGET_OUT_HEADERS)/diag/include
 LOCAL_ADDITIONAL_DEPENDENCIES  := $(TARGET_OUT_INTERMEDIATES)/KERNEL_OBJ/usr
 
 LOCAL_SRC_FILES := src/linux/ar_osal_mutex.c \
+                   src/linux/ar_osal_rwlock.c \
                    src/linux/ar_osal_thread.c \
                    src/linux/ar_osal_signal.c \
                    src/linux/ar_osal_log.c \
@@ -71,6 +72,10 @@ ifneq ($(strip $(AUDIO_FEATURE_OLD_ION_IMPL)), true)
         LOCAL_SHARED_LIBRARIES += libion
 endif
 
+ifeq ($(strip $(AUDIO_FEATURE_ENABLED_ACDB_MMAP)),true)
+    LOCAL_CFLAGS += -DAR_OSAL_FILE_MMAP
+endif
+
 ifeq ($(TARGET_PD_SERVICE_ENABLED), true)
     LOCAL_SHARED_LIBRARIES += libpdmapper
     LOCAL_SHARED_LIBRARIES += libpdnotifier
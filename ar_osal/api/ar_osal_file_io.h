@@ -106,11 +106,16 @@ size_t ar_fsize(ar_fhandle handle);
  * To free any possible resources allocated by this call, the caller
  * MUST call ar_funmap
  *
+ * On Linux the file is mapped with mmap when the library is built
+ * with AR_OSAL_FILE_MMAP. Otherwise AR_EUNSUPPORTED is returned and
+ * the caller is expected to read the file into its own buffer.
+ *
  * \param[in] handle: Handle to the file
  * \param[out] fbuffer: A pointer to the read-only Data memory buffer
  * 
  * \return
  *  0 -- Success
+ *  AR_EUNSUPPORTED -- File mapping is not supported
  *  Nonzero -- Failure
  */
 int32_t ar_fmap(ar_fhandle handle, 
@@ -128,6 +133,7 @@ int32_t ar_fmap(ar_fhandle handle,
  * 
  * \return
  *  0 -- Success
+ *  AR_EUNSUPPORTED -- File mapping is not supported
  *  Nonzero -- Failure
  */
 int32_t ar_funmap(const void *fbuffer);
@@ -201,6 +207,28 @@ int32_t ar_fclose(ar_fhandle handle);
  */
 int32_t ar_fdelete(const char_t *path);
 
+/**
+ *  \brief  ar_frename
+ *          Rename a file. If new_path already exists it is replaced
+ *          atomically, so a reader sees either the old or the new file.
+ *  \param[in]  old_path: Absolute path of the file to rename.
+ *  \param[in]  new_path: Absolute path to rename the file to.
+ *  \return
+ *  0 -- Success
+ *  Nonzero -- Failure
+ */
+int32_t ar_frename(const char_t *old_path, const char_t *new_path);
+
+/**
+ *  \brief  ar_fsync
+ *          Flush all data written to the file down to the storage device.
+ *  \param[in] handle: Handle to the file.
+ *  \return
+ *  0 -- Success
+ *  Nonzero -- Failure
+ */
+int32_t ar_fsync(ar_fhandle handle);
+
 #ifdef __cplusplus
 }
 #endif /*__cplusplus*/
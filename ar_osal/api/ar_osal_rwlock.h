@@ -0,0 +1,148 @@
+#ifndef AR_OSAL_RWLOCK_H
+#define AR_OSAL_RWLOCK_H
+
+/**
+ * \file ar_osal_rwlock.h
+ * \brief
+ *     This file contains reader/writer lock APIs. Any number of readers
+ *     can hold the lock at the same time, while a writer holds it alone.
+ * \copyright
+ *  Copyright (c) Qualcomm Innovation Center, Inc. All rights reserved.
+ *  SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/** @weakgroup weakf_ar_osal_rwlock_intro
+This section describes the following reader/writer lock functions.
+The locks are not recursive.
+ - ar_osal_rwlock_create()
+ - ar_osal_rwlock_destroy()
+ - ar_osal_rwlock_read_lock()
+ - ar_osal_rwlock_write_lock()
+ - ar_osal_rwlock_unlock()
+*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif /*__cplusplus*/
+
+/* =======================================================================
+INCLUDE FILES FOR MODULE
+========================================================================== */
+#include "ar_osal_types.h"
+
+/** @addtogroup rwlock
+@{ */
+
+/* -----------------------------------------------------------------------
+** Global definitions/forward declarations
+** ----------------------------------------------------------------------- */
+
+/** ar osal reader/writer lock type object.
+*/
+typedef void *ar_osal_rwlock_t;
+
+/****************************************************************************
+** Reader/Writer Lock
+*****************************************************************************/
+
+/**
+  Creates and initializes a reader/writer lock. Where the platform
+  supports it, waiting writers are preferred over new readers so that
+  a steady stream of readers cannot starve a writer.
+
+  @datatypes
+  ar_osal_rwlock_t
+
+  @param[Out] rwlock: Pointer to the lock object handle.
+
+  @return
+  0 -- Success
+  Nonzero -- Failure
+
+  @dependencies
+  None. @newpage
+*/
+int32_t ar_osal_rwlock_create(ar_osal_rwlock_t *rwlock);
+
+/**
+  Delete/free a reader/writer lock object. This function must be called
+  for each corresponding ar_osal_rwlock_create function to clean up all
+  resources.
+
+  @datatypes
+  ar_osal_rwlock_t
+
+  @param[in] rwlock: Pointer to the lock.
+
+  @return
+  0 -- Success
+  Nonzero -- Failure
+
+  @dependencies
+  Before calling this function, the object must have been created and
+  must not be held.
+  @newpage
+*/
+int32_t ar_osal_rwlock_destroy(ar_osal_rwlock_t rwlock);
+
+/**
+  Locks a reader/writer lock for shared (read) access. Blocks while a
+  writer holds the lock.
+
+  @datatypes
+  ar_osal_rwlock_t
+
+  @param[in] rwlock: Pointer to the lock.
+
+  @return
+  0 -- Success
+  Nonzero -- Failure
+
+  @dependencies
+  Before calling this function, the object must be created.
+  @newpage
+*/
+int32_t ar_osal_rwlock_read_lock(ar_osal_rwlock_t rwlock);
+
+/**
+  Locks a reader/writer lock for exclusive (write) access. Blocks while
+  any reader or writer holds the lock.
+
+  @datatypes
+  ar_osal_rwlock_t
+
+  @param[in] rwlock: Pointer to the lock.
+
+  @return
+  0 -- Success
+  Nonzero -- Failure
+
+  @dependencies
+  Before calling this function, the object must be created.
+  @newpage
+*/
+int32_t ar_osal_rwlock_write_lock(ar_osal_rwlock_t rwlock);
+
+/**
+  Releases a reader/writer lock held for either read or write access.
+
+  @datatypes
+  ar_osal_rwlock_t
+
+  @param[in] rwlock: Pointer to the lock.
+
+  @return
+  0 -- Success
+  Nonzero -- Failure
+
+  @dependencies
+  Before calling this function, the object must be created.
+  @newpage
+ */
+int32_t ar_osal_rwlock_unlock(ar_osal_rwlock_t rwlock);
+
+#ifdef __cplusplus
+}
+#endif /*__cplusplus*/
+
+#endif // #ifndef AR_OSAL_RWLOCK_H
@@ -17,6 +17,11 @@
 #include <unistd.h>
 #include <sys/types.h>
 #include <errno.h>
+#ifdef AR_OSAL_FILE_MMAP
+#include <stdlib.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#endif
 #include "ar_osal_file_io.h"
 #include "ar_osal_log.h"
 #include "ar_osal_error.h"
@@ -30,6 +35,21 @@ const char* gsl_log_paths[] = {"/data/vendor/audio/gsl_log.bin",
 
 #define AR_FILE_WRITE_MAX_SIZE ( (256)*(1024)*(1024) ) //256 MB
 
+#ifdef AR_OSAL_FILE_MMAP
+/**
+ * ar_funmap is only given the buffer pointer, so the length of every
+ * mapping created by ar_fmap is kept here until the buffer is unmapped.
+ */
+typedef struct ar_fmap_region {
+    const void *addr;
+    size_t size;
+    struct ar_fmap_region *next;
+} ar_fmap_region_t;
+
+static ar_fmap_region_t *ar_fmap_regions = NULL;
+static pthread_mutex_t ar_fmap_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
 _IRQL_requires_max_(PASSIVE_LEVEL)
 int32_t ar_fopen(_Out_ ar_fhandle *handle,
                    _In_  const char_t *path,
@@ -161,13 +181,97 @@ _IRQL_requires_max_(PASSIVE_LEVEL)
 int32_t ar_fmap(ar_fhandle handle,
                 const void **fbuffer)
 {
+#ifdef AR_OSAL_FILE_MMAP
+    int32_t rc = AR_EOK;
+    int fd = 0;
+    size_t file_size = 0;
+    void *addr = NULL;
+    ar_fmap_region_t *region = NULL;
+
+    if (NULL == handle || NULL == fbuffer) {
+        AR_LOG_ERR(AR_OSAL_FILE_IO_LOG_TAG,"%s Invalid file handle or buffer\n",__func__);
+        return AR_EBADPARAM;
+    }
+
+    fd = fileno((FILE *)handle);
+    if (fd < 0) {
+        AR_LOG_ERR(AR_OSAL_FILE_IO_LOG_TAG,"%s invalid file handle %s\n", __func__, strerror(errno));
+        return AR_EFAILED;
+    }
+
+    file_size = ar_fsize(handle);
+    if (0 == file_size) {
+        AR_LOG_ERR(AR_OSAL_FILE_IO_LOG_TAG,"%s cannot map an empty file\n", __func__);
+        return AR_EBADPARAM;
+    }
+
+    region = (ar_fmap_region_t *)malloc(sizeof(ar_fmap_region_t));
+    if (NULL == region) {
+        AR_LOG_ERR(AR_OSAL_FILE_IO_LOG_TAG,"%s failed to allocate map region\n", __func__);
+        return AR_ENOMEMORY;
+    }
+
+    /* Shared read-only pages let every process that maps the same file use one copy */
+    addr = mmap(NULL, file_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (MAP_FAILED == addr) {
+        rc = AR_EFAILED;
+        AR_LOG_ERR(AR_OSAL_FILE_IO_LOG_TAG,"%s mmap failed with error %d %s\n", __func__, rc, strerror(errno));
+        free(region);
+        return rc;
+    }
+
+    region->addr = addr;
+    region->size = file_size;
+    pthread_mutex_lock(&ar_fmap_lock);
+    region->next = ar_fmap_regions;
+    ar_fmap_regions = region;
+    pthread_mutex_unlock(&ar_fmap_lock);
+
+    *fbuffer = addr;
+    return rc;
+#else
     return AR_EUNSUPPORTED;
+#endif
 }
 
 _IRQL_requires_max_(PASSIVE_LEVEL)
 int32_t ar_funmap(const void *fbuffer)
 {
+#ifdef AR_OSAL_FILE_MMAP
+    int32_t rc = AR_EOK;
+    ar_fmap_region_t **link = NULL;
+    ar_fmap_region_t *region = NULL;
+
+    if (NULL == fbuffer) {
+        AR_LOG_ERR(AR_OSAL_FILE_IO_LOG_TAG,"%s Invalid file buffer\n",__func__);
+        return AR_EBADPARAM;
+    }
+
+    pthread_mutex_lock(&ar_fmap_lock);
+    for (link = &ar_fmap_regions; NULL != *link; link = &(*link)->next) {
+        if ((*link)->addr == fbuffer) {
+            region = *link;
+            *link = region->next;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&ar_fmap_lock);
+
+    if (NULL == region) {
+        AR_LOG_ERR(AR_OSAL_FILE_IO_LOG_TAG,"%s buffer was not mapped by ar_fmap\n", __func__);
+        return AR_EBADPARAM;
+    }
+
+    if (0 != munmap((void *)region->addr, region->size)) {
+        rc = AR_EFAILED;
+        AR_LOG_ERR(AR_OSAL_FILE_IO_LOG_TAG,"%s munmap failed with error %d %s\n", __func__, rc, strerror(errno));
+    }
+
+    free(region);
+    return rc;
+#else
     return AR_EUNSUPPORTED;
+#endif
 }
 
 _IRQL_requires_max_(PASSIVE_LEVEL)
@@ -316,3 +420,43 @@ int32_t ar_fdelete(_In_ const char_t *path)
 done:
     return rc;
 }
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+int32_t ar_frename(_In_ const char_t *old_path,
+                   _In_ const char_t *new_path)
+{
+    int32_t rc = 0;
+
+    if (NULL == old_path || NULL == new_path) {
+        AR_LOG_ERR(AR_OSAL_FILE_IO_LOG_TAG,"%s Invalid path\n",__func__);
+        rc = AR_EBADPARAM;
+        goto done;
+    }
+    rc = rename(old_path, new_path);
+    if (0 != rc) {
+        rc = AR_EFAILED;
+        AR_LOG_ERR(AR_OSAL_FILE_IO_LOG_TAG,"%s failed %d %s\n", __func__, rc, strerror(errno));
+    }
+done:
+    return rc;
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+int32_t ar_fsync(_In_ ar_fhandle handle)
+{
+    int32_t rc = 0;
+    FILE *file_ptr = (FILE *)handle;
+
+    if (NULL == handle) {
+        AR_LOG_ERR(AR_OSAL_FILE_IO_LOG_TAG,"%s Invalid file handle\n",__func__);
+        rc = AR_EBADPARAM;
+        goto done;
+    }
+
+    if (EOF == fflush(file_ptr) || 0 != fsync(fileno(file_ptr))) {
+        rc = AR_EFAILED;
+        AR_LOG_ERR(AR_OSAL_FILE_IO_LOG_TAG,"%s failed %d %s\n", __func__, rc, strerror(errno));
+    }
+done:
+    return rc;
+}
@@ -0,0 +1,145 @@
+/**
+ * \file ar_osal_rwlock.c
+ *
+ * \brief
+ *      This file implements reader/writer lock apis on top of
+ *      pthread rwlocks.
+ *
+ * \copyright
+ *  Copyright (c) Qualcomm Innovation Center, Inc. All rights reserved.
+ *  SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#define AR_OSAL_RWLOCK_LOG_TAG     "CORW"
+#include <stddef.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <errno.h>
+#include "ar_osal_rwlock.h"
+#include "ar_osal_log.h"
+#include "ar_osal_error.h"
+
+/* Internal lock definition */
+typedef struct osal_int_rwlock {
+    pthread_rwlock_t rwlock;
+} osal_int_rwlock_t;
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+int32_t ar_osal_rwlock_create(_Inout_ ar_osal_rwlock_t *ar_osal_rwlock)
+{
+    int32_t rc;
+    osal_int_rwlock_t *the_rwlock;
+    pthread_rwlockattr_t attr;
+
+    if (NULL == ar_osal_rwlock) {
+        return AR_EBADPARAM;
+    }
+
+    the_rwlock = ((osal_int_rwlock_t *) malloc(sizeof(osal_int_rwlock_t)));
+    if (NULL == the_rwlock) {
+        AR_LOG_ERR(AR_OSAL_RWLOCK_LOG_TAG,"%s: failed to allocate memory for rwlock\n", __func__);
+        rc = AR_ENOMEMORY;
+        goto exit;
+    }
+
+    pthread_rwlockattr_init(&attr);
+#if defined(__USE_GNU)
+    pthread_rwlockattr_setkind_np(&attr,
+        PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+#endif
+    rc = pthread_rwlock_init(&the_rwlock->rwlock, &attr);
+    pthread_rwlockattr_destroy(&attr);
+    if (rc) {
+        rc = AR_EFAILED;
+        AR_LOG_ERR(AR_OSAL_RWLOCK_LOG_TAG,"%s: failed to initialize rwlock\n", __func__);
+        goto fail;
+    }
+
+    *ar_osal_rwlock = the_rwlock;
+    return 0;
+
+fail:
+    free(the_rwlock);
+
+exit:
+    return rc;
+}
+
+_IRQL_requires_max_(PASSIVE_LEVEL)
+int32_t ar_osal_rwlock_destroy(_In_ ar_osal_rwlock_t ar_osal_rwlock)
+{
+    int32_t rc = 0;
+    osal_int_rwlock_t *the_rwlock = ar_osal_rwlock;
+
+    if (NULL == the_rwlock) {
+        return AR_EBADPARAM;
+    }
+
+    rc = pthread_rwlock_destroy(&the_rwlock->rwlock);
+    if (rc) {
+        AR_LOG_ERR(AR_OSAL_RWLOCK_LOG_TAG,"%s: Failed to destroy rwlock\n", __func__);
+        rc = AR_EFAILED;
+        goto exit;
+    }
+    free(the_rwlock);
+
+exit:
+    return rc;
+}
+
+_IRQL_requires_min_(PASSIVE_LEVEL)
+int32_t ar_osal_rwlock_read_lock(_In_ ar_osal_rwlock_t ar_osal_rwlock)
+{
+    int32_t rc;
+    osal_int_rwlock_t *the_rwlock = ar_osal_rwlock;
+
+    if (NULL == the_rwlock) {
+        AR_LOG_ERR(AR_OSAL_RWLOCK_LOG_TAG,"%s: ar_osal_rwlock is NULL\n", __func__);
+        return AR_EBADPARAM;
+    }
+
+    rc = pthread_rwlock_rdlock(&the_rwlock->rwlock);
+    if (rc) {
+        AR_LOG_ERR(AR_OSAL_RWLOCK_LOG_TAG,"%s: Failed to read lock ar_osal_rwlock\n", __func__);
+        rc = AR_EFAILED;
+    }
+    return rc;
+}
+
+_IRQL_requires_min_(PASSIVE_LEVEL)
+int32_t ar_osal_rwlock_write_lock(_In_ ar_osal_rwlock_t ar_osal_rwlock)
+{
+    int32_t rc;
+    osal_int_rwlock_t *the_rwlock = ar_osal_rwlock;
+
+    if (NULL == the_rwlock) {
+        AR_LOG_ERR(AR_OSAL_RWLOCK_LOG_TAG,"%s: ar_osal_rwlock is NULL\n", __func__);
+        return AR_EBADPARAM;
+    }
+
+    rc = pthread_rwlock_wrlock(&the_rwlock->rwlock);
+    if (rc) {
+        AR_LOG_ERR(AR_OSAL_RWLOCK_LOG_TAG,"%s: Failed to write lock ar_osal_rwlock\n", __func__);
+        rc = AR_EFAILED;
+    }
+    return rc;
+}
+
+_IRQL_requires_min_(PASSIVE_LEVEL)
+int32_t ar_osal_rwlock_unlock(_In_ ar_osal_rwlock_t ar_osal_rwlock)
+{
+    int32_t rc;
+    osal_int_rwlock_t *the_rwlock = ar_osal_rwlock;
+
+    if (NULL == the_rwlock) {
+        AR_LOG_ERR(AR_OSAL_RWLOCK_LOG_TAG,"%s: ar_osal_rwlock is NULL\n", __func__);
+        return AR_EBADPARAM;
+    }
+
+    rc = pthread_rwlock_unlock(&the_rwlock->rwlock);
+    if (rc) {
+        AR_LOG_ERR(AR_OSAL_RWLOCK_LOG_TAG,"%s: Failed to release ar_osal_rwlock\n", __func__);
+        rc = AR_EFAILED;
+    }
+    return rc;
+}
@@ -120,6 +120,49 @@ typedef struct ar_data_log_generic_pkt_info_t
                                              the generic log packet */
 }ar_data_log_generic_pkt_info_t;
 
+/*
+-------------------------------------------------------------------------------
+    Asynchronous Logging
+-------------------------------------------------------------------------------
+*/
+
+/**< Ring size used when ar_data_log_async_config_t::ring_size is zero */
+#define AR_DATA_LOG_ASYNC_DEFAULT_RING_SIZE (256 * 1024)
+
+/**< Max log packet size used when logging to a file sink */
+#define AR_DATA_LOG_ASYNC_FILE_MAX_PKT_SIZE 4096
+
+/**< Configuration for ar_data_log_async_start(...) */
+typedef struct ar_data_log_async_config_t
+{
+    uint32_t ring_size;             /**< Size of the ring buffer in bytes. Rounded up
+                                         to a power of 2. Zero selects
+                                         AR_DATA_LOG_ASYNC_DEFAULT_RING_SIZE */
+    const char_t *file_path;        /**< Path of the file that log packets are
+                                         appended to. If NULL, log packets are
+                                         sent through the data transport */
+}ar_data_log_async_config_t;
+
+/**< Header written to the file sink in front of each log packet */
+typedef struct ar_data_log_file_record_t
+{
+    uint16_t log_code;              /**< The log code of the packet */
+    uint16_t reserved;              /**< Reserved. Set to 0 */
+    uint32_t length;                /**< The length of the log packet that
+                                         follows this header */
+}ar_data_log_file_record_t;
+
+/**< Data logging counters returned by ar_data_log_get_stats(...) */
+typedef struct ar_data_log_stats_t
+{
+    uint32_t num_pkts_queued;       /**< Packets committed to the ring buffer */
+    uint32_t num_pkts_logged;       /**< Packets handed to the transport or file sink */
+    uint32_t num_pkts_dropped;      /**< Packets that could not be allocated */
+    uint32_t num_bytes_dropped;     /**< Total size of the dropped packets */
+    uint32_t num_sink_errors;       /**< Packets the transport or file sink failed
+                                         to log */
+}ar_data_log_stats_t;
+
 /*
 -------------------------------------------------------------------------------
     Data Logging Formats for AR_DATA_LOG_PKT_TYPE_GENERIC
@@ -257,6 +300,57 @@ int32_t ar_data_log_submit(ar_data_log_submit_info_t *info);
 */
 void ar_data_log_free(void *log_pkt_payload_ptr, ar_log_pkt_type_t pkt_type);
 
+/**
+* \brief
+*   Starts asynchronous data logging. Log packets are allocated from a
+*   lock-free ring buffer and committing a packet only publishes it. A
+*   background thread drains the ring to the data transport or to a file.
+*   Packets that do not fit in the ring are dropped and counted.
+*
+* \param[in] config: The ring and sink configuration. NULL selects the
+*                    default ring size and the data transport
+*
+* \return
+* AR_EOK          -- Success
+* AR_EALREADY     -- Asynchronous logging is already started
+* AR_EUNSUPPORTED -- The data transport cannot send log packets
+* Nonzero         -- Failure
+*
+* \dependencies
+*   Must call ar_data_log_init(...) first. Must not be called while
+*   clients are logging
+*/
+int32_t ar_data_log_async_start(const ar_data_log_async_config_t *config);
+
+/**
+* \brief
+*   Logs the packets committed to the ring buffer, stops the drain thread
+*   and returns to synchronous logging
+*
+* \return
+* 0       -- Success
+* Nonzero -- Failure
+*
+* \dependencies
+*   Must not be called while clients are logging
+*/
+int32_t ar_data_log_async_stop(void);
+
+/**
+* \brief
+*   Retrieves the data logging counters
+*
+* \param[out] stats: The counters accumulated since ar_data_log_init(...)
+*
+* \return
+* 0       -- Success
+* Nonzero -- Failure
+*
+* \dependencies
+*   None
+*/
+int32_t ar_data_log_get_stats(ar_data_log_stats_t *stats);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
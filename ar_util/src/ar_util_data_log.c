@@ -9,6 +9,7 @@
 *  SPDX-License-Identifier: BSD-3-Clause
 */
 
+#include <stdatomic.h>
 #include "ar_util_log_pkt_i.h"
 #include "ar_util_data_log.h"
 #include "ar_osal_error.h"
@@ -16,6 +17,11 @@
 #include "ar_osal_mem_op.h"
 #include "ar_osal_log_pkt_op.h"
 #include "ar_osal_types.h"
+#include "ar_osal_heap.h"
+#include "ar_osal_signal.h"
+#include "ar_osal_thread.h"
+#include "ar_osal_timer.h"
+#include "ar_osal_file_io.h"
 
 #define AR_DATA_LOG_LOG_TAG "AR Data Logger"
 #define AR_DATA_LOG_ERR(...) AR_LOG_ERR(AR_DATA_LOG_LOG_TAG, __VA_ARGS__)
@@ -33,8 +39,74 @@ typedef struct fragment_info_t
     uint32_t number;
     uint32_t length;
     uint32_t offset;
+    uint64_t time_stamp;
 }fragment_info_t;
 
+/*
+-------------------------------------------------------------------------------
+|    Asynchronous logging ring buffer
+|
+|    Producers reserve records by advancing reserve_pos with a CAS and
+|    publish them by storing the record state. The drain thread logs the
+|    records in order up to the first unpublished one, zeroes them and
+|    advances release_pos. A record that would wrap is preceded by a pad
+|    record that fills the end of the ring.
+|
+|    The drain thread sleeps without a timeout while the ring is empty and
+|    the producer that publishes the first record wakes it. While records
+|    are queued it drains them every flush interval, or as soon as the ring
+|    is half full.
+-------------------------------------------------------------------------------
+*/
+#define AR_DATA_LOG_RING_REC_ALIGN      16
+#define AR_DATA_LOG_RING_REC_COMMITTED  0x1
+#define AR_DATA_LOG_RING_REC_DISCARDED  0x2
+#define AR_DATA_LOG_RING_REC_PAD        0x3
+#define AR_DATA_LOG_RING_REC_FLAG_MASK  (AR_DATA_LOG_RING_REC_ALIGN - 1)
+/**< Interval at which the drain thread flushes a non-empty ring */
+#define AR_DATA_LOG_FLUSH_INTERVAL_NS   (5 * 1000 * 1000)
+
+#define AR_DATA_LOG_RING_REC_SIZE(length) \
+    ((sizeof(ar_data_log_ring_rec_t) + (length) + \
+    AR_DATA_LOG_RING_REC_ALIGN - 1) & ~(AR_DATA_LOG_RING_REC_ALIGN - 1))
+
+typedef struct ar_data_log_ring_rec_t
+{
+    /**< Record size | record flag. Zero while the record is being filled */
+    atomic_uint state;
+    uint32_t length;
+    uint16_t log_code;
+    uint16_t reserved[3];
+}ar_data_log_ring_rec_t;
+
+typedef struct ar_data_log_async_t
+{
+    uint8_t *ring;
+    uint32_t ring_size;
+    uint32_t max_pkt_size;
+    _Atomic uint64_t reserve_pos;
+    _Atomic uint64_t release_pos;
+    atomic_bool wake_pending;
+    /**< Set while the drain thread waits on an empty ring */
+    atomic_bool idle;
+    atomic_bool stop;
+    ar_osal_signal_t signal;
+    ar_osal_thread_t thread;
+    ar_fhandle file;
+}ar_data_log_async_t;
+
+typedef struct ar_data_log_counters_t
+{
+    atomic_uint num_pkts_queued;
+    atomic_uint num_pkts_logged;
+    atomic_uint num_pkts_dropped;
+    atomic_uint num_bytes_dropped;
+    atomic_uint num_sink_errors;
+}ar_data_log_counters_t;
+
+static ar_data_log_async_t *ar_data_log_async = NULL;
+static ar_data_log_counters_t ar_data_log_counters;
+
 /*
 -------------------------------------------------------------------------------
 |    Internal Helper Function Prototypes
@@ -65,6 +137,20 @@ static int32_t _log_generic_pkt(
 static int32_t _log_raw_pkt(
     void *log_pkt, int8_t *buffer, uint32_t buffer_size);
 
+static uint32_t _get_max_log_pkt_size(void);
+
+static void *_pkt_alloc(uint16_t log_code, uint32_t length);
+
+static int32_t _pkt_commit(void *log_pkt);
+
+static void _pkt_free(void *log_pkt);
+
+static uint64_t _get_time_stamp(uint64_t client_time_stamp);
+
+static void _async_drain(ar_data_log_async_t *async);
+
+static void _async_thread(void *param);
+
 /*
 -------------------------------------------------------------------------------
 |    Public Functions
@@ -74,6 +160,8 @@ int32_t ar_data_log_init()
 {
     int32_t status = AR_EOK;
 
+    ar_mem_set(&ar_data_log_counters, 0, sizeof(ar_data_log_counters));
+
     status = ar_log_pkt_op_init(NULL);
     if (AR_FAILED(status))
     {
@@ -87,6 +175,9 @@ int32_t ar_data_log_deinit()
 {
     int32_t status = AR_EOK;
 
+    if (ar_data_log_async)
+        ar_data_log_async_stop();
+
     status = ar_log_pkt_op_deinit();
     if (AR_FAILED(status))
     {
@@ -98,12 +189,16 @@ int32_t ar_data_log_deinit()
 
 bool_t ar_data_log_code_status(uint16_t log_code)
 {
+    /* The file sink logs every log code */
+    if (ar_data_log_async && ar_data_log_async->file)
+        return TRUE;
+
     return ar_log_code_status(log_code);
 }
 
 uint32_t ar_data_log_get_max_packet_size()
 {
-    return ar_log_pkt_get_max_size();
+    return _get_max_log_pkt_size();
 }
 
 void *ar_data_log_alloc(ar_data_log_alloc_info_t *info)
@@ -172,8 +267,8 @@ int32_t ar_data_log_commit(ar_data_log_commit_info_t *info)
         log_pkt_pcm->header.cmn_struct.user_session_info.tag = AR_AUDIOLOG_CNTR_USER_SESSION;
         log_pkt_pcm->header.cmn_struct.user_session_info.size = sizeof(ar_log_pkt_user_session_t);
         log_pkt_pcm->header.cmn_struct.user_session_info.user_session_id = 0;
-        uint64_t timestamp = 0;// posal_timer_get_time(); ar osal needs to support timer op
-        log_pkt_pcm->header.cmn_struct.user_session_info.time_stamp = timestamp;
+        log_pkt_pcm->header.cmn_struct.user_session_info.time_stamp =
+            _get_time_stamp(pcm_log_pkt_info->log_time_stamp);
 
         log_pkt_pcm->header.pcm_data_fmt.tag = AR_AUDIOLOG_CNTR_PCM_DATA_FORMAT;
         log_pkt_pcm->header.pcm_data_fmt.size = sizeof(ar_log_pkt_pcm_data_format_t);
@@ -211,6 +306,9 @@ int32_t ar_data_log_commit(ar_data_log_commit_info_t *info)
     }
     case AR_DATA_LOG_PKT_TYPE_AUDIO_BITSTREAM:
     {
+        ar_data_log_pcm_pkt_info_t *bs_log_pkt_info =
+            (ar_data_log_pcm_pkt_info_t*)info->pkt_info;
+
         ar_data_log_pkt_bit_stream_t *log_pkt_bitstream =
             (ar_data_log_pkt_bit_stream_t *)(
             (uint8_t *)info->log_pkt_data - sizeof(ar_data_log_pkt_bit_stream_t));
@@ -225,8 +323,8 @@ int32_t ar_data_log_commit(ar_data_log_commit_info_t *info)
         log_pkt_bitstream->header.cmn_struct.user_session_info.tag = AR_AUDIOLOG_CNTR_USER_SESSION;
         log_pkt_bitstream->header.cmn_struct.user_session_info.size = sizeof(ar_log_pkt_user_session_t);
         log_pkt_bitstream->header.cmn_struct.user_session_info.user_session_id = 0;
-        uint64_t timestamp = 0;//posal_timer_get_time(); ar osal needs to support timer op
-        log_pkt_bitstream->header.cmn_struct.user_session_info.time_stamp = timestamp;
+        log_pkt_bitstream->header.cmn_struct.user_session_info.time_stamp =
+            _get_time_stamp(bs_log_pkt_info ? bs_log_pkt_info->log_time_stamp : 0);
 
         log_pkt_bitstream->header.bs_data_fmt.tag = AR_AUDIOLOG_CNTR_BS_DATA_FORMAT;
         log_pkt_bitstream->header.bs_data_fmt.size = sizeof(ar_log_pkt_bitstream_data_format_t);
@@ -251,7 +349,8 @@ int32_t ar_data_log_commit(ar_data_log_commit_info_t *info)
         log_pkt_generic->header.info.fragment_length = (uint16_t)info->buffer_size;
         log_pkt_generic->header.info.fragment_offset = 0;
         log_pkt_generic->header.info.buffer_length = info->buffer_size;
-        log_pkt_generic->header.info.time_stamp = pkt_info->log_time_stamp;
+        log_pkt_generic->header.info.time_stamp =
+            _get_time_stamp(pkt_info->log_time_stamp);
 
         log_pkt_generic->header.cmd.header_length = 1;
         log_pkt_generic->header.cmd.version = 1;
@@ -270,7 +369,7 @@ int32_t ar_data_log_commit(ar_data_log_commit_info_t *info)
         return AR_EUNSUPPORTED;
     }
 
-    status = ar_log_pkt_commit(log_pkt);
+    status = _pkt_commit(log_pkt);
     if (AR_FAILED(status))
     {
         AR_DATA_LOG_ERR("Status[%d]: Unable to commit log packet for Packet Type#%d.",
@@ -314,6 +413,24 @@ int32_t ar_data_log_submit(ar_data_log_submit_info_t *info)
     buffer_ptr = info->buffer;
     remaining_buffer_size = info->buffer_size;
 
+    /* All fragments of the buffer share one time stamp */
+    switch (info->pkt_type)
+    {
+    case AR_DATA_LOG_PKT_TYPE_AUDIO_BITSTREAM:
+    case AR_DATA_LOG_PKT_TYPE_AUDIO_PCM:
+        if (info->pkt_info)
+            fragment.time_stamp = _get_time_stamp(
+                ((ar_data_log_pcm_pkt_info_t*)info->pkt_info)->log_time_stamp);
+        break;
+    case AR_DATA_LOG_PKT_TYPE_GENERIC:
+        if (info->pkt_info)
+            fragment.time_stamp = _get_time_stamp(
+                ((ar_data_log_generic_pkt_info_t*)info->pkt_info)->log_time_stamp);
+        break;
+    default:
+        break;
+    }
+
     fragment.total_count = (remaining_buffer_size % max_log_pkt_size) == 0 ?
         (remaining_buffer_size / max_log_pkt_size) :
         (remaining_buffer_size / max_log_pkt_size) + 1;
@@ -333,7 +450,11 @@ int32_t ar_data_log_submit(ar_data_log_submit_info_t *info)
             log_pkt_size, info->log_code, TRUE, info->pkt_type);
         if (!log_pkt)
         {
-            AR_DATA_LOG_ERR("Status[%d]: _log_alloc_pkt failed", AR_ENOMEMORY);
+            /* A full ring is counted by the drop counters rather than
+             * logged on the caller's thread */
+            if (!ar_data_log_async)
+                AR_DATA_LOG_ERR("Status[%d]: _log_alloc_pkt failed",
+                    AR_ENOMEMORY);
             return AR_ENOMEMORY;
         }
         fragment.length = log_pkt_size;
@@ -385,7 +506,7 @@ int32_t ar_data_log_submit(ar_data_log_submit_info_t *info)
 
         if (AR_FAILED(status))
         {
-            ar_log_pkt_free(log_pkt);
+            _pkt_free(log_pkt);
             return status;
         }
 
@@ -440,7 +561,181 @@ void ar_data_log_free(void *log_pkt_payload_ptr, ar_log_pkt_type_t pkt_type)
 
     log_pkt_ptr = (uint8_t*)log_pkt_payload_ptr - log_header_size;
 
-    ar_log_pkt_free(log_pkt_ptr);
+    _pkt_free(log_pkt_ptr);
+}
+
+int32_t ar_data_log_async_start(const ar_data_log_async_config_t *config)
+{
+    int32_t status = AR_EOK;
+    ar_data_log_async_t *async = NULL;
+    uint32_t ring_size = AR_DATA_LOG_ASYNC_DEFAULT_RING_SIZE;
+    uint32_t max_pkt_size = 0;
+    ar_osal_thread_attr_t thread_attr = { 0 };
+    ar_heap_info heap_info = {
+        .align_bytes = AR_HEAP_ALIGN_16_BYTES,
+        .pool_type = AR_HEAP_POOL_DEFAULT,
+        .heap_id = AR_HEAP_ID_DEFAULT,
+        .tag = AR_HEAP_TAG_DEFAULT
+    };
+
+    if (ar_data_log_async)
+        return AR_EALREADY;
+
+    if (config && config->ring_size)
+    {
+        if (config->ring_size > 0x80000000)
+        {
+            AR_DATA_LOG_ERR("Status[%d]: Ring size of %u bytes is too large",
+                AR_EBADPARAM, config->ring_size);
+            return AR_EBADPARAM;
+        }
+
+        for (ring_size = AR_DATA_LOG_RING_REC_ALIGN;
+            ring_size < config->ring_size; ring_size <<= 1);
+    }
+
+    max_pkt_size = (config && config->file_path) ?
+        AR_DATA_LOG_ASYNC_FILE_MAX_PKT_SIZE : ar_log_pkt_get_max_size();
+    if (0 == max_pkt_size)
+    {
+        AR_DATA_LOG_DBG("Status[%d]: The transport layer does not "
+            "support log packets", AR_EUNSUPPORTED);
+        return AR_EUNSUPPORTED;
+    }
+
+    /* The largest packet must leave room for the packets queued behind it */
+    if (AR_DATA_LOG_RING_REC_SIZE(max_pkt_size) > ring_size / 4)
+    {
+        AR_DATA_LOG_ERR("Status[%d]: Ring size of %u bytes is too small "
+            "for %u byte log packets", AR_EBADPARAM, ring_size, max_pkt_size);
+        return AR_EBADPARAM;
+    }
+
+    async = ar_heap_calloc(sizeof(ar_data_log_async_t), &heap_info);
+    if (!async)
+        return AR_ENOMEMORY;
+
+    async->ring = ar_heap_calloc(ring_size, &heap_info);
+    if (!async->ring)
+    {
+        status = AR_ENOMEMORY;
+        goto end;
+    }
+
+    async->ring_size = ring_size;
+    async->max_pkt_size = max_pkt_size;
+    atomic_init(&async->reserve_pos, 0);
+    atomic_init(&async->release_pos, 0);
+    atomic_init(&async->wake_pending, FALSE);
+    atomic_init(&async->idle, FALSE);
+    atomic_init(&async->stop, FALSE);
+
+    if (config && config->file_path)
+    {
+        status = ar_fopen(&async->file, config->file_path,
+            AR_FOPEN_WRITE_ONLY_APPEND);
+        if (AR_FAILED(status))
+        {
+            AR_DATA_LOG_ERR("Status[%d]: Unable to open %s",
+                status, config->file_path);
+            goto end;
+        }
+    }
+
+    status = ar_osal_signal_create(&async->signal);
+    if (AR_FAILED(status))
+        goto end;
+
+    status = ar_osal_thread_attr_init(&thread_attr);
+    if (AR_FAILED(status))
+        goto end;
+
+    thread_attr.thread_name = "ar_data_log";
+    status = ar_osal_thread_create(&async->thread, &thread_attr,
+        _async_thread, async);
+    if (AR_FAILED(status))
+        goto end;
+
+    ar_data_log_async = async;
+
+    AR_DATA_LOG_INFO("Asynchronous logging started with a %u byte ring",
+        ring_size);
+
+    return AR_EOK;
+
+end:
+    AR_DATA_LOG_ERR("Status[%d]: Failed to start asynchronous logging",
+        status);
+
+    if (async->signal)
+        ar_osal_signal_destroy(async->signal);
+    if (async->file)
+        ar_fclose(async->file);
+    if (async->ring)
+        ar_heap_free(async->ring, &heap_info);
+    ar_heap_free(async, &heap_info);
+
+    return status;
+}
+
+int32_t ar_data_log_async_stop(void)
+{
+    int32_t status = AR_EOK;
+    ar_data_log_async_t *async = ar_data_log_async;
+    ar_heap_info heap_info = {
+        .align_bytes = AR_HEAP_ALIGN_16_BYTES,
+        .pool_type = AR_HEAP_POOL_DEFAULT,
+        .heap_id = AR_HEAP_ID_DEFAULT,
+        .tag = AR_HEAP_TAG_DEFAULT
+    };
+
+    if (!async)
+        return AR_EOK;
+
+    /* The drain thread logs the remaining packets before it exits */
+    atomic_store(&async->stop, TRUE);
+    ar_osal_signal_set(async->signal);
+
+    status = ar_osal_thread_join_destroy(async->thread);
+    if (AR_FAILED(status))
+    {
+        AR_DATA_LOG_ERR("Status[%d]: Failed to join the drain thread",
+            status);
+        return status;
+    }
+
+    ar_data_log_async = NULL;
+
+    if (atomic_load(&async->reserve_pos) != atomic_load(&async->release_pos))
+        AR_DATA_LOG_ERR("Status[%d]: Packets allocated from the ring were "
+            "never committed or freed", AR_EFAILED);
+
+    ar_osal_signal_destroy(async->signal);
+    if (async->file)
+        ar_fclose(async->file);
+    ar_heap_free(async->ring, &heap_info);
+    ar_heap_free(async, &heap_info);
+
+    return status;
+}
+
+int32_t ar_data_log_get_stats(ar_data_log_stats_t *stats)
+{
+    if (!stats)
+        return AR_EBADPARAM;
+
+    stats->num_pkts_queued =
+        atomic_load_explicit(&ar_data_log_counters.num_pkts_queued, memory_order_relaxed);
+    stats->num_pkts_logged =
+        atomic_load_explicit(&ar_data_log_counters.num_pkts_logged, memory_order_relaxed);
+    stats->num_pkts_dropped =
+        atomic_load_explicit(&ar_data_log_counters.num_pkts_dropped, memory_order_relaxed);
+    stats->num_bytes_dropped =
+        atomic_load_explicit(&ar_data_log_counters.num_bytes_dropped, memory_order_relaxed);
+    stats->num_sink_errors =
+        atomic_load_explicit(&ar_data_log_counters.num_sink_errors, memory_order_relaxed);
+
+    return AR_EOK;
 }
 
 /*
@@ -453,7 +748,7 @@ int32_t _get_max_log_pkt_data_size(
     ar_log_pkt_type_t pkt_type, uint32_t *max_log_pkt_data_size)
 {
     int32_t status = AR_EOK;
-    uint32_t max_log_pkt_size = ar_log_pkt_get_max_size();
+    uint32_t max_log_pkt_size = _get_max_log_pkt_size();
     uint32_t log_header_size = 0;
 
     if (0 == max_log_pkt_size)
@@ -530,7 +825,7 @@ void *_log_alloc_pkt(
     //AR_DATA_LOG_DBG("Req Pkt Size %u : bytes for log code 0x%X",
     //    log_pkt_size, log_code);
 
-    log_pkt_ptr = ar_log_pkt_alloc((uint16_t)log_code, log_pkt_size);
+    log_pkt_ptr = _pkt_alloc((uint16_t)log_code, log_pkt_size);
     if (!log_pkt_ptr)
         return NULL;
 
@@ -605,8 +900,7 @@ static int32_t _log_bitsream_pkt(
     log_header_cmn->user_session_info.size = sizeof(ar_log_pkt_user_session_t);
     /* User session ID is un-used */
     log_header_cmn->user_session_info.user_session_id = 0;
-    log_header_cmn->user_session_info.time_stamp =
-        pcm_log_pkt_info->log_time_stamp;
+    log_header_cmn->user_session_info.time_stamp = fragment->time_stamp;
 
     /********** AUDIOLOG_BITSTREAM_DATA_FORAMT *************/
     bs_data_fmt->tag = AR_AUDIOLOG_CNTR_BS_DATA_FORMAT;
@@ -627,7 +921,7 @@ static int32_t _log_bitsream_pkt(
         return status;
     }
 
-    status = ar_log_pkt_commit(log_pkt);
+    status = _pkt_commit(log_pkt);
     if (AR_FAILED(status))
     {
         AR_DATA_LOG_ERR("Status[%d]: Unable to commit bitstream log packet.",
@@ -717,8 +1011,7 @@ static int32_t _log_pcm_pkt(
     log_header_cmn->user_session_info.size = sizeof(ar_log_pkt_user_session_t);
     /* User session ID is un-used */
     log_header_cmn->user_session_info.user_session_id = 0;
-    log_header_cmn->user_session_info.time_stamp =
-        pcm_log_pkt_info->log_time_stamp;
+    log_header_cmn->user_session_info.time_stamp = fragment->time_stamp;
 
     /*************** AUDIOLOG_PCM_DATA_FORAMT ***************/
     pcm_data_fmt->tag = AR_AUDIOLOG_CNTR_PCM_DATA_FORMAT;
@@ -794,7 +1087,7 @@ static int32_t _log_pcm_pkt(
         }
     }
 
-    status = ar_log_pkt_commit(log_pkt);
+    status = _pkt_commit(log_pkt);
     if (AR_FAILED(status))
     {
         AR_DATA_LOG_ERR("Status[%d]: Unable to commit pcm log packet.",
@@ -838,7 +1131,7 @@ static int32_t _log_generic_pkt(
     generic_log_pkt->header.info.fragment_num = (uint16_t)fragment->number;
     generic_log_pkt->header.info.fragment_length = (uint16_t)fragment->length;
     generic_log_pkt->header.info.fragment_offset = fragment->offset;
-    generic_log_pkt->header.info.time_stamp = pkt_info->log_time_stamp;
+    generic_log_pkt->header.info.time_stamp = fragment->time_stamp;
 
     generic_log_pkt->header.cmd.header_length = sizeof(ar_log_pkt_data_format_header_t) - sizeof(uint32_t);
     generic_log_pkt->header.cmd.version = 1;
@@ -854,7 +1147,7 @@ static int32_t _log_generic_pkt(
         return status;
     }
 
-    status = ar_log_pkt_commit(log_pkt);
+    status = _pkt_commit(log_pkt);
     if (AR_FAILED(status))
     {
         AR_DATA_LOG_ERR("Status[%d]: Unable to commit generic log packet.",
@@ -868,7 +1161,7 @@ static int32_t _log_raw_pkt(
     void *log_pkt, int8_t *buffer, uint32_t buffer_size)
 {
     int32_t     status = AR_EOK;
-    uint32_t    max_log_pkt_size = ar_log_pkt_get_max_size();
+    uint32_t    max_log_pkt_size = _get_max_log_pkt_size();
 
     if (buffer_size > max_log_pkt_size)
     {
@@ -885,7 +1178,7 @@ static int32_t _log_raw_pkt(
         return status;
     }
 
-    status = ar_log_pkt_commit(log_pkt);
+    status = _pkt_commit(log_pkt);
     if (AR_FAILED(status))
     {
         AR_DATA_LOG_ERR("Status[%d]: Unable to commit raw log packet.",
@@ -894,3 +1187,260 @@ static int32_t _log_raw_pkt(
 
     return status;
 }
+
+static uint32_t _get_max_log_pkt_size(void)
+{
+    if (ar_data_log_async)
+        return ar_data_log_async->max_pkt_size;
+
+    return ar_log_pkt_get_max_size();
+}
+
+static uint64_t _get_time_stamp(uint64_t client_time_stamp)
+{
+    if (client_time_stamp)
+        return client_time_stamp;
+
+    return ar_timer_get_time_in_us();
+}
+
+static bool_t _is_ring_pkt(ar_data_log_async_t *async, void *log_pkt)
+{
+    return async &&
+        (uint8_t*)log_pkt >= async->ring &&
+        (uint8_t*)log_pkt < async->ring + async->ring_size;
+}
+
+static void _count_drop(uint32_t length)
+{
+    atomic_fetch_add_explicit(
+        &ar_data_log_counters.num_pkts_dropped, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(
+        &ar_data_log_counters.num_bytes_dropped, length, memory_order_relaxed);
+}
+
+static void *_pkt_alloc(uint16_t log_code, uint32_t length)
+{
+    ar_data_log_async_t *async = ar_data_log_async;
+    ar_data_log_ring_rec_t *rec = NULL;
+    void *log_pkt = NULL;
+    uint64_t head = 0;
+    uint64_t tail = 0;
+    uint32_t offset = 0;
+    uint32_t pad_size = 0;
+    uint32_t rec_size = 0;
+
+    if (!async)
+    {
+        log_pkt = ar_log_pkt_alloc(log_code, length);
+        if (!log_pkt && ar_log_code_status(log_code))
+            _count_drop(length);
+        return log_pkt;
+    }
+
+    if (length > async->max_pkt_size)
+    {
+        _count_drop(length);
+        return NULL;
+    }
+
+    rec_size = (uint32_t)AR_DATA_LOG_RING_REC_SIZE(length);
+    do
+    {
+        /* Reading release_pos first keeps it at or below reserve_pos */
+        tail = atomic_load_explicit(&async->release_pos, memory_order_acquire);
+        head = atomic_load_explicit(&async->reserve_pos, memory_order_relaxed);
+        offset = (uint32_t)(head & (async->ring_size - 1));
+        pad_size = offset + rec_size > async->ring_size ?
+            async->ring_size - offset : 0;
+
+        if (head + pad_size + rec_size - tail > async->ring_size)
+        {
+            _count_drop(length);
+            return NULL;
+        }
+    } while (!atomic_compare_exchange_weak_explicit(&async->reserve_pos,
+        &head, head + pad_size + rec_size,
+        memory_order_relaxed, memory_order_relaxed));
+
+    if (pad_size)
+    {
+        rec = (ar_data_log_ring_rec_t*)(async->ring + offset);
+        atomic_store_explicit(&rec->state,
+            pad_size | AR_DATA_LOG_RING_REC_PAD, memory_order_release);
+        offset = 0;
+    }
+
+    rec = (ar_data_log_ring_rec_t*)(async->ring + offset);
+    rec->length = length;
+    rec->log_code = log_code;
+
+    /* Wake the drain thread early once the ring is half full */
+    if (head + pad_size + rec_size - tail > async->ring_size / 2 &&
+        !atomic_exchange_explicit(&async->wake_pending, TRUE,
+            memory_order_relaxed))
+        ar_osal_signal_set(async->signal);
+
+    return (void*)(rec + 1);
+}
+
+static void _pkt_publish(ar_data_log_async_t *async, void *log_pkt,
+    uint32_t flag)
+{
+    ar_data_log_ring_rec_t *rec = (ar_data_log_ring_rec_t*)log_pkt - 1;
+
+    atomic_store_explicit(&rec->state,
+        (uint32_t)AR_DATA_LOG_RING_REC_SIZE(rec->length) | flag,
+        memory_order_release);
+
+    /* Pairs with the fence in _async_thread. Either the drain thread sees
+     * the reserved record or this producer sees it idle and wakes it */
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&async->idle, memory_order_relaxed) &&
+        atomic_exchange_explicit(&async->idle, FALSE, memory_order_relaxed))
+        ar_osal_signal_set(async->signal);
+}
+
+static int32_t _pkt_commit(void *log_pkt)
+{
+    int32_t status = AR_EOK;
+
+    if (_is_ring_pkt(ar_data_log_async, log_pkt))
+    {
+        _pkt_publish(ar_data_log_async, log_pkt,
+            AR_DATA_LOG_RING_REC_COMMITTED);
+        atomic_fetch_add_explicit(&ar_data_log_counters.num_pkts_queued, 1,
+            memory_order_relaxed);
+        return AR_EOK;
+    }
+
+    status = ar_log_pkt_commit(log_pkt);
+    atomic_fetch_add_explicit(AR_SUCCEEDED(status) ?
+        &ar_data_log_counters.num_pkts_logged :
+        &ar_data_log_counters.num_sink_errors, 1, memory_order_relaxed);
+
+    return status;
+}
+
+static void _pkt_free(void *log_pkt)
+{
+    if (_is_ring_pkt(ar_data_log_async, log_pkt))
+    {
+        _pkt_publish(ar_data_log_async, log_pkt,
+            AR_DATA_LOG_RING_REC_DISCARDED);
+        return;
+    }
+
+    ar_log_pkt_free(log_pkt);
+}
+
+static int32_t _async_sink(ar_data_log_async_t *async,
+    ar_data_log_ring_rec_t *rec)
+{
+    int32_t status = AR_EOK;
+    void *log_pkt = NULL;
+    size_t bytes_written = 0;
+    ar_data_log_file_record_t file_rec = { 0 };
+
+    if (async->file)
+    {
+        file_rec.log_code = rec->log_code;
+        file_rec.length = rec->length;
+
+        status = ar_fwrite(async->file, &file_rec, sizeof(file_rec),
+            &bytes_written);
+        if (AR_SUCCEEDED(status))
+            status = ar_fwrite(async->file, rec + 1, rec->length,
+                &bytes_written);
+        return status;
+    }
+
+    log_pkt = ar_log_pkt_alloc(rec->log_code, rec->length);
+    if (!log_pkt)
+        return AR_ENOMEMORY;
+
+    ar_mem_cpy(log_pkt, rec->length, rec + 1, rec->length);
+
+    return ar_log_pkt_commit(log_pkt);
+}
+
+static void _async_drain(ar_data_log_async_t *async)
+{
+    int32_t status = AR_EOK;
+    ar_data_log_ring_rec_t *rec = NULL;
+    uint64_t pos = 0;
+    uint32_t offset = 0;
+    uint32_t state = 0;
+    uint32_t rec_size = 0;
+
+    pos = atomic_load_explicit(&async->release_pos, memory_order_relaxed);
+    while (pos != atomic_load_explicit(&async->reserve_pos,
+        memory_order_relaxed))
+    {
+        offset = (uint32_t)(pos & (async->ring_size - 1));
+        rec = (ar_data_log_ring_rec_t*)(async->ring + offset);
+
+        /* Packets are logged in order, so stop at the first packet
+         * that is still being filled */
+        state = atomic_load_explicit(&rec->state, memory_order_acquire);
+        if (0 == state)
+            break;
+
+        rec_size = state & ~AR_DATA_LOG_RING_REC_FLAG_MASK;
+        if (AR_DATA_LOG_RING_REC_COMMITTED ==
+            (state & AR_DATA_LOG_RING_REC_FLAG_MASK))
+        {
+            status = _async_sink(async, rec);
+            atomic_fetch_add_explicit(AR_SUCCEEDED(status) ?
+                &ar_data_log_counters.num_pkts_logged :
+                &ar_data_log_counters.num_sink_errors, 1,
+                memory_order_relaxed);
+        }
+
+        /* Record headers of the next lap may land anywhere in this
+         * record, so clear all of it before handing it back */
+        ar_mem_set(rec, 0, rec_size);
+        pos += rec_size;
+        atomic_store_explicit(&async->release_pos, pos, memory_order_release);
+    }
+}
+
+static void _async_thread(void *param)
+{
+    ar_data_log_async_t *async = (ar_data_log_async_t*)param;
+    uint32_t num_pkts_dropped = 0;
+    uint32_t last_num_pkts_dropped = 0;
+
+    while (!atomic_load(&async->stop))
+    {
+        atomic_store_explicit(&async->idle, TRUE, memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);
+        if (atomic_load_explicit(&async->reserve_pos, memory_order_relaxed) ==
+            atomic_load_explicit(&async->release_pos, memory_order_relaxed))
+        {
+            /* Nothing to drain, sleep until a packet is published */
+            ar_osal_signal_wait(async->signal);
+            ar_osal_signal_clear(async->signal);
+            continue;
+        }
+        atomic_store_explicit(&async->idle, FALSE, memory_order_relaxed);
+
+        ar_osal_signal_timedwait(async->signal, AR_DATA_LOG_FLUSH_INTERVAL_NS);
+        ar_osal_signal_clear(async->signal);
+        atomic_store_explicit(&async->wake_pending, FALSE,
+            memory_order_relaxed);
+
+        _async_drain(async);
+
+        num_pkts_dropped = atomic_load_explicit(
+            &ar_data_log_counters.num_pkts_dropped, memory_order_relaxed);
+        if (num_pkts_dropped != last_num_pkts_dropped)
+        {
+            AR_DATA_LOG_ERR("Status[%d]: Dropped %u log packets",
+                AR_ENOMEMORY, num_pkts_dropped - last_num_pkts_dropped);
+            last_num_pkts_dropped = num_pkts_dropped;
+        }
+    }
+
+    _async_drain(async);
+}
@@ -12,6 +12,7 @@
 #include "ar_osal_mem_op.h"
 #include "ar_osal_string.h"
 #include "ar_osal_log_pkt_op.h"
+#include "ar_osal_sleep.h"
 #include "ar_util_data_log.h"
 #include "ar_util_data_log_codes.h"
 #include "ar_util_log_pkt_i.h"
@@ -29,6 +30,16 @@
 #define AR_TEST_DATA_LOG_FILE "ar_util_data_log_commit.bin"
 #define AR_TEST_DIAG_PKT_HEADER_LENGTH 12
 
+#define AR_TEST_ASYNC_LOG_FILE "ar_util_data_log_async.bin"
+#define AR_TEST_ASYNC_LOG_CODE_BASE 0x1000
+/**< Smallest ring that holds AR_DATA_LOG_ASYNC_FILE_MAX_PKT_SIZE packets */
+#define AR_TEST_ASYNC_RING_SIZE (32 * 1024)
+/**< Not a divisor of the ring size, so packets wrap with a pad record */
+#define AR_TEST_ASYNC_WRAP_PKT_SIZE 3000
+#define AR_TEST_ASYNC_WRAP_NUM_PKTS 40
+#define AR_TEST_ASYNC_POLL_US 10000
+#define AR_TEST_ASYNC_POLL_COUNT 100
+
 typedef struct ar_test_buffer_t
 {
     size_t size;
@@ -107,12 +118,18 @@ int32_t ar_test_reassemble_raw_msg(
 
 void ar_test_data_log_submit();
 void ar_test_data_log_commit();
+void ar_test_data_log_async();
 
 int32_t ar_test_pcm_data_logging_commit(ar_heap_info *heap_info);
 int32_t ar_test_bitstream_data_logging_commit(ar_heap_info *heap_info);
 int32_t ar_test_generic_data_logging_commit(ar_heap_info *heap_info);
 int32_t ar_test_raw_data_logging_commit(ar_heap_info *heap_info);
 
+int32_t ar_test_data_log_async_start_stop(void);
+int32_t ar_test_data_log_async_file_sink(ar_heap_info *heap_info);
+int32_t ar_test_data_log_async_drop(void);
+int32_t ar_test_data_log_async_wrap(ar_heap_info *heap_info);
+
 /*****************************************************************************
 * Test Functions
 ******************************************************************************/
@@ -126,6 +143,10 @@ void ar_test_data_log_main()
     AR_DATA_LOG_TEST_DBG("START: Data Logging 'Commit' tests");
     ar_test_data_log_commit();
     AR_DATA_LOG_TEST_DBG("END: Data Logging 'Commit' tests");
+
+    AR_DATA_LOG_TEST_DBG("START: Data Logging 'Async' tests");
+    ar_test_data_log_async();
+    AR_DATA_LOG_TEST_DBG("END: Data Logging 'Async' tests");
 }
 
 void ar_test_data_log_submit()
@@ -469,6 +490,412 @@ end:
     return status;
 }
 
+/*****************************************************************************
+* Data logging 'Async' Tests
+******************************************************************************/
+
+void ar_test_data_log_async()
+{
+    int32_t status = AR_EOK;
+    uint32_t num_tests = 0;
+    //Heap
+    ar_heap_info heap_info =
+    {
+        AR_HEAP_ALIGN_DEFAULT,
+        AR_HEAP_POOL_DEFAULT,
+        AR_HEAP_ID_DEFAULT,
+        AR_HEAP_TAG_DEFAULT
+    };
+
+    /* Start and stop asynchronous logging */
+    status = ar_test_data_log_async_start_stop();
+    if (AR_SUCCEEDED(status)) num_tests++;
+
+    /* Log packets to the file sink, waking an idle drain thread */
+    ar_fdelete(AR_TEST_ASYNC_LOG_FILE);
+    status = ar_test_data_log_async_file_sink(&heap_info);
+    if (AR_SUCCEEDED(status)) num_tests++;
+
+    /* Drop packets once the ring is full */
+    ar_fdelete(AR_TEST_ASYNC_LOG_FILE);
+    status = ar_test_data_log_async_drop();
+    if (AR_SUCCEEDED(status)) num_tests++;
+
+    /* Wrap around the ring several times */
+    ar_fdelete(AR_TEST_ASYNC_LOG_FILE);
+    status = ar_test_data_log_async_wrap(&heap_info);
+    if (AR_SUCCEEDED(status)) num_tests++;
+
+    ar_fdelete(AR_TEST_ASYNC_LOG_FILE);
+    AR_DATA_LOG_TEST_INFO("%d/4 async tests passed", num_tests);
+}
+
+static uint8_t ar_test_async_pkt_byte(uint32_t seq, uint32_t i)
+{
+    return (uint8_t)(seq * 31 + i);
+}
+
+static int32_t ar_test_async_log_pkt(uint32_t seq, uint32_t length)
+{
+    uint32_t i = 0;
+    uint8_t *log_pkt_data = NULL;
+    ar_data_log_alloc_info_t dla_info = { 0 };
+    ar_data_log_commit_info_t commit_info = { 0 };
+
+    dla_info.log_code = AR_TEST_ASYNC_LOG_CODE_BASE + seq;
+    dla_info.pkt_type = AR_DATA_LOG_PKT_TYPE_RAW;
+    dla_info.buffer_size = length;
+    log_pkt_data = ar_data_log_alloc(&dla_info);
+    if (!log_pkt_data)
+        return AR_ENOMEMORY;
+
+    for (i = 0; i < length; i++)
+        log_pkt_data[i] = ar_test_async_pkt_byte(seq, i);
+
+    commit_info.buffer_size = length;
+    commit_info.log_pkt_data = log_pkt_data;
+    commit_info.pkt_type = AR_DATA_LOG_PKT_TYPE_RAW;
+
+    return ar_data_log_commit(&commit_info);
+}
+
+/* Waits for the drain thread to log num_pkts_logged packets in total */
+static int32_t ar_test_async_wait_logged(uint32_t num_pkts_logged)
+{
+    uint32_t i = 0;
+    ar_data_log_stats_t stats = { 0 };
+
+    for (i = 0; i < AR_TEST_ASYNC_POLL_COUNT; i++)
+    {
+        ar_data_log_get_stats(&stats);
+        if (stats.num_pkts_logged >= num_pkts_logged)
+            return AR_EOK;
+
+        ar_osal_micro_sleep(AR_TEST_ASYNC_POLL_US);
+    }
+
+    return AR_ETIMEOUT;
+}
+
+/* Checks that the file sink holds packets first_seq, first_seq + 1, ...
+ * in order, each with an ar_data_log_file_record_t in front */
+static int32_t ar_test_async_verify_file(ar_heap_info *heap_info,
+    uint32_t first_seq, uint32_t num_pkts, uint32_t length)
+{
+    int32_t status = AR_EOK;
+    size_t file_size = 0;
+    size_t bytes_read = 0;
+    uint32_t offset = 0;
+    uint32_t seq = 0;
+    uint32_t i = 0;
+    uint8_t *buffer = NULL;
+    uint8_t *payload = NULL;
+    ar_data_log_file_record_t *file_rec = NULL;
+
+    status = ar_util_test_data_log_file_read(AR_TEST_ASYNC_LOG_FILE,
+        AR_FOPEN_READ_ONLY, NULL, 0, &file_size, &bytes_read);
+    if (AR_FAILED(status))
+        return status;
+
+    if (file_size != (size_t)num_pkts *
+        (sizeof(ar_data_log_file_record_t) + length))
+    {
+        AR_DATA_LOG_TEST_ERR("Status[%d]: File size is %u bytes, expected "
+            "%u packets of %u bytes", AR_EFAILED, (uint32_t)file_size,
+            num_pkts, length);
+        return AR_EFAILED;
+    }
+
+    if (0 == file_size)
+        return AR_EOK;
+
+    buffer = ar_heap_malloc(file_size, heap_info);
+    if (!buffer)
+        return AR_ENOMEMORY;
+
+    status = ar_util_test_data_log_file_read(AR_TEST_ASYNC_LOG_FILE,
+        AR_FOPEN_READ_ONLY, buffer, file_size, &file_size, &bytes_read);
+    if (AR_FAILED(status))
+        goto end;
+
+    for (seq = first_seq; seq < first_seq + num_pkts; seq++)
+    {
+        file_rec = (ar_data_log_file_record_t*)(buffer + offset);
+        payload = (uint8_t*)(file_rec + 1);
+        if (file_rec->log_code != AR_TEST_ASYNC_LOG_CODE_BASE + seq ||
+            file_rec->reserved != 0 || file_rec->length != length)
+        {
+            status = AR_EFAILED;
+            AR_DATA_LOG_TEST_ERR("Status[%d]: Record %u has log code 0x%x "
+                "and length %u", status, seq, file_rec->log_code,
+                file_rec->length);
+            goto end;
+        }
+
+        for (i = 0; i < length; i++)
+        {
+            if (payload[i] != ar_test_async_pkt_byte(seq, i))
+            {
+                status = AR_EFAILED;
+                AR_DATA_LOG_TEST_ERR("Status[%d]: Record %u differs at "
+                    "byte %u", status, seq, i);
+                goto end;
+            }
+        }
+
+        offset += (uint32_t)sizeof(ar_data_log_file_record_t) + length;
+    }
+
+end:
+    ar_heap_free(buffer, heap_info);
+    return status;
+}
+
+int32_t ar_test_data_log_async_start_stop(void)
+{
+    int32_t status = AR_EOK;
+    ar_data_log_async_config_t config = { 0 };
+
+    config.file_path = AR_TEST_ASYNC_LOG_FILE;
+
+    status = ar_data_log_async_start(&config);
+    if (AR_FAILED(status))
+    {
+        AR_DATA_LOG_TEST_ERR("Status[%d]: Failed to start", status);
+        goto end;
+    }
+
+    if (AR_EALREADY != ar_data_log_async_start(&config))
+    {
+        status = AR_EFAILED;
+        AR_DATA_LOG_TEST_ERR("Status[%d]: Started twice", status);
+        ar_data_log_async_stop();
+        goto end;
+    }
+
+    if (AR_DATA_LOG_ASYNC_FILE_MAX_PKT_SIZE !=
+        ar_data_log_get_max_packet_size())
+    {
+        status = AR_EFAILED;
+        AR_DATA_LOG_TEST_ERR("Status[%d]: Wrong max packet size for the "
+            "file sink", status);
+        ar_data_log_async_stop();
+        goto end;
+    }
+
+    status = ar_data_log_async_stop();
+    if (AR_FAILED(status))
+    {
+        AR_DATA_LOG_TEST_ERR("Status[%d]: Failed to stop", status);
+        goto end;
+    }
+
+    /* Stopping again is a no-op and logging is synchronous again */
+    status = ar_data_log_async_stop();
+    if (AR_FAILED(status) ||
+        ar_log_pkt_get_max_size() != ar_data_log_get_max_packet_size())
+    {
+        status = AR_EFAILED;
+        AR_DATA_LOG_TEST_ERR("Status[%d]: Still asynchronous after stop",
+            status);
+    }
+
+end:
+    if (AR_FAILED(status))
+    {
+        AR_DATA_LOG_TEST_ERR("Status[%d]: "
+            "Async start/stop test failed", status);
+    }
+
+    return status;
+}
+
+int32_t ar_test_data_log_async_file_sink(ar_heap_info *heap_info)
+{
+    int32_t status = AR_EOK;
+    uint32_t seq = 0;
+    uint32_t length = 116;
+    uint8_t *log_pkt_data = NULL;
+    ar_data_log_async_config_t config = { 0 };
+    ar_data_log_alloc_info_t dla_info = { 0 };
+    ar_data_log_stats_t stats = { 0 };
+
+    config.file_path = AR_TEST_ASYNC_LOG_FILE;
+
+    status = ar_data_log_async_start(&config);
+    if (AR_FAILED(status))
+        goto end;
+
+    ar_data_log_get_stats(&stats);
+
+    /* Let the drain thread go idle on the empty ring. The first packet
+     * must wake it without a stop */
+    ar_osal_micro_sleep(AR_TEST_ASYNC_POLL_US);
+    status = ar_test_async_log_pkt(seq++, length);
+    if (AR_SUCCEEDED(status))
+        status = ar_test_async_wait_logged(stats.num_pkts_logged + 1);
+    if (AR_FAILED(status))
+    {
+        AR_DATA_LOG_TEST_ERR("Status[%d]: The first packet was not logged",
+            status);
+        ar_data_log_async_stop();
+        goto end;
+    }
+
+    /* A freed packet is skipped */
+    dla_info.log_code = AR_TEST_ASYNC_LOG_CODE_BASE + 0xFFF;
+    dla_info.pkt_type = AR_DATA_LOG_PKT_TYPE_RAW;
+    dla_info.buffer_size = length;
+    log_pkt_data = ar_data_log_alloc(&dla_info);
+    if (log_pkt_data)
+        ar_data_log_free(log_pkt_data, AR_DATA_LOG_PKT_TYPE_RAW);
+
+    for (; seq < 4 && AR_SUCCEEDED(status); seq++)
+        status = ar_test_async_log_pkt(seq, length);
+
+    /* Stopping logs what is still queued */
+    ar_data_log_async_stop();
+    if (AR_FAILED(status) || !log_pkt_data)
+    {
+        status = AR_EFAILED;
+        AR_DATA_LOG_TEST_ERR("Status[%d]: Failed to allocate", status);
+        goto end;
+    }
+
+    status = ar_test_async_verify_file(heap_info, 0, seq, length);
+
+end:
+    if (AR_FAILED(status))
+    {
+        AR_DATA_LOG_TEST_ERR("Status[%d]: "
+            "Async file sink test failed", status);
+    }
+
+    return status;
+}
+
+int32_t ar_test_data_log_async_drop(void)
+{
+    int32_t status = AR_EOK;
+    uint32_t i = 0;
+    uint32_t num_held = 0;
+    uint32_t length = AR_DATA_LOG_ASYNC_FILE_MAX_PKT_SIZE;
+    void *held[AR_TEST_ASYNC_RING_SIZE / AR_DATA_LOG_ASYNC_FILE_MAX_PKT_SIZE];
+    ar_data_log_async_config_t config = { 0 };
+    ar_data_log_alloc_info_t dla_info = { 0 };
+    ar_data_log_stats_t before = { 0 };
+    ar_data_log_stats_t after = { 0 };
+    size_t file_size = 0;
+    size_t bytes_read = 0;
+
+    config.ring_size = AR_TEST_ASYNC_RING_SIZE;
+    config.file_path = AR_TEST_ASYNC_LOG_FILE;
+
+    status = ar_data_log_async_start(&config);
+    if (AR_FAILED(status))
+        goto end;
+
+    ar_data_log_get_stats(&before);
+
+    /* Packets that are never committed hold the ring until it is full */
+    dla_info.log_code = AR_TEST_ASYNC_LOG_CODE_BASE;
+    dla_info.pkt_type = AR_DATA_LOG_PKT_TYPE_RAW;
+    dla_info.buffer_size = length;
+    for (num_held = 0; num_held < sizeof(held) / sizeof(held[0]); num_held++)
+    {
+        held[num_held] = ar_data_log_alloc(&dla_info);
+        if (!held[num_held])
+            break;
+    }
+
+    ar_data_log_get_stats(&after);
+
+    for (i = 0; i < num_held; i++)
+        ar_data_log_free(held[i], AR_DATA_LOG_PKT_TYPE_RAW);
+
+    ar_data_log_async_stop();
+
+    if (0 == num_held || num_held == sizeof(held) / sizeof(held[0]) ||
+        after.num_pkts_dropped - before.num_pkts_dropped != 1 ||
+        after.num_bytes_dropped - before.num_bytes_dropped != length)
+    {
+        status = AR_EFAILED;
+        AR_DATA_LOG_TEST_ERR("Status[%d]: %u packets fit, %u dropped",
+            status, num_held,
+            after.num_pkts_dropped - before.num_pkts_dropped);
+        goto end;
+    }
+
+    /* Freed packets are never written */
+    status = ar_util_test_data_log_file_read(AR_TEST_ASYNC_LOG_FILE,
+        AR_FOPEN_READ_ONLY, NULL, 0, &file_size, &bytes_read);
+    if (AR_SUCCEEDED(status) && 0 != file_size)
+        status = AR_EFAILED;
+
+end:
+    if (AR_FAILED(status))
+    {
+        AR_DATA_LOG_TEST_ERR("Status[%d]: "
+            "Async drop test failed", status);
+    }
+
+    return status;
+}
+
+int32_t ar_test_data_log_async_wrap(ar_heap_info *heap_info)
+{
+    int32_t status = AR_EOK;
+    uint32_t seq = 0;
+    ar_data_log_async_config_t config = { 0 };
+    ar_data_log_stats_t before = { 0 };
+    ar_data_log_stats_t after = { 0 };
+
+    config.ring_size = AR_TEST_ASYNC_RING_SIZE;
+    config.file_path = AR_TEST_ASYNC_LOG_FILE;
+
+    status = ar_data_log_async_start(&config);
+    if (AR_FAILED(status))
+        goto end;
+
+    ar_data_log_get_stats(&before);
+
+    /* Log one packet at a time so that none is dropped */
+    for (seq = 0; seq < AR_TEST_ASYNC_WRAP_NUM_PKTS; seq++)
+    {
+        status = ar_test_async_log_pkt(seq, AR_TEST_ASYNC_WRAP_PKT_SIZE);
+        if (AR_SUCCEEDED(status))
+            status = ar_test_async_wait_logged(
+                before.num_pkts_logged + seq + 1);
+        if (AR_FAILED(status))
+            break;
+    }
+
+    ar_data_log_get_stats(&after);
+    ar_data_log_async_stop();
+
+    if (AR_FAILED(status) ||
+        after.num_pkts_dropped != before.num_pkts_dropped ||
+        after.num_sink_errors != before.num_sink_errors)
+    {
+        status = AR_EFAILED;
+        AR_DATA_LOG_TEST_ERR("Status[%d]: Packet %u was not logged",
+            status, seq);
+        goto end;
+    }
+
+    status = ar_test_async_verify_file(heap_info, 0,
+        AR_TEST_ASYNC_WRAP_NUM_PKTS, AR_TEST_ASYNC_WRAP_PKT_SIZE);
+
+end:
+    if (AR_FAILED(status))
+    {
+        AR_DATA_LOG_TEST_ERR("Status[%d]: "
+            "Async wrap test failed", status);
+    }
+
+    return status;
+}
+
 /*****************************************************************************
 * Data logging 'Submit' Tests
 ******************************************************************************/
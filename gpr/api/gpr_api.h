@@ -82,6 +82,43 @@ struct gpr_packet_pool_info_v2_t
    /* Size of each packet in the pool.*/
 };
 
+/* Structure to define the allocation statistics of a single packet pool. */
+typedef struct gpr_packet_pool_stats_t gpr_packet_pool_stats_t;
+
+struct gpr_packet_pool_stats_t
+{
+   gpr_heap_index_t heap_index;
+   /* heap index of the packet pool. */
+
+   uint8_t is_dynamic;
+   /* Flag to indicate if the packets in the pool are allocated dynamically. */
+
+   uint16_t reserved;
+   /* Reserved field for alignment, set to 0 */
+
+   uint32_t packet_size;
+   /* Size of each packet in the pool. */
+
+   uint32_t num_packets;
+   /* Number of packets in the pool, or the maximum number of dynamic packets. */
+
+   uint32_t num_allocs;
+   /* Number of packets allocated from the pool since init. */
+
+   uint32_t num_alloc_misses;
+   /* Number of allocations that found the pool exhausted. */
+
+   uint32_t num_fallback_allocs;
+   /* Number of packets allocated from the pool because the smaller pools of the
+      heap that fit the packet were exhausted. Always 0 for dynamic pools. */
+
+   uint32_t num_in_use;
+   /* Number of packets currently allocated from the pool. */
+
+   uint32_t max_in_use;
+   /* High-water mark of num_in_use since init. */
+};
+
 /*****************************************************************************
  * Core Routines                                                             *
  ****************************************************************************/
@@ -374,6 +374,49 @@ __gpr_cmd_get_gpr_packet_info_v2( &num_packet_pools, packet_pool_info_arr );
  */
 uint32_t __gpr_cmd_get_gpr_packet_info_v2(uint32_t *num_packet_pools, gpr_packet_pool_info_v2_t *packet_pool_info_arr);
 
+/** @ingroup gpr_cmd_get_pkt_pool_stats
+  Queries for the allocation statistics of the GPR packet pools.
+
+  @datatypes
+  #gpr_packet_pool_stats_t
+
+  @param[out] num_packet_pools  Number of packet pools that are created.
+  @param[out] pool_stats_arr    Packet pool statistics array, in the same order
+                                as the array returned by
+                                __gpr_cmd_get_gpr_packet_info_v2().
+
+  @detdesc
+  Allocations are served by the smallest static pool of the requested heap
+  that fits the packet. When that pool is exhausted the allocation falls back
+  to the next larger static pool of the heap, and then to the dynamic pools.
+  The statistics show how often each pool was used, missed or used as a
+  fallback, and its high-water mark, so the pool sizes can be tuned.
+
+  @par
+  The counters are sampled without stopping allocations, so the values of
+  different pools may be slightly out of step with each other.
+
+  @return
+  #AR_EOK always.
+
+  @dependencies
+  GPR initialization must be completed via gpr_init().
+
+  @codeexample
+  @lstlisting
+#include "gpr_api_inline.h"
+
+gpr_packet_pool_stats_t *pool_stats_arr   = NULL;
+uint32_t                 num_packet_pools = 0;
+
+__gpr_cmd_get_packet_pool_stats( &num_packet_pools, NULL );
+pool_stats_arr = (gpr_packet_pool_stats_t *)malloc(num_packet_pools * sizeof(gpr_packet_pool_stats_t));
+__gpr_cmd_get_packet_pool_stats( &num_packet_pools, pool_stats_arr );
+
+  @endlstlisting
+ */
+uint32_t __gpr_cmd_get_packet_pool_stats(uint32_t *num_packet_pools, gpr_packet_pool_stats_t *pool_stats_arr);
+
 /** @ingroup gpr_cmd_send_async
   Sends an asynchronous message to other services.
 
@@ -384,6 +384,36 @@ GPR_INTERNAL uint32_t gpr_ipc_send_done(void *buf, uint32_t length)
    return AR_EOK;
 }
 
+// Utility to order the static pools by heap index and packet size, and by packet heap address.
+// Called at the time of init.
+static void gpr_drv_util_sort_static_pools(void)
+{
+   gpr_drv_pkt_static_pool_info_t *pools      = gpr_ctxt_struct_t.static_pool_arr;
+   uint8_t                        *size_order = gpr_ctxt_struct_t.static_pool_size_order;
+   uint8_t                        *addr_order = gpr_ctxt_struct_t.static_pool_addr_order;
+
+   for (uint32_t idx = 0; idx < gpr_ctxt_struct_t.num_static_packet_pools; idx++)
+   {
+      uint32_t pos = idx;
+      while ((pos > 0) && ((pools[size_order[pos - 1]].heap_index > pools[idx].heap_index) ||
+                           ((pools[size_order[pos - 1]].heap_index == pools[idx].heap_index) &&
+                            (pools[size_order[pos - 1]].buf_size > pools[idx].buf_size))))
+      {
+         size_order[pos] = size_order[pos - 1];
+         pos--;
+      }
+      size_order[pos] = (uint8_t)idx;
+
+      pos = idx;
+      while ((pos > 0) && (pools[addr_order[pos - 1]].packet_heap > pools[idx].packet_heap))
+      {
+         addr_order[pos] = addr_order[pos - 1];
+         pos--;
+      }
+      addr_order[pos] = (uint8_t)idx;
+   }
+}
+
 // Utility to create packet pool info arrays, called at the time of init
 static uint32_t gpr_drv_util_create_packet_pool_info_arrs(uint32_t                  num_packet_pools,
                                                           gpr_packet_pool_info_v2_t packet_pool_info[])
@@ -607,8 +637,10 @@ GPR_EXTERNAL uint32_t gpr_drv_internal_init_v2(uint32_t                  default
          gpr_ctxt_struct_t.static_pool_arr[new_pool_index].num_packets = num_packets;
          gpr_ctxt_struct_t.static_pool_arr[new_pool_index].heap_index  = packet_pool_info[idx].heap_index;
 
+         /* Units are kept word aligned for the memq entry at the start of each unit */
          uint32_t gpr_memq_size_per_packet =
             GPR_MEMQ_UNIT_OVERHEAD_V + buf_size + (GPR_DRV_METADATA_ITEMS_V * GPR_MEMQ_BYTES_PER_METADATA_ITEM_V);
+         gpr_memq_size_per_packet = (gpr_memq_size_per_packet + 3) & ~3UL;
 
          uint32_t gpr_memq_size = (num_packets * gpr_memq_size_per_packet);
 
@@ -635,8 +667,6 @@ GPR_EXTERNAL uint32_t gpr_drv_internal_init_v2(uint32_t                  default
                             (gpr_memq_size * sizeof(char)),
                             gpr_memq_size_per_packet,
                             GPR_DRV_METADATA_ITEMS_V,
-                            gpr_drv_isr_lock_fn,
-                            gpr_drv_isr_unlock_fn,
                             gpr_ctxt_struct_t.static_pool_arr[new_pool_index].heap_index);
          if (rc)
          {
@@ -644,6 +674,7 @@ GPR_EXTERNAL uint32_t gpr_drv_internal_init_v2(uint32_t                  default
          }
       }
    }
+   gpr_drv_util_sort_static_pools();
 
    /* Save default domain id and pass it through init*/
    gpr_ctxt_struct_t.default_domain_id = default_domain_id;
@@ -1206,4 +1237,50 @@ uint32_t __gpr_cmd_get_gpr_packet_info_v2(uint32_t *num_packet_pools, gpr_packet
 
    return AR_EOK;
 }
+
+uint32_t __gpr_cmd_get_packet_pool_stats(uint32_t *num_packet_pools, gpr_packet_pool_stats_t *pool_stats_arr)
+{
+   if (num_packet_pools)
+   {
+      *num_packet_pools = gpr_ctxt_struct_t.num_static_packet_pools + gpr_ctxt_struct_t.num_dyn_packet_pools;
+   }
+
+   if (pool_stats_arr)
+   {
+      gpr_packet_pool_stats_t *stats = pool_stats_arr;
+      for (uint32_t idx = 0; idx < gpr_ctxt_struct_t.num_static_packet_pools; idx++, stats++)
+      {
+         gpr_drv_pkt_static_pool_info_t *pool = &gpr_ctxt_struct_t.static_pool_arr[idx];
+
+         stats->heap_index          = pool->heap_index;
+         stats->is_dynamic          = FALSE;
+         stats->reserved            = 0;
+         stats->packet_size         = pool->buf_size;
+         stats->num_packets         = pool->num_packets;
+         stats->num_allocs          = atomic_load_explicit(&pool->num_allocs, memory_order_relaxed);
+         stats->num_alloc_misses    = atomic_load_explicit(&pool->num_alloc_misses, memory_order_relaxed);
+         stats->num_fallback_allocs = atomic_load_explicit(&pool->num_fallback_allocs, memory_order_relaxed);
+         stats->num_in_use          = atomic_load_explicit(&pool->num_in_use, memory_order_relaxed);
+         stats->max_in_use          = atomic_load_explicit(&pool->max_in_use, memory_order_relaxed);
+      }
+
+      for (uint32_t idx = 0; idx < gpr_ctxt_struct_t.num_dyn_packet_pools; idx++, stats++)
+      {
+         gpr_drv_pkt_dynamic_pool_info_t *pool = &gpr_ctxt_struct_t.dyn_pool_arr[idx];
+
+         stats->heap_index          = pool->heap_index;
+         stats->is_dynamic          = TRUE;
+         stats->reserved            = 0;
+         stats->packet_size         = pool->buf_size;
+         stats->num_packets         = pool->max_num_packets;
+         stats->num_allocs          = pool->num_allocs;
+         stats->num_alloc_misses    = pool->num_alloc_misses;
+         stats->num_fallback_allocs = 0;
+         stats->num_in_use          = pool->curr_num_packets;
+         stats->max_in_use          = pool->max_num_packets_in_use;
+      }
+   }
+
+   return AR_EOK;
+}
 //end of file
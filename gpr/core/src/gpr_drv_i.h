@@ -73,6 +73,13 @@ typedef struct gpr_drv_pkt_static_pool_info_t
    uint32_t          buf_size;
    uint32_t          num_packets;
    gpr_heap_index_t  heap_index;
+
+   /* Allocation statistics, updated without the driver lock */
+   atomic_uint num_allocs;          /* packets allocated from this pool */
+   atomic_uint num_alloc_misses;    /* allocations that found this pool empty */
+   atomic_uint num_fallback_allocs; /* allocations served after a smaller pool was empty */
+   atomic_uint num_in_use;
+   atomic_uint max_in_use;
 } gpr_drv_pkt_static_pool_info_t;
 
 /* Info related to each of the dynamic packet pool, currently only one dynamic pool is supported.*/
@@ -82,6 +89,9 @@ typedef struct gpr_drv_pkt_dynamic_pool_info_t
    uint32_t         max_num_packets;
    uint32_t         curr_num_packets;
    gpr_heap_index_t heap_index;
+   uint32_t         num_allocs;
+   uint32_t         num_alloc_misses;
+   uint32_t         max_num_packets_in_use;
 } gpr_drv_pkt_dynamic_pool_info_t;
 
 typedef struct gpr_ctxt_struct_t
@@ -110,6 +120,13 @@ typedef struct gpr_ctxt_struct_t
    uint32_t                        num_static_packet_pools;
    gpr_drv_pkt_static_pool_info_t *static_pool_arr;
 
+   /* Static pool indices sorted by heap index and then by packet size. An allocation starts
+     at the smallest pool of its heap that fits the packet and falls back to the larger ones. */
+   uint8_t static_pool_size_order[MAX_GPR_PKT_POOLS];
+
+   /* Static pool indices sorted by packet heap address, to find the pool a packet belongs to. */
+   uint8_t static_pool_addr_order[MAX_GPR_PKT_POOLS];
+
    /* Packets in the dynamic pool are malloced when packet_alloc() is called. the info struct contains
        max packets that can be dynamically allocated, current num of malloced packets and each packets size. */
    uint32_t                         num_dyn_packet_pools;
@@ -48,6 +48,82 @@ void gpr_drv_isr_unlock_fn(void)
    (void)ar_osal_mutex_unlock(gpr_ctxt_struct_t.gpr_drv_isr_lock);
 }
 
+/* Returns the static pool that holds the packet, or NULL for datalink and dynamic packets.
+   Binary search over the pools in address order, see static_pool_addr_order. */
+static inline gpr_drv_pkt_static_pool_info_t *gpr_drv_find_static_pool(const gpr_packet_t *packet)
+{
+   const char_t *addr = (const char_t *)packet;
+   uint32_t      lo   = 0;
+   uint32_t      hi   = gpr_ctxt_struct_t.num_static_packet_pools;
+
+   // Find the last pool that starts below the packet
+   while (lo < hi)
+   {
+      uint32_t mid = lo + ((hi - lo) / 2);
+      if (gpr_ctxt_struct_t.static_pool_arr[gpr_ctxt_struct_t.static_pool_addr_order[mid]].packet_heap < addr)
+      {
+         lo = mid + 1;
+      }
+      else
+      {
+         hi = mid;
+      }
+   }
+
+   if (0 == lo)
+   {
+      return NULL;
+   }
+
+   gpr_drv_pkt_static_pool_info_t *pool =
+      &gpr_ctxt_struct_t.static_pool_arr[gpr_ctxt_struct_t.static_pool_addr_order[lo - 1]];
+   return (addr < pool->packet_heap_end) ? pool : NULL;
+}
+
+/* Returns the position in static_pool_size_order of the smallest pool of the heap
+   that fits the packet, or of the first pool of a larger heap index if none does. */
+static inline uint32_t gpr_drv_find_static_pool_class(uint32_t packet_size, gpr_heap_index_t heap_index)
+{
+   uint32_t lo = 0;
+   uint32_t hi = gpr_ctxt_struct_t.num_static_packet_pools;
+
+   while (lo < hi)
+   {
+      uint32_t                        mid = lo + ((hi - lo) / 2);
+      gpr_drv_pkt_static_pool_info_t *pool =
+         &gpr_ctxt_struct_t.static_pool_arr[gpr_ctxt_struct_t.static_pool_size_order[mid]];
+      if ((pool->heap_index < heap_index) || ((pool->heap_index == heap_index) && (pool->buf_size < packet_size)))
+      {
+         lo = mid + 1;
+      }
+      else
+      {
+         hi = mid;
+      }
+   }
+   return lo;
+}
+
+static inline void gpr_drv_count_static_alloc(gpr_drv_pkt_static_pool_info_t *pool, bool_t is_fallback)
+{
+   uint32_t in_use     = atomic_fetch_add_explicit(&pool->num_in_use, 1, memory_order_relaxed) + 1;
+   uint32_t max_in_use = atomic_load_explicit(&pool->max_in_use, memory_order_relaxed);
+
+   while ((in_use > max_in_use) && !atomic_compare_exchange_weak_explicit(&pool->max_in_use,
+                                                                          &max_in_use,
+                                                                          in_use,
+                                                                          memory_order_relaxed,
+                                                                          memory_order_relaxed))
+   {
+   }
+
+   (void)atomic_fetch_add_explicit(&pool->num_allocs, 1, memory_order_relaxed);
+   if (is_fallback)
+   {
+      (void)atomic_fetch_add_explicit(&pool->num_fallback_allocs, 1, memory_order_relaxed);
+   }
+}
+
 /**
   @brief Sends an asynchronous message to other modules.
 
@@ -113,57 +189,46 @@ uint32_t __gpr_cmd_async_send(gpr_packet_t *packet)
    // check if the packet is from a static packet pool.
    // if so, set memq metadata and then send the packet
    // else, just call send
-   bool_t pkt_is_from_the_static_pool = false;
-   for (uint32_t idx = 0; idx < gpr_ctxt_struct_t.num_static_packet_pools; idx++)
+   gpr_drv_pkt_static_pool_info_t *static_pool = gpr_drv_find_static_pool(packet);
+   if (NULL != static_pool)
    {
-      /* Freeing linked list nodes*/
-      if ((char *)packet > gpr_ctxt_struct_t.static_pool_arr[idx].packet_heap &&
-          (char *)packet < gpr_ctxt_struct_t.static_pool_arr[idx].packet_heap_end)
-      {
-         pkt_is_from_the_static_pool = true;
-
 #ifdef GPR_DEBUG_MSG
-         AR_MSG(DBG_HIGH_PRIO,
-                "gpr packet send: Destination Domain ID %hhu, Destination Port %ld",
-                packet->dst_domain_id,
-                packet->dst_port);
+      AR_MSG(DBG_HIGH_PRIO,
+             "gpr packet send: Destination Domain ID %hhu, Destination Port %ld",
+             packet->dst_domain_id,
+             packet->dst_port);
 #endif
-         if (packet_len <= gpr_ctxt_struct_t.static_pool_arr[idx].buf_size)
-         {
-            block = gpr_ctxt_struct_t.static_pool_arr[idx].free_packets_memq;
-         }
-         else
-         {
-            AR_MSG(DBG_ERROR_PRIO, "Send error %lu", packet->dst_port);
-            return AR_EFAILED;
-         }
-
-         /* Sets the packet ownership to destination before sending */
-         gpr_memq_node_set_metadata(block, packet, 0, packet->dst_port);
+      if (packet_len <= static_pool->buf_size)
+      {
+         block = static_pool->free_packets_memq;
+      }
+      else
+      {
+         AR_MSG(DBG_ERROR_PRIO, "Send error %lu", packet->dst_port);
+         return AR_EFAILED;
+      }
 
-         rc = local_gpr_ipc_dl_table[domain_id].fn_ptr->send(domain_id, packet, packet_len);
-         if (rc)
-         {
-            /* Sets the packet owner to source if send fails for any reason */
-            gpr_memq_node_set_metadata(block, packet, 0, packet->src_port);
-            AR_MSG(DBG_ERROR_PRIO,
-                   "gpr packet send failed rc %d: Destination Domain ID %hhu, Destination Port %ld Opcode %lx token "
-                   "%lx",
-                   rc,
-                   packet->dst_domain_id,
-                   packet->dst_port,
-                   packet->opcode,
-                   packet->token);
-         }
+      /* Sets the packet ownership to destination before sending */
+      gpr_memq_node_set_metadata(block, packet, 0, packet->dst_port);
 
-         // stop iterating the loop
-         break;
+      rc = local_gpr_ipc_dl_table[domain_id].fn_ptr->send(domain_id, packet, packet_len);
+      if (rc)
+      {
+         /* Sets the packet owner to source if send fails for any reason */
+         gpr_memq_node_set_metadata(block, packet, 0, packet->src_port);
+         AR_MSG(DBG_ERROR_PRIO,
+                "gpr packet send failed rc %d: Destination Domain ID %hhu, Destination Port %ld Opcode %lx token "
+                "%lx",
+                rc,
+                packet->dst_domain_id,
+                packet->dst_port,
+                packet->opcode,
+                packet->token);
       }
    }
-
-   // If the packet is not from static pool, it could be from datalink packet or dynamic packet pool.
-   if (!pkt_is_from_the_static_pool)
+   else
    {
+      // The packet is not from static pool, it could be from datalink packet or dynamic packet pool.
 #ifdef GPR_DEBUG_MSG
       AR_MSG(DBG_HIGH_PRIO,
              "GPR datalink packet send: Destination Domain ID %hhu, Destination Port %ld",
@@ -206,45 +271,44 @@ uint32_t __gpr_cmd_alloc(uint32_t alloc_size, gpr_packet_t **ret_packet)
    return __gpr_cmd_alloc_v2(alloc_size, GPR_HEAP_INDEX_DEFAULT, ret_packet);
 }
 
-/**
-  @brief Allocates a free message for delivery.
-
-  @param[in]  alloc_size  Amount of memory required for allocation, in bytes.
-  @param[out] ret_packet  Returns the pointer to the allocated packet.
-
-  @detdesc
-  This function allocates a packet from the indicated module's free packet
-  queue, and it provides the caller with low-level control over the allocation
-  process. For general use, consider using a simplified helper function, such
-  as #GPR_CMDID_ALLOC_EXT.
-
-  @return
-  #AR_EOK when successful.
-*/
-uint32_t __gpr_cmd_alloc_v2(uint32_t alloc_size, gpr_heap_index_t heap_index, gpr_packet_t **ret_packet)
+/* Allocates a packet and returns the static pool it came from, or NULL if it was allocated dynamically. */
+static uint32_t gpr_drv_alloc_packet(uint32_t                         alloc_size,
+                                     gpr_heap_index_t                 heap_index,
+                                     gpr_packet_t                   **ret_packet,
+                                     gpr_drv_pkt_static_pool_info_t **ret_static_pool)
 {
-   gpr_memq_block_t *block;
-   gpr_packet_t     *new_packet  = NULL;
-   uint32_t          packet_size = (GPR_PKT_HEADER_BYTE_SIZE_V + alloc_size);
-
-   if (NULL == ret_packet)
-   {
-      AR_MSG(DBG_ERROR_PRIO, "alloc_error, NULL packet");
-      return AR_EBADPARAM;
-   }
-
-   bool_t found_packet_pool = FALSE;
-   for (uint32_t idx = 0; idx < gpr_ctxt_struct_t.num_static_packet_pools; idx++)
-   {
-      if (packet_size <= gpr_ctxt_struct_t.static_pool_arr[idx].buf_size &&
-          (heap_index == gpr_ctxt_struct_t.static_pool_arr[idx].heap_index))
+   gpr_packet_t                   *new_packet  = NULL;
+   gpr_drv_pkt_static_pool_info_t *static_pool = NULL;
+   uint32_t                        packet_size = (GPR_PKT_HEADER_BYTE_SIZE_V + alloc_size);
+
+   bool_t                          found_packet_pool = FALSE;
+   gpr_drv_pkt_static_pool_info_t *best_fit_pool     = NULL;
+   for (uint32_t class_idx = gpr_drv_find_static_pool_class(packet_size, heap_index);
+        class_idx < gpr_ctxt_struct_t.num_static_packet_pools;
+        class_idx++)
+   {
+      gpr_drv_pkt_static_pool_info_t *pool =
+         &gpr_ctxt_struct_t.static_pool_arr[gpr_ctxt_struct_t.static_pool_size_order[class_idx]];
+      if (heap_index != pool->heap_index)
       {
-         found_packet_pool = TRUE;
+         break;
+      }
 
-         block      = gpr_ctxt_struct_t.static_pool_arr[idx].free_packets_memq;
-         new_packet = (gpr_packet_t *)gpr_memq_alloc(block);
+      found_packet_pool = TRUE;
+      new_packet        = (gpr_packet_t *)gpr_memq_try_alloc(pool->free_packets_memq);
+      if (NULL != new_packet)
+      {
+         gpr_drv_count_static_alloc(pool, (NULL != best_fit_pool));
+         static_pool = pool;
          break;
       }
+
+      // Fall back to the next larger pool of the heap
+      (void)atomic_fetch_add_explicit(&pool->num_alloc_misses, 1, memory_order_relaxed);
+      if (NULL == best_fit_pool)
+      {
+         best_fit_pool = pool;
+      }
    }
 
    // If packet couldnt not be allocated in static pool, check dynamic pool
@@ -252,24 +316,41 @@ uint32_t __gpr_cmd_alloc_v2(uint32_t alloc_size, gpr_heap_index_t heap_index, gp
    {
       for (uint32_t idx = 0; idx < gpr_ctxt_struct_t.num_dyn_packet_pools; idx++)
       {
-         if ((packet_size <= gpr_ctxt_struct_t.dyn_pool_arr[idx].buf_size) &&
-             (gpr_ctxt_struct_t.dyn_pool_arr[idx].curr_num_packets <
-              gpr_ctxt_struct_t.dyn_pool_arr[idx].max_num_packets) &&
-             (heap_index == gpr_ctxt_struct_t.dyn_pool_arr[idx].heap_index))
+         gpr_drv_pkt_dynamic_pool_info_t *pool = &gpr_ctxt_struct_t.dyn_pool_arr[idx];
+         if ((packet_size > pool->buf_size) || (heap_index != pool->heap_index))
          {
-            found_packet_pool = TRUE;
+            continue;
+         }
 
-            gpr_allocate_dynamic_packet(&new_packet, packet_size);
-            if (new_packet == NULL)
-            {
-               AR_MSG(DBG_ERROR_PRIO, "alloc_error unsupported size %lu, heap_index: %lu", alloc_size, heap_index);
-               return AR_ENORESOURCE;
-            }
-            gpr_ctxt_struct_t.dyn_pool_arr[idx].curr_num_packets++;
+         found_packet_pool = TRUE;
+         if (pool->curr_num_packets >= pool->max_num_packets)
+         {
+            pool->num_alloc_misses++;
+            continue;
+         }
+
+         gpr_allocate_dynamic_packet(&new_packet, packet_size);
+         if (new_packet == NULL)
+         {
+            AR_MSG(DBG_ERROR_PRIO, "alloc_error unsupported size %lu, heap_index: %lu", alloc_size, heap_index);
+            return AR_ENORESOURCE;
+         }
+         pool->curr_num_packets++;
+         pool->num_allocs++;
+         if (pool->curr_num_packets > pool->max_num_packets_in_use)
+         {
+            pool->max_num_packets_in_use = pool->curr_num_packets;
          }
+         break;
       }
    }
 
+   // Only report the packet owners once every pool that could have served the packet is exhausted
+   if ((NULL == new_packet) && (NULL != best_fit_pool))
+   {
+      gpr_memq_log_oom(best_fit_pool->free_packets_memq);
+   }
+
    /* Check if packet has been allocated from a dynamic/static pool.*/
    if (new_packet == NULL)
    {
@@ -289,10 +370,38 @@ uint32_t __gpr_cmd_alloc_v2(uint32_t alloc_size, gpr_heap_index_t heap_index, gp
    new_packet->client_data = GPR_PKT_INIT_CLIENT_DATA_V;
    new_packet->reserved    = GPR_PKT_INIT_RESERVED_V;
    *ret_packet             = new_packet;
+   *ret_static_pool        = static_pool;
 
    return AR_EOK;
 }
 
+/**
+  @brief Allocates a free message for delivery.
+
+  @param[in]  alloc_size  Amount of memory required for allocation, in bytes.
+  @param[out] ret_packet  Returns the pointer to the allocated packet.
+
+  @detdesc
+  This function allocates a packet from the indicated module's free packet
+  queue, and it provides the caller with low-level control over the allocation
+  process. For general use, consider using a simplified helper function, such
+  as #GPR_CMDID_ALLOC_EXT.
+
+  @return
+  #AR_EOK when successful.
+*/
+uint32_t __gpr_cmd_alloc_v2(uint32_t alloc_size, gpr_heap_index_t heap_index, gpr_packet_t **ret_packet)
+{
+   gpr_drv_pkt_static_pool_info_t *static_pool;
+
+   if (NULL == ret_packet)
+   {
+      AR_MSG(DBG_ERROR_PRIO, "alloc_error, NULL packet");
+      return AR_EBADPARAM;
+   }
+
+   return gpr_drv_alloc_packet(alloc_size, heap_index, ret_packet, &static_pool);
+}
 /**
   @brief Frees a packet from the indicated module's free packet queue.
 
@@ -313,34 +422,35 @@ uint32_t __gpr_cmd_free(gpr_packet_t *packet)
    uint32_t          packet_size = GPR_PKT_GET_PACKET_BYTE_SIZE(packet->header);
    uint32_t          domain_id   = packet->src_domain_id;
 
-   bool_t pkt_is_from_static_pool = FALSE;
    /* If the packet is from Static pool, mark it Free*/
-   for (uint32_t idx = 0; idx < gpr_ctxt_struct_t.num_static_packet_pools; idx++)
+   gpr_drv_pkt_static_pool_info_t *static_pool = gpr_drv_find_static_pool(packet);
+   if (NULL != static_pool)
    {
-      if ((char *)packet > gpr_ctxt_struct_t.static_pool_arr[idx].packet_heap &&
-          (char *)packet < gpr_ctxt_struct_t.static_pool_arr[idx].packet_heap_end)
+      /* If buffer is allocated by GPR*/
+      if (packet_size <= static_pool->buf_size)
       {
-         /* If buffer is allocated by GPR*/
-         if (packet_size <= gpr_ctxt_struct_t.static_pool_arr[idx].buf_size)
-         {
-            block = gpr_ctxt_struct_t.static_pool_arr[idx].free_packets_memq;
+         block = static_pool->free_packets_memq;
 
-            /* Sets the packet owner to 0 before free the packet. */
-            gpr_memq_node_set_metadata(block, packet, 0, 0);
-            gpr_memq_free(block, packet);
-            pkt_is_from_static_pool = TRUE;
-            return AR_EOK;
-         }
-         else
+         /* Sets the packet owner to 0 before free the packet. */
+         gpr_memq_node_set_metadata(block, packet, 0, 0);
+
+         /* Drop the in use count before the packet can be allocated again, so that it never
+            exceeds the pool size */
+         (void)atomic_fetch_sub_explicit(&static_pool->num_in_use, 1, memory_order_relaxed);
+         if (AR_EOK != gpr_memq_free(block, packet))
          {
-            return AR_EBADPARAM;
+            (void)atomic_fetch_add_explicit(&static_pool->num_in_use, 1, memory_order_relaxed);
          }
+         return AR_EOK;
+      }
+      else
+      {
+         return AR_EBADPARAM;
       }
    }
-
-   // If packet is not from static pool, it could be from Dynamic pool.
-   if (FALSE == pkt_is_from_static_pool)
+   else
    {
+      // If packet is not from static pool, it could be from Dynamic pool.
       for (uint32_t idx = 0; idx < gpr_ctxt_struct_t.num_dyn_packet_pools; idx++)
       {
          if ((packet_size <= gpr_ctxt_struct_t.dyn_pool_arr[idx].buf_size) &&
@@ -430,16 +540,16 @@ uint32_t __gpr_cmd_alloc_ext(gpr_cmd_alloc_ext_t *args)
 
 uint32_t __gpr_cmd_alloc_ext_v2(gpr_cmd_alloc_ext_v2_t *args)
 {
-   uint32_t          rc;
-   gpr_packet_t     *new_packet;
-   gpr_memq_block_t *block;
+   uint32_t                        rc;
+   gpr_packet_t                   *new_packet;
+   gpr_drv_pkt_static_pool_info_t *static_pool;
 
    if ((NULL == args) || (NULL == args->ret_packet))
    {
       return AR_EBADPARAM;
    }
 
-   rc = __gpr_cmd_alloc_v2(args->payload_size, args->heap_index, &new_packet);
+   rc = gpr_drv_alloc_packet(args->payload_size, args->heap_index, &new_packet, &static_pool);
    if (rc)
    {
       return rc;
@@ -454,15 +564,9 @@ uint32_t __gpr_cmd_alloc_ext_v2(gpr_cmd_alloc_ext_v2_t *args)
    new_packet->client_data   = args->client_data;
 
    // set metadata in the corresponding packets memq.
-   for (uint32_t idx = 0; idx < gpr_ctxt_struct_t.num_static_packet_pools; idx++)
+   if (NULL != static_pool)
    {
-      if ((char *)new_packet > gpr_ctxt_struct_t.static_pool_arr[idx].packet_heap &&
-          (char *)new_packet < gpr_ctxt_struct_t.static_pool_arr[idx].packet_heap_end)
-      {
-         block = gpr_ctxt_struct_t.static_pool_arr[idx].free_packets_memq;
-         gpr_memq_node_set_metadata(block, new_packet, 0, new_packet->src_port);
-         break;
-      }
+      gpr_memq_node_set_metadata(static_pool->free_packets_memq, new_packet, 0, new_packet->src_port);
    }
 
    *args->ret_packet = new_packet;
@@ -612,15 +716,11 @@ uint32_t __gpr_cmd_end_command(gpr_packet_t *packet, uint32_t status)
          ((opcode_type & AR_GUID_TYPE_DATA_EVENT) == AR_GUID_TYPE_DATA_EVENT)))
    {
       // get GPR packet heap index
-      gpr_heap_index_t gpr_heap_index = GPR_HEAP_INDEX_DEFAULT;
-      for (uint32_t idx = 0; idx < gpr_ctxt_struct_t.num_static_packet_pools; idx++)
+      gpr_heap_index_t                gpr_heap_index = GPR_HEAP_INDEX_DEFAULT;
+      gpr_drv_pkt_static_pool_info_t *static_pool    = gpr_drv_find_static_pool(packet);
+      if (NULL != static_pool)
       {
-         /* Freeing linked list nodes*/
-         if ((char *)packet > gpr_ctxt_struct_t.static_pool_arr[idx].packet_heap &&
-             (char *)packet < gpr_ctxt_struct_t.static_pool_arr[idx].packet_heap_end)
-         {
-            gpr_heap_index = gpr_ctxt_struct_t.static_pool_arr[idx].heap_index;
-         }
+         gpr_heap_index = static_pool->heap_index;
       }
 
       // Reverse the source and destination addresses to send a command response.
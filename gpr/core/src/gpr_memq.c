@@ -27,48 +27,41 @@
 ** fixed memory allocation units. The unit_size is the amount of usable
 ** application memory for each allocation unit plus overhead (GPR_MEMQ_UNIT_OVERHEAD)*/
 
-GPR_EXTERNAL int gpr_memq_init(gpr_memq_block_t        *block,
-                               char_t                  *heap_base,
-                               uint32_t                 heap_size,
-                               uint32_t                 unit_size,
-                               uint32_t                 metadata_size,
-                               gpr_memq_lock_enter_fn_t lock_fn,
-                               gpr_memq_lock_leave_fn_t unlock_fn,
-                               gpr_heap_index_t         heap_index)
+GPR_EXTERNAL int gpr_memq_init(gpr_memq_block_t *block,
+                               char_t           *heap_base,
+                               uint32_t          heap_size,
+                               uint32_t          unit_size,
+                               uint32_t          metadata_size,
+                               gpr_heap_index_t  heap_index)
 {
-   uint32_t rc = AR_EOK;
-   if ((NULL == block) || (NULL == heap_base) || (NULL == lock_fn) || (NULL == unlock_fn))
+   uint32_t          unit_idx;
+   gpr_memq_entry_t *entry;
+
+   if ((NULL == block) || (NULL == heap_base))
    {
       return AR_EBADPARAM;
    }
 
-   if (unit_size < GPR_MEMQ_BYTES_PER_METADATA_ITEM_V * metadata_size)
+   /* Each unit starts with its atomic entry */
+   if ((unit_size < GPR_MEMQ_UNIT_OVERHEAD_V + GPR_MEMQ_BYTES_PER_METADATA_ITEM_V * metadata_size) ||
+       (0 != (unit_size % sizeof(uint32_t))) || (0 != ((uintptr_t)heap_base % sizeof(uint32_t))))
    {
       return AR_EBADPARAM;
    }
 
-   /* Partition the heap into fixed units in the free queue */
-   (void)gpr_list_init(&block->free_q, lock_fn, unlock_fn);
+   /* Partition the heap into fixed units, all on the free stack in address order */
    block->base_addr     = heap_base;
    block->unit_size     = unit_size;
    block->metadata_size = metadata_size;
+   block->total_units   = heap_size / unit_size;
 
-   while (heap_size >= unit_size)
+   for (unit_idx = 0; unit_idx < block->total_units; unit_idx++)
    {
-      (void)gpr_list_init_node((gpr_list_node_t *)heap_base);
-
-      rc = gpr_list_add_tail(&block->free_q, ((gpr_list_node_t *)heap_base));
-      if (AR_EOK != rc)
-      {
-         AR_MSG(DBG_ERROR_PRIO, "GPR memq: Adding node to free queue failed, init failed rc %d", rc);
-         return rc;
-      }
-
-      heap_base += unit_size;
-      heap_size -= unit_size;
+      entry = (gpr_memq_entry_t *)(heap_base + (unit_idx * unit_size));
+      atomic_init(&entry->next_free, (unit_idx + 1 < block->total_units) ? unit_idx + 2 : 0);
+      atomic_init(&entry->is_free, 1);
    }
-
-   block->total_units = block->free_q.size;
+   atomic_init(&block->free_head, (block->total_units > 0) ? 1 : 0);
 
    /*populate heap info*/
    ar_heap_info heap_info;
@@ -115,12 +108,19 @@ GPR_EXTERNAL void gpr_memq_deinit(gpr_memq_block_t *block, gpr_heap_index_t heap
       return;
    }
 
-   if (block->free_q.size != block->total_units)
+   uint32_t num_free_units = 0;
+   for (uint32_t unit_idx = 0; unit_idx < block->total_units; unit_idx++)
+   {
+      gpr_memq_entry_t *entry = (gpr_memq_entry_t *)(block->base_addr + (unit_idx * block->unit_size));
+      num_free_units += atomic_load(&entry->is_free);
+   }
+
+   if (num_free_units != block->total_units)
    {
       AR_MSG(DBG_ERROR_PRIO, "memory leak detected");
    }
 
-   gpr_list_clear(&block->free_q);
+   atomic_store(&block->free_head, 0);
 
    if (NULL != block->unique_metadata_ids)
    {
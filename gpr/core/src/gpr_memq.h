@@ -11,28 +11,35 @@
  *  SPDX-License-Identifier: BSD-3-Clause
  */
 
-#include "gpr_list.h"
+#include <stdatomic.h>
+#include "gpr_comdef.h"
+#include "ar_osal_error.h"
+#include "ar_msg.h"
 #include "gpr_api.h"
 
-typedef void (*gpr_memq_lock_enter_fn_t)(void);
-typedef void (*gpr_memq_lock_leave_fn_t)(void);
-
 /* Memory Queue Definitions */
 
+/* The free units of a block are kept on a lock-free stack of unit numbers
+** (unit index + 1, 0 terminates the stack). Units are allocated and freed
+** from any thread, so the head carries a tag in its upper 32 bits that is
+** bumped on every push and pop. A unit popped and pushed back between
+** another thread reading the head and swapping it then fails that swap
+** instead of corrupting the stack. */
 typedef struct gpr_memq_block_t
 {
-   gpr_list_t free_q;
-   char_t    *base_addr;
-   uint32_t   total_units;
-   uint32_t   unit_size;
-   uint32_t   metadata_size;
-   uint32_t  *unique_metadata_ids;
-   uint32_t  *unique_metadata_counts;
+   _Atomic uint64_t free_head; /* tag << 32 | unit number of the top free unit */
+   char_t          *base_addr;
+   uint32_t         total_units;
+   uint32_t         unit_size;
+   uint32_t         metadata_size;
+   uint32_t        *unique_metadata_ids;
+   uint32_t        *unique_metadata_counts;
 } gpr_memq_block_t;
 
 typedef struct gpr_memq_entry_t
 {
-   gpr_list_node_t link; /* Must be first */
+   atomic_uint next_free; /* Unit number of the next free unit, 0 at the bottom */
+   atomic_uint is_free;   /* Catches double frees */
 } gpr_memq_entry_t;
 
 #define GPR_MEMQ_BYTES_PER_METADATA_ITEM_V (sizeof(int32_t))
@@ -44,15 +51,20 @@ GPR_EXTERNAL int gpr_memq_init(gpr_memq_block_t        *block,
                                uint32_t                 heap_size,
                                uint32_t                 unit_size,
                                uint32_t                 metadata_size,
-                               gpr_memq_lock_enter_fn_t lock_fn,
-                               gpr_memq_lock_leave_fn_t unlock_fn,
                                gpr_heap_index_t         heap_index);
 
 GPR_EXTERNAL void gpr_memq_deinit(gpr_memq_block_t *block, gpr_heap_index_t heap_index);
 
 GPR_EXTERNAL void *gpr_memq_alloc(gpr_memq_block_t *block);
 
-GPR_EXTERNAL void gpr_memq_free(gpr_memq_block_t *block, void *mem_ptr);
+/* Same as gpr_memq_alloc() but returns NULL without the out of memory
+** analysis, for callers that fall back to another block. */
+GPR_EXTERNAL void *gpr_memq_try_alloc(gpr_memq_block_t *block);
+
+/* Logs which owners hold the units of an exhausted block. */
+GPR_EXTERNAL void gpr_memq_log_oom(gpr_memq_block_t *block);
+
+GPR_EXTERNAL uint32_t gpr_memq_free(gpr_memq_block_t *block, void *mem_ptr);
 
 GPR_EXTERNAL uint32_t gpr_memq_node_set_metadata(gpr_memq_block_t *block, void *mem_ptr, uint32_t index, int32_t value);
 
@@ -71,19 +71,45 @@ GPR_EXTERNAL uint32_t gpr_memq_node_get_metadata(gpr_memq_block_t *block,
    return AR_EOK;
 }
 
-GPR_EXTERNAL void *gpr_memq_alloc(gpr_memq_block_t *block)
+static inline gpr_memq_entry_t *gpr_memq_unit_entry(gpr_memq_block_t *block, uint32_t unit_num)
+{
+   return (gpr_memq_entry_t *)(block->base_addr + ((unit_num - 1) * block->unit_size));
+}
+
+GPR_EXTERNAL void *gpr_memq_try_alloc(gpr_memq_block_t *block)
 {
-   gpr_list_node_t *node;
-   char_t          *mem_ptr;
-   uint32_t         md_interator;
-   uint32_t         md_index;
-   int32_t          metadata         = 0;
-   uint32_t         total_unique_mds = 0;
-
-   if (gpr_list_remove_head(&block->free_q, &node) == AR_EOK)
+   gpr_memq_entry_t *entry;
+   uint64_t          head;
+   uint64_t          new_head;
+   uint32_t          unit_num;
+
+   head = atomic_load_explicit(&block->free_head, memory_order_acquire);
+   do
    {
-      return (((char_t *)node) + gpr_memq_size_of_metadata_and_overhead(block));
-   }
+      unit_num = (uint32_t)head;
+      if (0 == unit_num)
+      {
+         return NULL;
+      }
+      entry    = gpr_memq_unit_entry(block, unit_num);
+      new_head = (((head >> 32) + 1) << 32) | atomic_load_explicit(&entry->next_free, memory_order_relaxed);
+   } while (!atomic_compare_exchange_weak_explicit(&block->free_head,
+                                                   &head,
+                                                   new_head,
+                                                   memory_order_acquire,
+                                                   memory_order_acquire));
+
+   atomic_store_explicit(&entry->is_free, 0, memory_order_relaxed);
+   return (((char_t *)entry) + gpr_memq_size_of_metadata_and_overhead(block));
+}
+
+GPR_EXTERNAL void gpr_memq_log_oom(gpr_memq_block_t *block)
+{
+   char_t  *mem_ptr;
+   uint32_t md_interator;
+   uint32_t md_index;
+   int32_t  metadata         = 0;
+   uint32_t total_unique_mds = 0;
 
    AR_MSG(DBG_ERROR_PRIO, "Out of memory failure");
 
@@ -110,23 +136,57 @@ GPR_EXTERNAL void *gpr_memq_alloc(gpr_memq_block_t *block)
              block->unique_metadata_ids[md_index],
              block->unique_metadata_counts[md_index]);
    }
-   return NULL;
 }
 
-GPR_EXTERNAL void gpr_memq_free(gpr_memq_block_t *block, void *data_ptr)
+GPR_EXTERNAL void *gpr_memq_alloc(gpr_memq_block_t *block)
 {
-   uint32_t         rc = AR_EOK;
-   gpr_list_node_t *node;
+   void *mem_ptr = gpr_memq_try_alloc(block);
+
+   if (NULL == mem_ptr)
+   {
+      gpr_memq_log_oom(block);
+   }
+   return mem_ptr;
+}
+
+GPR_EXTERNAL uint32_t gpr_memq_free(gpr_memq_block_t *block, void *data_ptr)
+{
+   gpr_memq_entry_t *entry;
+   uint64_t          head;
+   uint32_t          unit_num;
+   uintptr_t         offset;
 
    if ((block == NULL) || (data_ptr == NULL))
    {
       AR_MSG(DBG_ERROR_PRIO, "GPR memq: block is NULL or data ptr is NULL");
-      return;
+      return AR_EBADPARAM;
+   }
+
+   entry  = (gpr_memq_entry_t *)(((char_t *)data_ptr) - gpr_memq_size_of_metadata_and_overhead(block));
+   offset = (uintptr_t)((char_t *)entry - block->base_addr);
+   if (((char_t *)entry < block->base_addr) || (0 != (offset % block->unit_size)) ||
+       (offset / block->unit_size >= block->total_units))
+   {
+      AR_MSG(DBG_ERROR_PRIO, "GPR memq: Cannot free packet, packet is not from this queue");
+      return AR_EBADPARAM;
    }
-   node = ((gpr_list_node_t *)(((char_t *)data_ptr) - gpr_memq_size_of_metadata_and_overhead(block)));
-   rc   = gpr_list_add_tail(&block->free_q, node);
-   if (AR_EOK != rc)
+
+   if (atomic_exchange_explicit(&entry->is_free, 1, memory_order_relaxed))
    {
-      AR_MSG(DBG_ERROR_PRIO, "GPR memq: Cannot free packet, packet is corrupted or already freed rc %d", rc);
+      AR_MSG(DBG_ERROR_PRIO, "GPR memq: Cannot free packet, packet is already freed");
+      return AR_EALREADY;
    }
+
+   unit_num = (uint32_t)(offset / block->unit_size) + 1;
+   head     = atomic_load_explicit(&block->free_head, memory_order_relaxed);
+   do
+   {
+      atomic_store_explicit(&entry->next_free, (uint32_t)head, memory_order_relaxed);
+   } while (!atomic_compare_exchange_weak_explicit(&block->free_head,
+                                                   &head,
+                                                   (((head >> 32) + 1) << 32) | unit_num,
+                                                   memory_order_release,
+                                                   memory_order_relaxed));
+
+   return AR_EOK;
 }
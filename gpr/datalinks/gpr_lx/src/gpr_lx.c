@@ -17,14 +17,13 @@
 #include "ar_osal_log.h"
 
 #ifdef GPR_USE_CUTILS
-#include <cutils/list.h>
 #include <sys/poll.h>
 #else
-#include "list.h"
 #include "poll.h"
 #endif
 
 #include <pthread.h>
+#include <stdatomic.h>
 #include "gpr_comdef.h"
 #include "ipc_dl_api.h"
 #include "gpr_ids_domains.h"
@@ -43,10 +42,26 @@ typedef uint32_t (*gpr_dl_lx_receive_cb)(void *ptr, uint32_t length);
 /** Data send done notification callback type*/
 typedef uint32_t (*gpr_dl_lx_send_done_cb)(void *ptr, uint32_t length);
 
-typedef struct gpr_dl_lx_buf{
-    struct listnode node;
-    void *buffer;
-}gpr_dl_lx_buf_t;
+#define GPR_DL_LX_BUF_NONE (-1)
+
+/*
+ * Receive buffers are carved out of one preallocated pool and kept on a
+ * free stack of buffer indices. Only the receiver thread pops, while
+ * buffers are pushed back from whichever thread the client frees the packet
+ * on, so the head is updated with compare-and-swap. With a single popper a
+ * buffer cannot be popped and pushed back between the popper reading the
+ * head and swapping it, so the stack needs no ABA tag.
+ */
+typedef struct gpr_dl_lx_buf_pool{
+    uint8_t *pool;                         /* no_of_buffers * buf_sz bytes */
+    size_t buf_sz;
+    int32_t no_of_buffers;
+    int32_t next[GPR_DL_LX_NO_OF_BUFFERS]; /* next free index of each buffer */
+    atomic_int free_head;                  /* GPR_DL_LX_BUF_NONE when empty */
+#ifdef GPR_DEBUG_MSG
+    atomic_uint free_mask;                 /* bit set while buffer is free */
+#endif
+}gpr_dl_lx_buf_pool_t;
 
 typedef struct gpr_dl_lx_port{
     uint32_t domain_id;
@@ -56,9 +71,8 @@ typedef struct gpr_dl_lx_port{
     gpr_dl_lx_send_done_cb send_done;
     int drv_fd;
     int intpipe[2];
-    struct listnode buff_list;
-    pthread_mutex_t buff_list_lock;
-    int buf_cnt;
+    gpr_dl_lx_buf_pool_t buf_pool;
+    atomic_int buf_cnt;
 } gpr_dl_lx_port_t;
 
 /*Array of structure pointers each member pointer corresponds to one domain*/
@@ -77,115 +91,109 @@ static ipc_to_gpr_vtbl_t gpr_dl_lx_vtbl =
 
 void deallocate_buffers(gpr_dl_lx_port_t *dl_lx_port)
 {
-    gpr_dl_lx_buf_t *buffer_node = NULL;
-    struct listnode *item = NULL;
-
-    pthread_mutex_lock(&dl_lx_port->buff_list_lock);
-    while (!list_empty(&dl_lx_port->buff_list)) {
-        item = list_head(&dl_lx_port->buff_list);
-        list_remove(item);
-        buffer_node = node_to_item(item, gpr_dl_lx_buf_t, node);
-        if (buffer_node->buffer)
-            free(buffer_node->buffer);
-        free(buffer_node);
-        buffer_node = NULL;
-    }
-    pthread_mutex_unlock(&dl_lx_port->buff_list_lock);
+    gpr_dl_lx_buf_pool_t *buf_pool = &dl_lx_port->buf_pool;
+
+    free(buf_pool->pool);
+    buf_pool->pool = NULL;
+    buf_pool->no_of_buffers = 0;
+    atomic_store(&buf_pool->free_head, GPR_DL_LX_BUF_NONE);
+    atomic_store(&dl_lx_port->buf_cnt, 0);
 }
 
 uint32_t allocate_buffers(gpr_dl_lx_port_t *dl_lx_port,
                           size_t buf_sz, size_t no_of_buffers)
 {
-    uint32_t status;
-    unsigned int i;
-
-    pthread_mutex_lock(&dl_lx_port->buff_list_lock);
-    list_init(&dl_lx_port->buff_list);
+    gpr_dl_lx_buf_pool_t *buf_pool = &dl_lx_port->buf_pool;
+    int32_t i;
 
-    for (i = 0; i < no_of_buffers; i++) {
-
-        gpr_dl_lx_buf_t *buffer_node =
-                          (gpr_dl_lx_buf_t *)malloc(sizeof(gpr_dl_lx_buf_t));
-        if (buffer_node == NULL) {
-            AR_LOG_ERR(LOG_TAG,"%s:%d malloc failed", __func__, __LINE__);
-            status = AR_ENOMEMORY;
-            goto error;
-        }
+    if (no_of_buffers > GPR_DL_LX_NO_OF_BUFFERS) {
+        AR_LOG_ERR(LOG_TAG,"%s:%d too many buffers %zu", __func__, __LINE__,
+                   no_of_buffers);
+        return AR_EBADPARAM;
+    }
 
-        buffer_node->buffer = calloc(buf_sz, sizeof(int8_t));
-        if (buffer_node->buffer == NULL) {
-            AR_LOG_ERR(LOG_TAG,"%s:%d malloc for buf failed", __func__, __LINE__);
-            free (buffer_node);
-            status = AR_ENOMEMORY;
-            goto error;
-        }
-        list_add_tail(&dl_lx_port->buff_list, &buffer_node->node);
-        dl_lx_port->buf_cnt++;
+    buf_pool->pool = (uint8_t *)calloc(no_of_buffers, buf_sz);
+    if (buf_pool->pool == NULL) {
+        AR_LOG_ERR(LOG_TAG,"%s:%d malloc for buf failed", __func__, __LINE__);
+        return AR_ENOMEMORY;
     }
-    AR_LOG_VERBOSE(LOG_TAG,"%s:%d buf_cnt = %d", __func__, __LINE__, dl_lx_port->buf_cnt);
-    pthread_mutex_unlock(&dl_lx_port->buff_list_lock);
+    buf_pool->buf_sz = buf_sz;
+    buf_pool->no_of_buffers = (int32_t)no_of_buffers;
+
+    for (i = 0; i < buf_pool->no_of_buffers; i++)
+        buf_pool->next[i] = (i + 1 < buf_pool->no_of_buffers) ?
+                            i + 1 : GPR_DL_LX_BUF_NONE;
+    atomic_store(&buf_pool->free_head,
+                 buf_pool->no_of_buffers ? 0 : GPR_DL_LX_BUF_NONE);
+#ifdef GPR_DEBUG_MSG
+    atomic_store(&buf_pool->free_mask,
+                 (uint32_t)((1ULL << buf_pool->no_of_buffers) - 1));
+#endif
+    atomic_store(&dl_lx_port->buf_cnt, buf_pool->no_of_buffers);
+
+    AR_LOG_VERBOSE(LOG_TAG,"%s:%d buf_cnt = %d", __func__, __LINE__,
+                   buf_pool->no_of_buffers);
     return AR_EOK;
-error:
-    pthread_mutex_unlock(&dl_lx_port->buff_list_lock);
-    deallocate_buffers(dl_lx_port);
-    return status;
 }
 
 uint32_t get_buffer(gpr_dl_lx_port_t *dl_lx_port, void **buf)
 {
-    gpr_dl_lx_buf_t *buffer_node;
-    struct listnode *item;
-    pthread_mutex_lock(&dl_lx_port->buff_list_lock);
-    if (list_empty(&dl_lx_port->buff_list)) {
-        AR_LOG_ERR(LOG_TAG,"%s:%d No free buffers available", __func__, __LINE__);
-        pthread_mutex_unlock(&dl_lx_port->buff_list_lock);
-        return AR_ENORESOURCE;
-    }
-    item = list_head(&dl_lx_port->buff_list);
-    if (item != NULL) {
-        list_remove(item);
-        buffer_node = node_to_item(item, gpr_dl_lx_buf_t, node);
-        if (buffer_node->buffer) {
-            *buf = buffer_node->buffer;
-            free(buffer_node);
-        } else {
-            AR_LOG_ERR(LOG_TAG,"%s:%d buffer node invalid", __func__, __LINE__);
-            pthread_mutex_unlock(&dl_lx_port->buff_list_lock);
-            return AR_ENOTEXIST;
+    gpr_dl_lx_buf_pool_t *buf_pool = &dl_lx_port->buf_pool;
+    int32_t head;
+
+    head = atomic_load_explicit(&buf_pool->free_head, memory_order_acquire);
+    do {
+        if (head == GPR_DL_LX_BUF_NONE) {
+            AR_LOG_ERR(LOG_TAG,"%s:%d No free buffers available", __func__, __LINE__);
+            return AR_ENORESOURCE;
         }
-        AR_LOG_VERBOSE(LOG_TAG,"%s:%d buf_cnt = %d", __func__, __LINE__, --dl_lx_port->buf_cnt);
-    }
-    pthread_mutex_unlock(&dl_lx_port->buff_list_lock);
+    } while (!atomic_compare_exchange_weak_explicit(&buf_pool->free_head,
+                &head, buf_pool->next[head], memory_order_acquire,
+                memory_order_acquire));
+
+#ifdef GPR_DEBUG_MSG
+    atomic_fetch_and(&buf_pool->free_mask, ~(1U << head));
+#endif
+    *buf = buf_pool->pool + (size_t)head * buf_pool->buf_sz;
+    AR_LOG_VERBOSE(LOG_TAG,"%s:%d buf_cnt = %d", __func__, __LINE__,
+                   atomic_fetch_sub(&dl_lx_port->buf_cnt, 1) - 1);
     return AR_EOK;
 }
 
 uint32_t put_buffer(gpr_dl_lx_port_t *dl_lx_port, void *buf)
 {
-    gpr_dl_lx_buf_t *buffer_node = NULL;
-    struct listnode *item = NULL;
-    struct listnode *temp_node = NULL;
-
-    pthread_mutex_lock(&dl_lx_port->buff_list_lock);
-    list_for_each_safe(item, temp_node, &dl_lx_port->buff_list) {
-        if (item != NULL) {
-            buffer_node = node_to_item(item, gpr_dl_lx_buf_t, node);
-            if (buffer_node && buffer_node->buffer == buf) {
-                AR_LOG_ERR(LOG_TAG,"%s:%d buffer already put error case", __func__, __LINE__);
-                pthread_mutex_unlock(&dl_lx_port->buff_list_lock);
-                return AR_EALREADY;
-            }
-        }
+    gpr_dl_lx_buf_pool_t *buf_pool = &dl_lx_port->buf_pool;
+    uint8_t *p = (uint8_t *)buf;
+    size_t offset;
+    int32_t idx, head;
+
+    if (p < buf_pool->pool || buf_pool->buf_sz == 0) {
+        AR_LOG_ERR(LOG_TAG,"%s:%d buffer not from pool", __func__, __LINE__);
+        return AR_EBADPARAM;
     }
-    buffer_node = (gpr_dl_lx_buf_t *)malloc(sizeof(gpr_dl_lx_buf_t));
-    if (buffer_node == NULL) {
-        AR_LOG_ERR(LOG_TAG,"%s:%d malloc failed", __func__, __LINE__);
-        pthread_mutex_unlock(&dl_lx_port->buff_list_lock);
-        return AR_ENOMEMORY;
+    offset = (size_t)(p - buf_pool->pool);
+    if (offset % buf_pool->buf_sz != 0 ||
+        offset / buf_pool->buf_sz >= (size_t)buf_pool->no_of_buffers) {
+        AR_LOG_ERR(LOG_TAG,"%s:%d buffer not from pool", __func__, __LINE__);
+        return AR_EBADPARAM;
+    }
+    idx = (int32_t)(offset / buf_pool->buf_sz);
+
+#ifdef GPR_DEBUG_MSG
+    if (atomic_fetch_or(&buf_pool->free_mask, 1U << idx) & (1U << idx)) {
+        AR_LOG_ERR(LOG_TAG,"%s:%d buffer already put error case", __func__, __LINE__);
+        return AR_EALREADY;
     }
-    buffer_node->buffer = buf;
-    list_add_tail(&dl_lx_port->buff_list, &buffer_node->node);
-    AR_LOG_VERBOSE(LOG_TAG,"%s:%d buf_cnt = %d", __func__, __LINE__, ++dl_lx_port->buf_cnt);
-    pthread_mutex_unlock(&dl_lx_port->buff_list_lock);
+#endif
+
+    head = atomic_load_explicit(&buf_pool->free_head, memory_order_relaxed);
+    do {
+        buf_pool->next[idx] = head;
+    } while (!atomic_compare_exchange_weak_explicit(&buf_pool->free_head,
+                &head, idx, memory_order_release, memory_order_relaxed));
+
+    AR_LOG_VERBOSE(LOG_TAG,"%s:%d buf_cnt = %d", __func__, __LINE__,
+                   atomic_fetch_add(&dl_lx_port->buf_cnt, 1) + 1);
     return AR_EOK;
 }
 
@@ -251,14 +259,18 @@ void *receiver_thread_loop(void *priv_data)
                 /*Shall we break out or continue ?*/
                 continue;
             }
-            memset(buf, 0 , GPR_DL_LX_BUF_SIZE);
             receive_size = read(dl_lx_port->drv_fd, buf, GPR_DL_LX_BUF_SIZE);
-            temp = (uint32_t *) buf;
-            AR_LOG_DEBUG(LOG_TAG,"recieved buffer %x %x %x %x size %d", temp[0], temp[1], temp[2], temp[3], receive_size);
             if ((receive_size <= 0) || (receive_size > GPR_DL_LX_BUF_SIZE)) {
                 AR_LOG_ERR(LOG_TAG,"%s:%d read failed %d", __func__, __LINE__, errno);
                 put_buffer(dl_lx_port, buf);
             } else {
+                /* the buffer is not cleared, only log words that were read */
+                temp = (uint32_t *) buf;
+                if (receive_size >= (int32_t)(4 * sizeof(uint32_t))) {
+                    AR_LOG_DEBUG(LOG_TAG,"recieved buffer %x %x %x %x size %d", temp[0], temp[1], temp[2], temp[3], receive_size);
+                } else {
+                    AR_LOG_DEBUG(LOG_TAG,"recieved buffer size %d", receive_size);
+                }
                 if (dl_lx_port->rx_cb) {
                     status = dl_lx_port->rx_cb(buf, receive_size);
                     if (status != AR_EOK) {
@@ -342,9 +354,6 @@ static gpr_dl_lx_port_t * gpr_dl_lx_local_init(uint32_t src_domain_id, uint32_t
         return NULL;
     }
 
-    pthread_mutex_init(&dl_lx_port->buff_list_lock,
-                          (const pthread_mutexattr_t *) NULL);
-
     status = allocate_buffers(dl_lx_port, GPR_DL_LX_BUF_SIZE,
                              GPR_DL_LX_NO_OF_BUFFERS);
     if (status) {
@@ -359,6 +368,7 @@ static gpr_dl_lx_port_t * gpr_dl_lx_local_init(uint32_t src_domain_id, uint32_t
                     receiver_thread_loop, dl_lx_port);
     if (status) {
         AR_LOG_ERR(LOG_TAG,"%s:%d error:%d pthread_create fail", __func__, __LINE__, status);
+        deallocate_buffers(dl_lx_port);
         free(dl_lx_port);
         return NULL;
     }
@@ -395,6 +405,7 @@ static uint32_t gpr_dl_lx_local_deinit(uint32_t src_domain_id, uint32_t dst_doma
     }
     close(dl_lx_port->drv_fd);
     dl_lx_port->drv_fd = 0;
+    deallocate_buffers(dl_lx_port);
     free(dl_lx_port);
     return status;
 }
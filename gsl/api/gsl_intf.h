@@ -191,6 +191,20 @@ enum gsl_cmd_id {
 	 * and property_values
 	 */
 	GSL_CMD_CLOSE_WITH_PROPS = 0x15,
+	/**
+	 * Get the counters of the graph open cache, which holds the database
+	 * lookups done to open graphs. The cache is shared by all graphs.
+	 * Payload: struct gsl_cmd_graph_cache_stats will be sent from client
+	 * and will get written to by GSL.
+	 */
+	GSL_CMD_GET_GRAPH_CACHE_STATS = 0x16,
+	/**
+	 * Get the time spent in each stage of the last open of the graph, for
+	 * profiling.
+	 * Payload: struct gsl_cmd_open_timing will be sent from client
+	 * and will get written to by GSL.
+	 */
+	GSL_CMD_GET_OPEN_TIMING = 0x17,
 	GSL_CMD_MAX
 };
 
@@ -409,6 +423,42 @@ struct gsl_cmd_graph_select {
 	struct gsl_key_vector cal_key_vect;
 };
 
+/** Cmd payload for GSL_CMD_GET_GRAPH_CACHE_STATS */
+struct gsl_cmd_graph_cache_stats {
+	/** number of lookups answered from the cache */
+	uint32_t hits;
+	/** number of lookups that had to query the database */
+	uint32_t misses;
+	/** number of entries dropped to make room for new ones */
+	uint32_t evictions;
+	/** number of times the cache was flushed because the database changed */
+	uint32_t invalidations;
+	/** number of entries currently in the cache */
+	uint32_t num_entries;
+	/** number of bytes currently held by the cache */
+	uint32_t size;
+};
+
+/**
+ * Cmd payload for GSL_CMD_GET_OPEN_TIMING, all times are in microseconds.
+ * Calibration is prefetched while Spf opens the graph, so cal_prefetch_us
+ * overlaps spf_open_us.
+ */
+struct gsl_cmd_open_timing {
+	/** getting the subgraphs and connections of the GKV from the database */
+	uint32_t acdb_graph_us;
+	/** getting the subgraph and connection data to open from the database */
+	uint32_t acdb_open_data_us;
+	/** sending the graph open command to Spf and waiting for the response */
+	uint32_t spf_open_us;
+	/** prefetching the non-persistent calibration from the database */
+	uint32_t cal_prefetch_us;
+	/** getting and sending the calibration after the graph is opened */
+	uint32_t cal_us;
+	/** the whole open */
+	uint32_t total_us;
+};
+
 /** Cmd payload for GSL_CMD_REMOVE_GRAPH*/
 struct gsl_cmd_remove_graph {
 	/**
@@ -705,6 +755,31 @@ int32_t gsl_register_global_event_cb(gsl_global_cb_func_ptr global_cb,
 int32_t gsl_open(const struct gsl_key_vector *graph_key_vect,
 	const struct gsl_key_vector *cal_key_vect, gsl_handle_t *graph_handle);
 
+/** A graph to load with gsl_open_batch */
+struct gsl_open_batch_entry {
+	const struct gsl_key_vector *graph_key_vect;
+	/**< used to identify the graph */
+	const struct gsl_key_vector *cal_key_vect;
+	/**< OPTIONAL used to identify calibration data for the graph */
+	gsl_handle_t graph_handle;
+	/**< [out] graph handle on success, null otherwise */
+};
+
+/**
+ * \brief Load several graphs to the DSP together. Subgraphs shared between
+ * the graphs are loaded once, and consecutive graphs on the same master
+ * processor are loaded with a single command to the DSP. Either all graphs
+ * are loaded or none are. Each returned handle is closed with gsl_close.
+ *
+ * \param[in,out] entries: the graphs to load, graph handles are returned in
+ * each entry
+ * \param[in] num_entries: number of entries
+ *
+ * \return GSL_EOK on success, error code otherwise
+ */
+int32_t gsl_open_batch(struct gsl_open_batch_entry *entries,
+	uint32_t num_entries);
+
 /**
  * \brief Close a graph that was specified using the graph_handle
  *
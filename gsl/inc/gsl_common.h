@@ -336,6 +336,11 @@ static inline int32_t gsl_memcpy(void *dst, size_t dst_size, const void *src,
 	return ar_mem_cpy(dst, dst_size, src, size);
 }
 
+static inline int32_t gsl_memcmp(const void *p1, const void *p2, size_t size)
+{
+	return ar_mem_cmp(p1, p2, size);
+}
+
 static inline void *gsl_mem_realloc(void *p, size_t old_sz, size_t new_sz)
 {
 	void *new_p = NULL;
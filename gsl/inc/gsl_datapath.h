@@ -20,6 +20,7 @@
 #include "gsl_intf.h"
 #include "gsl_common.h"
 #include "gsl_msg_builder.h"
+#include <stdatomic.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -110,11 +111,20 @@ struct gsl_data_path_info {
 	 * bit pos 1: indicates buffer number 1 is used or available
 	 * . . .
 	 * bit pos num_buffs - 1: buffer number (num_buffs - 1) is used or avail
+	 *
+	 * Together with curr_buff_index this forms a single-producer
+	 * single-consumer ring: only the client thread sets bits and advances
+	 * curr_buff_index, only the GPR receive thread clears bits, so neither
+	 * takes the lock. Both are reset only while the data path is being
+	 * configured and no buffers are with spf.
 	 */
-	int32_t buff_used_status;
+	atomic_uint buff_used_status;
 
-	/** Buffer available to be queued to spf [0,...,config.num_buffs) */
-	int32_t curr_buff_index;
+	/**
+	 * Buffer available to be queued to spf [0,...,config.num_buffs), only
+	 * accessed from the client thread
+	 */
+	uint32_t curr_buff_index;
 
 	/**
 	 * next metadata buffer available
@@ -141,7 +151,10 @@ struct gsl_data_path_info {
 	 */
 	 uint32_t md_buff_list_size;
 
-	/** Lock used to mark buffers as available or used */
+	/**
+	 * Lock used for the metadata buffer queue and the data path signal,
+	 * buffer ownership is tracked without it, see buff_used_status
+	 */
 	ar_osal_mutex_t lock;
 
 	/**
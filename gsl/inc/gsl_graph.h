@@ -200,6 +200,8 @@ struct gsl_graph {
 	 * values for this bitmask are provided in gsl_spf_ss_state.h
 	 */
 	uint32_t ss_mask;
+	/** time spent in each stage of the last open */
+	struct gsl_cmd_open_timing open_timing;
 };
 
 struct gsl_prepare_change_graph_single_gkv_params {
@@ -287,6 +289,26 @@ int32_t gsl_graph_open(struct gsl_graph *graph,
 			  const struct gsl_key_vector *ckv,
 			  ar_osal_mutex_t lock);
 
+/**
+ * \brief Load several graphs on to SPF together. The graphs are resolved
+ * against ACDB and added to the subgraph pool before anything is opened, so
+ * SGs shared between them are opened once, and consecutive graphs on the
+ * same master proc are opened with a single command. Either all graphs are
+ * opened or none are.
+ *
+ * \param[in] graphs: array of num_graphs pointers to graph memory
+ * \param[in] gkvs: graph key vector of each graph
+ * \param[in] ckvs: OPTIONAL calibration key vector of each graph
+ * \param[in] num_graphs: number of graphs to open
+ * \param[in] lock: OPTIONAL operations occur with this lock acquired
+ *
+ * \return AR_EOK on success, error code otherwise
+ */
+int32_t gsl_graph_open_batch(struct gsl_graph **graphs,
+			  const struct gsl_key_vector **gkvs,
+			  const struct gsl_key_vector **ckvs,
+			  uint32_t num_graphs, ar_osal_mutex_t lock);
+
 /**
  * \brief Close the graph on SPF. Releases all resources that belong to
  * the graph.
@@ -710,6 +732,56 @@ int32_t gsl_graph_close_with_properties(struct gsl_graph *graph,
  * \return EOK on success, error code otherwise.
  */
 void gsl_graph_set_rtgm_state(struct gsl_graph *graph, bool_t rtgm_in_prog);
+
+/**
+ * \brief Initialize the graph open cache, which holds the database lookups
+ * done to open graphs and apply their non-persistent calibration
+ *
+ * \return EOK on success, error code otherwise.
+ */
+int32_t gsl_graph_cache_init(void);
+
+/**
+ * \brief Free all entries of the graph open cache and its resources
+ */
+void gsl_graph_cache_deinit(void);
+
+/**
+ * \brief Flush the graph open cache. Writes to the database flush it on their
+ * own, through the ACDB data version. This is for changes the data version
+ * does not cover, e.g. a graph being changed through RTC.
+ */
+void gsl_graph_cache_invalidate(void);
+
+/**
+ * \brief Get the counters of the graph open cache
+ *
+ * \param[out] stats: filled with the current counters
+ */
+void gsl_graph_cache_get_stats(struct gsl_cmd_graph_cache_stats *stats);
+
+/**
+ * \brief Start the worker that prefetches non-persistent calibration while
+ * Spf opens a graph. Graphs open without the prefetch if this fails.
+ *
+ * \return EOK on success, error code otherwise.
+ */
+int32_t gsl_graph_cal_prefetch_init(void);
+
+/**
+ * \brief Stop the calibration prefetch worker and free its resources
+ */
+void gsl_graph_cal_prefetch_deinit(void);
+
+/**
+ * \brief Get the time spent in each stage of the last open of the graph
+ *
+ * \param[in] graph: pointer to graph's memory
+ * \param[out] timing: filled with the stage timings
+ * \param[in] lock: OPTIONAL operations occur with this lock acquired
+ */
+void gsl_graph_get_open_timing(struct gsl_graph *graph,
+	struct gsl_cmd_open_timing *timing, ar_osal_mutex_t lock);
 #ifdef __cplusplus
 }  /* extern "C" */
 #endif
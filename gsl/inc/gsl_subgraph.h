@@ -25,6 +25,7 @@ struct gsl_child_sg {
 
 struct gsl_subgraph {
 	struct ar_list_node_t node;
+	struct gsl_subgraph *hash_next; /**< next subgraph in pool hash bucket */
 	uint32_t sg_id;
 	uint32_t open_ref_cnt;
 	uint32_t start_ref_cnt;
@@ -36,6 +36,19 @@ int32_t gsl_sg_pool_deinit(void);
  */
 struct gsl_subgraph *gsl_sg_pool_find(uint32_t sgid);
 
+/**
+ * \brief Find a list of subgraphs by SGID in the pool
+ *
+ * \param[in] sg_ids: the subgraph IDs to find
+ * \param[in] num_sgs: number of entries in sg_ids
+ * \param[out] sg_objs: pointers to the SG objects, NULL for the SGIDs that
+ *		are not in the pool
+ *
+ * \return AR_EOK if all subgraphs were found, AR_ENOTEXIST otherwise
+ */
+int32_t gsl_sg_pool_find_list(const uint32_t *sg_ids, uint32_t num_sgs,
+	struct gsl_subgraph **sg_objs);
+
 /**
  * \brief Add a subgraph to the pool
  *
@@ -43,6 +56,20 @@ struct gsl_subgraph *gsl_sg_pool_find(uint32_t sgid);
  */
 struct gsl_subgraph *gsl_sg_pool_add(uint32_t sg_id, bool_t preload_only);
 
+/**
+ * \brief Add a list of subgraphs to the pool while holding the pool lock once
+ *
+ * \param[in] sg_ids: the subgraph IDs to add
+ * \param[in] num_sgs: number of entries in sg_ids
+ * \param[in] preload_only: do not take an open reference if set
+ * \param[out] sg_objs: pointers to the SG objects, NULL for the SGIDs that
+ *		could not be added
+ *
+ * \return AR_EOK on success, error code otherwise
+ */
+int32_t gsl_sg_pool_add_list(const uint32_t *sg_ids, uint32_t num_sgs,
+	bool_t preload_only, struct gsl_subgraph **sg_objs);
+
 /**
  * \brief Remove a subgraph from pool
  *
@@ -50,6 +77,15 @@ struct gsl_subgraph *gsl_sg_pool_add(uint32_t sg_id, bool_t preload_only);
  */
 int32_t gsl_sg_pool_remove(struct gsl_subgraph *sg, bool_t unload_only);
 
+/**
+ * \brief Remove a list of subgraphs from the pool while holding the pool
+ * lock once. NULL entries are skipped
+ *
+ * \return AR_EOK on success, error code otherwise
+ */
+int32_t gsl_sg_pool_remove_list(struct gsl_subgraph **sg_objs,
+	uint32_t num_sgs, bool_t unload_only);
+
 /**
  * \brief Determine which subgraphs out of the provided list have a refrence
  *	count of 1 and return the corresponding subgraph ids
@@ -20,9 +20,14 @@
 #include "gpr_api_inline.h"
 
 #define GSL_MAX_RETRIES 3
-#define GSL_MAX_CACHE_UNMAP_RETRIES  3
 #define GSL_MAX_CACHE_SIZE 32
 
+/* ext mem cache hash buckets, handles are hashed to the top bits */
+#define GSL_EXT_MEM_CACHE_BUCKET_SHIFT 6
+#define GSL_EXT_MEM_CACHE_NUM_BUCKETS (1 << GSL_EXT_MEM_CACHE_BUCKET_SHIFT)
+/* terminates the ext mem cache hash chains, LRU list and free list */
+#define GSL_EXT_MEM_CACHE_NO_ENTRY UINT32_MAX
+
 #define GSL_METADATA_TO_DATA_FACTOR 2
 
 #define GSL_EXT_MEM_HANDLE_CHANGING UINT64_MAX
@@ -33,17 +38,28 @@
 struct gsl_ext_mem_cache_entry {
 	uint64_t alloc_handle;
 	uint32_t alloc_size;
-	uint32_t num_bufs_in_flight;
-	uint64_t last_used;		// used when finding LRU eviction candidate
-	// todo: state
+	/*
+	 * only incremented under global_cache_lock, but decremented without it
+	 * when spf returns the buffer. An entry seen idle under the lock can
+	 * therefore be evicted safely.
+	 */
+	atomic_uint num_bufs_in_flight;
+	uint32_t hash_next;		// next entry in hash bucket or free list
+	uint32_t lru_prev;		// towards the most recently used entry
+	uint32_t lru_next;		// towards the least recently used entry
 	struct gsl_shmem_alloc_data shmem_data;
-	ar_osal_mutex_t lock;	// protects alloc_handle and num_bufs_in_flight
 };
 
 /* Global cache object for external memory */
 static struct gsl_external_mem_cache {
 	struct gsl_ext_mem_cache_entry *entries; // array of [GSL_MAX_CACHE_SIZE];
-	uint64_t age_counter;					// for updating last used
+	uint32_t buckets[GSL_EXT_MEM_CACHE_NUM_BUCKETS]; // first entry per hash
+	uint32_t lru_head;						// most recently used mapped entry
+	uint32_t lru_tail;						// least recently used mapped entry
+	uint32_t free_head;						// first unmapped entry
+	uint32_t num_hits;						// lookups served from the cache
+	uint32_t num_misses;					// lookups that mapped the buffer
+	uint32_t num_evictions;
 	uint32_t num_extern_mem_datapaths;		// refcount, essentially
 	ar_osal_mutex_t num_dps_lock;			// lock for refcount
 	ar_osal_mutex_t global_cache_lock;		// lock to serialise maps & evicts
@@ -62,11 +78,21 @@ static void ext_mem_cache_init(void)
 		/* if first UC, instantiate the cache array and locks.*/
 		ext_mem_cache.entries = gsl_mem_zalloc(
 			sizeof(struct gsl_ext_mem_cache_entry) * GSL_MAX_CACHE_SIZE);
-		ext_mem_cache.age_counter = 0;
 		ar_osal_mutex_create(&ext_mem_cache.global_cache_lock);
 
+		for (i = 0; i < GSL_EXT_MEM_CACHE_NUM_BUCKETS; ++i)
+			ext_mem_cache.buckets[i] = GSL_EXT_MEM_CACHE_NO_ENTRY;
+
+		/* all entries start out on the free list */
 		for (i = 0; i < GSL_MAX_CACHE_SIZE; ++i)
-			ar_osal_mutex_create(&ext_mem_cache.entries[i].lock);
+			ext_mem_cache.entries[i].hash_next = (i + 1 < GSL_MAX_CACHE_SIZE) ?
+				i + 1 : GSL_EXT_MEM_CACHE_NO_ENTRY;
+		ext_mem_cache.free_head = 0;
+		ext_mem_cache.lru_head = GSL_EXT_MEM_CACHE_NO_ENTRY;
+		ext_mem_cache.lru_tail = GSL_EXT_MEM_CACHE_NO_ENTRY;
+		ext_mem_cache.num_hits = 0;
+		ext_mem_cache.num_misses = 0;
+		ext_mem_cache.num_evictions = 0;
 	}
 	GSL_MUTEX_UNLOCK(ext_mem_cache.num_dps_lock);
 }
@@ -79,16 +105,15 @@ static void ext_mem_cache_deinit(void)
 	GSL_MUTEX_LOCK(ext_mem_cache.num_dps_lock);
 	/* decrement then check whether to tear down the cache */
 	if (--ext_mem_cache.num_extern_mem_datapaths == 0) {
-		GSL_DBG("Deinit ext mem cache");
+		GSL_DBG("Deinit ext mem cache, hits %d misses %d evictions %d",
+			ext_mem_cache.num_hits, ext_mem_cache.num_misses,
+			ext_mem_cache.num_evictions);
 
 		/* unmap all entries */
-		for (i = 0; i < GSL_MAX_CACHE_SIZE; ++i) {
-			//state...
-			if (ext_mem_cache.entries[i].alloc_handle
-				!= GSL_EXT_MEM_HDL_NOT_ALLOCD)
-				gsl_shmem_unmap_extern_mem(ext_mem_cache.entries[i].shmem_data);
-			ar_osal_mutex_destroy(ext_mem_cache.entries[i].lock);
-		}
+		for (i = ext_mem_cache.lru_head; i != GSL_EXT_MEM_CACHE_NO_ENTRY;
+			i = ext_mem_cache.entries[i].lru_next)
+			gsl_shmem_unmap_extern_mem(ext_mem_cache.entries[i].shmem_data);
+
 		ar_osal_mutex_destroy(ext_mem_cache.global_cache_lock);
 		gsl_mem_free(ext_mem_cache.entries);
 		ext_mem_cache.entries = NULL;
@@ -96,34 +121,126 @@ static void ext_mem_cache_deinit(void)
 	GSL_MUTEX_UNLOCK(ext_mem_cache.num_dps_lock);
 }
 
+static uint32_t ext_mem_cache_hash(uint64_t alloc_handle)
+{
+	/* fibonacci hashing, spreads handles that differ only in low bits */
+	return (uint32_t)((alloc_handle * 0x9E3779B97F4A7C15ULL) >>
+		(64 - GSL_EXT_MEM_CACHE_BUCKET_SHIFT));
+}
+
+/* below helpers must be called with global_cache_lock held */
+static uint32_t ext_mem_cache_find(uint64_t alloc_handle)
+{
+	uint32_t i = ext_mem_cache.buckets[ext_mem_cache_hash(alloc_handle)];
+
+	while (i != GSL_EXT_MEM_CACHE_NO_ENTRY &&
+		ext_mem_cache.entries[i].alloc_handle != alloc_handle)
+		i = ext_mem_cache.entries[i].hash_next;
+
+	return i;
+}
+
+static void ext_mem_cache_lru_unlink(uint32_t index)
+{
+	struct gsl_ext_mem_cache_entry *entry = &ext_mem_cache.entries[index];
+
+	if (entry->lru_prev != GSL_EXT_MEM_CACHE_NO_ENTRY)
+		ext_mem_cache.entries[entry->lru_prev].lru_next = entry->lru_next;
+	else
+		ext_mem_cache.lru_head = entry->lru_next;
+
+	if (entry->lru_next != GSL_EXT_MEM_CACHE_NO_ENTRY)
+		ext_mem_cache.entries[entry->lru_next].lru_prev = entry->lru_prev;
+	else
+		ext_mem_cache.lru_tail = entry->lru_prev;
+}
+
+static void ext_mem_cache_lru_push_front(uint32_t index)
+{
+	struct gsl_ext_mem_cache_entry *entry = &ext_mem_cache.entries[index];
+
+	entry->lru_prev = GSL_EXT_MEM_CACHE_NO_ENTRY;
+	entry->lru_next = ext_mem_cache.lru_head;
+	if (ext_mem_cache.lru_head != GSL_EXT_MEM_CACHE_NO_ENTRY)
+		ext_mem_cache.entries[ext_mem_cache.lru_head].lru_prev = index;
+	else
+		ext_mem_cache.lru_tail = index;
+	ext_mem_cache.lru_head = index;
+}
+
+/* unlinks a mapped entry from its hash bucket and the LRU list */
+static void ext_mem_cache_remove_entry(uint32_t index)
+{
+	struct gsl_ext_mem_cache_entry *entry = &ext_mem_cache.entries[index];
+	uint32_t *link = &ext_mem_cache.buckets[
+		ext_mem_cache_hash(entry->alloc_handle)];
+
+	while (*link != index)
+		link = &ext_mem_cache.entries[*link].hash_next;
+	*link = entry->hash_next;
+
+	ext_mem_cache_lru_unlink(index);
+
+	entry->alloc_handle = GSL_EXT_MEM_HDL_NOT_ALLOCD;
+	entry->alloc_size = 0;
+	gsl_memset(&entry->shmem_data, 0, sizeof(struct gsl_shmem_alloc_data));
+
+	entry->hash_next = ext_mem_cache.free_head;
+	ext_mem_cache.free_head = index;
+}
+
 /*
- * note this does not increment bufs in flight
- * -- that's done in get_entry for concurrency reasons
+ * Evicts idle entries starting from the least recently used one, either all
+ * of them or just the first. The mappings of the evicted entries are copied
+ * to to_unmap so they can be unmapped after the lock is released.
+ * Returns the number of evicted entries.
  */
-static void ext_mem_cache_update_entry_last_used(uint32_t index)
+static uint32_t ext_mem_cache_evict_idle(
+	struct gsl_shmem_alloc_data *to_unmap, bool_t evict_all)
 {
-	uint32_t i;
-	uint64_t least_recently_used = UINT64_MAX;
+	uint32_t i = ext_mem_cache.lru_tail, prev, num_evicted = 0;
+
+	while (i != GSL_EXT_MEM_CACHE_NO_ENTRY) {
+		prev = ext_mem_cache.entries[i].lru_prev;
+		if (atomic_load(&ext_mem_cache.entries[i].num_bufs_in_flight) == 0) {
+			GSL_DBG("evicting entry %d, handle 0x%x", i,
+				ext_mem_cache.entries[i].alloc_handle);
+			gsl_memcpy(&to_unmap[num_evicted++],
+				sizeof(struct gsl_shmem_alloc_data),
+				&ext_mem_cache.entries[i].shmem_data,
+				sizeof(struct gsl_shmem_alloc_data));
+			ext_mem_cache_remove_entry(i);
+			++ext_mem_cache.num_evictions;
+			if (!evict_all)
+				break;
+		}
+		i = prev;
+	}
 
-	/*
-	 * Not protecting this:
-	 * it does not matter if age counter is same for 2 buffers
-	 */
-	ext_mem_cache.entries[index].last_used = ext_mem_cache.age_counter++;
+	return num_evicted;
+}
 
-	/* int rollover handling for age counter */
-	if (ext_mem_cache.age_counter == UINT64_MAX) {
-		for (i = 0; i < GSL_MAX_CACHE_SIZE; ++i) {
-			if (ext_mem_cache.entries[i].last_used < least_recently_used)
-				least_recently_used = ext_mem_cache.entries[i].last_used;
-		}
-		for (i = 0; i < GSL_MAX_CACHE_SIZE; ++i)
-			ext_mem_cache.entries[i].last_used -= least_recently_used;
+static void ext_mem_cache_unmap_entries(struct gsl_shmem_alloc_data *to_unmap,
+	uint32_t num_to_unmap)
+{
+	int32_t rc = AR_EOK;
+	uint32_t i;
 
-		ext_mem_cache.age_counter = 0;
+	for (i = 0; i < num_to_unmap; ++i) {
+		rc = gsl_shmem_unmap_extern_mem(to_unmap[i]);
+		if (rc != AR_EOK) {
+			/* ignore this, we have torn down the entry anyway */
+			GSL_DBG("unmap extern mem failed rc=%d", rc);
+		}
 	}
 }
 
+/* drops a reference taken by ext_mem_cache_get_entry */
+static void ext_mem_cache_put_entry(uint32_t index)
+{
+	atomic_fetch_sub(&ext_mem_cache.entries[index].num_bufs_in_flight, 1);
+}
+
 /*
  * This only copies required fields out:  alloc_handle, alloc_size, spf_addr
  * If you need more, you need to add the copy.
@@ -141,207 +258,59 @@ static void ext_mem_cache_buf_done(uint32_t index,
 	cache_entry_data->shmem_data.spf_addr
 		= ext_mem_cache.entries[index].shmem_data.spf_addr;
 
-	GSL_MUTEX_LOCK(ext_mem_cache.entries[index].lock);
-	--ext_mem_cache.entries[index].num_bufs_in_flight;
-	GSL_MUTEX_UNLOCK(ext_mem_cache.entries[index].lock);
-}
-
-static int32_t ext_mem_cache_evict_entry(uint32_t *evicted_idx,
-	struct gsl_shmem_alloc_data *to_unmap)
-{
-	uint32_t i, lru_idx = UINT32_MAX, num_tries = 0;
-	uint64_t least_recently_used = UINT64_MAX;
-	bool_t entry_locked = FALSE;
-
-	while (!entry_locked) {
-		/*
-		 * bail if our candidate LRU gets repeatedly re-used from under us
-		 * This means all buffers are being used frequently (cache too small)
-		 */
-		if (num_tries++ == GSL_MAX_CACHE_UNMAP_RETRIES)
-			goto cache_full;
-
-		for (i = 0; i < GSL_MAX_CACHE_SIZE; ++i) {
-			/* this is the eviction strategy */
-			if (ext_mem_cache.entries[i].num_bufs_in_flight == 0 &&
-				ext_mem_cache.entries[i].last_used < least_recently_used) {
-				lru_idx = i;
-				least_recently_used = ext_mem_cache.entries[i].last_used;
-			}
-		}
-
-		if (lru_idx == UINT32_MAX) {
-			/* bail with failure -- all bufs in use */
-			goto cache_full;
-		}
-
-		/*
-		 * get lock and invalidate the alloc handle so other threads
-		 * can't grab it from under this one, and make sure no thread sent a buf
-		 * in the mean-time (i.e. dodge check-then-use issues)
-		 */
-		GSL_MUTEX_LOCK(ext_mem_cache.entries[lru_idx].lock);
-		if (ext_mem_cache.entries[lru_idx].num_bufs_in_flight == 0)	{
-			/* if bufs in flight non-zero, our candidate got used */
-			ext_mem_cache.entries[lru_idx].alloc_handle
-				= GSL_EXT_MEM_HDL_NOT_ALLOCD;
-
-			entry_locked = TRUE;	/* exit this loop */
-		}
-		GSL_MUTEX_UNLOCK(ext_mem_cache.entries[lru_idx].lock);
-	}
-
-	/* the unmap is sent outside the global mapping lock */
-	gsl_memcpy(to_unmap, sizeof(struct gsl_shmem_alloc_data),
-		&ext_mem_cache.entries[lru_idx].shmem_data,
-		sizeof(struct gsl_shmem_alloc_data));
-
-	ext_mem_cache.entries[lru_idx].alloc_size = 0;
-	ext_mem_cache.entries[lru_idx].last_used = UINT64_MAX;
-	gsl_memset(&ext_mem_cache.entries[lru_idx].shmem_data, 0,
-		sizeof(struct gsl_shmem_alloc_data));
-
-	*evicted_idx = lru_idx;
-
-	return AR_EOK;
-
-cache_full:
-	GSL_ERR("Cache all in use. Increase your cache size");
-	/* todo: map one-time use buffer for this case */
-	return AR_ENORESOURCE;
+	ext_mem_cache_put_entry(index);
 }
 
 /*
  * output: alloc_data is constructed as a copy, idx is the index into the array
  * Use idx as the token to send to gecko
- * This function increments num_bufs_in_flight for synchronization reasons.
+ * This function increments num_bufs_in_flight and marks the entry as most
+ * recently used.
  */
 static uint32_t ext_mem_cache_get_entry(uint32_t proc_id,
 	struct gsl_extern_alloc_buff_info ext_mem_data,
 	struct gsl_shmem_alloc_data *alloc_data, uint32_t *idx)
 {
 	int32_t rc = AR_EOK;
-	uint32_t i, first_unused = UINT32_MAX;
-	struct gsl_shmem_alloc_data to_unmap = { 0 };
+	uint32_t i, num_to_unmap = 0;
+	struct gsl_shmem_alloc_data to_unmap[GSL_MAX_CACHE_SIZE];
 
+#ifdef GSL_EXT_MEM_CACHE_DISABLE
 	/*
-	 * locking here only for cache disabled, to prevent double unmap
-	 * Should be moved back to where it is commented out when cache enabled.
-	 * Could make disable flow more efficient (no other locks) with this,
-	 * but effort is better spent on enabling the cache as designed...
+	 * with the cache disabled nothing stays mapped once spf has returned it,
+	 * so unmap every idle entry before looking up this buffer
 	 */
 	GSL_MUTEX_LOCK(ext_mem_cache.global_cache_lock);
+	num_to_unmap = ext_mem_cache_evict_idle(to_unmap, TRUE);
+	GSL_MUTEX_UNLOCK(ext_mem_cache.global_cache_lock);
+	ext_mem_cache_unmap_entries(to_unmap, num_to_unmap);
+	num_to_unmap = 0;
+#endif
 
-	/*
-	 * Checking if item is in the cache already
-	 * Not locking every check as this is costly. We will re-check under lock.
-	 */
-	for (i = 0; i < GSL_MAX_CACHE_SIZE; ++i) {
-
-#ifdef GSL_EXT_MEM_CACHE_DISABLE
-		if (ext_mem_cache.entries[i].num_bufs_in_flight == 0 &&
-			ext_mem_cache.entries[i].alloc_handle
-			!= GSL_EXT_MEM_HDL_NOT_ALLOCD) {
-
-			GSL_MUTEX_LOCK(ext_mem_cache.entries[i].lock);
-			/*
-			 * check again that handle is valid -- other thread may
-			 * have unmapped already
-			 */
-			if (ext_mem_cache.entries[i].num_bufs_in_flight == 0 &&
-				ext_mem_cache.entries[i].alloc_handle
-				!= GSL_EXT_MEM_HDL_NOT_ALLOCD) {
-				GSL_DBG("Unmapping entry %d, handle 0x%x",
-					i, ext_mem_cache.entries[i].alloc_handle);
-
-				ext_mem_cache.entries[i].alloc_handle
-					= GSL_EXT_MEM_HDL_NOT_ALLOCD;
-
-				//unmapping within lock... not efficient
-				rc = gsl_shmem_unmap_extern_mem(
-					ext_mem_cache.entries[i].shmem_data);
-				if (rc != AR_EOK)
-					GSL_DBG("unmap extern mem failed rc=%d", rc);
-			}
-
-			GSL_MUTEX_UNLOCK(ext_mem_cache.entries[i].lock);
-
-		}
-		/* we will never hit the next check in cache disabled path. */
-#endif // GSL_EXT_MEM_CACHE_DISABLE
-
-		if (ext_mem_cache.entries[i].alloc_handle
-			== ext_mem_data.alloc_handle) {
-
-			/* found cache entry. mark it in use safely */
-			GSL_MUTEX_LOCK(ext_mem_cache.entries[i].lock);
-			if (ext_mem_cache.entries[i].alloc_handle
-				== ext_mem_data.alloc_handle) {
-				++ext_mem_cache.entries[i].num_bufs_in_flight;
-				GSL_MUTEX_UNLOCK(ext_mem_cache.entries[i].lock);
-
-				goto exit_success;
-			}
-
-			/* implied else */
-			/* Our entry got sniped by an eviction. Log and map later */
-			GSL_MUTEX_UNLOCK(ext_mem_cache.entries[i].lock);
-			GSL_DBG("gsl extmem cache entry got sniped. increase cache size?");
-		}
-	}
-
-	/* We did not find our buffer in the cache. We need to map it */
-	/* see note at top of function re lock */
-	//GSL_MUTEX_LOCK(ext_mem_cache.global_cache_lock);
-	/* all mappings are serialised to avoid double-mapping the same alloc */
-
-	/*
-	 * Check if our handle got added to the cache while we were waiting for
-	 * the global lock
-	 */
-	for (i = 0; i < GSL_MAX_CACHE_SIZE; ++i) {
-		if (ext_mem_cache.entries[i].alloc_handle
-			== ext_mem_data.alloc_handle) {
-			/* our buffer got mapped by another thread. We can stop. */
-			GSL_MUTEX_LOCK(ext_mem_cache.entries[i].lock);
-			++ext_mem_cache.entries[i].num_bufs_in_flight;
-			GSL_MUTEX_UNLOCK(ext_mem_cache.entries[i].lock);
-
-			/* see note at top of function re lock */
-			//GSL_MUTEX_UNLOCK(ext_mem_cache.global_cache_lock);
-			goto exit_success;
-		}
+	GSL_MUTEX_LOCK(ext_mem_cache.global_cache_lock);
 
-		/*
-		 * continue even if we see an unused buff, since desired buffer could be
-		 * after first unused once we add aging out
-		 */
-		if (first_unused == UINT32_MAX
-			&& ext_mem_cache.entries[i].alloc_handle
-			== GSL_EXT_MEM_HDL_NOT_ALLOCD) {
-			first_unused = i;
-		}
+	i = ext_mem_cache_find(ext_mem_data.alloc_handle);
+	if (i != GSL_EXT_MEM_CACHE_NO_ENTRY) {
+		++ext_mem_cache.num_hits;
+		ext_mem_cache_lru_unlink(i);
+		goto exit_success;
 	}
 
 	/*
-	 * Buffer is not already in cache. If we saw empty space, take it
-	 * if no empty space, find a buffer to evict.
+	 * Buffer is not already in cache. Take a free entry if there is one,
+	 * otherwise evict the least recently used idle entry.
 	 */
-	if (first_unused != UINT32_MAX) {
-		i = first_unused;
-	} else {
-		/* there was no unused buffer. We need to evict an entry */
-		rc = ext_mem_cache_evict_entry(&i, &to_unmap);
-		if (rc != AR_EOK) {
-			GSL_ERR("Unable to evict: cache all in use right now. rc=%d", rc);
-			goto exit_error;
+	++ext_mem_cache.num_misses;
+	if (ext_mem_cache.free_head == GSL_EXT_MEM_CACHE_NO_ENTRY) {
+		num_to_unmap = ext_mem_cache_evict_idle(to_unmap, FALSE);
+		if (num_to_unmap == 0) {
+			GSL_ERR("Cache all in use. Increase your cache size");
+			/* todo: map one-time use buffer for this case */
+			rc = AR_ENORESOURCE;
+			goto exit;
 		}
 	}
-
-	/* we evicted entry i and it's available, or we saw i was unused */
-	GSL_MUTEX_LOCK(ext_mem_cache.entries[i].lock);
-	ext_mem_cache.entries[i].num_bufs_in_flight = 1;
-	GSL_MUTEX_UNLOCK(ext_mem_cache.entries[i].lock);
+	i = ext_mem_cache.free_head;
 
 	GSL_DBG("mapping entry %d, handle 0x%x", i, ext_mem_data.alloc_handle);
 
@@ -350,49 +319,34 @@ static uint32_t ext_mem_cache_get_entry(uint32_t proc_id,
 		ext_mem_data.alloc_size, proc_id, &ext_mem_cache.entries[i].shmem_data);
 	if (rc != AR_EOK) {
 		GSL_ERR("map extern mem failed rc=%d", rc);
-		GSL_MUTEX_LOCK(ext_mem_cache.entries[i].lock);
-		ext_mem_cache.entries[i].num_bufs_in_flight = 0;
-		GSL_MUTEX_UNLOCK(ext_mem_cache.entries[i].lock);
-		goto exit_error;
+		goto exit;
 	}
 
-	GSL_MUTEX_LOCK(ext_mem_cache.entries[i].lock);
-	ext_mem_cache.entries[i].alloc_size = ext_mem_data.alloc_size;
-	ext_mem_cache.entries[i].last_used = ext_mem_cache.age_counter;
+	ext_mem_cache.free_head = ext_mem_cache.entries[i].hash_next;
 	ext_mem_cache.entries[i].alloc_handle = ext_mem_data.alloc_handle;
-	GSL_MUTEX_UNLOCK(ext_mem_cache.entries[i].lock);
-
-	/* see note at top of function re lock */
-	//GSL_MUTEX_UNLOCK(ext_mem_cache.global_cache_lock);
-
-	/*
-	 * Unmapping from outside the global lock.
-	 * This is to allow shmem mgr in future to not be serialised.
-	 */
-	if (to_unmap.handle) {
-		GSL_DBG("Unmapping because evicted, handle 0x%x",
-			ext_mem_cache.entries[i].alloc_handle);
-		rc = gsl_shmem_unmap_extern_mem(to_unmap);
-		if (rc != AR_EOK) {
-			/* ignore this, we have torn down the entry anyway */
-			GSL_DBG("unmap extern mem failed rc=%d", rc);
-		}
-	}
+	ext_mem_cache.entries[i].alloc_size = ext_mem_data.alloc_size;
+	ext_mem_cache.entries[i].hash_next = ext_mem_cache.buckets[
+		ext_mem_cache_hash(ext_mem_data.alloc_handle)];
+	ext_mem_cache.buckets[ext_mem_cache_hash(ext_mem_data.alloc_handle)] = i;
 
 exit_success:
+	atomic_fetch_add(&ext_mem_cache.entries[i].num_bufs_in_flight, 1);
+	ext_mem_cache_lru_push_front(i);
+
 	gsl_memcpy(alloc_data, sizeof(struct gsl_shmem_alloc_data),
 		&ext_mem_cache.entries[i].shmem_data,
 		sizeof(struct gsl_shmem_alloc_data));
 	*idx = i;
 
+exit:
+	GSL_MUTEX_UNLOCK(ext_mem_cache.global_cache_lock);
+
 	/*
-	 * see note at top of function re lock
-	 * for now with disable just use the unlock here
+	 * Unmapping from outside the global lock.
+	 * This is to allow shmem mgr in future to not be serialised.
 	 */
-	//return rc;
+	ext_mem_cache_unmap_entries(to_unmap, num_to_unmap);
 
-exit_error:
-	GSL_MUTEX_UNLOCK(ext_mem_cache.global_cache_lock);
 	return rc;
 }
 
@@ -423,16 +377,16 @@ static struct gsl_buff_internal *gsl_dp_find_buff_from_va(
 /*
  * Marks a buffer as available, available here means the buffer is with GSL and
  * not with Spf. So GSL can only read/write buffers that are available.
+ * Called from the GPR receive thread, the release pairs with the acquire in
+ * gsl_find_next_avail_buffer so the client sees what was written to the
+ * buffer before it was handed back.
  */
 static void gsl_mark_buffer_as_avail(struct gsl_data_path_info *dp_info,
 	uint32_t buf_index)
 {
-	GSL_MUTEX_LOCK(dp_info->lock);
-
-	if (buf_index <= dp_info->config.num_buffs)
-		clear_bit(dp_info->buff_used_status, buf_index);
-
-	GSL_MUTEX_UNLOCK(dp_info->lock);
+	if (buf_index < dp_info->config.num_buffs)
+		atomic_fetch_and_explicit(&dp_info->buff_used_status,
+			~(1U << buf_index), memory_order_release);
 }
 
 /* reset the internal metadata buff queue to empty state */
@@ -680,29 +634,29 @@ static int32_t gsl_handle_buff_done_nonshmem(struct gsl_data_path_info *dp_info,
 	return AR_EOK;
 }
 
+/*
+ * Takes the next buffer in round-robin order if it is available. Called from
+ * the client thread only, which owns curr_buff_index.
+ */
 static struct gsl_buff_internal *gsl_find_next_avail_buffer(
 	struct gsl_data_path_info *dp_info, uint32_t *buf_idx)
 {
-	struct gsl_buff_internal *gsl_buff = NULL;
-
-	GSL_MUTEX_LOCK(dp_info->lock);
+	uint32_t idx = dp_info->curr_buff_index;
+	uint32_t mask = 1U << idx;
 
 	if (dp_info->config.num_buffs == 0)
-		goto exit;
+		return NULL;
 
-	if (test_bit(dp_info->buff_used_status, dp_info->curr_buff_index))
-		goto exit;
+	if (atomic_load_explicit(&dp_info->buff_used_status,
+		memory_order_acquire) & mask)
+		return NULL;
 
-	gsl_buff = &dp_info->buff_list[dp_info->curr_buff_index];
-	*buf_idx = dp_info->curr_buff_index;
-	set_bit(dp_info->buff_used_status, dp_info->curr_buff_index);
-	dp_info->curr_buff_index = (dp_info->curr_buff_index + 1) %
-		dp_info->config.num_buffs;
+	atomic_fetch_or_explicit(&dp_info->buff_used_status, mask,
+		memory_order_relaxed);
+	*buf_idx = idx;
+	dp_info->curr_buff_index = (idx + 1) % dp_info->config.num_buffs;
 
-exit:
-	GSL_MUTEX_UNLOCK(dp_info->lock);
-
-	return gsl_buff;
+	return &dp_info->buff_list[idx];
 }
 
 /*
@@ -1711,8 +1665,6 @@ static int32_t gsl_dp_write_extern_mem(struct gsl_data_path_info *dp_info,
 	if (rc != AR_EOK)
 		return rc;
 
-	ext_mem_cache_update_entry_last_used(cache_idx);
-
 	if (dp_info->config.max_metadata_size > 0) {
 		/* enqueue a new metadata buffer */
 		internal_md_buf = gsl_enqueue_internal_md_buff(dp_info);
@@ -1740,6 +1692,9 @@ static int32_t gsl_dp_write_extern_mem(struct gsl_data_path_info *dp_info,
 	if (buff->flags & GSL_BUFF_FLAG_EOS)
 		gsl_dp_write_send_eos(dp_info);
 exit:
+	/* spf never saw the buffer, so no buf done will release the entry */
+	if (rc != AR_EOK)
+		ext_mem_cache_put_entry(cache_idx);
 	return rc;
 }
 
@@ -1758,7 +1713,6 @@ static int32_t gsl_dp_read_extern_mem(struct gsl_data_path_info *dp_info,
 	if (rc != AR_EOK)
 		return rc;
 
-	ext_mem_cache_update_entry_last_used(cache_idx);
 	if (dp_info->config.max_metadata_size > 0) {
 		/* enqueue a new metadata buffer */
 		internal_md_buf = gsl_enqueue_internal_md_buff(dp_info);
@@ -1780,6 +1734,9 @@ static int32_t gsl_dp_read_extern_mem(struct gsl_data_path_info *dp_info,
 	}
 
 exit:
+	/* spf never saw the buffer, so no buf done will release the entry */
+	if (rc != AR_EOK)
+		ext_mem_cache_put_entry(cache_idx);
 	return rc;
 }
 
@@ -1984,7 +1941,7 @@ int32_t gsl_dp_config_data_path(struct gsl_data_path_info *dp_info,
 	}
 
 	/** mark all buffers available for use */
-	dp_info->buff_used_status = 0;
+	atomic_store(&dp_info->buff_used_status, 0);
 	dp_info->curr_buff_index = 0; /**< start with buf 0 */
 	dp_info->processed_buf_cnt = 0;
 	dp_info->md_buff_list_head = 0;
@@ -2406,9 +2363,9 @@ uint32_t gsl_dp_get_avail_buffer_size(struct gsl_data_path_info *dp_info)
 	if (!dp_info)
 		return AR_EBADPARAM;
 
-	GSL_MUTEX_LOCK(dp_info->lock);
 	available_buff_cnt = dp_info->config.num_buffs;
-	buff_used_status = dp_info->buff_used_status;
+	buff_used_status = atomic_load_explicit(&dp_info->buff_used_status,
+		memory_order_relaxed);
 	for (int i = 0; i < dp_info->config.num_buffs && buff_used_status != 0; i++) {
 		if (buff_used_status % 2 == 1)
 			available_buff_cnt--;
@@ -2416,7 +2373,6 @@ uint32_t gsl_dp_get_avail_buffer_size(struct gsl_data_path_info *dp_info)
 	}
 
 	available_bytes = available_buff_cnt * dp_info->config.buff_size;
-	GSL_MUTEX_UNLOCK(dp_info->lock);
 
 	return available_bytes;
 }
@@ -2443,20 +2399,16 @@ static void gsl_clear_internal_buf(struct gsl_data_path_info *dp_info)
 
 		packet = (gpr_packet_t *)internal_buf->gsl_msg.payload;
 		__gpr_cmd_free(packet);
-		GSL_MUTEX_LOCK(dp_info->lock);
-		clear_bit(dp_info->buff_used_status, buf_idx);
-		GSL_MUTEX_UNLOCK(dp_info->lock);
+		gsl_mark_buffer_as_avail(dp_info, buf_idx);
 	}
 }
 
 int32_t gsl_wait_for_all_buffs_to_be_avail(struct gsl_data_path_info *dp_info)
 {
-	int32_t rc = AR_EOK, local_buff_used_status;
-	uint32_t wait_flags = 0;
+	int32_t rc = AR_EOK;
+	uint32_t wait_flags = 0, local_buff_used_status;
 
-	GSL_MUTEX_LOCK(dp_info->lock);
-	local_buff_used_status = dp_info->buff_used_status;
-	GSL_MUTEX_UNLOCK(dp_info->lock);
+	local_buff_used_status = atomic_load(&dp_info->buff_used_status);
 
 	while (local_buff_used_status != 0) {
 		/*
@@ -2469,9 +2421,7 @@ int32_t gsl_wait_for_all_buffs_to_be_avail(struct gsl_data_path_info *dp_info)
 		if (rc != AR_EOK || wait_flags & GSL_SIG_EVENT_MASK_SSR)
 			break;
 
-		GSL_MUTEX_LOCK(dp_info->lock);
-		local_buff_used_status = dp_info->buff_used_status;
-		GSL_MUTEX_UNLOCK(dp_info->lock);
+		local_buff_used_status = atomic_load(&dp_info->buff_used_status);
 	}
 
 	/* clear any metadata buffs */
@@ -13,6 +13,8 @@
 #include "ar_osal_error.h"
 #include "ar_osal_shmem.h"
 #include "ar_osal_log.h"
+#include "ar_osal_thread.h"
+#include "ar_osal_timer.h"
 #include "ar_util_data_log.h"
 #include "ar_util_data_log_codes.h"
 #include "gsl_graph.h"
@@ -616,6 +618,366 @@ static void gsl_graph_update_gkv_node(struct gsl_graph_gkv_node *gkv_node,
 	ar_list_init_node(&gkv_node->node);
 }
 
+/*
+ * Graph open cache
+ *
+ * Holds the ACDB responses used to open a graph and set its non-persistent
+ * calibration, keyed by the ACDB command and its request. Key vectors are
+ * sorted by key ID in the cache key so the order of the KVs does not matter.
+ * The least recently used entry is evicted once either limit is reached.
+ *
+ * The cache follows the ACDB data version, which ACDB increments on every
+ * write from any client, including ATS. A changed version flushes the cache
+ * before the next lookup or insert. Entries are only added when the generation
+ * has not moved since the lookup missed, so a response read before a flush is
+ * never cached.
+ */
+#define GSL_GRAPH_CACHE_MAX_ENTRIES 64
+#define GSL_GRAPH_CACHE_MAX_SIZE (512 * 1024)
+#define GSL_GRAPH_CACHE_MAX_BLOBS 2
+
+struct gsl_graph_cache_key {
+	uint32_t cmd_id; /**< ACDB command of the response */
+	uint32_t generation; /**< cache generation when the lookup missed */
+	uint32_t size; /**< size of words in bytes */
+	uint32_t *words; /**< normalized request, NULL if it could not be built */
+};
+
+struct gsl_graph_cache_entry {
+	ar_list_node_t node;
+	uint32_t cmd_id;
+	uint32_t key_size;
+	uint32_t *key;
+	/** command specific count, e.g. number of subgraphs */
+	uint32_t num_elems;
+	struct gsl_blob blobs[GSL_GRAPH_CACHE_MAX_BLOBS];
+	uint32_t total_size; /**< size of the entry allocation */
+};
+
+static struct gsl_graph_cache {
+	ar_osal_mutex_t lock;
+	ar_list_t lru; /**< least recently used entry first */
+	uint32_t generation;
+	uint32_t acdb_version; /**< ACDB data version the entries were read at */
+	struct gsl_cmd_graph_cache_stats stats;
+} graph_cache;
+
+static uint32_t *gsl_graph_cache_key_add_list(uint32_t *p,
+	const void *list, uint32_t len)
+{
+	*p++ = len;
+	gsl_memcpy(p, len * sizeof(uint32_t), list, len * sizeof(uint32_t));
+
+	return p + len;
+}
+
+static uint32_t *gsl_graph_cache_key_add_kv(uint32_t *p,
+	const struct gsl_key_vector *kv)
+{
+	struct gsl_key_value_pair *kvp, tmp;
+	uint32_t i, j;
+
+	*p++ = kv->num_kvps;
+	kvp = (struct gsl_key_value_pair *)p;
+	gsl_memcpy(kvp, kv->num_kvps * sizeof(*kvp), kv->kvp,
+		kv->num_kvps * sizeof(*kvp));
+
+	/* key vectors are short, sort them in place by key id */
+	for (i = 1; i < kv->num_kvps; ++i) {
+		tmp = kvp[i];
+		for (j = i; j > 0 && kvp[j - 1].key > tmp.key; --j)
+			kvp[j] = kvp[j - 1];
+		kvp[j] = tmp;
+	}
+
+	return (uint32_t *)(kvp + kv->num_kvps);
+}
+
+static uint32_t gsl_graph_cache_kv_size(const struct gsl_key_vector *kv)
+{
+	return (uint32_t)(sizeof(uint32_t) +
+		kv->num_kvps * sizeof(struct gsl_key_value_pair));
+}
+
+static void gsl_graph_cache_key_alloc(struct gsl_graph_cache_key *key,
+	uint32_t cmd_id, uint32_t size)
+{
+	key->cmd_id = cmd_id;
+	key->generation = 0;
+	key->size = size;
+	key->words = gsl_mem_zalloc(size);
+}
+
+static void gsl_graph_cache_key_free(struct gsl_graph_cache_key *key)
+{
+	gsl_mem_free(key->words);
+	key->words = NULL;
+}
+
+static void gsl_graph_cache_remove_entry(struct gsl_graph_cache_entry *entry)
+{
+	ar_list_delete(&graph_cache.lru, &entry->node);
+	--graph_cache.stats.num_entries;
+	graph_cache.stats.size -= entry->total_size;
+	gsl_mem_free(entry);
+}
+
+static void gsl_graph_cache_flush(void)
+{
+	ar_list_node_t *node = NULL;
+
+	while (!ar_list_is_empty(&graph_cache.lru)) {
+		node = ar_list_get_head(&graph_cache.lru);
+		gsl_graph_cache_remove_entry(get_container_base(node,
+			struct gsl_graph_cache_entry, node));
+	}
+	++graph_cache.generation;
+}
+
+/* Flushes the cache if ACDB data changed since it was last checked */
+static void gsl_graph_cache_check_acdb_version(void)
+{
+	uint32_t acdb_version = acdb_get_data_version();
+
+	if (acdb_version == graph_cache.acdb_version)
+		return;
+
+	gsl_graph_cache_flush();
+	++graph_cache.stats.invalidations;
+	graph_cache.acdb_version = acdb_version;
+}
+
+/*
+ * Looks up a response. On a hit, copies of the cached blobs are allocated and
+ * returned in blobs, and the caller owns them. On a miss, records the current
+ * generation in the key for gsl_graph_cache_put.
+ *
+ * \return AR_EOK on a hit, AR_ENOTEXIST on a miss
+ */
+static int32_t gsl_graph_cache_get(struct gsl_graph_cache_key *key,
+	uint32_t *num_elems, struct gsl_blob *blobs, uint32_t num_blobs)
+{
+	struct gsl_graph_cache_entry *entry = NULL;
+	ar_list_node_t *node = NULL;
+	uint32_t i;
+	int32_t rc = AR_ENOTEXIST;
+
+	if (!key->words || !graph_cache.lock)
+		return AR_ENOTEXIST;
+
+	GSL_MUTEX_LOCK(graph_cache.lock);
+	gsl_graph_cache_check_acdb_version();
+	key->generation = graph_cache.generation;
+
+	ar_list_for_each_entry(node, &graph_cache.lru) {
+		entry = get_container_base(node, struct gsl_graph_cache_entry, node);
+		if (entry->cmd_id == key->cmd_id && entry->key_size == key->size &&
+			!gsl_memcmp(entry->key, key->words, key->size))
+			break;
+		entry = NULL;
+	}
+
+	if (!entry) {
+		++graph_cache.stats.misses;
+		goto exit;
+	}
+
+	for (i = 0; i < num_blobs; ++i) {
+		blobs[i].size = entry->blobs[i].size;
+		blobs[i].buf = NULL;
+		if (!blobs[i].size)
+			continue;
+
+		blobs[i].buf = gsl_mem_zalloc(blobs[i].size);
+		if (!blobs[i].buf) {
+			while (i-- > 0) {
+				gsl_mem_free(blobs[i].buf);
+				blobs[i].buf = NULL;
+			}
+			goto exit;
+		}
+		gsl_memcpy(blobs[i].buf, blobs[i].size, entry->blobs[i].buf,
+			entry->blobs[i].size);
+	}
+	*num_elems = entry->num_elems;
+
+	/* move to the most recently used end */
+	ar_list_delete(&graph_cache.lru, &entry->node);
+	ar_list_add_tail(&graph_cache.lru, &entry->node);
+	++graph_cache.stats.hits;
+	rc = AR_EOK;
+
+exit:
+	GSL_MUTEX_UNLOCK(graph_cache.lock);
+	return rc;
+}
+
+/*
+ * Checks whether a response is cached without copying it or counting the
+ * lookup. Records the current generation in the key for gsl_graph_cache_put.
+ */
+static bool_t gsl_graph_cache_contains(struct gsl_graph_cache_key *key)
+{
+	ar_list_node_t *node = NULL;
+	struct gsl_graph_cache_entry *entry;
+	bool_t found = FALSE;
+
+	if (!key->words || !graph_cache.lock)
+		return FALSE;
+
+	GSL_MUTEX_LOCK(graph_cache.lock);
+	gsl_graph_cache_check_acdb_version();
+	key->generation = graph_cache.generation;
+
+	ar_list_for_each_entry(node, &graph_cache.lru) {
+		entry = get_container_base(node, struct gsl_graph_cache_entry, node);
+		if (entry->cmd_id == key->cmd_id && entry->key_size == key->size &&
+			!gsl_memcmp(entry->key, key->words, key->size)) {
+			found = TRUE;
+			break;
+		}
+	}
+
+	GSL_MUTEX_UNLOCK(graph_cache.lock);
+	return found;
+}
+
+/* Adds a response after a lookup for the same key missed */
+static void gsl_graph_cache_put(struct gsl_graph_cache_key *key,
+	uint32_t num_elems, const struct gsl_blob *blobs, uint32_t num_blobs)
+{
+	struct gsl_graph_cache_entry *entry;
+	ar_list_node_t *node = NULL;
+	uint32_t i, total_size;
+	uint8_t *p;
+
+	if (!key->words || !graph_cache.lock)
+		return;
+
+	total_size = GSL_ALIGN_8BYTE(sizeof(*entry)) +
+		GSL_ALIGN_8BYTE(key->size);
+	for (i = 0; i < num_blobs; ++i)
+		total_size += GSL_ALIGN_8BYTE(blobs[i].size);
+	if (total_size > GSL_GRAPH_CACHE_MAX_SIZE)
+		return;
+
+	entry = gsl_mem_zalloc(total_size);
+	if (!entry)
+		return;
+
+	p = (uint8_t *)entry + GSL_ALIGN_8BYTE(sizeof(*entry));
+	entry->cmd_id = key->cmd_id;
+	entry->key_size = key->size;
+	entry->key = (uint32_t *)p;
+	gsl_memcpy(p, key->size, key->words, key->size);
+	p += GSL_ALIGN_8BYTE(key->size);
+	for (i = 0; i < num_blobs; ++i) {
+		entry->blobs[i].size = blobs[i].size;
+		entry->blobs[i].buf = p;
+		if (blobs[i].size)
+			gsl_memcpy(p, blobs[i].size, blobs[i].buf, blobs[i].size);
+		p += GSL_ALIGN_8BYTE(blobs[i].size);
+	}
+	entry->num_elems = num_elems;
+	entry->total_size = total_size;
+	ar_list_init_node(&entry->node);
+
+	GSL_MUTEX_LOCK(graph_cache.lock);
+	/* the database changed or another thread got here first */
+	gsl_graph_cache_check_acdb_version();
+	if (graph_cache.generation != key->generation) {
+		GSL_MUTEX_UNLOCK(graph_cache.lock);
+		gsl_mem_free(entry);
+		return;
+	}
+	ar_list_for_each_entry(node, &graph_cache.lru) {
+		struct gsl_graph_cache_entry *e = get_container_base(node,
+			struct gsl_graph_cache_entry, node);
+
+		if (e->cmd_id == key->cmd_id && e->key_size == key->size &&
+			!gsl_memcmp(e->key, key->words, key->size)) {
+			GSL_MUTEX_UNLOCK(graph_cache.lock);
+			gsl_mem_free(entry);
+			return;
+		}
+	}
+
+	while (!ar_list_is_empty(&graph_cache.lru) &&
+		(graph_cache.stats.num_entries >= GSL_GRAPH_CACHE_MAX_ENTRIES ||
+		graph_cache.stats.size + total_size > GSL_GRAPH_CACHE_MAX_SIZE)) {
+		node = ar_list_get_head(&graph_cache.lru);
+		gsl_graph_cache_remove_entry(get_container_base(node,
+			struct gsl_graph_cache_entry, node));
+		++graph_cache.stats.evictions;
+	}
+
+	ar_list_add_tail(&graph_cache.lru, &entry->node);
+	++graph_cache.stats.num_entries;
+	graph_cache.stats.size += total_size;
+	GSL_MUTEX_UNLOCK(graph_cache.lock);
+}
+
+int32_t gsl_graph_cache_init(void)
+{
+	int32_t rc;
+
+	gsl_memset(&graph_cache, 0, sizeof(graph_cache));
+	ar_list_init(&graph_cache.lru, NULL, NULL);
+	graph_cache.acdb_version = acdb_get_data_version();
+
+	rc = ar_osal_mutex_create(&graph_cache.lock);
+	if (rc) {
+		GSL_ERR("graph cache lock create failed %d", rc);
+		graph_cache.lock = NULL;
+	}
+
+	return rc;
+}
+
+void gsl_graph_cache_deinit(void)
+{
+	if (!graph_cache.lock)
+		return;
+
+	GSL_MUTEX_LOCK(graph_cache.lock);
+	gsl_graph_cache_flush();
+	GSL_MUTEX_UNLOCK(graph_cache.lock);
+
+	ar_osal_mutex_destroy(graph_cache.lock);
+	graph_cache.lock = NULL;
+}
+
+void gsl_graph_cache_invalidate(void)
+{
+	if (!graph_cache.lock)
+		return;
+
+	GSL_MUTEX_LOCK(graph_cache.lock);
+	gsl_graph_cache_flush();
+	++graph_cache.stats.invalidations;
+	GSL_MUTEX_UNLOCK(graph_cache.lock);
+}
+
+void gsl_graph_cache_get_stats(struct gsl_cmd_graph_cache_stats *stats)
+{
+	if (!graph_cache.lock) {
+		gsl_memset(stats, 0, sizeof(*stats));
+		return;
+	}
+
+	GSL_MUTEX_LOCK(graph_cache.lock);
+	*stats = graph_cache.stats;
+	GSL_MUTEX_UNLOCK(graph_cache.lock);
+}
+
+void gsl_graph_get_open_timing(struct gsl_graph *graph,
+	struct gsl_cmd_open_timing *timing, ar_osal_mutex_t lock)
+{
+	GSL_MUTEX_LOCK(lock);
+	*timing = graph->open_timing;
+	GSL_MUTEX_UNLOCK(lock);
+}
+
 static int32_t gsl_acdb_get_subgraph_connections(AcdbSubgraph *sg_conn,
 	uint32_t num_sg_conn, struct gsl_blob *spf_blob)
 {
@@ -735,6 +1097,404 @@ static int32_t gsl_acdb_get_subgraph_data(struct gsl_sgid_list *sg_id_list,
 	return rc;
 }
 
+/*
+ * Gets the spf blob and the driver property blob of the given subgraphs,
+ * from the graph open cache if possible. Both blobs are allocated here and
+ * must be freed by the caller.
+ */
+static int32_t gsl_graph_get_subgraph_data_cached(
+	struct gsl_sgid_list *sg_id_list, const struct gsl_key_vector *gkv,
+	struct gsl_blob *spf_blob, AcdbDriverPropertyData *drv_blob)
+{
+	struct gsl_graph_cache_key key;
+	struct gsl_blob blobs[2];
+	uint32_t num_sgid = 0;
+	int32_t rc;
+
+	gsl_graph_cache_key_alloc(&key, ACDB_CMD_GET_SUBGRAPH_DATA,
+		gsl_graph_cache_kv_size(gkv) +
+		(sg_id_list->len + 1) * sizeof(uint32_t));
+	if (key.words)
+		gsl_graph_cache_key_add_list(
+			gsl_graph_cache_key_add_kv(key.words, gkv),
+			sg_id_list->sg_ids, sg_id_list->len);
+
+	if (gsl_graph_cache_get(&key, &num_sgid, blobs, 2) == AR_EOK) {
+		*spf_blob = blobs[0];
+		drv_blob->num_sgid = num_sgid;
+		drv_blob->size = blobs[1].size;
+		drv_blob->sub_graph_prop_data = blobs[1].buf;
+		rc = AR_EOK;
+		goto exit;
+	}
+
+	rc = gsl_acdb_get_subgraph_data(sg_id_list, gkv, spf_blob, drv_blob);
+	if (rc) {
+		GSL_ERR("get subgraph data for size failed: %d", rc);
+		goto exit;
+	}
+
+	if (spf_blob->size) {
+		spf_blob->buf = gsl_mem_zalloc(spf_blob->size);
+		if (!spf_blob->buf) {
+			rc = AR_ENOMEMORY;
+			goto exit;
+		}
+	}
+
+	if (drv_blob->size) {
+		drv_blob->sub_graph_prop_data = gsl_mem_zalloc(drv_blob->size);
+		if (!drv_blob->sub_graph_prop_data) {
+			rc = AR_ENOMEMORY;
+			goto free_spf_blob;
+		}
+	}
+
+	/* Get both spf data blob and subgraph driver property blob */
+	rc = gsl_acdb_get_subgraph_data(sg_id_list, gkv, spf_blob, drv_blob);
+	if (rc) {
+		GSL_ERR("get subgraph data failed %d", rc);
+		gsl_mem_free(drv_blob->sub_graph_prop_data);
+		drv_blob->sub_graph_prop_data = NULL;
+		goto free_spf_blob;
+	}
+
+	blobs[0] = *spf_blob;
+	blobs[1].size = drv_blob->size;
+	blobs[1].buf = drv_blob->sub_graph_prop_data;
+	gsl_graph_cache_put(&key, drv_blob->num_sgid, blobs, 2);
+	goto exit;
+
+free_spf_blob:
+	gsl_mem_free(spf_blob->buf);
+	spf_blob->buf = NULL;
+exit:
+	gsl_graph_cache_key_free(&key);
+	return rc;
+}
+
+/*
+ * Gets the spf blob of the given subgraph connections, from the graph open
+ * cache if possible. The blob is allocated here and must be freed by the
+ * caller.
+ */
+static int32_t gsl_graph_get_subgraph_connections_cached(AcdbSubgraph *sg_conn,
+	uint32_t num_sg_conn, struct gsl_blob *spf_blob)
+{
+	struct gsl_graph_cache_key key;
+	AcdbSubgraph *p = sg_conn;
+	uint32_t i, sg_conn_size = 0, num_elems = 0;
+	int32_t rc;
+
+	for (i = 0; i < num_sg_conn; ++i) {
+		sg_conn_size += (2 + p->num_dst_sgids) * sizeof(uint32_t);
+		p = (AcdbSubgraph *)((uint32_t *)p->dst_sg_ids + p->num_dst_sgids);
+	}
+
+	gsl_graph_cache_key_alloc(&key, ACDB_CMD_GET_SUBGRAPH_CONNECTIONS,
+		sg_conn_size + sizeof(uint32_t));
+	if (key.words)
+		gsl_graph_cache_key_add_list(key.words, sg_conn,
+			sg_conn_size / sizeof(uint32_t));
+
+	if (gsl_graph_cache_get(&key, &num_elems, spf_blob, 1) == AR_EOK) {
+		rc = AR_EOK;
+		goto exit;
+	}
+
+	rc = gsl_acdb_get_subgraph_connections(sg_conn, num_sg_conn, spf_blob);
+	if (rc)
+		goto exit;
+
+	spf_blob->buf = gsl_mem_zalloc(spf_blob->size);
+	if (!spf_blob->buf) {
+		rc = AR_ENOMEMORY;
+		goto exit;
+	}
+
+	rc = gsl_acdb_get_subgraph_connections(sg_conn, num_sg_conn, spf_blob);
+	if (rc) {
+		GSL_ERR("get subgraph conn data failed: %d", rc);
+		gsl_mem_free(spf_blob->buf);
+		spf_blob->buf = NULL;
+		goto exit;
+	}
+
+	gsl_graph_cache_put(&key, num_sg_conn, spf_blob, 1);
+
+exit:
+	gsl_graph_cache_key_free(&key);
+	return rc;
+}
+
+struct gsl_graph_cal_msg_ctx {
+	struct gsl_graph *graph;
+	gsl_msg_t *gsl_msg;
+	int32_t rc;
+	bool_t is_allocated;
+};
+
+/*
+ * allocates the APM_CMD_SET_CFG message for the calibration ACDB SW is
+ * about to fill and returns its out-of-band payload as the response buffer
+ */
+static void *gsl_graph_alloc_cal_msg(uint32_t size, void *context)
+{
+	struct gsl_graph_cal_msg_ctx *ctx = context;
+
+	ctx->rc = gsl_msg_alloc(APM_CMD_SET_CFG, ctx->graph->src_port,
+		GSL_GPR_DST_PORT_APM, sizeof(struct apm_cmd_header_t), 0,
+		ctx->graph->proc_id, size, false, ctx->gsl_msg);
+	if (ctx->rc) {
+		GSL_ERR("gsl msg alloc failed %d", ctx->rc);
+		return NULL;
+	}
+	ctx->is_allocated = TRUE;
+
+	return ctx->gsl_msg->payload;
+}
+
+static void gsl_graph_nonpersist_cal_key_alloc(struct gsl_graph_cache_key *key,
+	struct gsl_sgid_list *sgid_list, const struct gsl_key_vector *prior_ckv,
+	const struct gsl_key_vector *new_ckv)
+{
+	gsl_graph_cache_key_alloc(key,
+		ACDB_CMD_GET_SUBGRAPH_CALIBRATION_DATA_NONPERSIST,
+		(sgid_list->len + 1) * sizeof(uint32_t) +
+		gsl_graph_cache_kv_size(prior_ckv) +
+		gsl_graph_cache_kv_size(new_ckv));
+	if (key->words)
+		gsl_graph_cache_key_add_kv(gsl_graph_cache_key_add_kv(
+			gsl_graph_cache_key_add_list(key->words, sgid_list->sg_ids,
+			sgid_list->len), prior_ckv), new_ckv);
+}
+
+static void *gsl_graph_alloc_cal_blob(uint32_t size, void *context)
+{
+	struct gsl_blob *blob = context;
+
+	blob->buf = gsl_mem_zalloc(size);
+	if (blob->buf)
+		blob->size = size;
+
+	return blob->buf;
+}
+
+/*
+ * Non-persistent calibration prefetch
+ *
+ * While Spf processes the graph open command, a worker gets the
+ * non-persistent calibration of the new SGs from ACDB and adds it to the graph
+ * open cache, so that gsl_graph_send_nonpersist_cal only has to send it once
+ * the open completes. The prefetch never changes the result of the open, any
+ * error is left for gsl_graph_send_nonpersist_cal to report.
+ *
+ * One worker thread, created in gsl_init, serves the opens of all graphs in
+ * order. A request the worker has not started when the open needs it is
+ * dropped, the calibration is then fetched by the open itself.
+ */
+enum gsl_graph_cal_prefetch_state {
+	GSL_GRAPH_CAL_PREFETCH_QUEUED,
+	GSL_GRAPH_CAL_PREFETCH_RUNNING,
+	GSL_GRAPH_CAL_PREFETCH_DONE,
+};
+
+struct gsl_graph_cal_prefetch {
+	ar_list_node_t node;
+	enum gsl_graph_cal_prefetch_state state;
+	struct gsl_sgid_list *sgid_list;
+	const struct gsl_key_vector *prior_ckv;
+	const struct gsl_key_vector *new_ckv;
+	uint64_t time_us;
+};
+
+static struct gsl_graph_cal_prefetch_worker {
+	ar_osal_thread_t thread;
+	ar_osal_mutex_t lock;
+	ar_list_t queue; /**< requests not started yet, oldest first */
+	ar_osal_signal_t work_sig; /**< set when a request is queued or on stop */
+	ar_osal_signal_t done_sig; /**< set when a request is done */
+	bool_t stop;
+} cal_prefetch;
+
+static void gsl_graph_cal_prefetch_run(struct gsl_graph_cal_prefetch *prefetch)
+{
+	uint64_t start_us = ar_timer_get_time_in_us();
+	AcdbSgIdCalKeyVector cmd_struct;
+	AcdbBlob rsp_struct = {0, NULL};
+	struct gsl_graph_cache_key key;
+	struct gsl_blob cal_blob = {0, NULL};
+	int32_t rc;
+
+	gsl_graph_nonpersist_cal_key_alloc(&key, prefetch->sgid_list,
+		prefetch->prior_ckv, prefetch->new_ckv);
+	if (gsl_graph_cache_contains(&key))
+		goto exit;
+
+	cmd_struct.num_sg_ids = prefetch->sgid_list->len;
+	cmd_struct.sg_ids = prefetch->sgid_list->sg_ids;
+	cmd_struct.cal_key_vector_prior.num_keys = prefetch->prior_ckv->num_kvps;
+	cmd_struct.cal_key_vector_prior.graph_key_vector =
+		(AcdbKeyValuePair *)prefetch->prior_ckv->kvp;
+	cmd_struct.cal_key_vector_new.num_keys = prefetch->new_ckv->num_kvps;
+	cmd_struct.cal_key_vector_new.graph_key_vector =
+		(AcdbKeyValuePair *)prefetch->new_ckv->kvp;
+
+	rc = acdb_ioctl_alloc(ACDB_CMD_GET_SUBGRAPH_CALIBRATION_DATA_NONPERSIST,
+		&cmd_struct, sizeof(cmd_struct), &rsp_struct, sizeof(rsp_struct),
+		gsl_graph_alloc_cal_blob, &cal_blob);
+	if (rc == AR_EOK) {
+		cal_blob.size = rsp_struct.buf_size;
+		gsl_graph_cache_put(&key, 0, &cal_blob, 1);
+	}
+	gsl_mem_free(cal_blob.buf);
+
+exit:
+	gsl_graph_cache_key_free(&key);
+	prefetch->time_us = ar_timer_get_time_in_us() - start_us;
+}
+
+static void gsl_graph_cal_prefetch_thread(void *arg)
+{
+	struct gsl_graph_cal_prefetch *prefetch;
+	ar_list_node_t *node;
+
+	(void)arg;
+
+	GSL_MUTEX_LOCK(cal_prefetch.lock);
+	while (!cal_prefetch.stop) {
+		if (ar_list_is_empty(&cal_prefetch.queue)) {
+			/* cleared under the lock, so a request queued after it sets it */
+			ar_osal_signal_clear(cal_prefetch.work_sig);
+			GSL_MUTEX_UNLOCK(cal_prefetch.lock);
+			ar_osal_signal_wait(cal_prefetch.work_sig);
+			GSL_MUTEX_LOCK(cal_prefetch.lock);
+			continue;
+		}
+
+		node = ar_list_get_head(&cal_prefetch.queue);
+		ar_list_delete(&cal_prefetch.queue, node);
+		prefetch = get_container_base(node, struct gsl_graph_cal_prefetch,
+			node);
+		prefetch->state = GSL_GRAPH_CAL_PREFETCH_RUNNING;
+		ar_osal_signal_clear(cal_prefetch.done_sig);
+		GSL_MUTEX_UNLOCK(cal_prefetch.lock);
+
+		gsl_graph_cal_prefetch_run(prefetch);
+
+		GSL_MUTEX_LOCK(cal_prefetch.lock);
+		prefetch->state = GSL_GRAPH_CAL_PREFETCH_DONE;
+		ar_osal_signal_set(cal_prefetch.done_sig);
+	}
+	GSL_MUTEX_UNLOCK(cal_prefetch.lock);
+}
+
+int32_t gsl_graph_cal_prefetch_init(void)
+{
+	ar_osal_thread_attr_t thread_attr;
+	int32_t rc;
+
+	gsl_memset(&cal_prefetch, 0, sizeof(cal_prefetch));
+	ar_list_init(&cal_prefetch.queue, NULL, NULL);
+
+	rc = ar_osal_mutex_create(&cal_prefetch.lock);
+	if (rc)
+		goto err;
+	rc = ar_osal_signal_create(&cal_prefetch.work_sig);
+	if (rc)
+		goto err;
+	rc = ar_osal_signal_create(&cal_prefetch.done_sig);
+	if (rc)
+		goto err;
+	rc = ar_osal_thread_attr_init(&thread_attr);
+	if (rc)
+		goto err;
+	thread_attr.thread_name = "gsl_cal_pf";
+	rc = ar_osal_thread_create(&cal_prefetch.thread, &thread_attr,
+		gsl_graph_cal_prefetch_thread, NULL);
+	if (rc)
+		goto err;
+
+	return AR_EOK;
+
+err:
+	cal_prefetch.thread = NULL;
+	gsl_graph_cal_prefetch_deinit();
+	return rc;
+}
+
+void gsl_graph_cal_prefetch_deinit(void)
+{
+	if (cal_prefetch.thread) {
+		GSL_MUTEX_LOCK(cal_prefetch.lock);
+		cal_prefetch.stop = TRUE;
+		GSL_MUTEX_UNLOCK(cal_prefetch.lock);
+		ar_osal_signal_set(cal_prefetch.work_sig);
+		ar_osal_thread_join_destroy(cal_prefetch.thread);
+	}
+	if (cal_prefetch.done_sig)
+		ar_osal_signal_destroy(cal_prefetch.done_sig);
+	if (cal_prefetch.work_sig)
+		ar_osal_signal_destroy(cal_prefetch.work_sig);
+	if (cal_prefetch.lock)
+		ar_osal_mutex_destroy(cal_prefetch.lock);
+	gsl_memset(&cal_prefetch, 0, sizeof(cal_prefetch));
+}
+
+/*
+ * Queues a prefetch of the non-persistent calibration that
+ * gsl_graph_set_sg_cal will set for sgid_list, returns FALSE if nothing is
+ * prefetched
+ */
+static bool_t gsl_graph_cal_prefetch_start(
+	struct gsl_graph_cal_prefetch *prefetch, struct gsl_sgid_list *sgid_list,
+	struct gsl_graph_gkv_node *gkv_node, const struct gsl_key_vector *ckv)
+{
+	gsl_memset(prefetch, 0, sizeof(*prefetch));
+
+	if (!cal_prefetch.thread)
+		return FALSE;
+
+	/* same ckv selection as gsl_graph_set_sg_cal */
+	prefetch->prior_ckv = &gkv_node->ckv;
+	if (ckv)
+		prefetch->new_ckv = ckv;
+	else if (gkv_node->ckv.num_kvps == 0)
+		prefetch->new_ckv = &gkv_node->ckv;
+	else
+		return FALSE; /**< no non-persistent cal will be set */
+
+	if (!sgid_list->len)
+		return FALSE;
+	prefetch->sgid_list = sgid_list;
+	prefetch->state = GSL_GRAPH_CAL_PREFETCH_QUEUED;
+	ar_list_init_node(&prefetch->node);
+
+	GSL_MUTEX_LOCK(cal_prefetch.lock);
+	ar_list_add_tail(&cal_prefetch.queue, &prefetch->node);
+	GSL_MUTEX_UNLOCK(cal_prefetch.lock);
+	ar_osal_signal_set(cal_prefetch.work_sig);
+
+	return TRUE;
+}
+
+/*
+ * Waits for a prefetch queued by gsl_graph_cal_prefetch_start, or drops it
+ * if the worker has not started it yet
+ */
+static void gsl_graph_cal_prefetch_wait(struct gsl_graph_cal_prefetch *prefetch)
+{
+	GSL_MUTEX_LOCK(cal_prefetch.lock);
+	if (prefetch->state == GSL_GRAPH_CAL_PREFETCH_QUEUED)
+		ar_list_delete(&cal_prefetch.queue, &prefetch->node);
+	while (prefetch->state == GSL_GRAPH_CAL_PREFETCH_RUNNING) {
+		GSL_MUTEX_UNLOCK(cal_prefetch.lock);
+		ar_osal_signal_wait(cal_prefetch.done_sig);
+		GSL_MUTEX_LOCK(cal_prefetch.lock);
+	}
+	GSL_MUTEX_UNLOCK(cal_prefetch.lock);
+}
+
 static int32_t gsl_graph_send_nonpersist_cal(struct gsl_graph *graph,
 	struct gsl_sgid_list *sgid_list,
 	struct gsl_key_vector *prior_ckv, const struct gsl_key_vector *new_ckv)
@@ -744,6 +1504,35 @@ static int32_t gsl_graph_send_nonpersist_cal(struct gsl_graph *graph,
 	int32_t rc;
 	struct apm_cmd_header_t *cmd_header;
 	gsl_msg_t gsl_msg;
+	struct gsl_graph_cal_msg_ctx msg_ctx;
+	struct gsl_graph_cache_key key;
+	struct gsl_blob cal_blob;
+	uint32_t num_elems = 0;
+
+	msg_ctx.graph = graph;
+	msg_ctx.gsl_msg = &gsl_msg;
+	msg_ctx.rc = AR_EOK;
+	msg_ctx.is_allocated = FALSE;
+
+	gsl_graph_nonpersist_cal_key_alloc(&key, sgid_list, prior_ckv, new_ckv);
+
+	if (gsl_graph_cache_get(&key, &num_elems, &cal_blob, 1) == AR_EOK) {
+		rc = AR_EOK;
+		if (!cal_blob.size)
+			goto exit; /**< no calibration to send */
+
+		gsl_graph_alloc_cal_msg(cal_blob.size, &msg_ctx);
+		if (msg_ctx.rc) {
+			gsl_mem_free(cal_blob.buf);
+			rc = msg_ctx.rc;
+			goto exit;
+		}
+		gsl_memcpy(gsl_msg.payload, cal_blob.size, cal_blob.buf,
+			cal_blob.size);
+		gsl_mem_free(cal_blob.buf);
+		rsp_struct.buf_size = cal_blob.size;
+		goto send_cal;
+	}
 
 	cmd_struct.num_sg_ids = sgid_list->len;
 	cmd_struct.sg_ids = sgid_list->sg_ids;
@@ -757,31 +1546,32 @@ static int32_t gsl_graph_send_nonpersist_cal(struct gsl_graph *graph,
 	rsp_struct.buf = NULL;
 	rsp_struct.buf_size = 0;
 
-	rc = acdb_ioctl(ACDB_CMD_GET_SUBGRAPH_CALIBRATION_DATA_NONPERSIST,
-		&cmd_struct, sizeof(cmd_struct), &rsp_struct, sizeof(rsp_struct));
-	if (rc == AR_ENOTEXIST) {
+	/*
+	 * ACDB SW sizes the calibration, allocates the message through
+	 * gsl_graph_alloc_cal_msg and fills its payload in a single call
+	 */
+	rc = acdb_ioctl_alloc(ACDB_CMD_GET_SUBGRAPH_CALIBRATION_DATA_NONPERSIST,
+		&cmd_struct, sizeof(cmd_struct), &rsp_struct, sizeof(rsp_struct),
+		gsl_graph_alloc_cal_msg, &msg_ctx);
+	if (msg_ctx.rc) {
+		rc = msg_ctx.rc;
+		goto exit;
+	} else if (rc == AR_ENOTEXIST) {
 		/* avoid logging error if not exist */
-		return rc;
+		goto exit;
 	} else if (rc) {
-		GSL_ERR("get non-persist data (size) failed %d", rc);
-		return rc;
-	}
-
-	rc = gsl_msg_alloc(APM_CMD_SET_CFG, graph->src_port, GSL_GPR_DST_PORT_APM,
-		sizeof(*cmd_header), 0, graph->proc_id, rsp_struct.buf_size, false,
-		&gsl_msg);
-	if (rc) {
-		GSL_ERR("gsl msg alloc failed %d", rc);
-		return rc;
-	}
-	rsp_struct.buf = gsl_msg.payload;
-	rc = acdb_ioctl(ACDB_CMD_GET_SUBGRAPH_CALIBRATION_DATA_NONPERSIST,
-		&cmd_struct, sizeof(cmd_struct), &rsp_struct, sizeof(rsp_struct));
-	if (rc) {
-		GSL_ERR("get non-persist data (cal) failed %d", rc);
+		GSL_ERR("get non-persist data failed %d", rc);
 		goto exit;
 	}
 
+	cal_blob.size = rsp_struct.buf_size;
+	cal_blob.buf = rsp_struct.buf;
+	gsl_graph_cache_put(&key, 0, &cal_blob, 1);
+
+	if (!msg_ctx.is_allocated)
+		goto exit; /**< no calibration to send */
+
+send_cal:
 	cmd_header = GPR_PKT_GET_PAYLOAD(struct apm_cmd_header_t,
 		gsl_msg.gpr_packet);
 	cmd_header->mem_map_handle = gsl_msg.shmem.spf_mmap_handle;
@@ -799,7 +1589,9 @@ static int32_t gsl_graph_send_nonpersist_cal(struct gsl_graph *graph,
 		GSL_ERR("send non-perist cal failed %d", rc);
 
 exit:
-	gsl_msg_free(&gsl_msg);
+	if (msg_ctx.is_allocated)
+		gsl_msg_free(&gsl_msg);
+	gsl_graph_cache_key_free(&key);
 	return rc;
 }
 
@@ -1374,6 +2166,14 @@ int32_t gsl_graph_deinit(struct gsl_graph *graph)
 	return AR_EOK;
 }
 
+/* allocator for ACDB responses that are owned by the caller */
+static void *gsl_acdb_rsp_zalloc(uint32_t size, void *context)
+{
+	(void)context;
+
+	return gsl_mem_zalloc(size);
+}
+
 int32_t gsl_acdb_get_graph(const struct gsl_key_vector *gkv,
 	uint32_t **sg_id_list, AcdbGetGraphRsp *sg_conn_info)
 {
@@ -1383,6 +2183,22 @@ int32_t gsl_acdb_get_graph(const struct gsl_key_vector *gkv,
 	uint32_t cmd_struct_size, rsp_struct_size, num_dst_sgs;
 	int32_t rc, i, payload_size;
 	uint32_t num_of_subgraphs, *rsp_p, *sg_ids;
+	struct gsl_graph_cache_key key;
+	struct gsl_blob sg_blob = {0, NULL};
+
+	gsl_graph_cache_key_alloc(&key, ACDB_CMD_GET_GRAPH,
+		gsl_graph_cache_kv_size(gkv));
+	if (key.words)
+		gsl_graph_cache_key_add_kv(key.words, gkv);
+
+	if (gsl_graph_cache_get(&key, &num_of_subgraphs, &sg_blob, 1) == AR_EOK) {
+		rsp_struct.num_subgraphs = num_of_subgraphs;
+		rsp_struct.size = sg_blob.size;
+		rsp_struct.subgraphs = sg_blob.buf;
+		sgs = rsp_struct.subgraphs;
+		rc = AR_EOK;
+		goto parse_rsp;
+	}
 
 	/* Populate command structure */
 	cmd_struct_size = sizeof(AcdbGraphKeyVector);
@@ -1391,20 +2207,27 @@ int32_t gsl_acdb_get_graph(const struct gsl_key_vector *gkv,
 
 	/**
 	 * Populate response structure
-	 * Response size is unknown here, so allocate minimum of 8 bytes,
-	 * so ACDB SW can return the size to be allocated
+	 * Response size is unknown here, so let ACDB SW allocate the subgraph
+	 * list once it has looked up the graph
 	 */
 	rsp_struct.subgraphs = NULL;
 	rsp_struct.size = 0;
 	rsp_struct.num_subgraphs = 0;
 	rsp_struct_size = sizeof(AcdbGetGraphRsp);
 
-	rc = acdb_ioctl(ACDB_CMD_GET_GRAPH, &cmd_struct, cmd_struct_size,
-		&rsp_struct, rsp_struct_size);
+	rc = acdb_ioctl_alloc(ACDB_CMD_GET_GRAPH, &cmd_struct, cmd_struct_size,
+		&rsp_struct, rsp_struct_size, gsl_acdb_rsp_zalloc, NULL);
+	sgs = rsp_struct.subgraphs;
 	if (rc) {
-		GSL_ERR("get_graph acdb ioctl for size failed: %d", rc);
-		goto exit;
+		GSL_ERR("get_graph acdb ioctl failed: %d", rc);
+		goto free_sgs;
 	}
+
+	sg_blob.size = rsp_struct.size;
+	sg_blob.buf = rsp_struct.subgraphs;
+	gsl_graph_cache_put(&key, rsp_struct.num_subgraphs, &sg_blob, 1);
+
+parse_rsp:
 	/*
 	 * Getting 0 subgraphs is a valid scenario, GSL should handle it by not
 	 * opening any subgraphs on Spf
@@ -1422,20 +2245,6 @@ int32_t gsl_acdb_get_graph(const struct gsl_key_vector *gkv,
 		goto exit;
 	}
 
-	sgs = gsl_mem_zalloc(rsp_struct.size);
-	if (!sgs) {
-		rc = AR_ENOMEMORY;
-		goto exit;
-	}
-	rsp_struct.subgraphs = sgs;
-
-	rc = acdb_ioctl(ACDB_CMD_GET_GRAPH, &cmd_struct, cmd_struct_size,
-		&rsp_struct, rsp_struct_size);
-	if (rc) {
-		GSL_ERR("get_graph acdb ioctl for data failed: %d", rc);
-		goto free_sgs;
-	}
-
 	/* rsp_struct: {num_of_subgraphs, size, <AcdbSubgraph structure> */
 	rsp_p = (uint32_t *)&rsp_struct;
 	payload_size = rsp_struct.size;
@@ -1489,6 +2298,7 @@ free_sgs:
 			sg_conn_info->subgraphs = NULL;
 	}
 exit:
+	gsl_graph_cache_key_free(&key);
 	return rc;
 }
 
@@ -2555,8 +3365,8 @@ free_pruned_sg_info:
 	if (props) {
 		rc = gsl_graph_remove_sgs_w_props(gkv_node, props);
 	} else {
-		for (i = 0; i < gkv_node->num_of_subgraphs; ++i)
-			gsl_sg_pool_remove(gkv_node->sg_array[i], FALSE);
+		gsl_sg_pool_remove_list(gkv_node->sg_array,
+			gkv_node->num_of_subgraphs, FALSE);
 
 		if (!preserve_gkv_node) {
 			gsl_mem_free(gkv_node->sg_array);
@@ -2626,8 +3436,12 @@ static int32_t gsl_graph_add_and_prune_sgs_and_connections(
 		goto exit;
 	}
 
-	for (i = 0; i < gkv_node->num_of_subgraphs; ++i)
-		gkv_node->sg_array[i] = gsl_sg_pool_add(sg_list.sg_ids[i], FALSE);
+	rc = gsl_sg_pool_add_list(sg_list.sg_ids, gkv_node->num_of_subgraphs,
+		FALSE, gkv_node->sg_array);
+	if (AR_FAILED(rc)) {
+		GSL_ERR("subgraph pool add failed: %d", rc);
+		goto remove_from_pool;
+	}
 	/*
 	 * allocate memory to store pruned sg list
 	 */
@@ -2758,8 +3572,8 @@ remove_from_pool:
 	pruned_sg_connections->size = 0;
 	pruned_sg_connections->subgraphs = NULL;
 
-	for (i = 0; i < gkv_node->num_of_subgraphs; ++i)
-		gsl_sg_pool_remove(gkv_node->sg_array[i], FALSE);
+	gsl_sg_pool_remove_list(gkv_node->sg_array, gkv_node->num_of_subgraphs,
+		FALSE);
 	if (existing_sgid_list) {
 		gsl_mem_free(existing_sgid_list->sg_ids);
 		existing_sgid_list->len = 0;
@@ -2777,33 +3591,38 @@ exit:
 	return rc;
 }
 
+/* Spf blobs gathered from ACDB to open the pruned SGs and connections of a GKV */
+struct gsl_graph_open_data {
+	struct gsl_blob spf_blob;
+	struct gsl_blob spf_sg_conn_blob;
+	AcdbDriverPropertyData drv_blob;
+};
+
+static void gsl_graph_free_open_data(struct gsl_graph_open_data *open_data)
+{
+	gsl_mem_free(open_data->drv_blob.sub_graph_prop_data);
+	gsl_mem_free(open_data->spf_blob.buf);
+	gsl_mem_free(open_data->spf_sg_conn_blob.buf);
+	gsl_memset(open_data, 0, sizeof(*open_data));
+}
+
 /**
- * Opens SG IDS and Connections on Spf. Subgraph_Data and
- * SG_Connections_Data are retrieved from the acdb for the given
- * sgids and sg_connections and sent to Spf. Also applies calibration
- * using ckv for the SGIDS that are opened on spf.
+ * Gets the Subgraph_Data and SG_Connections_Data of the given sgids and
+ * sg_connections from the acdb. Also parses the driver properties of the
+ * SGs, which sets the graph's proc id, and checks that the subsystems the
+ * SGs need are up. The open data is freed on failure.
  */
-static int32_t gsl_graph_open_sgids_and_connections(struct gsl_graph *graph,
+static int32_t gsl_graph_prepare_open(struct gsl_graph *graph,
 	struct gsl_graph_gkv_node *gkv_node,
 	struct gsl_sgid_list *sgids, struct gsl_graph_sg_conn_data *sg_conn,
-	struct gsl_key_vector *gkv, struct gsl_key_vector *ckv)
+	struct gsl_key_vector *gkv, struct gsl_graph_open_data *open_data)
 {
-	uint32_t graph_open_size = 0, i;
-	struct gsl_blob spf_blob, spf_sg_conn_blob;
-	struct apm_cmd_header_t *open_cmd;
-	AcdbDriverPropertyData drv_blob;
+	uint32_t i;
 	int32_t rc = AR_EOK;
 	struct gsl_sgobj_list sg_obj_list;
-	gsl_msg_t gsl_msg;
 	bool_t is_shmem_supported = TRUE;
 
-	/* check if there are any sub-graphs or edges to open */
-	if ((sgids->len == 0) && (sg_conn->num_sgs == 0))
-		return AR_EOK; /**< nothing to open on SPF */
-
-	gsl_memset(&spf_blob, 0, sizeof(struct gsl_blob));
-	gsl_memset(&drv_blob, 0, sizeof(AcdbDriverPropertyData));
-	gsl_memset(&spf_sg_conn_blob, 0, sizeof(struct gsl_blob));
+	gsl_memset(open_data, 0, sizeof(*open_data));
 
 	/** Get subgraph data size for spf and drv blobs */
 	GSL_DBG("num_sgid= %d", sgids->len);
@@ -2811,51 +3630,32 @@ static int32_t gsl_graph_open_sgids_and_connections(struct gsl_graph *graph,
 	for (i = 0; i < sgids->len; ++i)
 		GSL_DBG("%x", sgids->sg_ids[i]);
 	if (sgids->len) {
-		rc = gsl_acdb_get_subgraph_data(sgids, gkv, &spf_blob, &drv_blob);
-		if (rc) {
-			GSL_ERR("get subgraph data for size failed: %d", rc);
-			goto exit;
-		}
-
 		/*
-		 * Get graph proc id. Need driver blob only.
-		 * Hence setting spf blob to NULL
+		 * Get the spf blob and the driver blob, the driver blob gives the
+		 * graph proc id needed to allocate the open command
 		 */
-		spf_blob.buf = NULL;
-		spf_blob.size = 0;
-		/* Alloc memory for SG driver property data */
-		drv_blob.sub_graph_prop_data = gsl_mem_zalloc(drv_blob.size);
-		if (!drv_blob.sub_graph_prop_data) {
-			rc = AR_ENOMEMORY;
+		rc = gsl_graph_get_subgraph_data_cached(sgids, gkv,
+			&open_data->spf_blob, &open_data->drv_blob);
+		if (rc)
 			goto exit;
-		}
-
-		/*
-		 * spf_blob buf is set to NULL & size is set to 0, acdb returns
-		 * driver blob, for spf blob we get back size only.
-		 */
-		rc = gsl_acdb_get_subgraph_data(sgids, gkv, &spf_blob, &drv_blob);
-		if (rc) {
-			GSL_ERR("get subgraph data failed %d", rc);
-			goto free_sg_prop_data;
-		}
 
 		/* Parse driver prop data to get routing id */
 		sg_obj_list.sg_objs = gkv_node->sg_array;
 		sg_obj_list.len = gkv_node->num_of_subgraphs;
 
-		rc = gsl_acdb_parse_sg_drv_prop_data(graph, &sg_obj_list, &drv_blob);
+		rc = gsl_acdb_parse_sg_drv_prop_data(graph, &sg_obj_list,
+			&open_data->drv_blob);
 		if (rc) {
 			GSL_ERR("gsl_acdb_parse_sg_drv_prop_data failed with status %d",
 				rc);
-			goto free_sg_prop_data;
+			goto free_open_data;
 		}
 
 		if ((gsl_spf_ss_state_get(graph->proc_id) & gkv_node->spf_ss_mask)
 			!= gkv_node->spf_ss_mask) {
 
 			rc = AR_ENOTREADY;
-			goto free_sg_prop_data;
+			goto free_open_data;
 		}
 
 		/*
@@ -2866,7 +3666,7 @@ static int32_t gsl_graph_open_sgids_and_connections(struct gsl_graph *graph,
 			&is_shmem_supported);
 		if (rc) {
 			GSL_ERR("GPR is shmem supported failed %d", rc)
-			goto free_sg_prop_data;
+			goto free_open_data;
 		}
 		if (is_shmem_supported)
 			gsl_mdf_utils_shmem_alloc(gkv_node->spf_ss_mask, graph->proc_id);
@@ -2877,23 +3677,43 @@ static int32_t gsl_graph_open_sgids_and_connections(struct gsl_graph *graph,
 		gsl_print_sg_conn_info((uint32_t *)sg_conn->subgraphs,
 			sg_conn->num_sgs);
 
-		rc = gsl_acdb_get_subgraph_connections(sg_conn->subgraphs,
-			sg_conn->num_sgs, &spf_sg_conn_blob);
+		rc = gsl_graph_get_subgraph_connections_cached(sg_conn->subgraphs,
+			sg_conn->num_sgs, &open_data->spf_sg_conn_blob);
 		if (rc == AR_ENOTEXIST) {
 			GSL_ERR("got 0 size for subgraph conn data, rc %d", rc);
 			rc = AR_EOK;
 		} else if (rc) {
 			GSL_ERR("get subgraph conn data for size failed: %d, size:%d", rc,
-				spf_sg_conn_blob.size);
-			goto free_sg_prop_data;
+				open_data->spf_sg_conn_blob.size);
+			goto free_open_data;
 		}
 	}
+	goto exit;
+
+free_open_data:
+	gsl_graph_free_open_data(open_data);
+exit:
+	return rc;
+}
+
+/**
+ * Sends a single APM_CMD_GRAPH_OPEN whose payload is the concatenation of
+ * the given spf blobs from the graph's port, and waits for the response
+ */
+static int32_t gsl_graph_send_open(struct gsl_graph *graph,
+	const struct gsl_blob *blobs, uint32_t num_blobs)
+{
+	uint32_t graph_open_size = 0, offset = 0, i;
+	struct apm_cmd_header_t *open_cmd;
+	int32_t rc = AR_EOK;
+	gsl_msg_t gsl_msg;
+
+	for (i = 0; i < num_blobs; ++i)
+		graph_open_size += blobs[i].size;
 
-	graph_open_size = spf_blob.size + spf_sg_conn_blob.size;
 	if (graph_open_size == 0) {
 		GSL_ERR("spf blob size for open is zero");
-		rc = AR_EFAILED;
-		goto free_sg_prop_data;
+		return AR_EFAILED;
 	}
 
 	/*
@@ -2905,28 +3725,15 @@ static int32_t gsl_graph_open_sgids_and_connections(struct gsl_graph *graph,
 		graph_open_size, false, &gsl_msg);
 	if (rc) {
 		GSL_ERR("GSL MSG alloc failed size: %d rc:%d", graph_open_size, rc);
-		goto free_sg_prop_data;
-	}
-
-	if (spf_blob.size) {
-		spf_blob.buf = gsl_msg.payload;
-		/* Get both spf data blob and subgraph driver property blob */
-		rc = gsl_acdb_get_subgraph_data(sgids, gkv, &spf_blob, &drv_blob);
-		if (rc) {
-			GSL_ERR("get subgraph data failed %d", rc);
-			goto free_gsl_msg;
-		}
+		return rc;
 	}
 
-	if (spf_sg_conn_blob.size) {
-		spf_sg_conn_blob.buf = (int8_t *)gsl_msg.payload +
-			spf_blob.size;
-		rc = gsl_acdb_get_subgraph_connections(sg_conn->subgraphs,
-			sg_conn->num_sgs, &spf_sg_conn_blob);
-		if (rc) {
-			GSL_ERR("get subgraph conn data failed: %d", rc);
-			goto free_gsl_msg;
-		}
+	for (i = 0; i < num_blobs; ++i) {
+		if (!blobs[i].size)
+			continue;
+		gsl_memcpy((int8_t *)gsl_msg.payload + offset,
+			graph_open_size - offset, blobs[i].buf, blobs[i].size);
+		offset += blobs[i].size;
 	}
 
 	open_cmd = GPR_PKT_GET_PAYLOAD(struct apm_cmd_header_t, gsl_msg.gpr_packet);
@@ -2941,92 +3748,202 @@ static int32_t gsl_graph_open_sgids_and_connections(struct gsl_graph *graph,
 
 	rc = gsl_send_spf_cmd_wait_for_basic_rsp(&gsl_msg.gpr_packet,
 		&graph->graph_signal[GRAPH_CTRL_GRP1_CMD_SIG]);
-	if (rc) {
+	if (rc)
 		GSL_ERR("Graph open failed:%d", rc);
-		goto free_gsl_msg;
-	}
 
-	sg_obj_list.len = gkv_node->num_of_subgraphs;
-	sg_obj_list.sg_objs = gkv_node->sg_array;
+	gsl_msg_free(&gsl_msg);
+	return rc;
+}
 
-	/* Apply cal */
-	if (sgids->len) {
-		GSL_MUTEX_LOCK(graph->get_set_cfg_lock);
-		rc = gsl_graph_set_sg_cal(graph, sgids, gkv_node, ckv);
-		GSL_MUTEX_UNLOCK(graph->get_set_cfg_lock);
-		if (rc == AR_EUNSUPPORTED || rc == AR_ENOTEXIST) {
-			/*
-			 * we let open succeed since ENOTEXIST is benign and EUNSUPPORTED is
-			 * widespread. We should get everyone to fix their EUNSUPPORTEDs in
-			 * the future by opening CRs.
-			 */
-			GSL_DBG("graph set cal failed:%d", rc);
-			rc = AR_EOK;
-		} else if (rc != AR_EOK) {
-			/*
-			 * for other serious cal failures, we need to send close on SPF
-			 * Caller function will handle the internal clean-up
-			 * This is to ensure that GSL and SPF and client all have the same
-			 * state of a graph. We must fail on set cal fail, since some cals
-			 * e.g. speaker protection are  essential
-			 *
-			 * we ignore RC of close fail -- cleanup function & preserve
-			 * original error
-			 */
-			GSL_ERR("set sg cal failed, closing all opened SGs: %d", rc);
-			gsl_graph_close_sgids_and_connections(graph, *sgids,
-				sg_conn->subgraphs, sg_conn->num_sgs);
-		}
+/**
+ * Applies calibration using ckv to the SGIDS that were just opened on Spf.
+ * Benign cal failures are ignored.
+ */
+static int32_t gsl_graph_set_open_cal(struct gsl_graph *graph,
+	struct gsl_graph_gkv_node *gkv_node, struct gsl_sgid_list *sgids,
+	struct gsl_key_vector *ckv)
+{
+	int32_t rc = AR_EOK;
+
+	if (!sgids->len)
+		return AR_EOK;
+
+	GSL_MUTEX_LOCK(graph->get_set_cfg_lock);
+	rc = gsl_graph_set_sg_cal(graph, sgids, gkv_node, ckv);
+	GSL_MUTEX_UNLOCK(graph->get_set_cfg_lock);
+	if (rc == AR_EUNSUPPORTED || rc == AR_ENOTEXIST) {
+		/*
+		 * we let open succeed since ENOTEXIST is benign and EUNSUPPORTED is
+		 * widespread. We should get everyone to fix their EUNSUPPORTEDs in
+		 * the future by opening CRs.
+		 */
+		GSL_DBG("graph set cal failed:%d", rc);
+		rc = AR_EOK;
 	}
 
-free_gsl_msg:
-	gsl_msg_free(&gsl_msg);
+	return rc;
+}
+
+/**
+ * Opens SG IDS and Connections on Spf. Subgraph_Data and
+ * SG_Connections_Data are retrieved from the acdb for the given
+ * sgids and sg_connections and sent to Spf. Also applies calibration
+ * using ckv for the SGIDS that are opened on spf, the non-persistent
+ * calibration is fetched from the acdb while Spf opens the SGs.
+ */
+static int32_t gsl_graph_open_sgids_and_connections(struct gsl_graph *graph,
+	struct gsl_graph_gkv_node *gkv_node,
+	struct gsl_sgid_list *sgids, struct gsl_graph_sg_conn_data *sg_conn,
+	struct gsl_key_vector *gkv, struct gsl_key_vector *ckv)
+{
+	struct gsl_graph_open_data open_data;
+	struct gsl_graph_cal_prefetch prefetch;
+	struct gsl_cmd_open_timing *timing = &graph->open_timing;
+	struct gsl_blob blobs[2];
+	bool_t is_prefetching;
+	uint64_t start_us, t_us;
+	int32_t rc = AR_EOK;
+
+	gsl_memset(timing, 0, sizeof(*timing));
+
+	/* check if there are any sub-graphs or edges to open */
+	if ((sgids->len == 0) && (sg_conn->num_sgs == 0))
+		return AR_EOK; /**< nothing to open on SPF */
+
+	start_us = ar_timer_get_time_in_us();
+	rc = gsl_graph_prepare_open(graph, gkv_node, sgids, sg_conn, gkv,
+		&open_data);
+	t_us = ar_timer_get_time_in_us();
+	timing->acdb_open_data_us = (uint32_t)(t_us - start_us);
+	if (rc)
+		goto exit;
+
+	is_prefetching = gsl_graph_cal_prefetch_start(&prefetch, sgids, gkv_node,
+		ckv);
+
+	blobs[0] = open_data.spf_blob;
+	blobs[1] = open_data.spf_sg_conn_blob;
+	rc = gsl_graph_send_open(graph, blobs, 2);
+	timing->spf_open_us = (uint32_t)(ar_timer_get_time_in_us() - t_us);
+
+	if (is_prefetching) {
+		gsl_graph_cal_prefetch_wait(&prefetch);
+		timing->cal_prefetch_us = (uint32_t)prefetch.time_us;
+	}
+	if (rc)
+		goto free_open_data;
 
-free_sg_prop_data:
-	gsl_mem_free(drv_blob.sub_graph_prop_data);
+	t_us = ar_timer_get_time_in_us();
+	rc = gsl_graph_set_open_cal(graph, gkv_node, sgids, ckv);
+	timing->cal_us = (uint32_t)(ar_timer_get_time_in_us() - t_us);
+	if (rc) {
+		/*
+		 * for serious cal failures, we need to send close on SPF
+		 * Caller function will handle the internal clean-up
+		 * This is to ensure that GSL and SPF and client all have the same
+		 * state of a graph. We must fail on set cal fail, since some cals
+		 * e.g. speaker protection are  essential
+		 *
+		 * we ignore RC of close fail -- cleanup function & preserve
+		 * original error
+		 */
+		GSL_ERR("set sg cal failed, closing all opened SGs: %d", rc);
+		gsl_graph_close_sgids_and_connections(graph, *sgids,
+			sg_conn->subgraphs, sg_conn->num_sgs);
+	}
 
+free_open_data:
+	gsl_graph_free_open_data(&open_data);
 exit:
+	timing->total_us = (uint32_t)(ar_timer_get_time_in_us() - start_us);
 	return rc;
 }
 
-/* Graph open for single GKV. Called with open_close_mutex lock acquired */
-static int32_t gsl_graph_open_single_gkv(struct gsl_graph *graph,
-	const struct gsl_key_vector *gkv, const struct gsl_key_vector *ckv,
-	struct gsl_graph_gkv_node *gkv_node)
+/**
+ * Gets the SGs and connections of a GKV from ACDB and adds them to the pool.
+ * On success the caller owns sgids, pruned_sgids and pruned_sg_conn, which
+ * hold the SGs and connections that are not yet open on Spf.
+ */
+static int32_t gsl_graph_add_gkv_to_pool(struct gsl_graph *graph,
+	const struct gsl_key_vector *gkv, struct gsl_graph_gkv_node *gkv_node,
+	struct gsl_sgid_list *sgids, struct gsl_sgid_list *pruned_sgids,
+	struct gsl_graph_sg_conn_data *pruned_sg_conn)
 {
 	int32_t rc;
-	struct gsl_sgid_list pruned_sgids = {0, NULL};
-	struct gsl_sgid_list sgids = {0, NULL};
-	uint32_t i = 0;
 	AcdbGetGraphRsp sg_conn_info;
-	struct gsl_graph_sg_conn_data pruned_sg_conn = {0,};
-	AcdbSubgraph *p;
 
 	/* Get graph data from ACDB */
-	rc = gsl_acdb_get_graph(gkv, &sgids.sg_ids, &sg_conn_info);
+	rc = gsl_acdb_get_graph(gkv, &sgids->sg_ids, &sg_conn_info);
 	if (rc) {
 		GSL_ERR("acdb get graph failed %d", rc);
-		goto cleanup;
+		return rc;
 	}
 
 	/**
 	 * Add SGIDs and connections to the pool. Get pruned sgid list
 	 * sg connections after adding them to the pool.
 	 */
-	sgids.len = sg_conn_info.num_subgraphs;
-	pruned_sgids.len = 0;
-	pruned_sgids.sg_ids = NULL;
-	rc = gsl_graph_add_and_prune_sgs_and_connections(gkv_node, sgids,
-		sg_conn_info.subgraphs, sg_conn_info.size, &pruned_sgids,
-		&pruned_sg_conn, NULL, NULL);
+	sgids->len = sg_conn_info.num_subgraphs;
+	pruned_sgids->len = 0;
+	pruned_sgids->sg_ids = NULL;
+	rc = gsl_graph_add_and_prune_sgs_and_connections(gkv_node, *sgids,
+		sg_conn_info.subgraphs, sg_conn_info.size, pruned_sgids,
+		pruned_sg_conn, NULL, NULL);
 	if (rc)
-		goto cleanup;
+		return rc;
 
 	/**
 	 * update the graph level ss_mask to reflect this gkv
 	 */
 	 graph->ss_mask |= gkv_node->spf_ss_mask;
 
+	return rc;
+}
+
+/**
+ * Removes the sgids and connections of a gkv node that failed to open from
+ * the pool
+ */
+static void gsl_graph_remove_gkv_from_pool(struct gsl_graph_gkv_node *gkv_node)
+{
+	uint32_t i = 0;
+	AcdbSubgraph *p;
+
+	p = gkv_node->sg_conn_data.subgraphs;
+	while (i < gkv_node->num_of_subgraphs) {
+		gsl_subgraph_remove_children(gkv_node->sg_array[i++], p, NULL,
+			NULL);
+		p = (AcdbSubgraph *)((uint32_t *)p->dst_sg_ids + p->num_dst_sgids);
+	}
+
+	gsl_sg_pool_remove_list(gkv_node->sg_array,
+		gkv_node->num_of_subgraphs, FALSE);
+
+	gsl_mem_free(gkv_node->sg_array);
+	gkv_node->sg_array = NULL;
+	gsl_mem_free(gkv_node->sg_conn_data.subgraphs);
+	gkv_node->sg_conn_data.subgraphs = NULL;
+}
+
+/* Graph open for single GKV. Called with open_close_mutex lock acquired */
+static int32_t gsl_graph_open_single_gkv(struct gsl_graph *graph,
+	const struct gsl_key_vector *gkv, const struct gsl_key_vector *ckv,
+	struct gsl_graph_gkv_node *gkv_node)
+{
+	int32_t rc;
+	struct gsl_sgid_list pruned_sgids = {0, NULL};
+	struct gsl_sgid_list sgids = {0, NULL};
+	struct gsl_graph_sg_conn_data pruned_sg_conn = {0,};
+	uint64_t start_us = ar_timer_get_time_in_us();
+	uint32_t acdb_graph_us;
+
+	gsl_memset(&graph->open_timing, 0, sizeof(graph->open_timing));
+	rc = gsl_graph_add_gkv_to_pool(graph, gkv, gkv_node, &sgids,
+		&pruned_sgids, &pruned_sg_conn);
+	acdb_graph_us = (uint32_t)(ar_timer_get_time_in_us() - start_us);
+	if (rc)
+		goto cleanup;
+
 	/** Now open the pruned sgid list and connections */
 	rc = gsl_graph_open_sgids_and_connections(graph, gkv_node, &pruned_sgids,
 		&pruned_sg_conn, (struct gsl_key_vector *)gkv,
@@ -3040,19 +3957,7 @@ static int32_t gsl_graph_open_single_gkv(struct gsl_graph *graph,
 		 * in the failure case, remove the sgids and connections
 		 * of the given gkv from the pool
 		 */
-		p = gkv_node->sg_conn_data.subgraphs;
-		i = 0;
-		while (i < gkv_node->num_of_subgraphs) {
-			gsl_subgraph_remove_children(gkv_node->sg_array[i++], p, NULL,
-				NULL);
-			p = (AcdbSubgraph *)((uint32_t *)p->dst_sg_ids + p->num_dst_sgids);
-		}
-
-		for (i = 0; i < gkv_node->num_of_subgraphs; ++i)
-			gsl_sg_pool_remove(gkv_node->sg_array[i], FALSE);
-
-		gsl_mem_free(gkv_node->sg_array);
-		gsl_mem_free(gkv_node->sg_conn_data.subgraphs);
+		gsl_graph_remove_gkv_from_pool(gkv_node);
 	}
 
 cleanup:
@@ -3063,6 +3968,9 @@ cleanup:
 	if (sgids.sg_ids)
 		gsl_mem_free(sgids.sg_ids);
 
+	graph->open_timing.acdb_graph_us = acdb_graph_us;
+	graph->open_timing.total_us =
+		(uint32_t)(ar_timer_get_time_in_us() - start_us);
 	return rc;
 }
 
@@ -4394,6 +5302,241 @@ free_gkv_node:
 	return rc;
 }
 
+/* Per graph state of gsl_graph_open_batch */
+struct gsl_graph_batch_entry {
+	struct gsl_graph *graph;
+	const struct gsl_key_vector *gkv;
+	const struct gsl_key_vector *ckv;
+	struct gsl_graph_gkv_node *gkv_node;
+	struct gsl_sgid_list sgids;
+	struct gsl_sgid_list pruned_sgids;
+	struct gsl_graph_sg_conn_data pruned_sg_conn;
+	struct gsl_graph_open_data open_data;
+	bool_t registered; /**< registered with gpr */
+	bool_t in_pool; /**< SGs and connections added to the pool */
+	bool_t opened; /**< SGs and connections opened on Spf */
+};
+
+static bool_t gsl_graph_batch_needs_open(struct gsl_graph_batch_entry *e)
+{
+	return e->gkv_node &&
+		(e->pruned_sgids.len != 0 || e->pruned_sg_conn.num_sgs != 0);
+}
+
+static void gsl_graph_batch_free_lists(struct gsl_graph_batch_entry *e)
+{
+	gsl_mem_free(e->pruned_sgids.sg_ids);
+	e->pruned_sgids.sg_ids = NULL;
+	gsl_mem_free(e->pruned_sg_conn.subgraphs);
+	e->pruned_sg_conn.subgraphs = NULL;
+	gsl_mem_free(e->sgids.sg_ids);
+	e->sgids.sg_ids = NULL;
+	gsl_graph_free_open_data(&e->open_data);
+}
+
+/*
+ * Opens consecutive batch entries that share a master proc with a single
+ * APM_CMD_GRAPH_OPEN sent from the port of the first graph. The SG data of
+ * every graph is sent ahead of the connection data so that connections to
+ * SGs of other graphs in the run are resolved. Runs are not merged across
+ * procs so later graphs never connect to SGs that are not yet open.
+ */
+static int32_t gsl_graph_batch_send_open(struct gsl_graph_batch_entry *ents,
+	uint32_t first, uint32_t num)
+{
+	struct gsl_blob *blobs;
+	uint32_t i;
+	int32_t rc;
+
+	blobs = gsl_mem_zalloc(2 * num * sizeof(*blobs));
+	if (!blobs)
+		return AR_ENOMEMORY;
+
+	for (i = 0; i < num; ++i) {
+		blobs[i] = ents[first + i].open_data.spf_blob;
+		blobs[num + i] = ents[first + i].open_data.spf_sg_conn_blob;
+	}
+
+	GSL_DBG("opening %d graphs on proc %d with one command", num,
+		ents[first].graph->proc_id);
+	rc = gsl_graph_send_open(ents[first].graph, blobs, 2 * num);
+
+	gsl_mem_free(blobs);
+	return rc;
+}
+
+int32_t gsl_graph_open_batch(struct gsl_graph **graphs,
+	const struct gsl_key_vector **gkvs, const struct gsl_key_vector **ckvs,
+	uint32_t num_graphs, ar_osal_mutex_t lock)
+{
+	struct gsl_graph_batch_entry *ents, *e;
+	uint64_t start_us = ar_timer_get_time_in_us(), t_us;
+	uint32_t i, j;
+	int32_t rc = AR_EOK;
+
+	if (!graphs || !gkvs || num_graphs == 0)
+		return AR_EBADPARAM;
+
+	ents = gsl_mem_zalloc(num_graphs * sizeof(*ents));
+	if (!ents)
+		return AR_ENOMEMORY;
+
+	for (i = 0; i < num_graphs; ++i) {
+		e = &ents[i];
+		e->graph = graphs[i];
+		e->gkv = gkvs[i];
+		e->ckv = ckvs ? ckvs[i] : NULL;
+		if (!e->graph) {
+			rc = AR_EBADPARAM;
+			goto free_entries;
+		}
+
+		/* It is possible to open a graph with a null GKV */
+		if (e->gkv && e->gkv->num_kvps != 0) {
+			e->gkv_node = gsl_mem_zalloc(sizeof(struct gsl_graph_gkv_node));
+			if (!e->gkv_node) {
+				rc = AR_ENOMEMORY;
+				goto free_entries;
+			}
+		}
+
+		rc = __gpr_cmd_register(e->graph->src_port, gsl_gpr_callback,
+			e->graph);
+		if (rc)
+			goto free_entries;
+		e->registered = TRUE;
+	}
+
+	GSL_MUTEX_LOCK(lock);
+
+	/*
+	 * Add every GKV to the pool before anything is opened, SGs shared with
+	 * an earlier graph of the batch are pruned from the later graphs
+	 */
+	for (i = 0; i < num_graphs; ++i) {
+		e = &ents[i];
+		gsl_memset(&e->graph->open_timing, 0, sizeof(e->graph->open_timing));
+		if (!e->gkv_node)
+			continue;
+		t_us = ar_timer_get_time_in_us();
+		rc = gsl_graph_add_gkv_to_pool(e->graph, e->gkv, e->gkv_node,
+			&e->sgids, &e->pruned_sgids, &e->pruned_sg_conn);
+		e->graph->open_timing.acdb_graph_us =
+			(uint32_t)(ar_timer_get_time_in_us() - t_us);
+		if (rc) {
+			GSL_ERR("add gkv %d of batch to pool failed %d", i, rc);
+			goto unwind;
+		}
+		e->in_pool = TRUE;
+	}
+
+	for (i = 0; i < num_graphs; ++i) {
+		e = &ents[i];
+		if (!gsl_graph_batch_needs_open(e))
+			continue;
+		t_us = ar_timer_get_time_in_us();
+		rc = gsl_graph_prepare_open(e->graph, e->gkv_node, &e->pruned_sgids,
+			&e->pruned_sg_conn, (struct gsl_key_vector *)e->gkv,
+			&e->open_data);
+		e->graph->open_timing.acdb_open_data_us =
+			(uint32_t)(ar_timer_get_time_in_us() - t_us);
+		if (rc) {
+			GSL_ERR("prepare open of gkv %d of batch failed %d", i, rc);
+			goto unwind;
+		}
+	}
+
+	i = 0;
+	while (i < num_graphs) {
+		if (!gsl_graph_batch_needs_open(&ents[i])) {
+			j = i + 1;
+			t_us = 0; /**< nothing to open on SPF */
+		} else {
+			for (j = i + 1; j < num_graphs; ++j) {
+				if (!gsl_graph_batch_needs_open(&ents[j]) ||
+					ents[j].graph->proc_id != ents[i].graph->proc_id)
+					break;
+			}
+			t_us = ar_timer_get_time_in_us();
+			rc = gsl_graph_batch_send_open(ents, i, j - i);
+			t_us = ar_timer_get_time_in_us() - t_us;
+			if (rc)
+				goto unwind;
+		}
+
+		/* the graphs of a run share the time of the single open */
+		for (; i < j; ++i) {
+			ents[i].opened = ents[i].gkv_node != NULL;
+			if (ents[i].opened)
+				ents[i].graph->open_timing.spf_open_us = (uint32_t)t_us;
+		}
+	}
+
+	/*
+	 * cal is set before the GKV and CKV are added to the gkv node, as in
+	 * gsl_graph_open_single_gkv, so ACDB sees an empty prior CKV
+	 */
+	for (i = 0; i < num_graphs; ++i) {
+		e = &ents[i];
+		if (!e->gkv_node)
+			continue;
+		t_us = ar_timer_get_time_in_us();
+		rc = gsl_graph_set_open_cal(e->graph, e->gkv_node, &e->pruned_sgids,
+			(struct gsl_key_vector *)e->ckv);
+		e->graph->open_timing.cal_us =
+			(uint32_t)(ar_timer_get_time_in_us() - t_us);
+		if (rc) {
+			GSL_ERR("set sg cal failed for gkv %d of batch: %d", i, rc);
+			goto unwind;
+		}
+	}
+
+	t_us = ar_timer_get_time_in_us();
+	for (i = 0; i < num_graphs; ++i) {
+		e = &ents[i];
+		if (e->gkv_node) {
+			gsl_graph_update_gkv_node(e->gkv_node, e->gkv, e->ckv);
+			gsl_graph_add_gkv_to_list(e->graph, e->gkv_node);
+		}
+		gsl_graph_batch_free_lists(e);
+		e->graph->open_timing.total_us = (uint32_t)(t_us - start_us);
+	}
+	GSL_MUTEX_UNLOCK(lock);
+
+	gsl_mem_free(ents);
+	return rc;
+
+unwind:
+	/*
+	 * The batch is all or nothing. Close what was opened in reverse order so
+	 * SGs shared between graphs of the batch are closed on Spf once their
+	 * last user is gone, we ignore RC of close fail and keep the original
+	 * error
+	 */
+	i = num_graphs;
+	while (i-- > 0) {
+		e = &ents[i];
+		if (e->opened) {
+			gsl_graph_close_single_gkv(e->graph, e->gkv_node, 0, NULL, NULL,
+				NULL, 0);
+		} else if (e->in_pool) {
+			gsl_graph_remove_gkv_from_pool(e->gkv_node);
+		}
+		gsl_graph_batch_free_lists(e);
+		gsl_graph_update_state(e->graph, GRAPH_IDLE);
+	}
+	GSL_MUTEX_UNLOCK(lock);
+
+free_entries:
+	for (i = 0; i < num_graphs; ++i) {
+		if (ents[i].registered)
+			__gpr_cmd_deregister(ents[i].graph->src_port);
+		gsl_mem_free(ents[i].gkv_node);
+	}
+	gsl_mem_free(ents);
+	return rc;
+}
+
 int32_t gsl_graph_close(struct gsl_graph *graph, ar_osal_mutex_t lock)
 {
 	ar_list_node_t *curr = NULL;
@@ -4693,8 +5836,8 @@ int32_t gsl_graph_change(struct gsl_graph *graph,
 			goto cleanup;
 		}
 
-		for (i = 0; i < existing_sgids.len; ++i)
-			gkv_node->sg_array[i] = gsl_sg_pool_find(existing_sgids.sg_ids[i]);
+		gsl_sg_pool_find_list(existing_sgids.sg_ids, existing_sgids.len,
+			gkv_node->sg_array);
 
 		gkv_node->sg_conn_data.subgraphs = existing_sg_conn.subgraphs;
 		gkv_node->sg_conn_data.size = existing_sg_conn.size;
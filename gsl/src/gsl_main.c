@@ -37,6 +37,7 @@
 #include "apm_graph_properties.h"
 #include <string.h>
 #include <stdio.h>
+#include <stdatomic.h>
 
 #if defined(GSL_LOG_PKT_ENABLE) || defined(GSL_LOG_DATA_ENABLE)
 ar_fhandle pkt_log_fd = NULL;
@@ -54,14 +55,23 @@ ar_osal_mutex_t log_mutex;
  */
 #define GSL_MINOR_VERSION 0
 
-/** max. number of use-case graphs, initialize to 16 */
-#define MAX_UC_GRAPHS 16
 #define GSL_MAGIC_WORD  0x47534C  /* 'GSL' */
 #define GSL_MAGIC_WORD_MASK  0xFFFFFF
 #define GSL_GRAPH_IDX_SHIFT 24
 #define GSL_GRAPH_SRC_PORT_MIN  0x2010
 #define GSL_GRAPH_SRC_PORT_MAX  0x2100
 
+/**
+ * max. number of use-case graphs, bounded by the GPR source ports reserved
+ * for graphs so that every graph gets its own port. The graph list is
+ * allocated once at this size so that it never moves and handles can be
+ * looked up without a lock
+ */
+#define MAX_UC_GRAPHS \
+	(GSL_GRAPH_SRC_PORT_MAX - GSL_GRAPH_SRC_PORT_MIN + 1)
+_Static_assert(MAX_UC_GRAPHS <= 255,
+	"graph index must fit in the 8 bits of a handle");
+
 #define get_src_port(i)  ((((i) + GSL_GRAPH_SRC_PORT_MIN) > \
 				GSL_GRAPH_SRC_PORT_MAX) ? \
 				GSL_GRAPH_SRC_PORT_MIN : ((i) + GSL_GRAPH_SRC_PORT_MIN))
@@ -79,18 +89,23 @@ struct gsl_rtgm_state_info {
 	 * when non-zero it means rtgm operation is in progress
 	 * QACT sends all prepares then all change
 	 */
-	uint32_t num_rtgm_in_prog;
+	atomic_uint num_rtgm_in_prog;
 
 	/*
-	 * when true it means non-rtgm client operation is in progress such as
-	 * read/write or set_cfg
+	 * number of non-rtgm client operations in progress such as read/write or
+	 * set_cfg
 	 */
-	bool_t client_op_in_prog;
+	atomic_uint num_client_ops;
 
 	/*
-	 * signal to tell waiting rtgm operation when it is safe to proceed
+	 * signal to tell blocked client operations that rtgm is done
 	 */
 	struct gsl_signal sig;
+
+	/*
+	 * signal to tell waiting rtgm operation when it is safe to proceed
+	 */
+	struct gsl_signal client_op_done_sig;
 };
 
 struct gsl_acdb_client_info {
@@ -102,7 +117,7 @@ struct gsl_acdb_client_info {
 };
 
 static struct gsl_ctxt_ {
-	void **graph_list; /**< list of all graphs, one per GSL handle */
+	_Atomic(void *) *graph_list; /**< list of all graphs, one per GSL handle */
 	uint8_t graph_list_size; /**< size of graph list */
 	uint32_t num_graphs; /**< number of active graphs */
 	ar_osal_mutex_t open_close_lock;
@@ -146,75 +161,118 @@ static bool_t is_valid_gsl_hdl(gsl_handle_t hdl)
 	return 1;
 }
 
+/*
+ * Client operations and RTGM exclude each other through two counters. A
+ * client operation announces itself in num_client_ops before it checks
+ * num_rtgm_in_prog, and RTGM announces itself in num_rtgm_in_prog before it
+ * checks num_client_ops. Both use sequentially consistent atomics, so at
+ * least one side always sees the other. While no RTGM is pending a client
+ * operation takes no lock and sets no signal.
+ */
+
+/*
+ * Clears "client_operation_in_progress" state, must only be called after
+ * the client operation was started successfully
+ */
+static void gsl_main_end_client_op(struct gsl_ctxt_ *ctxt)
+{
+	struct gsl_rtgm_state_info *info = &ctxt->rtgm_state_info;
+
+	if (atomic_fetch_sub(&info->num_client_ops, 1) == 1 &&
+		atomic_load(&info->num_rtgm_in_prog) > 0)
+		gsl_signal_set(&info->client_op_done_sig,
+			GSL_SIG_EVENT_CLIENT_OP_DONE, 0, NULL);
+}
+
 /*
  * If RTGM is in progrss returns failure. Otherwise sets the rtgm_state_info to
  * "clint_operation_in_progress" and returns success
  */
 static bool_t gsl_main_start_client_op(struct gsl_ctxt_ *ctxt)
 {
-	GSL_MUTEX_LOCK(ctxt->graph_hdl_lock);
-	if (ctxt->rtgm_state_info.num_rtgm_in_prog > 0) {
-		GSL_MUTEX_UNLOCK(ctxt->graph_hdl_lock);
-		return false;
-	}
-	ctxt->rtgm_state_info.client_op_in_prog = true;
-	GSL_MUTEX_UNLOCK(ctxt->graph_hdl_lock);
-	return true;
+	struct gsl_rtgm_state_info *info = &ctxt->rtgm_state_info;
+
+	atomic_fetch_add(&info->num_client_ops, 1);
+	if (atomic_load(&info->num_rtgm_in_prog) == 0)
+		return true;
+
+	gsl_main_end_client_op(ctxt);
+	return false;
 }
 
 static int32_t gsl_main_start_client_op_blocking(struct gsl_ctxt_ *ctxt)
 {
+	struct gsl_rtgm_state_info *info = &ctxt->rtgm_state_info;
 	int32_t rc = AR_EOK;
 	uint32_t ev_flags = 0;
 
-	GSL_MUTEX_LOCK(ctxt->graph_hdl_lock);
 	/* if RTGM is in-progress block */
-	while (ctxt->rtgm_state_info.num_rtgm_in_prog > 0) {
-		GSL_MUTEX_UNLOCK(ctxt->graph_hdl_lock);
+	while (!gsl_main_start_client_op(ctxt)) {
 		GSL_DBG("blocked due to RTGM");
-		rc = gsl_signal_timedwait(
-			&ctxt->rtgm_state_info.sig,
+		if (atomic_load(&info->num_rtgm_in_prog) == 0)
+			continue;
+
+		rc = gsl_signal_timedwait(&info->sig,
 			GSL_SPF_READ_WRITE_TIMEOUT_MS, &ev_flags, NULL, NULL);
 		if (rc != AR_EOK) {
 			GSL_ERR("signal timed wait returned err %d", rc);
 			return rc;
 		}
-		GSL_MUTEX_LOCK(ctxt->graph_hdl_lock);
 	}
-	ctxt->rtgm_state_info.client_op_in_prog = true;
-	GSL_MUTEX_UNLOCK(ctxt->graph_hdl_lock);
 
 	return rc;
 }
 
+/* Finishes an rtgm operation, unblocks client operations if no more */
+static void gsl_main_end_rtgm(struct gsl_ctxt_ *ctxt)
+{
+	struct gsl_rtgm_state_info *info = &ctxt->rtgm_state_info;
+
+	if (atomic_fetch_sub(&info->num_rtgm_in_prog, 1) == 1)
+		gsl_signal_set(&info->sig, GSL_SIG_EVENT_MASK_RTGM_DONE, 0, NULL);
+}
+
 /*
- * Clears "client_operation_in_progress" state if it was set
+ * Blocks new client operations and waits for the ones in progress to
+ * complete before RTGM starts
  */
-static void gsl_main_end_client_op(struct gsl_ctxt_ *ctxt)
+static int32_t gsl_main_start_rtgm(struct gsl_ctxt_ *ctxt)
 {
-	GSL_MUTEX_LOCK(ctxt->graph_hdl_lock);
-	ctxt->rtgm_state_info.client_op_in_prog = false;
-	gsl_signal_set(&ctxt->rtgm_state_info.sig, GSL_SIG_EVENT_CLIENT_OP_DONE,
-		0, NULL);
-	GSL_MUTEX_UNLOCK(ctxt->graph_hdl_lock);
+	struct gsl_rtgm_state_info *info = &ctxt->rtgm_state_info;
+	int32_t rc = AR_EOK;
+	uint32_t ev_flags = 0;
+
+	atomic_fetch_add(&info->num_rtgm_in_prog, 1);
+	while (atomic_load(&info->num_client_ops) > 0) {
+		rc = gsl_signal_timedwait(&info->client_op_done_sig,
+			GSL_SPF_TIMEOUT_MS, &ev_flags, NULL, NULL);
+		if (rc) {
+			GSL_ERR("signal timedwait failed %d", rc);
+			gsl_main_end_rtgm(ctxt);
+			break;
+		}
+	}
+
+	return rc;
 }
 
+/*
+ * The graph list is never reallocated, so a handle is looked up with a
+ * single atomic load instead of taking graph_hdl_lock
+ */
 static struct gsl_graph *to_gsl_graph(gsl_handle_t graph_handle)
 {
-	struct gsl_graph *graph = NULL;
-
-	GSL_MUTEX_LOCK(gsl_ctxt.graph_hdl_lock);
+	uint8_t i;
 
 	if (!is_valid_gsl_hdl(graph_handle))
-		goto cleanup;
+		return NULL;
 
-	graph = (struct gsl_graph *)
-		gsl_ctxt.graph_list[to_gsl_graph_index(graph_handle)];
+	i = to_gsl_graph_index(graph_handle);
+	if (i >= gsl_ctxt.graph_list_size)
+		return NULL;
 
-cleanup:
-	GSL_MUTEX_UNLOCK(gsl_ctxt.graph_hdl_lock);
-
-	return graph;
+	return (struct gsl_graph *)atomic_load_explicit(&gsl_ctxt.graph_list[i],
+		memory_order_acquire);
 }
 
 /** callback handles RTC callbacks */
@@ -286,19 +344,11 @@ static int32_t gsl_rtc_callback(enum gsl_rtc_request_type req, void *cb_data)
 		 * check that no other client operation is in progress before starting
 		 * RTGM, if it is then wait for it to complete
 		 */
-		GSL_MUTEX_LOCK(gsl_ctxt.graph_hdl_lock);
-		while (gsl_ctxt.rtgm_state_info.client_op_in_prog) {
-			GSL_MUTEX_UNLOCK(gsl_ctxt.graph_hdl_lock);
-			rc = gsl_signal_timedwait(&gsl_ctxt.rtgm_state_info.sig,
-				GSL_SPF_TIMEOUT_MS, &ev_flags, NULL, NULL);
-			if (rc) {
-				GSL_ERR("signal timedwait failed %d", rc);
-				goto exit;
-			}
-			GSL_MUTEX_LOCK(gsl_ctxt.graph_hdl_lock);
-		}
-		++gsl_ctxt.rtgm_state_info.num_rtgm_in_prog;
-		GSL_MUTEX_UNLOCK(gsl_ctxt.graph_hdl_lock);
+		rc = gsl_main_start_rtgm(&gsl_ctxt);
+		if (rc)
+			goto exit;
+		/* the changed graph is reopened from the updated ACDB data */
+		gsl_graph_cache_invalidate();
 
 		GSL_MUTEX_LOCK(gsl_ctxt.open_close_lock);
 		prep_change_graph_params = (struct gsl_rtc_prepare_change_graph_info *)
@@ -403,13 +453,9 @@ static int32_t gsl_rtc_callback(enum gsl_rtc_request_type req, void *cb_data)
 		GSL_MUTEX_UNLOCK(gsl_ctxt.open_close_lock);
 
 		/* Decrement counter to finish this rtgm operation. Signal if no more */
-		GSL_MUTEX_LOCK(gsl_ctxt.graph_hdl_lock);
-		if (--gsl_ctxt.rtgm_state_info.num_rtgm_in_prog == 0)
-			gsl_signal_set(&gsl_ctxt.rtgm_state_info.sig,
-				GSL_SIG_EVENT_MASK_RTGM_DONE, 0, NULL);
+		gsl_main_end_rtgm(&gsl_ctxt);
 		GSL_ERR("tvl end of RTGM, num in prog: %d",
-			gsl_ctxt.rtgm_state_info.num_rtgm_in_prog);
-		GSL_MUTEX_UNLOCK(gsl_ctxt.graph_hdl_lock);
+			atomic_load(&gsl_ctxt.rtgm_state_info.num_rtgm_in_prog));
 		break;
 
 	case GSL_RTC_CONN_INFO_CHANGE:
@@ -417,6 +463,16 @@ static int32_t gsl_rtc_callback(enum gsl_rtc_request_type req, void *cb_data)
 		rtc_conn_info = (struct gsl_rtc_conn_info *)cb_data;
 		switch (rtc_conn_info->state) {
 		case GSL_RTC_CONNECTION_STATE_START:
+			/*
+			 * graphs only log while RTC is connected, so start logging off
+			 * the caller's thread on the first connection. No graph logs
+			 * yet, graphs are flagged to log under open_close_lock. The
+			 * drain thread runs until gsl_deinit
+			 */
+			rc = ar_data_log_async_start(NULL);
+			if (rc && rc != AR_EALREADY)
+				GSL_DBG("ar data logging stays synchronous %d", rc);
+			rc = AR_EOK;
 			gsl_ctxt.rtc_conn_active = true;
 			break;
 		case GSL_RTC_CONNECTION_STATE_STOP:
@@ -456,6 +512,8 @@ static int32_t gsl_rtc_callback(enum gsl_rtc_request_type req, void *cb_data)
 			else
 				rc = gsl_rtc_graph_set_persist_data(graph,
 					rtc_persist_cal_data);
+			if (req == GSL_RTC_SET_PERSIST_DATA)
+				gsl_graph_cache_invalidate();
 		} else if ((req == GSL_RTC_GET_NON_PERSIST_DATA) ||
 			(req == GSL_RTC_SET_NON_PERSIST_DATA)) {
 			rtc_cal_data = (struct gsl_rtc_param *)cb_data;
@@ -471,6 +529,8 @@ static int32_t gsl_rtc_callback(enum gsl_rtc_request_type req, void *cb_data)
 			else
 				rc = gsl_rtc_graph_set_non_persist_data(graph,
 					rtc_cal_data->total_size, rtc_cal_data->sg_cal_data);
+			if (req == GSL_RTC_SET_NON_PERSIST_DATA)
+				gsl_graph_cache_invalidate();
 		} else {
 			rc = AR_EFAILED;
 		}
@@ -647,7 +707,6 @@ static uint32_t gsl_main_gpr_callback(gpr_packet_t *packet, void *cb_data)
 
 static gsl_handle_t get_graph_handle(struct gsl_graph *graph)
 {
-	void **tmp;
 	gsl_handle_t hdl = 0;
 	uint8_t i;
 
@@ -658,15 +717,8 @@ static gsl_handle_t get_graph_handle(struct gsl_graph *graph)
 			break;
 	}
 	if (i == gsl_ctxt.graph_list_size) {
-		tmp = gsl_mem_realloc(gsl_ctxt.graph_list,
-			sizeof(void *) * ((size_t)gsl_ctxt.graph_list_size),
-			sizeof(void *) * ((size_t)gsl_ctxt.graph_list_size +
-			(MAX_UC_GRAPHS >> 1)));
-		if (!tmp)
-			goto exit;
-
-		gsl_ctxt.graph_list_size +=  (MAX_UC_GRAPHS >> 1);
-		gsl_ctxt.graph_list = tmp;
+		GSL_ERR("no free graph handle, %d graphs open", gsl_ctxt.num_graphs);
+		goto exit;
 	}
 
 	hdl = to_gsl_handle(i);
@@ -975,14 +1027,25 @@ int32_t gsl_init(struct gsl_init_data *init_data)
 		goto deinit_sgpool;
 	}
 
+	rc = gsl_graph_cache_init();
+	if (rc) {
+		GSL_ERR("gsl_graph_cache_init failed %d", rc);
+		goto deinit_gpcpool;
+	}
+
+	rc = gsl_graph_cal_prefetch_init();
+	if (rc)
+		GSL_DBG("cal prefetch init failed %d, cal is not prefetched", rc);
+	rc = AR_EOK;
+
 	ar_list_init(&gsl_ctxt.acdb_client_list, NULL, NULL);
 	ar_osal_mutex_create(&gsl_ctxt.acdb_client_lock);
 	gsl_ctxt.graph_list_size = MAX_UC_GRAPHS;
 	gsl_ctxt.graph_list = gsl_mem_zalloc(gsl_ctxt.graph_list_size *
-				sizeof(void *));
+				sizeof(*gsl_ctxt.graph_list));
 	if (!gsl_ctxt.graph_list) {
 		rc = AR_ENOMEMORY;
-		goto deinit_gpcpool;
+		goto deinit_graph_cache;
 	}
 
 	gsl_ctxt.num_graphs = 0;
@@ -1029,14 +1092,21 @@ int32_t gsl_init(struct gsl_init_data *init_data)
 		GSL_ERR("signal create failed %d", rc);
 		goto destroy_rsp_signal;
 	}
-	gsl_ctxt.rtgm_state_info.client_op_in_prog = false;
-	gsl_ctxt.rtgm_state_info.num_rtgm_in_prog = 0;
+
+	rc = gsl_signal_create(&gsl_ctxt.rtgm_state_info.client_op_done_sig,
+		NULL);
+	if (rc) {
+		GSL_ERR("signal create failed %d", rc);
+		goto destroy_rtgm_state_signal;
+	}
+	atomic_store(&gsl_ctxt.rtgm_state_info.num_client_ops, 0);
+	atomic_store(&gsl_ctxt.rtgm_state_info.num_rtgm_in_prog, 0);
 
 	rc = __gpr_cmd_register(GSL_MAIN_SRC_PORT, gsl_main_gpr_callback,
 		&gsl_ctxt);
 	if (rc) {
 		GSL_ERR("gpr register failed");
-		goto destroy_rtgm_state_signal;
+		goto destroy_client_op_done_signal;
 	}
 
 	rc = gsl_mdf_utils_init();
@@ -1170,6 +1240,8 @@ mdf_utils_deinit:
 	gsl_mdf_utils_deinit();
 gpr_deregister:
 	__gpr_cmd_deregister(GSL_MAIN_SRC_PORT);
+destroy_client_op_done_signal:
+	gsl_signal_destroy(&gsl_ctxt.rtgm_state_info.client_op_done_sig);
 destroy_rtgm_state_signal:
 	gsl_signal_destroy(&gsl_ctxt.rtgm_state_info.sig);
 destroy_rsp_signal:
@@ -1185,6 +1257,9 @@ destroy_open_close_lock:
 	ar_osal_mutex_destroy(gsl_ctxt.open_close_lock);
 free_graph_list:
 	gsl_mem_free(gsl_ctxt.graph_list);
+deinit_graph_cache:
+	gsl_graph_cal_prefetch_deinit();
+	gsl_graph_cache_deinit();
 deinit_gpcpool:
 	gsl_global_persist_cal_pool_deinit();
 deinit_sgpool:
@@ -1238,11 +1313,14 @@ void gsl_deinit(void)
 		gsl_mem_free(master_procs);
 	}
 	acdb_deinit();
+	gsl_graph_cal_prefetch_deinit();
+	gsl_graph_cache_deinit();
 	gsl_global_persist_cal_pool_deinit();
 	gsl_sg_pool_deinit();
 	__gpr_cmd_deregister(GSL_MAIN_SRC_PORT);
 	gsl_signal_destroy(&gsl_ctxt.rsp_signal);
 	gsl_signal_destroy(&gsl_ctxt.rtgm_state_info.sig);
+	gsl_signal_destroy(&gsl_ctxt.rtgm_state_info.client_op_done_sig);
 	gsl_dp_destroy_cache_refcount_lock();
 	ar_osal_mutex_destroy(gsl_ctxt.open_close_lock);
 	ar_osal_mutex_destroy(gsl_ctxt.start_stop_lock);
@@ -1264,32 +1342,16 @@ int32_t gsl_register_global_event_cb(gsl_global_cb_func_ptr global_cb,
 	return AR_EOK;
 }
 
-int32_t gsl_open(const struct gsl_key_vector *graph_key_vect,
-	const struct gsl_key_vector *cal_key_vect, gsl_handle_t *graph_handle)
+/*
+ * Restores the state of any master proc that restarted since the last graph
+ * open, before new graphs are opened on it
+ */
+static void gsl_handle_spf_restart(void)
 {
 	int32_t rc = AR_EOK;
-	struct gsl_graph *graph = NULL;
-	gsl_handle_t hdl = 0;
 	uint32_t supported_ss_mask = 0;
 	bool_t is_shmem_supported = TRUE;
 	uint8_t i = 0;
-	int32_t ss_retry_count = 10;
-
-	if (graph_handle == NULL)
-		return AR_EBADPARAM;
-
-	GSL_PKT_LOG_OPEN(AR_FOPEN_WRITE_ONLY_APPEND);
-
-	graph = gsl_mem_zalloc(sizeof(struct gsl_graph));
-	if (graph == NULL)
-		return AR_ENOMEMORY;
-
-	/** get graph handle and assign a source port */
-	hdl = get_graph_handle(graph);
-	if (!hdl) {
-		rc = AR_ENOMEMORY;
-		goto cleanup;
-	}
 
 	for (i = AR_SUB_SYS_ID_FIRST; i <= AR_SUB_SYS_ID_LAST; i++) {
 		GSL_MUTEX_LOCK(gsl_ctxt.open_close_lock);
@@ -1326,6 +1388,33 @@ int32_t gsl_open(const struct gsl_key_vector *graph_key_vect,
 		}
 		GSL_MUTEX_UNLOCK(gsl_ctxt.open_close_lock);
 	}
+}
+
+int32_t gsl_open(const struct gsl_key_vector *graph_key_vect,
+	const struct gsl_key_vector *cal_key_vect, gsl_handle_t *graph_handle)
+{
+	int32_t rc = AR_EOK;
+	struct gsl_graph *graph = NULL;
+	gsl_handle_t hdl = 0;
+	int32_t ss_retry_count = 10;
+
+	if (graph_handle == NULL)
+		return AR_EBADPARAM;
+
+	GSL_PKT_LOG_OPEN(AR_FOPEN_WRITE_ONLY_APPEND);
+
+	graph = gsl_mem_zalloc(sizeof(struct gsl_graph));
+	if (graph == NULL)
+		return AR_ENOMEMORY;
+
+	/** get graph handle and assign a source port */
+	hdl = get_graph_handle(graph);
+	if (!hdl) {
+		rc = AR_ENOMEMORY;
+		goto cleanup;
+	}
+
+	gsl_handle_spf_restart();
 
     /*
      * Initialize graph instance and register to GPR to
@@ -1376,6 +1465,103 @@ cleanup:
 	return rc;
 }
 
+int32_t gsl_open_batch(struct gsl_open_batch_entry *entries,
+	uint32_t num_entries)
+{
+	int32_t rc = AR_EOK;
+	struct gsl_graph **graphs = NULL;
+	const struct gsl_key_vector **gkvs = NULL, **ckvs = NULL;
+	gsl_handle_t *hdls = NULL;
+	uint32_t i, num_allocated = 0, num_inited = 0;
+	int32_t ss_retry_count = 10;
+
+	if (!entries || num_entries == 0)
+		return AR_EBADPARAM;
+
+	graphs = gsl_mem_zalloc(num_entries * (sizeof(*graphs) + sizeof(*gkvs) +
+		sizeof(*ckvs) + sizeof(*hdls)));
+	if (!graphs)
+		return AR_ENOMEMORY;
+	gkvs = (const struct gsl_key_vector **)(graphs + num_entries);
+	ckvs = gkvs + num_entries;
+	hdls = (gsl_handle_t *)(ckvs + num_entries);
+
+	for (i = 0; i < num_entries; ++i) {
+		gkvs[i] = entries[i].graph_key_vect;
+		ckvs[i] = entries[i].cal_key_vect;
+		entries[i].graph_handle = NULL;
+
+		GSL_PKT_LOG_OPEN(AR_FOPEN_WRITE_ONLY_APPEND);
+		graphs[i] = gsl_mem_zalloc(sizeof(struct gsl_graph));
+		if (!graphs[i]) {
+			GSL_PKT_LOG_CLOSE();
+			rc = AR_ENOMEMORY;
+			goto cleanup;
+		}
+
+		/** get graph handle and assign a source port */
+		hdls[i] = get_graph_handle(graphs[i]);
+		++num_allocated;
+		if (!hdls[i]) {
+			rc = AR_ENOMEMORY;
+			goto cleanup;
+		}
+	}
+
+	gsl_handle_spf_restart();
+
+	GSL_MUTEX_LOCK(gsl_ctxt.graph_hdl_lock);
+	for (; num_inited < num_entries; ++num_inited) {
+		rc = gsl_graph_init(graphs[num_inited]);
+		if (rc)
+			break;
+	}
+	GSL_MUTEX_UNLOCK(gsl_ctxt.graph_hdl_lock);
+	if (rc) {
+		GSL_ERR("graph_init failed %d", rc);
+		goto cleanup;
+	}
+
+	while (ss_retry_count--) {
+		rc = gsl_graph_open_batch(graphs, gkvs, ckvs, num_entries,
+			gsl_ctxt.open_close_lock);
+		if (AR_ESUBSYSRESET == rc) {
+			GSL_INFO("wait subsystem online, remaining retry count: %d", ss_retry_count);
+			ar_osal_micro_sleep(GSL_TIMEOUT_US(GSL_SS_RETRY_MS));
+			continue;
+		} else if (rc) {
+			GSL_ERR("graph_open_batch failed %d", rc);
+			goto cleanup;
+		}
+		break;
+	}
+	if (AR_ESUBSYSRESET == rc)
+		goto cleanup;
+
+	for (i = 0; i < num_entries; ++i) {
+		entries[i].graph_handle = hdls[i];
+		if (gsl_ctxt.rtc_conn_active)
+			graphs[i]->rtc_conn_active = true;
+	}
+	gsl_mem_free(graphs);
+
+	return rc;
+
+cleanup:
+	GSL_MUTEX_LOCK(gsl_ctxt.graph_hdl_lock);
+	for (i = 0; i < num_inited; ++i)
+		gsl_graph_deinit(graphs[i]);
+	GSL_MUTEX_UNLOCK(gsl_ctxt.graph_hdl_lock);
+	for (i = 0; i < num_allocated; ++i) {
+		if (hdls[i])
+			release_graph_handle(hdls[i]);
+		gsl_mem_free(graphs[i]);
+		GSL_PKT_LOG_CLOSE();
+	}
+	gsl_mem_free(graphs);
+	return rc;
+}
+
 int32_t gsl_close(gsl_handle_t graph_handle)
 {
 	int32_t rc = AR_EOK;
@@ -1387,8 +1573,10 @@ int32_t gsl_close(gsl_handle_t graph_handle)
 		return rc;
 
 	graph = to_gsl_graph(graph_handle);
-	if (!graph)
+	if (!graph) {
+		gsl_main_end_client_op(&gsl_ctxt);
 		return AR_EBADPARAM;
+	}
 
 	/** Stop graph if not already done */
 	rc = gsl_graph_stop(graph, gsl_ctxt.start_stop_lock);
@@ -1692,8 +1880,18 @@ int32_t gsl_ioctl(gsl_handle_t graph_handle,
 	struct gsl_cmd_graph_select *ag = NULL, *cg = NULL;
 	struct gsl_cmd_remove_graph *rg = NULL;
 
-	if (!gsl_main_start_client_op(&gsl_ctxt)) {
-		rc = AR_ENOTREADY;
+	if (!gsl_main_start_client_op(&gsl_ctxt))
+		return AR_ENOTREADY;
+
+	/* the graph cache is global, graph_handle is ignored */
+	if (cmd_id == GSL_CMD_GET_GRAPH_CACHE_STATS) {
+		if (!cmd_payload ||
+			cmd_payload_sz < sizeof(struct gsl_cmd_graph_cache_stats)) {
+			rc = AR_EBADPARAM;
+			goto exit;
+		}
+		gsl_graph_cache_get_stats(
+			(struct gsl_cmd_graph_cache_stats *)cmd_payload);
 		goto exit;
 	}
 
@@ -1925,6 +2123,16 @@ int32_t gsl_ioctl(gsl_handle_t graph_handle,
 		if (rc)
 			GSL_ERR("close with properties ioctl failed %d", rc);
 		break;
+	case GSL_CMD_GET_OPEN_TIMING:
+		if (!cmd_payload ||
+			cmd_payload_sz < sizeof(struct gsl_cmd_open_timing)) {
+			rc = AR_EBADPARAM;
+			break;
+		}
+		gsl_graph_get_open_timing(graph,
+			(struct gsl_cmd_open_timing *)cmd_payload,
+			gsl_ctxt.open_close_lock);
+		break;
 
 	case GSL_CMD_QUERY_GRAPH_DELAY:
 	case GSL_CMD_MAX:
@@ -2102,8 +2310,12 @@ int32_t gsl_get_tags_with_module_info(
 
 int32_t gsl_enable_acdb_persistence(uint8_t enable_flag)
 {
-	return acdb_ioctl(ACDB_CMD_ENABLE_PERSISTANCE, &enable_flag,
+	int32_t rc = AR_EOK;
+
+	rc = acdb_ioctl(ACDB_CMD_ENABLE_PERSISTANCE, &enable_flag,
 		sizeof(enable_flag), NULL, 0);
+
+	return rc;
 }
 
 int32_t gsl_set_cal_data_to_acdb(
@@ -2242,6 +2454,7 @@ int32_t gsl_set_temp_path_to_acdb(uint32_t path_length, const char_t *temp_path)
 
 	rc = acdb_ioctl(ACDB_CMD_SET_TEMP_PATH, &cmd_struct,
 		sizeof(cmd_struct), NULL, 0);
+	gsl_graph_cache_invalidate();
 	if (rc)
 		GSL_ERR("acdb set temp path failed with %d", rc);
 
@@ -21,6 +21,9 @@
 #include "gpr_ids_domains.h"
 #include "gpr_api_inline.h"
 #include "gsl_spf_ss_state.h"
+#ifdef GSL_SHMEM_MGR_STATS_ENABLE
+#include "ar_osal_timer.h"
+#endif
 
 /**
  * all pages must have size that is a multiple of this
@@ -44,6 +47,29 @@
 #define GSL_SHMEM_MGR_CONVERT_BYTES_TO_FRAMES(size_bytes)\
 ((size_bytes) >> GSL_SHMEM_MGR_FRAME_SZ_SHIFT)
 
+/**
+ * free frames of a scratch page are tracked in a 32 bit mask, so scratch
+ * pages can hold at most 32 frames
+ */
+#define GSL_SHMEM_MGR_MAX_FRAMES_PER_PAGE 32
+#if GSL_SHMEM_MGR_CONVERT_BYTES_TO_FRAMES(GSL_SHMEM_PRE_ALLOC_SIZE) > \
+	GSL_SHMEM_MGR_MAX_FRAMES_PER_PAGE
+#error "scratch pages must fit in the free frame mask"
+#endif
+
+/**
+ * scratch pages are kept in per-bin free lists keyed by the number of
+ * frames in their largest free run, capped at the largest scratch request.
+ * Class 0 holds full pages and is never linked.
+ */
+#define GSL_SHMEM_MGR_NUM_FREE_CLASSES \
+(GSL_SHMEM_MAX_FRAMES_IN_SCRATCH_ALLOC + 1)
+
+/** mask with the lowest num_frames bits set */
+#define GSL_SHMEM_MGR_FRAME_MASK(num_frames) \
+((num_frames) >= GSL_SHMEM_MGR_MAX_FRAMES_PER_PAGE ? 0xFFFFFFFFU : \
+((1U << (num_frames)) - 1))
+
 /**
  * number of bins
  */
@@ -80,16 +106,6 @@ struct gsl_shmem_block {
 	 * FREE = 0
 	 */
 	uint32_t size_bytes;
-	/**
-	 * index of the preceeding block, used in merge operation
-	 * -1 indicates there is no predecessor
-	 */
-	int16_t predecessor_idx;
-	/**
-	 * index of the successor block, used in merge operation
-	 * -1 indicates there is no successor
-	 */
-	int16_t successor_idx;
 #ifdef GSL_SHMEM_MGR_STATS_ENABLE
 	/**
 	 * Actual size that was requested by client for this block, this might be
@@ -100,8 +116,18 @@ struct gsl_shmem_block {
 
 };
 
+/**
+ * blocks[] of a page is indexed by the frame the block starts at, so a block
+ * is found from its address and a new block never needs a spare entry
+ */
 struct gsl_shmem_page {
 	ar_list_node_t node;
+	/** links the page into the free list of its bin, scratch pages only */
+	ar_list_node_t free_node;
+	/** bit n is set when frame n is free, scratch pages only */
+	uint32_t free_frame_mask;
+	/** free list class the page is linked in, 0 if not linked */
+	uint32_t free_class;
 	/** size of this page */
 	uint32_t size_bytes;
 	/** maximum number of blocks */
@@ -130,6 +156,13 @@ struct gsl_shmem_bin {
 	uint32_t num_pages;
 	/** holds the page metadata objects for this bin, one per page */
 	struct ar_list_t page_list;
+	/**
+	 * free lists of the scratch pages in this bin, indexed by the frames in
+	 * the largest free run of the page
+	 */
+	struct ar_list_t free_lists[GSL_SHMEM_MGR_NUM_FREE_CLASSES];
+	/** bit n is set when free_lists[n] is not empty */
+	uint32_t free_class_mask;
 };
 
 struct gsl_shmem_mgr_ctxt {
@@ -195,6 +228,27 @@ static struct gsl_shmem_stats {
 	 * size in bytes of peak memory requested by client
 	 */
 	uint32_t max_bytes_requested;
+	/**
+	 * size in bytes of free frames in scratch pages
+	 */
+	uint32_t curr_bytes_free_scratch;
+	/**
+	 * number of scratch allocations that mapped a new page even though the
+	 * scratch pages had enough free frames, because none of the free runs
+	 * was long enough
+	 */
+	uint32_t num_fragmented_allocs;
+	/**
+	 * number of allocations and frees
+	 */
+	uint32_t num_allocs;
+	uint32_t num_frees;
+	/**
+	 * latency in microseconds of the slowest allocation and free, including
+	 * the time spent waiting for the lock and mapping pages to Spf
+	 */
+	uint32_t max_alloc_time_us;
+	uint32_t max_free_time_us;
 } stats;
 #endif
 
@@ -549,6 +603,74 @@ exit:
 	return rc;
 }
 
+/** returns the index of the lowest set bit, mask must not be 0 */
+static uint32_t gsl_shmem_lowest_bit(uint32_t mask)
+{
+	static const uint8_t debruijn_bit_idx[32] = {
+		0, 1, 28, 2, 29, 14, 24, 3, 30, 22, 20, 15, 25, 17, 4, 8,
+		31, 27, 13, 23, 21, 19, 16, 7, 26, 12, 18, 6, 11, 5, 10, 9
+	};
+
+	return debruijn_bit_idx[((mask & (0U - mask)) * 0x077CB531U) >> 27];
+}
+
+/**
+ * returns a mask of the frames that start a run of at least num_frames free
+ * frames
+ */
+static uint32_t gsl_shmem_free_run_starts(uint32_t free_frame_mask,
+	uint32_t num_frames)
+{
+	uint32_t run_starts = free_frame_mask;
+	uint32_t i = 0;
+
+	for (i = 1; i < num_frames && run_starts; ++i)
+		run_starts &= free_frame_mask >> i;
+
+	return run_starts;
+}
+
+/**
+ * moves a scratch page to the free list that matches the largest free run
+ * of the page, must be called whenever free_frame_mask changes
+ */
+static void gsl_shmem_update_free_class(struct gsl_shmem_page *page)
+{
+	struct gsl_shmem_bin *bin =
+		&ctxt[page->master_proc]->bins[page->bin_idx];
+	uint32_t runs = page->free_frame_mask;
+	uint32_t free_class = 0;
+	int32_t rc = AR_EOK;
+
+	/* every step shortens all runs by one frame */
+	while (runs && free_class < GSL_SHMEM_MAX_FRAMES_IN_SCRATCH_ALLOC) {
+		runs &= runs >> 1;
+		++free_class;
+	}
+
+	if (free_class == page->free_class)
+		return;
+
+	if (page->free_class) {
+		rc = ar_list_delete(&bin->free_lists[page->free_class],
+			&page->free_node);
+		if (rc)
+			GSL_ERR("ar_list_delete failed with error %d", rc);
+		if (ar_list_is_empty(&bin->free_lists[page->free_class]))
+			bin->free_class_mask &= ~(1U << page->free_class);
+	}
+
+	if (free_class) {
+		rc = ar_list_add_tail(&bin->free_lists[free_class],
+			&page->free_node);
+		if (rc)
+			GSL_ERR("ar_list_add_tail failed with error %d", rc);
+		bin->free_class_mask |= 1U << free_class;
+	}
+
+	page->free_class = free_class;
+}
+
 /**
  * Allocates a new page of a given size and adds it to the provided bin,
  * it is callers responsibility to ensure that the correct bin_idx is
@@ -655,17 +777,26 @@ static int32_t allocate_page(uint32_t page_size, uint32_t bin_idx,
 		goto unmap_page;
 	}
 
+	rc = ar_list_init_node(&page->free_node);
+	if (rc) {
+		GSL_ERR("ar_list_init_node failed with error %d", rc);
+		goto unmap_page;
+	}
+
 	rc = ar_list_add_tail(&bin->page_list, &page->node);
 	if (rc) {
 		GSL_ERR("ar_list_add_tail failed with error %d", rc);
 		goto unmap_page;
 	}
 
-	/* mark entire page as a single free block */
-	page->blocks[0].base_addr = page->shmem_info.vaddr;
-	page->blocks[0].size_bytes = page_size; /* LSB of size is assumed 0 */
-	page->blocks[0].predecessor_idx = -1;
-	page->blocks[0].successor_idx = -1;
+	/* mark all frames of a scratch page as free */
+	if (bin_idx != GSL_SHMEM_MGR_BIN_IDX_DEDICATED) {
+		page->free_frame_mask = GSL_SHMEM_MGR_FRAME_MASK(max_num_blocks);
+		gsl_shmem_update_free_class(page);
+#ifdef GSL_SHMEM_MGR_STATS_ENABLE
+		stats.curr_bytes_free_scratch += page_size;
+#endif
+	}
 
 	bin->num_pages += 1;
 	*new_page = page;
@@ -740,6 +871,14 @@ static int32_t free_page(int32_t bin_idx,
 			rc1 = rc;
 	}
 
+	if (bin_idx != GSL_SHMEM_MGR_BIN_IDX_DEDICATED) {
+		page->free_frame_mask = 0;
+		gsl_shmem_update_free_class(page);
+#ifdef GSL_SHMEM_MGR_STATS_ENABLE
+		stats.curr_bytes_free_scratch -= page->size_bytes;
+#endif
+	}
+
 #ifdef GSL_SHMEM_MGR_STATS_ENABLE
 	stats.curr_bytes_mapped -= page->size_bytes;
 #endif
@@ -751,125 +890,55 @@ static int32_t free_page(int32_t bin_idx,
 }
 
 static void *do_alloc_block(struct gsl_shmem_page *page,
-	int16_t found_block_idx, uint32_t frame_aligned_sz)
+	uint32_t frame_idx, uint32_t frame_aligned_sz)
 {
-	uint32_t i = 0;
-	int32_t found_block_successor_idx =
-		page->blocks[found_block_idx].successor_idx;
-
-	if (page->blocks[found_block_idx].size_bytes > frame_aligned_sz) {
-		/*
-		 * find available entry in block list and use it for new free block
-		 * Note: max_num_blocks is set to page_size/frame_size,  this ensures
-		 * that there is always an entry available in blocks[] for the worst
-		 * case fragmenation
-		 */
-		for (i = 0; i < page->max_num_blocks; ++i) {
-			if (page->blocks[i].base_addr == NULL) {
-				/* found an available entry, use it as a new free block */
-				page->blocks[i].base_addr =
-					(char *)(page->blocks[found_block_idx].base_addr) +
-					frame_aligned_sz;
-				page->blocks[i].size_bytes =
-					page->blocks[found_block_idx].size_bytes -
-					frame_aligned_sz;
-				/*
-				 * make the successor of the found block point to the new block
-				 */
-				if (found_block_successor_idx != -1)
-					page->blocks[found_block_successor_idx].predecessor_idx =
-						(int16_t) i;
-
-				/* make the new empty block a successor of the found block */
-				page->blocks[i].predecessor_idx = found_block_idx;
-				page->blocks[i].successor_idx =
-					page->blocks[found_block_idx].successor_idx;
-				page->blocks[found_block_idx].successor_idx = (int16_t) i;
-				break;
-			}
-		}
-	}
+	struct gsl_shmem_block *block = &page->blocks[frame_idx];
 
 	/* update used block info and mark it as used */
-	page->blocks[found_block_idx].size_bytes = frame_aligned_sz;
-	page->blocks[found_block_idx].size_bytes |=
+	block->base_addr = (uint8_t *)page->shmem_info.vaddr +
+		(frame_idx << GSL_SHMEM_MGR_FRAME_SZ_SHIFT);
+	block->size_bytes = frame_aligned_sz |
 		GSL_SHMEM_MGR_BLOCK_SZ_USED_BIT_MASK;
 
-	return page->blocks[found_block_idx].base_addr;
+	if (page->bin_idx != GSL_SHMEM_MGR_BIN_IDX_DEDICATED) {
+		page->free_frame_mask &= ~(GSL_SHMEM_MGR_FRAME_MASK(
+			GSL_SHMEM_MGR_CONVERT_BYTES_TO_FRAMES(frame_aligned_sz))
+			<< frame_idx);
+		gsl_shmem_update_free_class(page);
+#ifdef GSL_SHMEM_MGR_STATS_ENABLE
+		stats.curr_bytes_free_scratch -= frame_aligned_sz;
+#endif
+	}
+
+	return block->base_addr;
 }
 
 /**
- * returns the size of the resulting free block after freeing and merging with
- * neighbors
+ * returns true if the page has no used blocks left after the block is freed
  */
-static uint32_t do_free_block(struct gsl_shmem_page *page,
-	uint16_t freed_block_idx)
+static bool_t do_free_block(struct gsl_shmem_page *page,
+	uint32_t freed_block_idx)
 {
-	int16_t successor_idx = page->blocks[freed_block_idx].successor_idx;
-	int16_t predecessor_idx = page->blocks[freed_block_idx].predecessor_idx;
-	int16_t successor_successor_idx = 0;
-	uint32_t resulting_free_block_sz = 0;
-
-	/* found block, mark it as free */
-	page->blocks[freed_block_idx].size_bytes &=
+	struct gsl_shmem_block *block = &page->blocks[freed_block_idx];
+	uint32_t freed_sz = block->size_bytes &
 		~GSL_SHMEM_MGR_BLOCK_SZ_USED_BIT_MASK;
 
-	/*
-	 * if successor is available and marked as free,
-	 * merge successor into freed block
-	 */
-	if ((successor_idx != -1) && !(page->blocks[successor_idx].size_bytes &
-		GSL_SHMEM_MGR_BLOCK_SZ_USED_BIT_MASK)) {
-		successor_successor_idx = page->blocks[successor_idx].successor_idx;
-
-		page->blocks[freed_block_idx].size_bytes +=
-			page->blocks[successor_idx].size_bytes;
-		page->blocks[freed_block_idx].successor_idx = successor_successor_idx;
+	block->base_addr = NULL;
+	block->size_bytes = 0;
 
-		if (successor_successor_idx != -1)
-			page->blocks[successor_successor_idx].predecessor_idx =
-			freed_block_idx;
+	/* dedicated pages only ever hold a single block */
+	if (page->bin_idx == GSL_SHMEM_MGR_BIN_IDX_DEDICATED)
+		return TRUE;
 
-		/* mark successor entry as available */
-		page->blocks[successor_idx].base_addr = NULL;
-		page->blocks[successor_idx].predecessor_idx = -1;
-		page->blocks[successor_idx].successor_idx = -1;
-		page->blocks[successor_idx].size_bytes = 0;
-	}
-
-	/*
-	 * store the size this is the resulting free block size so far
-	 */
-	resulting_free_block_sz = page->blocks[freed_block_idx].size_bytes;
-
-	/*
-	 * if predecessor is availble and marked as free,
-	 * merge freed block into predecessor
-	 */
-	if ((predecessor_idx != -1) && !(page->blocks[predecessor_idx].size_bytes &
-		GSL_SHMEM_MGR_BLOCK_SZ_USED_BIT_MASK)) {
-		page->blocks[predecessor_idx].size_bytes +=
-			page->blocks[freed_block_idx].size_bytes;
-		successor_idx = page->blocks[freed_block_idx].successor_idx;
-		page->blocks[predecessor_idx].successor_idx = successor_idx;
-
-		if (successor_idx != -1)
-			page->blocks[successor_idx].predecessor_idx = predecessor_idx;
-
-		/* mark freed block entry as available */
-		page->blocks[freed_block_idx].base_addr = NULL;
-		page->blocks[freed_block_idx].predecessor_idx = -1;
-		page->blocks[freed_block_idx].successor_idx = -1;
-		page->blocks[freed_block_idx].size_bytes = 0;
-
-		/*
-		 * update resulting free block size to reflect the size of the
-		 * resulting free block after we merged with predecessor
-		 */
-		resulting_free_block_sz = page->blocks[predecessor_idx].size_bytes;
-	}
+	page->free_frame_mask |= GSL_SHMEM_MGR_FRAME_MASK(
+		GSL_SHMEM_MGR_CONVERT_BYTES_TO_FRAMES(freed_sz)) << freed_block_idx;
+	gsl_shmem_update_free_class(page);
+#ifdef GSL_SHMEM_MGR_STATS_ENABLE
+	stats.curr_bytes_free_scratch += freed_sz;
+#endif
 
-	return resulting_free_block_sz;
+	return page->free_frame_mask ==
+		GSL_SHMEM_MGR_FRAME_MASK(page->max_num_blocks);
 }
 
 int32_t gsl_shmem_alloc(uint32_t size_bytes, uint32_t master_proc_id,
@@ -886,12 +955,15 @@ int32_t gsl_shmem_alloc_ext(uint32_t size_bytes, uint32_t spf_ss_mask,
 {
 	int32_t rc = AR_EOK;
 	uint32_t size_frame_aligned = 0, size_page_aligned = 0, bin_idx = 0;
-	struct gsl_shmem_page *page;
+	struct gsl_shmem_page *page = NULL;
+	struct gsl_shmem_bin *bin = NULL;
 	uint64_t offset = 0;
-	uint32_t i = 0;
-	int16_t j;
+	uint32_t i = 0, num_frames = 0, free_classes = 0, frame_idx = 0;
 	bool_t block_found = false;
-	ar_list_node_t *itr = NULL;
+#ifdef GSL_SHMEM_MGR_STATS_ENABLE
+	uint64_t start_time_us = ar_timer_get_time_in_us();
+	uint32_t alloc_time_us = 0;
+#endif
 
 	if (!alloc_data || size_bytes == 0)
 		return AR_EBADPARAM;
@@ -922,88 +994,66 @@ int32_t gsl_shmem_alloc_ext(uint32_t size_bytes, uint32_t spf_ss_mask,
 	 */
 	if (bin_idx == GSL_SHMEM_MGR_BIN_IDX_DEDICATED)
 		size_frame_aligned = size_page_aligned;
+	num_frames = GSL_SHMEM_MGR_CONVERT_BYTES_TO_FRAMES(size_frame_aligned);
 
 	GSL_MUTEX_LOCK(ctxt[master_proc_id]->mutex);
 	/*
-	 * scan through all bins and try to find if a suitable free block is
-	 * available. Note: We purposely dont search in the last bin as this
-	 * holds either dedicated pages or very large size pages which are meant
-	 * for single allocations only
+	 * look for a scratch page with a long enough free run, taking the page
+	 * from the smallest free list that fits. Note: We purposely dont search
+	 * in the last bin as this holds either dedicated pages or very large
+	 * size pages which are meant for single allocations only
 	 */
 	for (i = bin_idx; i <= GSL_SHMEM_MGR_BIN_IDX_SCRATCH; ++i) {
-		if (ctxt[master_proc_id]->bins[i].num_pages == 0)
+		bin = &ctxt[master_proc_id]->bins[i];
+		free_classes = bin->free_class_mask &
+			~GSL_SHMEM_MGR_FRAME_MASK(num_frames);
+		if (free_classes == 0)
 			continue;
 
-		ar_list_for_each_entry(itr, &ctxt[master_proc_id]->bins[i].page_list) {
-			page = get_container_base(itr, struct gsl_shmem_page, node);
-
-			/* search for free block */
-			j = 0;
-			while (j != -1) {
-				if (!(page->blocks[j].size_bytes &
-					GSL_SHMEM_MGR_BLOCK_SZ_USED_BIT_MASK) &&
-					(size_frame_aligned <= page->blocks[j].size_bytes)) {
-
-					/* found suitable block */
-					alloc_data->handle = page;
-					alloc_data->spf_mmap_handle = page->spf_handle;
-					alloc_data->v_addr = do_alloc_block(page, j,
-						size_frame_aligned);
-					/* compute PA for this block */
-					offset = (uint8_t *)alloc_data->v_addr -
-						(uint8_t *)page->shmem_info.vaddr;
-					if (GSL_SHMEM_IS_OFFSET_MODE(page->shmem_info.index_type)) {
-						alloc_data->spf_addr = offset;
-					} else {
-						alloc_data->spf_addr =
-							((uint64_t)page->shmem_info.ipa_msw << 32) +
-							page->shmem_info.ipa_lsw + offset;
-					}
-					alloc_data->metadata = page->shmem_info.metadata;
-					block_found = true;
-#ifdef GSL_SHMEM_MGR_STATS_ENABLE
-					page->blocks[j].requested_size_bytes = size_bytes;
-#endif
-					break;
-				}
-				j = page->blocks[j].successor_idx;
-			}
-			if (block_found)
-				break;
-		}
-		if (block_found)
-			break;
+		page = get_container_base(ar_list_get_head(
+			&bin->free_lists[gsl_shmem_lowest_bit(free_classes)]),
+			struct gsl_shmem_page, free_node);
+		frame_idx = gsl_shmem_lowest_bit(gsl_shmem_free_run_starts(
+			page->free_frame_mask, num_frames));
+		block_found = true;
+		break;
 	}
 
 	if (!block_found) {
 		/* no suitable block found in existing pages, allocate a new page */
 
-		if (bin_idx == GSL_SHMEM_MGR_BIN_IDX_PRE_ALLOC_SCRATCH)
+		if (bin_idx == GSL_SHMEM_MGR_BIN_IDX_PRE_ALLOC_SCRATCH) {
 			bin_idx = GSL_SHMEM_MGR_BIN_IDX_SCRATCH;
+#ifdef GSL_SHMEM_MGR_STATS_ENABLE
+			if (stats.curr_bytes_free_scratch >= size_frame_aligned)
+				++stats.num_fragmented_allocs;
+#endif
+		}
 
 		rc = allocate_page(size_page_aligned, bin_idx, spf_ss_mask, flags,
 			platform_info, GSL_EXT_MEM_HDL_NOT_ALLOCD, master_proc_id, &page);
 		if (rc)
 			goto exit;
-		alloc_data->handle = page;
-		alloc_data->v_addr = do_alloc_block(page, 0, size_frame_aligned);
-		alloc_data->spf_mmap_handle = page->spf_handle;
-		/* compute PA for this block */
-		offset = (uint8_t *)alloc_data->v_addr -
-			(uint8_t *)page->shmem_info.vaddr;
-		if (GSL_SHMEM_IS_OFFSET_MODE(page->shmem_info.index_type))
-			alloc_data->spf_addr = offset;
-		else
-			alloc_data->spf_addr =
-				((uint64_t) page->shmem_info.ipa_msw << 32) +
-				page->shmem_info.ipa_lsw + offset;
-		alloc_data->metadata = page->shmem_info.metadata;
-#ifdef GSL_SHMEM_MGR_STATS_ENABLE
-		page->blocks[0].requested_size_bytes = size_bytes;
-#endif
+		frame_idx = 0;
 	}
 
+	alloc_data->handle = page;
+	alloc_data->v_addr = do_alloc_block(page, frame_idx, size_frame_aligned);
+	alloc_data->spf_mmap_handle = page->spf_handle;
+	/* compute PA for this block */
+	offset = (uint8_t *)alloc_data->v_addr -
+		(uint8_t *)page->shmem_info.vaddr;
+	if (GSL_SHMEM_IS_OFFSET_MODE(page->shmem_info.index_type))
+		alloc_data->spf_addr = offset;
+	else
+		alloc_data->spf_addr =
+			((uint64_t) page->shmem_info.ipa_msw << 32) +
+			page->shmem_info.ipa_lsw + offset;
+	alloc_data->metadata = page->shmem_info.metadata;
+
 #ifdef GSL_SHMEM_MGR_STATS_ENABLE
+	page->blocks[frame_idx].requested_size_bytes = size_bytes;
+
 	stats.curr_bytes_requested += size_bytes;
 	if (stats.curr_bytes_requested >= stats.max_bytes_requested)
 		stats.max_bytes_requested = stats.curr_bytes_requested;
@@ -1011,6 +1061,11 @@ int32_t gsl_shmem_alloc_ext(uint32_t size_bytes, uint32_t spf_ss_mask,
 	stats.curr_bytes_allocated += size_frame_aligned;
 	if (stats.curr_bytes_allocated >= stats.max_bytes_allocated)
 		stats.max_bytes_allocated = stats.curr_bytes_allocated;
+
+	++stats.num_allocs;
+	alloc_time_us = (uint32_t)(ar_timer_get_time_in_us() - start_time_us);
+	if (alloc_time_us > stats.max_alloc_time_us)
+		stats.max_alloc_time_us = alloc_time_us;
 	GSL_LOG_PKT("mem_stat", GSL_SHMEM_SRC_PORT, &stats,
 		sizeof(struct gsl_shmem_stats), NULL, 0);
 #endif
@@ -1023,11 +1078,15 @@ exit:
 int32_t gsl_shmem_free(struct gsl_shmem_alloc_data *alloc_data)
 {
 	struct gsl_shmem_page *page;
-	int16_t freed_block_idx = 0;
-	uint32_t resulting_free_block_sz = 0, bin_idx = 0;
+	uintptr_t offset = 0;
+	uint32_t freed_block_idx = 0, bin_idx = 0;
 	int32_t rc = AR_EOK;
-	bool_t found_block = false;
+	bool_t found_block = false, is_page_empty = false;
 	uint32_t master_proc_id;
+#ifdef GSL_SHMEM_MGR_STATS_ENABLE
+	uint64_t start_time_us = ar_timer_get_time_in_us();
+	uint32_t free_time_us = 0;
+#endif
 
 	if (!alloc_data)
 		return AR_EBADPARAM;
@@ -1042,29 +1101,34 @@ int32_t gsl_shmem_free(struct gsl_shmem_alloc_data *alloc_data)
 	if (!ctxt[master_proc_id])
 		return AR_EUNSUPPORTED;
 
+	/*
+	 * blocks are indexed by their first frame, an address outside the page
+	 * wraps around to an index past max_num_blocks
+	 */
+	offset = (uintptr_t)alloc_data->v_addr -
+		(uintptr_t)page->shmem_info.vaddr;
+	freed_block_idx = (uint32_t)(offset >> GSL_SHMEM_MGR_FRAME_SZ_SHIFT);
+
 	GSL_MUTEX_LOCK(ctxt[master_proc_id]->mutex);
 
 	/* find the block in page and free it */
-	while (freed_block_idx != (int16_t)(-1)) {
-		if (page->blocks[freed_block_idx].base_addr == alloc_data->v_addr) {
+	if (freed_block_idx < page->max_num_blocks &&
+		page->blocks[freed_block_idx].base_addr == alloc_data->v_addr &&
+		(page->blocks[freed_block_idx].size_bytes &
+		GSL_SHMEM_MGR_BLOCK_SZ_USED_BIT_MASK)) {
 #ifdef GSL_SHMEM_MGR_STATS_ENABLE
-			stats.curr_bytes_requested -=
-				page->blocks[freed_block_idx].requested_size_bytes;
-			stats.curr_bytes_allocated -=
-				page->blocks[freed_block_idx].size_bytes &
-				~GSL_SHMEM_MGR_BLOCK_SZ_USED_BIT_MASK;
+		stats.curr_bytes_requested -=
+			page->blocks[freed_block_idx].requested_size_bytes;
+		stats.curr_bytes_allocated -=
+			page->blocks[freed_block_idx].size_bytes &
+			~GSL_SHMEM_MGR_BLOCK_SZ_USED_BIT_MASK;
 #endif
-			/* found the block being freed */
-			resulting_free_block_sz = do_free_block(page, freed_block_idx);
-			found_block = true;
-			break;
-		}
-
-		freed_block_idx = page->blocks[freed_block_idx].successor_idx;
+		is_page_empty = do_free_block(page, freed_block_idx);
+		found_block = true;
 	}
 
 	 /* check if the page can be freed back to system */
-	if (found_block && resulting_free_block_sz == page->size_bytes) {
+	if (found_block && is_page_empty) {
 		/*
 		 * do not free page if it belongs to bin 0, this will be freed during
 		 * deinit
@@ -1077,6 +1141,10 @@ int32_t gsl_shmem_free(struct gsl_shmem_alloc_data *alloc_data)
 		rc = AR_ENOTEXIST;
 
 #ifdef GSL_SHMEM_MGR_STATS_ENABLE
+	++stats.num_frees;
+	free_time_us = (uint32_t)(ar_timer_get_time_in_us() - start_time_us);
+	if (free_time_us > stats.max_free_time_us)
+		stats.max_free_time_us = free_time_us;
 	GSL_LOG_PKT("mem_stat", GSL_SHMEM_SRC_PORT, &stats,
 		sizeof(struct gsl_shmem_stats), NULL, 0);
 #endif
@@ -1308,6 +1376,17 @@ int32_t gsl_shmem_init(uint32_t num_master_procs, uint32_t *master_procs)
 				goto free_ctxt;
 			}
 			ctxt[master_procs[i]]->bins[bin_idx].num_pages = 0;
+
+			for (j = 0; j < GSL_SHMEM_MGR_NUM_FREE_CLASSES; ++j) {
+				rc = ar_list_init(
+					&ctxt[master_procs[i]]->bins[bin_idx].free_lists[j],
+					NULL, NULL);
+				if (rc) {
+					GSL_ERR("ar init list failed %d", rc);
+					goto free_ctxt;
+				}
+			}
+			ctxt[master_procs[i]]->bins[bin_idx].free_class_mask = 0;
 		}
 	}
 
@@ -1333,12 +1412,7 @@ int32_t gsl_shmem_init(uint32_t num_master_procs, uint32_t *master_procs)
 		}
 
 #ifdef GSL_SHMEM_MGR_STATS_ENABLE
-	stats.curr_bytes_mapped = 0;
-	stats.curr_bytes_requested = 0;
-	stats.curr_bytes_allocated = 0;
-	stats.max_bytes_mapped = 0;
-	stats.max_bytes_requested = 0;
-	stats.max_bytes_allocated = 0;
+	gsl_memset(&stats, 0, sizeof(stats));
 #endif
 		/*
 		 * allocate a page and keep it mapped till de-init, this is to somewhat
@@ -18,13 +18,75 @@
 #include <string.h>
 #include <stdlib.h>
 
+/* sg_id hash buckets, sg_ids are hashed to the top bits */
+#define GSL_SG_POOL_BUCKET_SHIFT 8
+#define GSL_SG_POOL_NUM_BUCKETS (1 << GSL_SG_POOL_BUCKET_SHIFT)
 
 struct gsl_sg_pool {
 	ar_list_t sg_list; /**< list of all subgraphs in the system */
 	uint32_t num_subgraphs; /**< number of entries in subgraph pool */
 	ar_osal_mutex_t lock; /**< used to serialize operations on pool */
+	/** subgraphs of the pool chained through hash_next, indexed by sg_id */
+	struct gsl_subgraph *buckets[GSL_SG_POOL_NUM_BUCKETS];
 } sg_pool;
 
+static uint32_t gsl_sg_pool_hash(uint32_t sg_id)
+{
+	/* fibonacci hashing, sg_ids are often sequential */
+	return (sg_id * 0x9E3779B9U) >> (32 - GSL_SG_POOL_BUCKET_SHIFT);
+}
+
+/* below helpers must be called with sg_pool.lock held */
+static struct gsl_subgraph *gsl_sg_pool_find_or_add(uint32_t sg_id,
+	bool_t preload_only)
+{
+	struct gsl_subgraph *curr_sg = NULL;
+	uint32_t bucket = gsl_sg_pool_hash(sg_id);
+
+	/* check if sg_id already exists in the pool */
+	curr_sg = gsl_sg_pool_find(sg_id);
+
+	if (!curr_sg) {
+		/* subgraph does not exist, so add it to pool */
+		curr_sg = gsl_mem_zalloc(sizeof(struct gsl_subgraph));
+		if (curr_sg == NULL)
+			goto exit;
+		if (gsl_subgraph_init(curr_sg, sg_id) != AR_EOK) {
+			/* GSL_ERR("gsl_subgraph_init failed %d", rc); */
+			goto cleanup;
+		}
+
+		if (ar_list_add_tail(&sg_pool.sg_list, &curr_sg->node)
+			!= AR_EOK) {
+			/* GSL_ERR("ar_list_add_tail failed %d", rc); */
+			goto cleanup;
+		}
+		curr_sg->hash_next = sg_pool.buckets[bucket];
+		sg_pool.buckets[bucket] = curr_sg;
+		++sg_pool.num_subgraphs;
+	}
+	if (preload_only == FALSE)
+		++curr_sg->open_ref_cnt;
+	goto exit;
+
+cleanup:
+	gsl_mem_free(curr_sg);
+	curr_sg = NULL;
+exit:
+	return curr_sg;
+}
+
+static void gsl_sg_pool_unlink(struct gsl_subgraph *sg)
+{
+	struct gsl_subgraph **link =
+		&sg_pool.buckets[gsl_sg_pool_hash(sg->sg_id)];
+
+	while (*link && *link != sg)
+		link = &(*link)->hash_next;
+	if (*link)
+		*link = sg->hash_next;
+}
+
 int32_t gsl_sg_pool_init(void)
 {
 	int32_t rc = AR_EOK;
@@ -50,69 +112,73 @@ int32_t gsl_sg_pool_deinit(void)
 	return AR_EOK;
 }
 
-/* todo find SG from graph SG list */
 struct gsl_subgraph *gsl_sg_pool_find(uint32_t sgid)
 {
-	ar_list_node_t *curr = NULL;
-	struct gsl_subgraph *curr_sg = NULL;
+	struct gsl_subgraph *curr_sg = sg_pool.buckets[gsl_sg_pool_hash(sgid)];
+
+	while (curr_sg && curr_sg->sg_id != sgid)
+		curr_sg = curr_sg->hash_next;
 
-	ar_list_for_each_entry(curr, &sg_pool.sg_list) {
-		curr_sg = get_container_base(curr, struct gsl_subgraph, node);
-		if (curr_sg->sg_id == sgid)
-			goto exit;
-	}
-	curr_sg = NULL;
-exit:
 	return curr_sg;
 }
 
-struct gsl_subgraph *gsl_sg_pool_add(uint32_t sg_id, bool_t preload_only)
+int32_t gsl_sg_pool_find_list(const uint32_t *sg_ids, uint32_t num_sgs,
+	struct gsl_subgraph **sg_objs)
 {
-	struct gsl_subgraph *curr_sg = NULL;
+	int32_t rc = AR_EOK;
+	uint32_t i = 0;
 
-	GSL_MUTEX_LOCK(sg_pool.lock);
+	if (!sg_ids || !sg_objs)
+		return AR_EBADPARAM;
 
-	/* check if sg_id already exists in the pool */
-	curr_sg = gsl_sg_pool_find(sg_id);
+	GSL_MUTEX_LOCK(sg_pool.lock);
+	for (; i < num_sgs; ++i) {
+		sg_objs[i] = gsl_sg_pool_find(sg_ids[i]);
+		if (!sg_objs[i])
+			rc = AR_ENOTEXIST;
+	}
+	GSL_MUTEX_UNLOCK(sg_pool.lock);
 
-	if (!curr_sg) {
-		/* subgraph does not exist, so add it to pool */
-		curr_sg = gsl_mem_zalloc(sizeof(struct gsl_subgraph));
-		if (curr_sg == NULL)
-			goto exit;
-		if (gsl_subgraph_init(curr_sg, sg_id) != AR_EOK) {
-			/* GSL_ERR("gsl_subgraph_init failed %d", rc); */
-			goto cleanup;
-		}
+	return rc;
+}
 
-		if (ar_list_add_tail(&sg_pool.sg_list, &curr_sg->node)
-			!= AR_EOK) {
-			/* GSL_ERR("ar_list_add_tail failed %d", rc); */
-			goto cleanup;
-		}
-		++sg_pool.num_subgraphs;
-	}
-	if (preload_only == FALSE)
-		++curr_sg->open_ref_cnt;
-	goto exit;
+struct gsl_subgraph *gsl_sg_pool_add(uint32_t sg_id, bool_t preload_only)
+{
+	struct gsl_subgraph *curr_sg = NULL;
 
-cleanup:
-	gsl_mem_free(curr_sg);
-	curr_sg = NULL;
-exit:
+	GSL_MUTEX_LOCK(sg_pool.lock);
+	curr_sg = gsl_sg_pool_find_or_add(sg_id, preload_only);
 	GSL_MUTEX_UNLOCK(sg_pool.lock);
+
 	return curr_sg;
 }
 
-
-int32_t gsl_sg_pool_remove(struct gsl_subgraph *sg, bool_t unload_only)
+int32_t gsl_sg_pool_add_list(const uint32_t *sg_ids, uint32_t num_sgs,
+	bool_t preload_only, struct gsl_subgraph **sg_objs)
 {
 	int32_t rc = AR_EOK;
+	uint32_t i = 0;
 
-	if (sg == NULL)
+	if (!sg_ids || !sg_objs)
 		return AR_EBADPARAM;
 
 	GSL_MUTEX_LOCK(sg_pool.lock);
+	for (; i < num_sgs; ++i) {
+		sg_objs[i] = gsl_sg_pool_find_or_add(sg_ids[i], preload_only);
+		if (!sg_objs[i])
+			rc = AR_ENOMEMORY;
+	}
+	GSL_MUTEX_UNLOCK(sg_pool.lock);
+
+	return rc;
+}
+
+
+/* must be called with sg_pool.lock held */
+static int32_t gsl_sg_pool_release(struct gsl_subgraph *sg, bool_t unload_only)
+{
+	int32_t rc = AR_EOK;
+
 	if (sg->open_ref_cnt > 0 && (unload_only == FALSE))
 		sg->open_ref_cnt--;
 
@@ -122,6 +188,7 @@ int32_t gsl_sg_pool_remove(struct gsl_subgraph *sg, bool_t unload_only)
 			GSL_ERR("ar list delete failed %d", rc);
 			goto exit;
 		}
+		gsl_sg_pool_unlink(sg);
 		--sg_pool.num_subgraphs;
 		/*
 		 * Do not free if we fail to remove from list, to preserve the
@@ -130,10 +197,45 @@ int32_t gsl_sg_pool_remove(struct gsl_subgraph *sg, bool_t unload_only)
 		gsl_mem_free(sg);
 	}
 exit:
+	return rc;
+}
+
+int32_t gsl_sg_pool_remove(struct gsl_subgraph *sg, bool_t unload_only)
+{
+	int32_t rc = AR_EOK;
+
+	if (sg == NULL)
+		return AR_EBADPARAM;
+
+	GSL_MUTEX_LOCK(sg_pool.lock);
+	rc = gsl_sg_pool_release(sg, unload_only);
 	GSL_MUTEX_UNLOCK(sg_pool.lock);
 	return rc;
 }
 
+int32_t gsl_sg_pool_remove_list(struct gsl_subgraph **sg_objs,
+	uint32_t num_sgs, bool_t unload_only)
+{
+	int32_t rc = AR_EOK;
+	uint32_t i = 0;
+
+	if (!sg_objs)
+		return AR_EBADPARAM;
+
+	GSL_MUTEX_LOCK(sg_pool.lock);
+	for (; i < num_sgs; ++i) {
+		if (!sg_objs[i]) {
+			rc = AR_EBADPARAM;
+			continue;
+		}
+		if (gsl_sg_pool_release(sg_objs[i], unload_only) != AR_EOK)
+			rc = AR_EFAILED;
+	}
+	GSL_MUTEX_UNLOCK(sg_pool.lock);
+
+	return rc;
+}
+
 uint32_t gsl_sg_pool_prune_sg_list(struct gsl_subgraph **subgraphs,
 	uint32_t num_sgs, struct gsl_cmd_properties *props,
 	struct gsl_sgid_list *pruned_sgids, struct gsl_sgid_list *existing_sgids)
@@ -149,6 +251,8 @@ uint32_t gsl_sg_pool_prune_sg_list(struct gsl_subgraph **subgraphs,
 
 	GSL_MUTEX_LOCK(sg_pool.lock);
 	for (; i < num_sgs; ++i) {
+		if (!subgraphs[i])
+			continue;
 		if (subgraphs[i]->open_ref_cnt == 1 &&
 			(!props || is_matching_sg_property(subgraphs[i], props)))
 			pruned_sgids->sg_ids[pruned_sgids->len++] = subgraphs[i]->sg_id;
@@ -167,18 +271,19 @@ void gsl_sg_pool_update_child_refs(void)
 	struct gsl_subgraph *parent_sg = NULL;
 	struct gsl_child_sg *child_entry = NULL;
 
-	/* scan through the children of every subgraph in the pool */
+	/*
+	 * scan through the children of every subgraph in the pool once, each
+	 * unresolved child costs a single hash lookup
+	 */
+	GSL_MUTEX_LOCK(sg_pool.lock);
 	ar_list_for_each_entry(parent, &sg_pool.sg_list) {
 		parent_sg = get_container_base(parent, struct gsl_subgraph, node);
 		ar_list_for_each_entry(child, &parent_sg->children)	{
-			/*
-			 * update the sg_obj for this child only if not already set,
-			 * gsl_sg_pool_find does a linear search through the entire pool
-			 * so we only want to call it when necessary
-			 */
+			/* update the sg_obj for this child only if not already set */
 			child_entry = get_container_base(child, struct gsl_child_sg, node);
 			if (!child_entry->sg_obj)
 				child_entry->sg_obj = gsl_sg_pool_find(child_entry->sg_id);
 		}
 	}
+	GSL_MUTEX_UNLOCK(sg_pool.lock);
 }